@@ -0,0 +1,302 @@
+#include <scai/dmemo/GenBlockDistribution.hpp>
+#include <scai/hmemo/ReadAccess.hpp>
+#include <scai/hmemo/WriteAccess.hpp>
+#include <scai/tracing.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include "AutoTuner.h"
+#include "GraphUtils.h"
+#include "KMeans.h"
+#include "Metrics.h"
+
+namespace ITI {
+
+template<typename IndexType, typename ValueType>
+Settings AutoTuner<IndexType, ValueType>::tune(
+    const CSRSparseMatrix<ValueType>& graph,
+    const std::vector<DenseVector<ValueType>>& coordinates,
+    const std::vector<DenseVector<ValueType>>& nodeWeights,
+    const Settings& settings) {
+
+    SCAI_REGION("AutoTuner.tune");
+    std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
+
+    const scai::dmemo::CommunicatorPtr comm = graph.getRowDistributionPtr()->getCommunicatorPtr();
+    const std::string key = featureKey(graph, settings);
+
+    Settings result(settings);
+
+    std::map<std::string,std::map<std::string,double>> database;
+    if (settings.tuningDBFile != "-") {
+        database = readDatabase(settings.tuningDBFile);
+        const auto entry = database.find(key);
+        if (entry != database.end()) {
+            PRINT0("Autotuning: using the stored parameters for " << key);
+            setParameters(result, entry->second);
+            return result;
+        }
+    }
+
+    //the probes must not stop at the deadlines of a time budget
+    Settings probeSettings(settings);
+    probeSettings.verbose = false;
+    probeSettings.initialDeadline = 0;
+    probeSettings.refinementDeadline = 0;
+    if (probeSettings.sfcResolution <= 0) {
+        probeSettings.sfcResolution = std::min(IndexType(std::log2(coordinates[0].size())), IndexType(21));
+    }
+
+    std::vector<DenseVector<ValueType>> sampleCoordinates;
+    std::vector<DenseVector<ValueType>> sampleWeights;
+    const IndexType stride = std::max(IndexType(std::round(1/settings.tuningSampleFraction)), IndexType(1));
+    samplePoints(coordinates, nodeWeights, stride, sampleCoordinates, sampleWeights);
+
+    //minSamplingNodes sets the size of the first sampling round, on the sample the same fraction of the points is stride times fewer
+    if (probeSettings.minSamplingNodes > 0) {
+        probeSettings.minSamplingNodes = std::max(probeSettings.minSamplingNodes/stride, IndexType(1));
+    }
+    PRINT0("Autotuning " << key << " on a sample of " << sampleCoordinates[0].size() << " points");
+
+    std::pair<ValueType,ValueType> best = probe(sampleCoordinates, sampleWeights, probeSettings);
+
+    //faster is better if the imbalance is within the target, otherwise better balance
+    auto isBetter = [&](const std::pair<ValueType,ValueType>& a, const std::pair<ValueType,ValueType>& b) {
+        const bool aBalanced = a.second <= settings.epsilon;
+        const bool bBalanced = b.second <= settings.epsilon;
+        if (aBalanced != bBalanced) return aBalanced;
+        return aBalanced ? a.first < b.first : a.second < b.second;
+    };
+
+    const IndexType sfc = probeSettings.sfcResolution;
+    std::map<std::string,std::vector<double>> candidates = {
+        {"sfcResolution", {double(sfc > 4 ? sfc-2 : 2), double(sfc+2)}},
+        {"minSamplingNodes", {50, 100, 200, 500}},
+        {"influenceChangeCap", {0.05, 0.1, 0.2}}
+    };
+    //the batches are only used by the rebalancing
+    if (settings.initialPartition == Tool::geoKmeansBalance) {
+        candidates["batchPercent"] = {0.005, 0.01, 0.05};
+    }
+
+    //one parameter after the other, starting from the best configuration so far
+    for (const auto& parameter : candidates) {
+        const double current = getParameters(probeSettings)[parameter.first];
+        for (const double value : parameter.second) {
+            if (value == current) continue;
+            Settings candidateSettings(probeSettings);
+            setParameters(candidateSettings, {{parameter.first, value}});
+            const std::pair<ValueType,ValueType> measured = probe(sampleCoordinates, sampleWeights, candidateSettings);
+            PRINT0("Autotuning: " << parameter.first << "=" << value << ", time " << measured.first << ", imbalance " << measured.second);
+            if (isBetter(measured, best)) {
+                best = measured;
+                probeSettings = candidateSettings;
+            }
+        }
+    }
+
+    if (probeSettings.minSamplingNodes > 0) {
+        probeSettings.minSamplingNodes *= stride;
+    }
+    const std::map<std::string,double> parameters = getParameters(probeSettings);
+    setParameters(result, parameters);
+
+    if (comm->getRank() == 0) {
+        std::cout << "Autotuning chose";
+        for (const auto& parameter : parameters) {
+            std::cout << " " << parameter.first << "=" << parameter.second;
+        }
+        std::cout << std::endl;
+    }
+
+    if (settings.tuningDBFile != "-" and comm->getRank() == 0) {
+        database[key] = parameters;
+        writeDatabase(settings.tuningDBFile, database);
+    }
+
+    std::chrono::duration<double> tuningTime = std::chrono::steady_clock::now() - startTime;
+    PRINT0("Time for autotuning: " << comm->max(tuningTime.count()));
+
+    return result;
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+std::string AutoTuner<IndexType, ValueType>::featureKey(const CSRSparseMatrix<ValueType>& graph, const Settings& settings) {
+    const scai::dmemo::CommunicatorPtr comm = graph.getRowDistributionPtr()->getCommunicatorPtr();
+    const IndexType n = graph.getNumRows();
+
+    IndexType localMaxDegree = 0;
+    {
+        const scai::hmemo::ReadAccess<IndexType> ia(graph.getLocalStorage().getIA());
+        for (IndexType i = 0; i+1 < ia.size(); i++) {
+            localMaxDegree = std::max(localMaxDegree, ia[i+1]-ia[i]);
+        }
+    }
+    const IndexType maxDegree = comm->max(localMaxDegree);
+    const IndexType m = comm->sum(graph.getLocalStorage().getJA().size()) / 2;
+
+    auto log2Round = [](const IndexType x) {
+        return x > 0 ? IndexType(std::round(std::log2(x))) : IndexType(0);
+    };
+
+    std::ostringstream key;
+    key << "n2^" << log2Round(n) << "_m2^" << log2Round(m) << "_maxdeg2^" << log2Round(maxDegree)
+        << "_dim" << settings.dimensions << "_k" << settings.numBlocks << "_p" << comm->getSize();
+    return key.str();
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+std::pair<ValueType,ValueType> AutoTuner<IndexType, ValueType>::probe(
+    const std::vector<DenseVector<ValueType>>& coordinates,
+    const std::vector<DenseVector<ValueType>>& nodeWeights,
+    const Settings& settings) {
+
+    SCAI_REGION("AutoTuner.probe");
+    const scai::dmemo::CommunicatorPtr comm = coordinates[0].getDistributionPtr()->getCommunicatorPtr();
+    const IndexType numWeights = nodeWeights.size();
+
+    std::vector<std::vector<ValueType>> blockSizes(numWeights);
+    for (IndexType w = 0; w < numWeights; w++) {
+        blockSizes[w].assign(settings.numBlocks, std::ceil(nodeWeights[w].sum()/settings.numBlocks));
+    }
+
+    Metrics<ValueType> metrics(settings);
+    comm->synchronize();
+    std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
+
+    DenseVector<IndexType> partition;
+    if (settings.initialPartition == Tool::geoKmeansBalance) {
+        partition = KMeans<IndexType, ValueType>::computePartition_targetBalance(coordinates, nodeWeights, blockSizes, partition, settings, metrics);
+    } else {
+        partition = KMeans<IndexType, ValueType>::computePartition(coordinates, nodeWeights, blockSizes, settings, metrics);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    const ValueType time = comm->max(elapsed.count());
+
+    ValueType imbalance = 0;
+    for (IndexType w = 0; w < numWeights; w++) {
+        imbalance = std::max(imbalance, GraphUtils<IndexType, ValueType>::computeImbalance(partition, settings.numBlocks, nodeWeights[w], blockSizes[w]));
+    }
+    return std::make_pair(time, imbalance);
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void AutoTuner<IndexType, ValueType>::samplePoints(
+    const std::vector<DenseVector<ValueType>>& coordinates,
+    const std::vector<DenseVector<ValueType>>& nodeWeights,
+    const IndexType stride,
+    std::vector<DenseVector<ValueType>>& sampleCoordinates,
+    std::vector<DenseVector<ValueType>>& sampleWeights) {
+
+    const scai::dmemo::DistributionPtr dist = coordinates[0].getDistributionPtr();
+    const scai::dmemo::CommunicatorPtr comm = dist->getCommunicatorPtr();
+    const IndexType localN = dist->getLocalSize();
+
+    //the first local point is always taken, k-means needs points on every PE
+    const IndexType sampleLocalN = (localN + stride - 1) / stride;
+    const IndexType sampleGlobalN = comm->sum(sampleLocalN);
+    const scai::dmemo::DistributionPtr sampleDist = scai::dmemo::genBlockDistributionBySize(sampleGlobalN, sampleLocalN, comm);
+
+    auto sample = [&](const DenseVector<ValueType>& vector) {
+        scai::hmemo::HArray<ValueType> values(sampleLocalN);
+        {
+            const scai::hmemo::ReadAccess<ValueType> rValues(vector.getLocalValues());
+            scai::hmemo::WriteAccess<ValueType> wValues(values);
+            for (IndexType i = 0; i < sampleLocalN; i++) {
+                wValues[i] = rValues[i*stride];
+            }
+        }
+        return DenseVector<ValueType>(sampleDist, std::move(values));
+    };
+
+    sampleCoordinates.clear();
+    for (const DenseVector<ValueType>& coords : coordinates) {
+        sampleCoordinates.push_back(sample(coords));
+    }
+    sampleWeights.clear();
+    for (const DenseVector<ValueType>& weights : nodeWeights) {
+        sampleWeights.push_back(sample(weights));
+    }
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+std::map<std::string,double> AutoTuner<IndexType, ValueType>::getParameters(const Settings& settings) {
+    return {
+        {"sfcResolution", settings.sfcResolution},
+        {"minSamplingNodes", settings.minSamplingNodes},
+        {"influenceChangeCap", settings.influenceChangeCap},
+        {"batchPercent", settings.batchPercent}
+    };
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void AutoTuner<IndexType, ValueType>::setParameters(Settings& settings, const std::map<std::string,double>& parameters) {
+    for (const auto& parameter : parameters) {
+        const std::string& name = parameter.first;
+        const double value = parameter.second;
+        if (name == "sfcResolution") {
+            settings.sfcResolution = IndexType(value);
+        } else if (name == "minSamplingNodes") {
+            settings.minSamplingNodes = IndexType(value);
+        } else if (name == "influenceChangeCap") {
+            settings.influenceChangeCap = value;
+        } else if (name == "batchPercent") {
+            settings.batchPercent = value;
+        } else if (name == "coarseningStepsBetweenRefinement") {
+            settings.coarseningStepsBetweenRefinement = IndexType(value);
+        } else if (name == "minBorderNodesPercent") {
+            settings.minBorderNodesPercent = value;
+        }
+    }
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+std::map<std::string,std::map<std::string,double>> AutoTuner<IndexType, ValueType>::readDatabase(const std::string& filename) {
+    std::map<std::string,std::map<std::string,double>> database;
+    std::ifstream in(filename);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream tokens(line);
+        std::string key, pair;
+        if (!(tokens >> key) or key[0] == '%') continue;
+        while (tokens >> pair) {
+            const size_t separator = pair.find('=');
+            if (separator == std::string::npos) continue;
+            database[key][pair.substr(0, separator)] = std::stod(pair.substr(separator+1));
+        }
+    }
+    return database;
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void AutoTuner<IndexType, ValueType>::writeDatabase(const std::string& filename, const std::map<std::string,std::map<std::string,double>>& database) {
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        std::cout << "WARNING: could not write the tuning database " << filename << std::endl;
+        return;
+    }
+    for (const auto& entry : database) {
+        out << entry.first;
+        for (const auto& parameter : entry.second) {
+            out << " " << parameter.first << "=" << parameter.second;
+        }
+        out << std::endl;
+    }
+}
+//---------------------------------------------------------------------------------------
+
+template class AutoTuner<IndexType, double>;
+template class AutoTuner<IndexType, float>;
+
+} // namespace ITI
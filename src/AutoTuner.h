@@ -0,0 +1,89 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <scai/lama/DenseVector.hpp>
+#include <scai/lama/matrix/CSRSparseMatrix.hpp>
+
+#include "Settings.h"
+
+namespace ITI {
+
+using scai::lama::CSRSparseMatrix;
+using scai::lama::DenseVector;
+
+/** @brief Choose performance parameters for an input, by probing on a sample or from a tuning database.
+
+The tuned parameters are sfcResolution, minSamplingNodes, influenceChangeCap and batchPercent. The probes only run
+k-means, so the multilevel parameters coarseningStepsBetweenRefinement and minBorderNodesPercent are not tuned, but
+an entry of the database written by hand may set them.
+
+Inputs are described by features: the number of vertices and edges, the maximum degree, the dimensions, k and p.
+The sizes are rounded to powers of two, so that similar inputs share an entry of the database.
+If the database has an entry for the features, its parameters are used. Otherwise the k-means of
+settings.initialPartition is run on a sample of the points for a few candidates of every probed parameter,
+one parameter after the other. The fastest configuration whose imbalance is within settings.epsilon is kept
+and stored in the database. minSamplingNodes is probed for the sample and scaled by the inverse sample fraction,
+so that the first sampling round covers the same fraction of the full input.
+
+The database is a text file with one line per entry: the features key followed by name=value pairs.
+*/
+
+template <typename IndexType, typename ValueType>
+class AutoTuner {
+public:
+
+    /** Settings with the tuned parameters. Collective operation.
+
+    @param[in] graph The adjacency matrix of the graph, only used for the features.
+    @param[in] coordinates The coordinates of the vertices, with the row distribution of the graph.
+    @param[in] nodeWeights The node weights, with the row distribution of the graph.
+    @param[in] settings Uses tuningDBFile, tuningSampleFraction, numBlocks, epsilon and initialPartition.
+
+    @return A copy of settings with the tuned parameters.
+    */
+    static Settings tune(
+        const CSRSparseMatrix<ValueType>& graph,
+        const std::vector<DenseVector<ValueType>>& coordinates,
+        const std::vector<DenseVector<ValueType>>& nodeWeights,
+        const Settings& settings);
+
+    /** The key of the input in the tuning database. Collective operation.
+    */
+    static std::string featureKey(const CSRSparseMatrix<ValueType>& graph, const Settings& settings);
+
+    /** Run k-means on the points with the given settings.
+    @return The time, maximum over all PEs, and the imbalance of the partition.
+    */
+    static std::pair<ValueType,ValueType> probe(
+        const std::vector<DenseVector<ValueType>>& coordinates,
+        const std::vector<DenseVector<ValueType>>& nodeWeights,
+        const Settings& settings);
+
+    /** Every stride-th local point, the sample has a block distribution.
+    */
+    static void samplePoints(
+        const std::vector<DenseVector<ValueType>>& coordinates,
+        const std::vector<DenseVector<ValueType>>& nodeWeights,
+        const IndexType stride,
+        std::vector<DenseVector<ValueType>>& sampleCoordinates,
+        std::vector<DenseVector<ValueType>>& sampleWeights);
+
+    /** The values of the tuned parameters, these are stored in the database.
+    */
+    static std::map<std::string,double> getParameters(const Settings& settings);
+
+    /** Set the parameters, unknown names are ignored.
+    */
+    static void setParameters(Settings& settings, const std::map<std::string,double>& parameters);
+
+    /** All entries of the database, empty if the file does not exist.
+    */
+    static std::map<std::string,std::map<std::string,double>> readDatabase(const std::string& filename);
+
+    static void writeDatabase(const std::string& filename, const std::map<std::string,std::map<std::string,double>>& database);
+};
+
+} // namespace ITI
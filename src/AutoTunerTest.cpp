@@ -0,0 +1,100 @@
+#include <cstdio>
+
+#include "gtest/gtest.h"
+
+#include "AutoTuner.h"
+#include "FileIO.h"
+
+namespace ITI {
+
+template<typename T>
+class AutoTunerTest : public ::testing::Test {
+protected:
+    // the directory of all the meshes used
+    // projectRoot is defined in config.h.in
+    const std::string graphPath = projectRoot+"/meshes/";
+};
+
+using testTypes = ::testing::Types<double,float>;
+TYPED_TEST_SUITE(AutoTunerTest, testTypes);
+
+//-----------------------------------------------
+
+TYPED_TEST(AutoTunerTest, testTuneAndStore) {
+    using ValueType = TypeParam;
+
+    std::string fileName = "bubbles-00010.graph";
+    std::string file = AutoTunerTest<ValueType>::graphPath + fileName;
+    const IndexType dimensions = 2;
+
+    const scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+
+    CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph(file);
+    const IndexType n = graph.getNumRows();
+    std::vector<DenseVector<ValueType>> coords = FileIO<IndexType, ValueType>::readCoords( std::string(file + ".xyz"), n, dimensions);
+    std::vector<DenseVector<ValueType>> nodeWeights(1, DenseVector<ValueType>(graph.getRowDistributionPtr(), 1));
+
+    Settings settings;
+    settings.numBlocks = 4;
+    settings.dimensions = dimensions;
+    settings.autoTune = true;
+    settings.tuningSampleFraction = 0.5;
+    settings.tuningDBFile = "autoTunerTest_" + std::to_string(comm->getSize()) + ".db";
+    if (comm->getRank() == 0) {
+        std::remove(settings.tuningDBFile.c_str());
+    }
+    comm->synchronize();
+
+    const Settings tuned = AutoTuner<IndexType, ValueType>::tune(graph, coords, nodeWeights, settings);
+    EXPECT_GT(tuned.sfcResolution, 0);
+    EXPECT_GT(tuned.influenceChangeCap, 0);
+
+    //the second call must use the stored entry
+    comm->synchronize();
+    const std::string key = AutoTuner<IndexType, ValueType>::featureKey(graph, settings);
+    const auto database = AutoTuner<IndexType, ValueType>::readDatabase(settings.tuningDBFile);
+    ASSERT_EQ(1, database.count(key));
+    EXPECT_EQ(tuned.sfcResolution, database.at(key).at("sfcResolution"));
+    //probed on every second point, for the full input
+    EXPECT_EQ(0, tuned.minSamplingNodes % 2);
+    //not probed, so not stored
+    EXPECT_EQ(0, database.at(key).count("coarseningStepsBetweenRefinement"));
+    EXPECT_EQ(0, database.at(key).count("minBorderNodesPercent"));
+
+    Settings changed(settings);
+    changed.influenceChangeCap = 0.9;
+    const Settings stored = AutoTuner<IndexType, ValueType>::tune(graph, coords, nodeWeights, changed);
+    EXPECT_EQ(tuned.sfcResolution, stored.sfcResolution);
+    EXPECT_EQ(tuned.minSamplingNodes, stored.minSamplingNodes);
+    EXPECT_NEAR(tuned.influenceChangeCap, stored.influenceChangeCap, 1e-6);
+
+    comm->synchronize();
+    if (comm->getRank() == 0) {
+        std::remove(settings.tuningDBFile.c_str());
+    }
+}
+//-----------------------------------------------
+
+TYPED_TEST(AutoTunerTest, testDatabaseRoundTrip) {
+    using ValueType = TypeParam;
+
+    const scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+    const std::string filename = "autoTunerRoundTrip_" + std::to_string(comm->getRank()) + ".db";
+
+    std::map<std::string,std::map<std::string,double>> database;
+    database["n2^10_m2^11_maxdeg2^3_dim2_k4_p1"] = {{"sfcResolution", 7}, {"minBorderNodesPercent", 0.05}};
+    database["n2^20_m2^21_maxdeg2^4_dim3_k64_p64"] = {{"influenceChangeCap", 0.2}};
+    AutoTuner<IndexType, ValueType>::writeDatabase(filename, database);
+
+    const auto read = AutoTuner<IndexType, ValueType>::readDatabase(filename);
+    EXPECT_EQ(database, read);
+
+    Settings settings;
+    AutoTuner<IndexType, ValueType>::setParameters(settings, read.at("n2^10_m2^11_maxdeg2^3_dim2_k4_p1"));
+    EXPECT_EQ(7, settings.sfcResolution);
+    EXPECT_EQ(0.05, settings.minBorderNodesPercent);
+
+    std::remove(filename.c_str());
+}
+
+} // namespace ITI
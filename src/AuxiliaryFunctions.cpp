@@ -1,4 +1,5 @@
 #include "AuxiliaryFunctions.h"
+#include "Redistribution.h"
 #include "scai/partitioning/Partitioning.hpp"
 #include <numeric>
 
@@ -211,13 +212,12 @@ scai::dmemo::DistributionPtr aux<IndexType,ValueType>::redistributeFromPartition
     scai::dmemo::DistributionPtr distFromPartition;
 
     if( useRedistributor ) {
-        scai::dmemo::RedistributePlan resultRedist = scai::dmemo::redistributePlanByNewOwners(partition.getLocalValues(), partition.getDistributionPtr());
-        distFromPartition = resultRedist.getTargetDistributionPtr();
-        SCAI_ASSERT_EQ_ERROR( partition.getDistribution(), graph.getRowDistribution(), "Distributions do not agree");
-        
-        scai::dmemo::RedistributePlan redistributor = scai::dmemo::redistributePlanByNewDistribution( distFromPartition, graph.getRowDistributionPtr());
-    
-        redistributeInput( redistributor, partition, graph, coordinates, nodeWeights);      
+        //the new owners are known, move everything in one packed exchange
+        if( not graph.getColDistributionPtr()->isReplicated() ){
+            const scai::dmemo::DistributionPtr noDist(new scai::dmemo::NoDistribution(globalN));
+            graph.redistribute( graph.getRowDistributionPtr(), noDist );
+        }
+        distFromPartition = Redistribution<IndexType,ValueType>::redistributeByNewOwners( partition.getLocalValues(), graph, coordinates, nodeWeights, {&partition} );
     } else {
         // create new distribution from partition
         distFromPartition = scai::dmemo::generalDistributionByNewOwners( partition.getDistribution(), partition.getLocalValues());
@@ -242,20 +242,43 @@ void aux<IndexType,ValueType>::redistributeInput(
     std::vector<DenseVector<ValueType>>& coordinates,
     std::vector<DenseVector<ValueType>>& nodeWeights){
 
+    //column are not distributed
+    const IndexType globalN = coordinates[0].getDistributionPtr()->getGlobalSize();
+    const scai::dmemo::DistributionPtr noDist(new scai::dmemo::NoDistribution(globalN));
+    const scai::dmemo::Distribution& graphDist = graph.getRowDistribution();
+
+    bool aligned = true;
     for (IndexType d=0; d<coordinates.size(); d++) {
-        coordinates[d].redistribute( targetDistribution );
+        aligned = aligned and coordinates[d].getDistribution().isEqual( graphDist );
     }
-
     for(int w=0; w<nodeWeights.size(); w++){
-        nodeWeights[w].redistribute( targetDistribution );
+        aligned = aligned and nodeWeights[w].getDistribution().isEqual( graphDist );
     }
+    const bool partitionAligned = partition.getDistribution().isEqual( graphDist );
 
-    //column are not distributed
-    const IndexType globalN = coordinates[0].getDistributionPtr()->getGlobalSize();
-    const scai::dmemo::DistributionPtr noDist(new scai::dmemo::NoDistribution(globalN));
+    //the packed exchange needs all data on the same distribution, e.g., not the case in alignDistributions
+    if( not aligned ){
+        for (IndexType d=0; d<coordinates.size(); d++) {
+            coordinates[d].redistribute( targetDistribution );
+        }
+        for(int w=0; w<nodeWeights.size(); w++){
+            nodeWeights[w].redistribute( targetDistribution );
+        }
+        graph.redistribute( targetDistribution, noDist );
+        partition.redistribute( targetDistribution );
+        return;
+    }
 
-    graph.redistribute( targetDistribution, noDist );
-    partition.redistribute( targetDistribution );
+    if( not graph.getColDistributionPtr()->isReplicated() ){
+        graph.redistribute( graph.getRowDistributionPtr(), noDist );
+    }
+
+    if( partitionAligned ){
+        Redistribution<IndexType,ValueType>::redistribute( targetDistribution, graph, coordinates, nodeWeights, {&partition} );
+    } else {
+        partition.redistribute( targetDistribution );
+        Redistribution<IndexType,ValueType>::redistribute( targetDistribution, graph, coordinates, nodeWeights, {} );
+    }
 } 
 
 //---------------------------------------------------------------------------------------
@@ -324,7 +324,8 @@ public:
     	@param[out] graph The graph to be redistributed.
     	@param[out] coordinates The coordinates of the graoh to be redistributed.
     	@param[out] nodeWeights The node weights to be redistributed.
-    	@param[in] useRedistributor Flag if we should use or not a redistributor object.
+    	@param[in] useRedistributor If true, all data are moved together with Redistribution::redistributeByNewOwners,
+    	otherwise every vector and the graph are redistributed separately.
     	@param[in] renumberPEs Flag if we should renumber some PE if this reduces the communication volume.
     	@return The distribution pointer of the created distribution.
     **/
@@ -339,6 +340,10 @@ public:
         bool renumberPEs = true );
 
 
+    /** Redistribute the graph, coordinates, node weights and the partition to the target distribution.
+    	If they all share the row distribution of the graph, they are moved in one packed exchange,
+    	see Redistribution::redistribute.
+    */
     static void redistributeInput(
         const scai::dmemo::DistributionPtr targetDistribution,
         scai::lama::DenseVector<IndexType>& partition,
@@ -0,0 +1,288 @@
+#include <scai/dmemo/GeneralDistribution.hpp>
+#include <scai/dmemo/NoDistribution.hpp>
+#include <scai/tracing.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+#include "Checkpoint.h"
+
+namespace ITI {
+
+namespace {
+
+template<typename T>
+void writeArray(std::ofstream& out, const T* data, const IndexType n) {
+    out.write(reinterpret_cast<const char*>(data), sizeof(T)*n);
+}
+
+template<typename T>
+void readArray(std::ifstream& in, T* data, const IndexType n) {
+    in.read(reinterpret_cast<char*>(data), sizeof(T)*n);
+}
+
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+std::vector<std::string> Checkpoint<IndexType, ValueType>::stages() {
+    return {"input", "migrated", "initial", "refined"};
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+int Checkpoint<IndexType, ValueType>::stageIndex(const std::string& stage) {
+    const std::vector<std::string> names = stages();
+    const auto it = std::find(names.begin(), names.end(), stage);
+    return it == names.end() ? -1 : int(it - names.begin());
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+std::string Checkpoint<IndexType, ValueType>::fileName(const std::string& dir, const std::string& stage, const IndexType rank) {
+    return dir + "/" + stage + "_" + std::to_string(rank) + ".bin";
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void Checkpoint<IndexType, ValueType>::write(
+    const std::string& dir,
+    const std::string& stage,
+    const CSRSparseMatrix<ValueType>& graph,
+    const std::vector<DenseVector<ValueType>>& coordinates,
+    const std::vector<DenseVector<ValueType>>& nodeWeights,
+    const DenseVector<IndexType>& partition,
+    const scai::dmemo::CommunicatorPtr comm) {
+
+    SCAI_REGION("Checkpoint.write")
+    std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
+
+    const bool hasGraph = graph.getNumRows() > 0;
+    SCAI_ASSERT_ERROR(hasGraph or not coordinates.empty(), "Nothing to write for stage " << stage);
+    const scai::dmemo::DistributionPtr dist = hasGraph ? graph.getRowDistributionPtr() : coordinates[0].getDistributionPtr();
+    const IndexType globalN = dist->getGlobalSize();
+    const IndexType localN = dist->getLocalSize();
+
+    //all parts are written in the distribution of the rows
+    auto aligned = [&dist](DenseVector<ValueType> vector) {
+        if (not vector.getDistribution().isEqual(*dist)) {
+            vector.redistribute(dist);
+        }
+        return vector;
+    };
+
+    CSRSparseMatrix<ValueType> replicatedColumns;
+    if (hasGraph and not graph.getColDistributionPtr()->isReplicated()) {
+        replicatedColumns = graph;
+        replicatedColumns.redistribute(dist, scai::dmemo::DistributionPtr(new scai::dmemo::NoDistribution(globalN)));
+    }
+    const scai::lama::CSRStorage<ValueType>& storage = replicatedColumns.getNumRows() > 0 ? replicatedColumns.getLocalStorage() : graph.getLocalStorage();
+    const IndexType localNnz = hasGraph ? storage.getNumValues() : 0;
+    const IndexType hasPartition = partition.size() > 0 ? 1 : 0;
+
+    //the parts are overwritten now, and the later stages do not follow from this state any more
+    if (comm->getRank() == 0) {
+        std::remove((dir + "/" + stage + ".done").c_str());
+        const std::vector<std::string> names = stages();
+        for (int s = stageIndex(stage) + 1; s > 0 and s < int(names.size()); s++) {
+            std::remove((dir + "/" + names[s] + ".done").c_str());
+        }
+    }
+    comm->synchronize();
+
+    std::ofstream out(fileName(dir, stage, comm->getRank()), std::ios::binary);
+    if (out.is_open()) {
+        //the sizes of the types guard against reading a checkpoint of a differently compiled version
+        const std::vector<IndexType> header = {IndexType(sizeof(IndexType)), IndexType(sizeof(ValueType)), globalN, localN,
+            IndexType(hasGraph), localNnz, IndexType(coordinates.size()), IndexType(nodeWeights.size()), hasPartition};
+        writeArray(out, header.data(), header.size());
+
+        scai::hmemo::HArray<IndexType> ownedIndexes;
+        dist->getOwnedIndexes(ownedIndexes);
+        writeArray(out, scai::hmemo::ReadAccess<IndexType>(ownedIndexes).get(), localN);
+
+        if (hasGraph) {
+            writeArray(out, scai::hmemo::ReadAccess<IndexType>(storage.getIA()).get(), localN + 1);
+            writeArray(out, scai::hmemo::ReadAccess<IndexType>(storage.getJA()).get(), localNnz);
+            writeArray(out, scai::hmemo::ReadAccess<ValueType>(storage.getValues()).get(), localNnz);
+        }
+        for (const DenseVector<ValueType>& coords : coordinates) {
+            const DenseVector<ValueType> alignedCoords = aligned(coords);
+            writeArray(out, scai::hmemo::ReadAccess<ValueType>(alignedCoords.getLocalValues()).get(), localN);
+        }
+        for (const DenseVector<ValueType>& weights : nodeWeights) {
+            const DenseVector<ValueType> alignedWeights = aligned(weights);
+            writeArray(out, scai::hmemo::ReadAccess<ValueType>(alignedWeights.getLocalValues()).get(), localN);
+        }
+        if (hasPartition) {
+            DenseVector<IndexType> alignedPartition(partition);
+            if (not alignedPartition.getDistribution().isEqual(*dist)) {
+                alignedPartition.redistribute(dist);
+            }
+            writeArray(out, scai::hmemo::ReadAccess<IndexType>(alignedPartition.getLocalValues()).get(), localN);
+        }
+    }
+    const bool written = out.is_open() and out.good();
+    out.close();
+
+    if (comm->any(not written)) {
+        throw std::runtime_error("Could not write the checkpoint of stage " + stage + " to " + dir);
+    }
+
+    //mark the checkpoint complete only after all parts are written
+    if (comm->getRank() == 0) {
+        std::ofstream done(dir + "/" + stage + ".done");
+        done << comm->getSize() << std::endl;
+    }
+    comm->synchronize();
+
+    std::chrono::duration<double> writeTime = std::chrono::steady_clock::now() - startTime;
+    PRINT0("Wrote checkpoint of stage " << stage << " in " << comm->max(writeTime.count()) << " seconds");
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void Checkpoint<IndexType, ValueType>::read(
+    const std::string& dir,
+    const std::string& stage,
+    CSRSparseMatrix<ValueType>& graph,
+    std::vector<DenseVector<ValueType>>& coordinates,
+    std::vector<DenseVector<ValueType>>& nodeWeights,
+    DenseVector<IndexType>& partition,
+    const scai::dmemo::CommunicatorPtr comm) {
+
+    SCAI_REGION("Checkpoint.read")
+
+    std::ifstream in(fileName(dir, stage, comm->getRank()), std::ios::binary);
+    std::vector<IndexType> header(9, 0);
+    if (in.is_open()) {
+        readArray(in, header.data(), header.size());
+    }
+    const bool typesMatch = in.good() and header[0] == sizeof(IndexType) and header[1] == sizeof(ValueType);
+    if (comm->any(not typesMatch)) {
+        throw std::runtime_error("Could not read the checkpoint of stage " + stage + " from " + dir);
+    }
+
+    const IndexType globalN = header[2];
+    const IndexType localN = header[3];
+    const bool hasGraph = header[4];
+    const IndexType localNnz = header[5];
+    const IndexType numCoordinates = header[6];
+    const IndexType numWeights = header[7];
+    const bool hasPartition = header[8];
+
+    std::vector<IndexType> ownedIndexes(localN);
+    readArray(in, ownedIndexes.data(), localN);
+    const scai::dmemo::DistributionPtr dist = scai::dmemo::generalDistributionUnchecked(globalN, scai::hmemo::HArray<IndexType>(localN, ownedIndexes.data()), comm);
+    SCAI_ASSERT_EQ_ERROR(dist->getLocalSize(), localN, "Checkpoint of stage " << stage << " has duplicate global ids");
+
+    //the distribution may order its local indexes differently than they were written
+    std::vector<IndexType> newPosition(localN);
+    for (IndexType i = 0; i < localN; i++) {
+        newPosition[i] = dist->global2Local(ownedIndexes[i]);
+    }
+
+    if (hasGraph) {
+        std::vector<IndexType> ia(localN + 1), ja(localNnz);
+        std::vector<ValueType> values(localNnz);
+        readArray(in, ia.data(), localN + 1);
+        readArray(in, ja.data(), localNnz);
+        readArray(in, values.data(), localNnz);
+
+        scai::hmemo::HArray<IndexType> newIA(localN + 1, IndexType(0));
+        scai::hmemo::HArray<IndexType> newJA(localNnz);
+        scai::hmemo::HArray<ValueType> newValues(localNnz);
+        {
+            scai::hmemo::WriteAccess<IndexType> wIA(newIA);
+            for (IndexType i = 0; i < localN; i++) {
+                wIA[newPosition[i] + 1] = ia[i + 1] - ia[i];
+            }
+            for (IndexType i = 0; i < localN; i++) {
+                wIA[i + 1] += wIA[i];
+            }
+            scai::hmemo::WriteAccess<IndexType> wJA(newJA);
+            scai::hmemo::WriteAccess<ValueType> wValues(newValues);
+            for (IndexType i = 0; i < localN; i++) {
+                std::copy(ja.begin() + ia[i], ja.begin() + ia[i + 1], wJA.get() + wIA[newPosition[i]]);
+                std::copy(values.begin() + ia[i], values.begin() + ia[i + 1], wValues.get() + wIA[newPosition[i]]);
+            }
+        }
+        graph = CSRSparseMatrix<ValueType>(dist, scai::lama::CSRStorage<ValueType>(localN, globalN, std::move(newIA), std::move(newJA), std::move(newValues)));
+    }
+
+    auto readVector = [&](DenseVector<ValueType>& vector) {
+        std::vector<ValueType> values(localN);
+        readArray(in, values.data(), localN);
+        scai::hmemo::HArray<ValueType> localValues(localN);
+        {
+            scai::hmemo::WriteAccess<ValueType> wValues(localValues);
+            for (IndexType i = 0; i < localN; i++) {
+                wValues[newPosition[i]] = values[i];
+            }
+        }
+        vector = DenseVector<ValueType>(dist, std::move(localValues));
+    };
+
+    if (numCoordinates > 0) {
+        coordinates.resize(numCoordinates);
+        for (DenseVector<ValueType>& coords : coordinates) {
+            readVector(coords);
+        }
+    }
+    if (numWeights > 0) {
+        nodeWeights.resize(numWeights);
+        for (DenseVector<ValueType>& weights : nodeWeights) {
+            readVector(weights);
+        }
+    }
+    if (hasPartition) {
+        std::vector<IndexType> values(localN);
+        readArray(in, values.data(), localN);
+        scai::hmemo::HArray<IndexType> localValues(localN);
+        {
+            scai::hmemo::WriteAccess<IndexType> wValues(localValues);
+            for (IndexType i = 0; i < localN; i++) {
+                wValues[newPosition[i]] = values[i];
+            }
+        }
+        partition = DenseVector<IndexType>(dist, std::move(localValues));
+    }
+
+    if (comm->any(not in.good())) {
+        throw std::runtime_error("Checkpoint of stage " + stage + " in " + dir + " is truncated");
+    }
+    PRINT0("Resuming from the checkpoint of stage " << stage << " with " << globalN << " vertices");
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+bool Checkpoint<IndexType, ValueType>::exists(const std::string& dir, const std::string& stage, const scai::dmemo::CommunicatorPtr comm) {
+    bool complete = false;
+    if (comm->getRank() == 0) {
+        std::ifstream done(dir + "/" + stage + ".done");
+        IndexType numPEs = 0;
+        complete = (done >> numPEs) and numPEs == comm->getSize();
+    }
+    return comm->any(complete);
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+bool Checkpoint<IndexType, ValueType>::resumeAt(const std::string& stage, const Settings& settings, const scai::dmemo::CommunicatorPtr comm) {
+    if (settings.checkpointDir == "-" or settings.resumeFrom == "-") {
+        return false;
+    }
+    const int lastStage = settings.resumeFrom == "last" ? int(stages().size()) - 1 : stageIndex(settings.resumeFrom);
+    if (stageIndex(stage) > lastStage) {
+        return false;
+    }
+    return exists(settings.checkpointDir, stage, comm);
+}
+//---------------------------------------------------------------------------------------
+
+template class Checkpoint<IndexType, double>;
+template class Checkpoint<IndexType, float>;
+
+} // namespace ITI
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <scai/lama/DenseVector.hpp>
+#include <scai/lama/matrix/CSRSparseMatrix.hpp>
+
+#include "Settings.h"
+
+namespace ITI {
+
+using scai::lama::CSRSparseMatrix;
+using scai::lama::DenseVector;
+
+/** @brief Store and restore the distributed state of the partitioning pipeline after its stages.
+
+The stages, in their order, are
+ - input: the graph, coordinates and node weights as read by the driver,
+ - migrated: the coordinates and node weights after the space filling curve migration before k-means,
+ - initial: the input together with the initial partition,
+ - refined: the input together with the partition after local refinement.
+
+Every PE writes its local rows, with their global ids, to the file <dir>/<stage>_<rank>.bin. The global ids give
+the distribution back when the checkpoint is read. After all PEs are done, rank 0 writes <dir>/<stage>.done with
+the number of PEs, so only complete checkpoints are used. Before the parts of a stage are written, the .done files of
+the stage and of all later stages are removed, so an interrupted write or an earlier run does not leave a checkpoint
+that does not belong to the current state. The k-means centers are not stored, they are the
+centers of the blocks of the stored partition.
+*/
+
+template <typename IndexType, typename ValueType>
+class Checkpoint {
+public:
+
+    /** The position of the stage in the pipeline, \sa stages.
+    @return The index of the stage or -1 for an unknown stage.
+    */
+    static int stageIndex(const std::string& stage);
+
+    /** The names of the stages in their order.
+    */
+    static std::vector<std::string> stages();
+
+    /** Write the local parts of the state. Collective operation.
+    The vectors are written in the row distribution of the graph, or of the first coordinate if the graph is empty.
+    The columns of the graph are stored as global ids.
+
+    @param[in] dir The directory of the checkpoints, must exist.
+    @param[in] stage The name of the stage.
+    @param[in] graph The graph, can be empty.
+    @param[in] coordinates The coordinates, can be empty.
+    @param[in] nodeWeights The node weights, can be empty.
+    @param[in] partition The partition, can be empty.
+    */
+    static void write(
+        const std::string& dir,
+        const std::string& stage,
+        const CSRSparseMatrix<ValueType>& graph,
+        const std::vector<DenseVector<ValueType>>& coordinates,
+        const std::vector<DenseVector<ValueType>>& nodeWeights,
+        const DenseVector<IndexType>& partition,
+        const scai::dmemo::CommunicatorPtr comm);
+
+    /** Read the state of a stage with the distribution it was written with. Collective operation.
+    The arguments that were empty when the checkpoint was written are not changed.
+    */
+    static void read(
+        const std::string& dir,
+        const std::string& stage,
+        CSRSparseMatrix<ValueType>& graph,
+        std::vector<DenseVector<ValueType>>& coordinates,
+        std::vector<DenseVector<ValueType>>& nodeWeights,
+        DenseVector<IndexType>& partition,
+        const scai::dmemo::CommunicatorPtr comm);
+
+    /** True if a complete checkpoint of the stage exists for the number of PEs of comm. Collective operation.
+    */
+    static bool exists(const std::string& dir, const std::string& stage, const scai::dmemo::CommunicatorPtr comm);
+
+    /** True if checkpoints are written and the run should continue from the checkpoint of this stage: the checkpoint
+    exists and the stage is not later than settings.resumeFrom. Collective operation.
+    */
+    static bool resumeAt(const std::string& stage, const Settings& settings, const scai::dmemo::CommunicatorPtr comm);
+
+private:
+    static std::string fileName(const std::string& dir, const std::string& stage, const IndexType rank);
+};
+
+} // namespace ITI
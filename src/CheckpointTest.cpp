@@ -0,0 +1,124 @@
+#include <cstdio>
+#include <fstream>
+
+#include <scai/dmemo/BlockDistribution.hpp>
+
+#include "gtest/gtest.h"
+
+#include "Checkpoint.h"
+#include "FileIO.h"
+#include "GraphUtils.h"
+
+namespace ITI {
+
+template<typename T>
+class CheckpointTest : public ::testing::Test {
+protected:
+    // the directory of all the meshes used
+    // projectRoot is defined in config.h.in
+    const std::string graphPath = projectRoot+"/meshes/";
+};
+
+using testTypes = ::testing::Types<double,float>;
+TYPED_TEST_SUITE(CheckpointTest, testTypes);
+
+//-----------------------------------------------
+
+TYPED_TEST(CheckpointTest, testWriteAndRead) {
+    using ValueType = TypeParam;
+
+    const std::string file = CheckpointTest<ValueType>::graphPath + "Grid16x16";
+    const IndexType dimensions = 2;
+    const scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+
+    CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph(file, comm);
+    const IndexType n = graph.getNumRows();
+    std::vector<DenseVector<ValueType>> coords = FileIO<IndexType, ValueType>::readCoords(file + ".xyz", n, dimensions, comm);
+    std::vector<DenseVector<ValueType>> nodeWeights(1, DenseVector<ValueType>(graph.getRowDistributionPtr(), 1));
+    DenseVector<IndexType> partition(graph.getRowDistributionPtr(), comm->getRank());
+
+    const std::string dir = ".";
+    const std::string stage = "checkpointTest" + std::to_string(sizeof(ValueType));
+    Checkpoint<IndexType, ValueType>::write(dir, stage, graph, coords, nodeWeights, partition, comm);
+    EXPECT_TRUE(Checkpoint<IndexType, ValueType>::exists(dir, stage, comm));
+
+    CSRSparseMatrix<ValueType> readGraph;
+    std::vector<DenseVector<ValueType>> readCoords, readWeights;
+    DenseVector<IndexType> readPartition;
+    Checkpoint<IndexType, ValueType>::read(dir, stage, readGraph, readCoords, readWeights, readPartition, comm);
+
+    ASSERT_EQ(n, readGraph.getNumRows());
+    ASSERT_EQ(dimensions, readCoords.size());
+    ASSERT_EQ(1, readWeights.size());
+    EXPECT_TRUE(readGraph.getRowDistribution().isEqual(graph.getRowDistribution()));
+    EXPECT_EQ(graph.getNumValues(), readGraph.getNumValues());
+    EXPECT_EQ(GraphUtils<IndexType, ValueType>::computeCut(graph, partition), GraphUtils<IndexType, ValueType>::computeCut(readGraph, readPartition));
+    for (IndexType d = 0; d < dimensions; d++) {
+        EXPECT_EQ(0, (coords[d] - readCoords[d]).maxNorm());
+    }
+    EXPECT_EQ(n, readWeights[0].sum());
+    EXPECT_EQ(0, (partition - readPartition).maxNorm());
+
+    //the checkpoint of the migration has no graph and no partition
+    const std::string coordStage = stage + "_coords";
+    Checkpoint<IndexType, ValueType>::write(dir, coordStage, CSRSparseMatrix<ValueType>(), coords, nodeWeights, DenseVector<IndexType>(), comm);
+    CSRSparseMatrix<ValueType> noGraph;
+    DenseVector<IndexType> noPartition;
+    std::vector<DenseVector<ValueType>> coordsOnly;
+    Checkpoint<IndexType, ValueType>::read(dir, coordStage, noGraph, coordsOnly, readWeights, noPartition, comm);
+    EXPECT_EQ(0, noGraph.getNumRows());
+    EXPECT_EQ(0, noPartition.size());
+    ASSERT_EQ(dimensions, coordsOnly.size());
+    EXPECT_EQ(0, (coords[1] - coordsOnly[1]).maxNorm());
+
+    comm->synchronize();
+    for (const std::string name : {stage, coordStage}) {
+        std::remove((dir + "/" + name + "_" + std::to_string(comm->getRank()) + ".bin").c_str());
+        if (comm->getRank() == 0) {
+            std::remove((dir + "/" + name + ".done").c_str());
+        }
+    }
+}
+//-----------------------------------------------
+
+TYPED_TEST(CheckpointTest, testResumeAt) {
+    using ValueType = TypeParam;
+
+    const scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+    EXPECT_EQ(0, Checkpoint<IndexType, ValueType>::stageIndex("input"));
+    EXPECT_LT(Checkpoint<IndexType, ValueType>::stageIndex("initial"), Checkpoint<IndexType, ValueType>::stageIndex("refined"));
+    EXPECT_EQ(-1, Checkpoint<IndexType, ValueType>::stageIndex("unknown"));
+
+    Settings settings;
+    EXPECT_FALSE(Checkpoint<IndexType, ValueType>::resumeAt("input", settings, comm));
+
+    //a missing directory has no checkpoints
+    settings.checkpointDir = "checkpointTestDoesNotExist";
+    settings.resumeFrom = "last";
+    EXPECT_FALSE(Checkpoint<IndexType, ValueType>::resumeAt("initial", settings, comm));
+
+    settings.checkpointDir = ".";
+    if (comm->getRank() == 0) {
+        std::ofstream done("./initial.done");
+        done << comm->getSize() << std::endl;
+    }
+    comm->synchronize();
+    EXPECT_TRUE(Checkpoint<IndexType, ValueType>::resumeAt("initial", settings, comm));
+    settings.resumeFrom = "migrated";
+    EXPECT_FALSE(Checkpoint<IndexType, ValueType>::resumeAt("initial", settings, comm));
+
+    //writing an earlier stage invalidates the checkpoints of the later ones
+    const scai::dmemo::DistributionPtr dist(new scai::dmemo::BlockDistribution(10, comm));
+    const std::vector<DenseVector<ValueType>> coords(2, DenseVector<ValueType>(dist, 1));
+    Checkpoint<IndexType, ValueType>::write(".", "migrated", CSRSparseMatrix<ValueType>(), coords, {}, DenseVector<IndexType>(), comm);
+    EXPECT_TRUE(Checkpoint<IndexType, ValueType>::exists(".", "migrated", comm));
+    EXPECT_FALSE(Checkpoint<IndexType, ValueType>::exists(".", "initial", comm));
+
+    comm->synchronize();
+    std::remove(("./migrated_" + std::to_string(comm->getRank()) + ".bin").c_str());
+    if (comm->getRank() == 0) {
+        std::remove("./migrated.done");
+    }
+}
+
+} // namespace ITI
@@ -0,0 +1,86 @@
+#include <scai/hmemo/ReadAccess.hpp>
+#include <scai/tracing.hpp>
+
+#include <limits>
+
+#include "CompactGraph.h"
+
+namespace ITI {
+
+template<typename IndexType, typename ValueType>
+CompactGraph<IndexType, ValueType>::CompactGraph(const scai::lama::CSRSparseMatrix<ValueType>& graph, const scai::dmemo::HaloExchangePlan& halo) {
+    SCAI_REGION("CompactGraph.build");
+
+    const scai::dmemo::DistributionPtr dist = graph.getRowDistributionPtr();
+    localN = dist->getLocalSize();
+    const IndexType haloSize = halo.getHaloSize();
+
+    SCAI_ASSERT_LE_ERROR( std::size_t(localN) + haloSize, std::size_t(std::numeric_limits<LocalIndex>::max()), "Too many local and ghost vertices for 32-bit local indices" );
+
+    const scai::lama::CSRStorage<ValueType>& localStorage = graph.getLocalStorage();
+    const scai::hmemo::ReadAccess<IndexType> ia(localStorage.getIA());
+    const scai::hmemo::ReadAccess<IndexType> ja(localStorage.getJA());
+    const scai::hmemo::ReadAccess<ValueType> values(localStorage.getValues());
+    SCAI_ASSERT_EQ_ERROR( ia.size(), localN+1, "Wrong size of ia" );
+
+    const IndexType localM = ja.size();
+
+    unitWeights = true;
+    for (IndexType j = 0; j < localM; j++) {
+        if (values[j] != 1) {
+            unitWeights = false;
+            break;
+        }
+    }
+
+    offsets.assign(ia.get(), ia.get() + localN + 1);
+    columns.resize(localM);
+    if (!unitWeights) {
+        weights.assign(values.get(), values.get() + localM);
+    }
+
+    local2Global.resize(localN);
+    for (IndexType i = 0; i < localN; i++) {
+        local2Global[i] = dist->local2Global(i);
+    }
+
+    {
+        const scai::hmemo::ReadAccess<IndexType> rHalo2Global(halo.getHalo2GlobalIndexes());
+        ghost2Global.assign(rHalo2Global.get(), rHalo2Global.get() + haloSize);
+    }
+
+    //the only place where global ids are translated
+    for (IndexType j = 0; j < localM; j++) {
+        const IndexType localNeighbor = dist->global2Local(ja[j]);
+        if (localNeighbor != scai::invalidIndex) {
+            columns[j] = localNeighbor;
+        } else {
+            const IndexType haloIndex = halo.global2Halo(ja[j]);
+            SCAI_ASSERT_NE_ERROR( haloIndex, scai::invalidIndex, "Neighbor " << ja[j] << " is neither local nor in the halo" );
+            columns[j] = localN + haloIndex;
+        }
+    }
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+bool CompactGraph<IndexType, ValueType>::hasGhostNeighbors(const LocalIndex v) const {
+    for (IndexType j = offsets[v]; j < offsets[v+1]; j++) {
+        if (columns[j] >= localN) {
+            return true;
+        }
+    }
+    return false;
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+std::size_t CompactGraph<IndexType, ValueType>::edgeBytes() const {
+    return offsets.size()*sizeof(IndexType) + columns.size()*sizeof(LocalIndex) + weights.size()*sizeof(ValueType);
+}
+//---------------------------------------------------------------------------------------
+
+template class CompactGraph<IndexType, double>;
+template class CompactGraph<IndexType, float>;
+
+} // namespace ITI
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <scai/lama/matrix/CSRSparseMatrix.hpp>
+#include <scai/dmemo/HaloExchangePlan.hpp>
+
+#include "Settings.h"
+
+namespace ITI {
+
+/** @brief A compact, read-only copy of the local part of a distributed graph for the hot loops.
+
+The CSR storage of LAMA keeps global column indices of IndexType (64 bit in our LAMA builds) and one
+ValueType per edge, also for unweighted graphs where all edge weights are one. Every lookup of a
+neighbor additionally needs a global2Local call on the row distribution.
+
+Here, the columns are stored as 32-bit local indices: a column c < numLocal() is the local vertex c,
+a column c >= numLocal() is a ghost vertex with halo index c - numLocal() in the given halo exchange plan.
+Arrays exchanged with this halo (HaloExchangePlan::updateHalo) can thus be accessed directly with
+the ghost index. If all local edge weights are one, no weights are stored and weight() returns 1.
+*/
+
+template <typename IndexType, typename ValueType>
+class CompactGraph {
+public:
+
+    /** The type of local and ghost vertex ids. */
+    typedef std::uint32_t LocalIndex;
+
+    /** Build the compact copy of the local part of the graph.
+
+    @param[in] graph The distributed graph, the column indices are global.
+    @param[in] halo A halo exchange plan that contains every non-local neighbor of the local vertices,
+    e.g. from GraphUtils::buildNeighborHalo.
+    */
+    CompactGraph(const scai::lama::CSRSparseMatrix<ValueType>& graph, const scai::dmemo::HaloExchangePlan& halo);
+
+    /** Number of local vertices. */
+    IndexType numLocal() const { return localN; }
+
+    /** Number of ghost vertices, equal to the size of the halo. */
+    IndexType numGhosts() const { return ghost2Global.size(); }
+
+    /** Number of local directed edges. */
+    IndexType numEdges() const { return columns.size(); }
+
+    /** First edge of local vertex v. */
+    IndexType beginEdges(const LocalIndex v) const { return offsets[v]; }
+
+    /** One past the last edge of local vertex v. */
+    IndexType endEdges(const LocalIndex v) const { return offsets[v+1]; }
+
+    IndexType degree(const LocalIndex v) const { return offsets[v+1] - offsets[v]; }
+
+    /** Target of edge e, either a local vertex or a ghost. */
+    LocalIndex target(const IndexType e) const { return columns[e]; }
+
+    /** Weight of edge e. */
+    ValueType weight(const IndexType e) const { return unitWeights ? ValueType(1) : weights[e]; }
+
+    bool isLocal(const LocalIndex c) const { return c < localN; }
+
+    /** The halo index of a ghost vertex. */
+    IndexType ghostIndex(const LocalIndex c) const { return c - localN; }
+
+    /** The global id of a local or ghost vertex. */
+    IndexType toGlobal(const LocalIndex c) const { return isLocal(c) ? local2Global[c] : ghost2Global[c - localN]; }
+
+    /** True if no edge weights are stored since all of them are one. */
+    bool hasUnitWeights() const { return unitWeights; }
+
+    /** True if local vertex v has at least one ghost neighbor. */
+    bool hasGhostNeighbors(const LocalIndex v) const;
+
+    /** The bytes used by the edge data of this structure. */
+    std::size_t edgeBytes() const;
+
+private:
+    IndexType localN;
+    bool unitWeights;
+    std::vector<IndexType> offsets;
+    std::vector<LocalIndex> columns;
+    std::vector<ValueType> weights;
+    std::vector<IndexType> local2Global;
+    std::vector<IndexType> ghost2Global;
+};
+
+} // namespace ITI
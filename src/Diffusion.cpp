@@ -7,12 +7,18 @@
 #include <assert.h>
 #include <vector>
 #include <random>
+#include <cmath>
+#include <set>
 
 #include <scai/hmemo/ReadAccess.hpp>
 #include <scai/hmemo/WriteAccess.hpp>
 #include <scai/solver.hpp>
+#include <scai/tracing.hpp>
 
 #include "Diffusion.h"
+#include "GraphUtils.h"
+#include "CompactGraph.h"
+#include "HaloPlanFns.h"
 
 namespace ITI {
 
@@ -100,6 +106,7 @@ template<typename IndexType, typename ValueType>
 DenseMatrix<ValueType> Diffusion<IndexType, ValueType>::multiplePotentials(const scai::lama::CSRSparseMatrix<ValueType>& laplacian, const scai::lama::DenseVector<ValueType>& nodeWeights, const std::vector<IndexType>& sources, ValueType eps) {
     using scai::hmemo::HArray;
 
+    //the dense result matrix is built from the local rows, use potentialsFromSources for distributed input
     if (!laplacian.getRowDistributionPtr()->isReplicated() or !nodeWeights.getDistributionPtr()->isReplicated()) {
         throw std::logic_error("Should only be called with replicated input.");
     }
@@ -114,9 +121,10 @@ DenseMatrix<ValueType> Diffusion<IndexType, ValueType>::multiplePotentials(const
     scai::dmemo::DistributionPtr dist(laplacian.getRowDistributionPtr());
     scai::dmemo::DistributionPtr lDist(new scai::dmemo::NoDistribution(l));
 
-    //get potentials and copy them into common vector
-    for (IndexType landmark : sources) {
-        DenseVector<ValueType> potentials = potentialsFromSource(laplacian, nodeWeights, landmark, eps);
+    std::vector<DenseVector<ValueType>> allPotentials = potentialsFromSources(laplacian, nodeWeights, sources, eps);
+
+    //copy the potentials into common vector
+    for (const DenseVector<ValueType>& potentials : allPotentials) {
         assert(potentials.size() == n);
         WriteAccess<ValueType> wResult(resultContainer);
         ReadAccess<ValueType> rPotentials(potentials.getLocalValues());
@@ -131,6 +139,184 @@ DenseMatrix<ValueType> Diffusion<IndexType, ValueType>::multiplePotentials(const
     return scai::lama::distribute<DenseMatrix<ValueType>>(DenseStorage<ValueType>(l, localN, resultContainer), lDist, dist);
 }
 
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+std::vector<DenseVector<ValueType>> Diffusion<IndexType, ValueType>::potentialsFromSources(const CSRSparseMatrix<ValueType>& laplacian, const DenseVector<ValueType>& nodeWeights, const std::vector<IndexType>& sources, ValueType eps, IndexType maxIterations) {
+    SCAI_REGION("Diffusion.potentialsFromSources");
+
+    const IndexType n = laplacian.getNumRows();
+    if (laplacian.getNumColumns() != n) {
+        throw std::invalid_argument("Matrix must be symmetric to be a Laplacian");
+    }
+
+    const scai::dmemo::DistributionPtr dist(laplacian.getRowDistributionPtr());
+    const scai::dmemo::CommunicatorPtr comm = dist->getCommunicatorPtr();
+    SCAI_ASSERT_ERROR( nodeWeights.getDistribution().isEqual(*dist), "Node weights and laplacian must have the same distribution" );
+
+    const IndexType l = sources.size();
+    const IndexType localN = dist->getLocalSize();
+    const IndexType numPEs = comm->getSize();
+
+    //the halo and the compact graph need global column indices
+    const CSRSparseMatrix<ValueType>* matrix = &laplacian;
+    CSRSparseMatrix<ValueType> replicatedColumns;
+    if (!laplacian.getColDistributionPtr()->isReplicated()) {
+        replicatedColumns = laplacian;
+        replicatedColumns.redistribute(dist, scai::dmemo::DistributionPtr(new scai::dmemo::NoDistribution(n)));
+        matrix = &replicatedColumns;
+    }
+
+    const scai::dmemo::HaloExchangePlan halo = GraphUtils<IndexType, ValueType>::buildNeighborHalo(*matrix);
+    const CompactGraph<IndexType, ValueType> compact(*matrix, halo);
+
+    const IndexType numGhosts = compact.numGhosts();
+    std::vector<ValueType> ghostValues(numGhosts*l);
+
+    //all blocks of l values are stored row-wise, the values of node i are at i*l,...,i*l+l-1
+
+    //product = laplacian * x for all l vectors
+    auto multiply = [&](const std::vector<ValueType>& x, std::vector<ValueType>& product) {
+        SCAI_REGION("Diffusion.potentialsFromSources.SpMM");
+        updateHaloBlocks(halo, x.data(), ghostValues.data(), l, *comm);
+
+        #pragma omp parallel for schedule(static)
+        for (IndexType i = 0; i < localN; i++) {
+            ValueType* row = product.data() + i*l;
+            std::fill(row, row+l, ValueType(0));
+            for (IndexType e = compact.beginEdges(i); e < compact.endEdges(i); e++) {
+                const typename CompactGraph<IndexType, ValueType>::LocalIndex target = compact.target(e);
+                const ValueType weight = compact.weight(e);
+                const ValueType* neighbor = compact.isLocal(target) ? x.data() + target*l : ghostValues.data() + compact.ghostIndex(target)*l;
+                for (IndexType c = 0; c < l; c++) {
+                    row[c] += weight*neighbor[c];
+                }
+            }
+        }
+    };
+
+    //one dot product per vector, reduced together
+    auto dotProducts = [&](const std::vector<ValueType>& a, const std::vector<ValueType>& b) {
+        std::vector<ValueType> result(l, 0);
+        for (IndexType i = 0; i < localN; i++) {
+            for (IndexType c = 0; c < l; c++) {
+                result[c] += a[i*l+c]*b[i*l+c];
+            }
+        }
+        comm->sumImpl( result.data(), result.data(), l, scai::common::TypeTraits<ValueType>::stype );
+        return result;
+    };
+
+    //right hand sides, the demand is the node weight and the sources provide the sum of all weights
+    std::vector<ValueType> residual(localN*l);
+    {
+        const ValueType weightSum = nodeWeights.sum();
+        const ReadAccess<ValueType> rWeights(nodeWeights.getLocalValues());
+        for (IndexType i = 0; i < localN; i++) {
+            std::fill(residual.begin() + i*l, residual.begin() + (i+1)*l, -rWeights[i]);
+        }
+        for (IndexType c = 0; c < l; c++) {
+            SCAI_ASSERT_EQ_ERROR( comm->sum(sources[c]), sources[c]*numPEs, "Sources must be the same on all PEs" );
+            const IndexType localSource = dist->global2Local(sources[c]);
+            if (localSource != scai::invalidIndex) {
+                residual[localSource*l + c] += weightSum;
+            }
+        }
+    }
+
+    //the initial solution is zero, thus the initial residual is the right hand side
+    std::vector<ValueType> solution(localN*l, 0);
+    std::vector<ValueType> direction(residual);
+    std::vector<ValueType> product(localN*l);
+
+    std::vector<ValueType> rr = dotProducts(residual, residual);
+    const std::vector<ValueType> initialRR(rr);
+    std::vector<bool> converged(l);
+    for (IndexType c = 0; c < l; c++) {
+        converged[c] = std::sqrt(rr[c]) <= eps*std::sqrt(initialRR[c]) or initialRR[c] == 0;
+    }
+
+    IndexType iter = 0;
+    for (; iter < maxIterations and std::find(converged.begin(), converged.end(), false) != converged.end(); iter++) {
+        multiply(direction, product);
+        const std::vector<ValueType> pq = dotProducts(direction, product);
+
+        std::vector<ValueType> alpha(l, 0);
+        for (IndexType c = 0; c < l; c++) {
+            if (!converged[c] and pq[c] > 0) {
+                alpha[c] = rr[c] / pq[c];
+            }
+        }
+
+        #pragma omp parallel for schedule(static)
+        for (IndexType i = 0; i < localN; i++) {
+            for (IndexType c = 0; c < l; c++) {
+                solution[i*l+c] += alpha[c]*direction[i*l+c];
+                residual[i*l+c] -= alpha[c]*product[i*l+c];
+            }
+        }
+
+        const std::vector<ValueType> newRR = dotProducts(residual, residual);
+        std::vector<ValueType> beta(l, 0);
+        for (IndexType c = 0; c < l; c++) {
+            if (converged[c]) continue;
+            beta[c] = rr[c] > 0 ? newRR[c] / rr[c] : 0;
+            rr[c] = newRR[c];
+            converged[c] = std::sqrt(rr[c]) <= eps*std::sqrt(initialRR[c]);
+        }
+
+        #pragma omp parallel for schedule(static)
+        for (IndexType i = 0; i < localN; i++) {
+            for (IndexType c = 0; c < l; c++) {
+                direction[i*l+c] = residual[i*l+c] + beta[c]*direction[i*l+c];
+            }
+        }
+    }
+
+    const IndexType numConverged = std::count(converged.begin(), converged.end(), true);
+    if (numConverged < l and comm->getRank() == 0) {
+        std::cout << "WARNING: only " << numConverged << " of " << l << " diffusion systems converged in " << iter << " iterations" << std::endl;
+    }
+
+    std::vector<DenseVector<ValueType>> result(l);
+    for (IndexType c = 0; c < l; c++) {
+        scai::hmemo::HArray<ValueType> localValues(localN);
+        {
+            WriteAccess<ValueType> wValues(localValues);
+            for (IndexType i = 0; i < localN; i++) {
+                wValues[i] = solution[i*l+c];
+            }
+        }
+        result[c] = DenseVector<ValueType>(dist, std::move(localValues));
+    }
+    return result;
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+std::vector<DenseVector<ValueType>> Diffusion<IndexType, ValueType>::diffusionCoordinates(const CSRSparseMatrix<ValueType>& graph, const DenseVector<ValueType>& nodeWeights, const Settings& settings) {
+    SCAI_REGION("Diffusion.diffusionCoordinates");
+
+    const IndexType n = graph.getNumRows();
+    const IndexType numLandmarks = settings.dimensions;
+    SCAI_ASSERT_LE_ERROR( numLandmarks, n, "More landmarks than vertices" );
+
+    //same seed on all PEs, so all draw the same landmarks
+    std::mt19937 generator(static_cast<unsigned long>(settings.seed));
+    std::uniform_int_distribution<IndexType> distribution(0, n-1);
+    std::set<IndexType> chosen;
+    std::vector<IndexType> landmarks;
+    while (IndexType(landmarks.size()) < numLandmarks) {
+        const IndexType landmark = distribution(generator);
+        if (chosen.insert(landmark).second) {
+            landmarks.push_back(landmark);
+        }
+    }
+
+    const CSRSparseMatrix<ValueType> laplacian = GraphUtils<IndexType, ValueType>::constructLaplacian(graph);
+    return potentialsFromSources(laplacian, nodeWeights, landmarks, settings.CGResidual, settings.maxCGIterations);
+}
+//---------------------------------------------------------------------------------------
 
 template class Diffusion<IndexType, double>;
 template class Diffusion<IndexType, float>;
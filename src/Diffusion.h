@@ -60,6 +60,37 @@ public:
      */
     static scai::lama::DenseMatrix<ValueType> multiplePotentials(const scai::lama::CSRSparseMatrix<ValueType>& laplacian, const scai::lama::DenseVector<ValueType>& nodeWeights, const std::vector<IndexType>& sources, ValueType eps=1e-6);
 
+    /**
+     * @brief Computes the potentials for all sources at once with a distributed CG solver for multiple right hand sides.
+     *
+     * The systems for all l sources share the Laplacian, so they are solved together: every iteration does one
+     * sparse matrix times l vectors product with a single halo exchange of l values per halo node, and one reduction
+     * of l values for each of the two dot products. The step lengths are computed per system, a system that
+     * has converged is not updated any more.
+     *
+     * @param laplacian The laplacian of the graph, can be distributed.
+     * @param nodeWeights The demand at each (non-source) node, must have the row distribution of the laplacian.
+     * @param sources list of source indices, the same on all PEs
+     * @param eps accuracy, relative to the norm of the initial residual
+     * @param maxIterations maximum number of CG iterations
+     *
+     * @return one vector of potentials for every source, with the row distribution of the laplacian
+     */
+    static std::vector<scai::lama::DenseVector<ValueType>> potentialsFromSources(const scai::lama::CSRSparseMatrix<ValueType>& laplacian, const scai::lama::DenseVector<ValueType>& nodeWeights, const std::vector<IndexType>& sources, ValueType eps=1e-6, IndexType maxIterations=1000);
+
+    /**
+     * @brief Artificial coordinates for a graph without coordinates: the potentials of a diffusion from
+     * settings.dimensions random landmarks, one dimension per landmark.
+     *
+     * The landmarks are drawn with settings.seed, the solver uses settings.CGResidual and settings.maxCGIterations.
+     *
+     * @param graph The adjacency matrix of the graph, can be distributed.
+     * @param nodeWeights The node weights, used as demands. Must have the row distribution of the graph.
+     *
+     * @return the coordinates, with the row distribution of the graph
+     */
+    static std::vector<scai::lama::DenseVector<ValueType>> diffusionCoordinates(const scai::lama::CSRSparseMatrix<ValueType>& graph, const scai::lama::DenseVector<ValueType>& nodeWeights, const Settings& settings);
+
 };
 
 } /* namespace ITI */
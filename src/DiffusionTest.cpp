@@ -105,6 +105,33 @@ TYPED_TEST(DiffusionTest, testMultiplePotentials) {
 
 }
 
+TYPED_TEST(DiffusionTest, testPotentialsFromSources) {
+    using ValueType = TypeParam;
+
+    std::string fileName = "Grid16x16";
+    std::string file = DiffusionTest<ValueType>::graphPath + fileName;
+    CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph(file );
+    const IndexType n = graph.getNumRows();
+
+    CSRSparseMatrix<ValueType> L = GraphUtils<IndexType, ValueType>::constructLaplacian(graph);
+    DenseVector<ValueType> nodeWeights(L.getRowDistributionPtr(),1);
+
+    const std::vector<IndexType> sources = {0, n/2, n-1};
+    const ValueType epsilon = 1e-5;
+    std::vector<DenseVector<ValueType>> potentials = Diffusion<IndexType, ValueType>::potentialsFromSources(L, nodeWeights, sources, epsilon);
+    ASSERT_EQ(sources.size(), potentials.size());
+
+    //every system must agree with the single source solver
+    for (IndexType c = 0; c < IndexType(sources.size()); c++) {
+        EXPECT_EQ(n, potentials[c].size());
+        EXPECT_TRUE(potentials[c].getDistribution().isEqual(L.getRowDistribution()));
+
+        DenseVector<ValueType> single = Diffusion<IndexType, ValueType>::potentialsFromSource(L, nodeWeights, sources[c], epsilon);
+        DenseVector<ValueType> diff = scai::lama::eval<DenseVector<ValueType>>(single - potentials[c]);
+        EXPECT_LT(diff.maxNorm(), 1e-2*single.maxNorm());
+    }
+}
+
 TYPED_TEST(DiffusionTest, testConstructFJLTMatrix) {
     using ValueType = TypeParam;
 
@@ -0,0 +1,176 @@
+#include <scai/hmemo/ReadAccess.hpp>
+#include <scai/hmemo/WriteAccess.hpp>
+#include <scai/dmemo/HaloExchangePlan.hpp>
+#include <scai/tracing.hpp>
+
+#include <chrono>
+
+#include "Embedding.h"
+#include "Diffusion.h"
+#include "MultiLevel.h"
+#include "GraphUtils.h"
+#include "CompactGraph.h"
+#include "SpectralPartition.h"
+
+namespace ITI {
+
+template<typename IndexType, typename ValueType>
+std::vector<DenseVector<ValueType>> Embedding<IndexType, ValueType>::multilevelEmbedding(
+    const CSRSparseMatrix<ValueType>& graph,
+    const DenseVector<ValueType>& nodeWeights,
+    const Settings& settings) {
+
+    SCAI_REGION("Embedding.multilevelEmbedding");
+    std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
+
+    const scai::dmemo::CommunicatorPtr comm = graph.getRowDistributionPtr()->getCommunicatorPtr();
+    SCAI_ASSERT_GT_ERROR( settings.dimensions, 0, "Need at least one dimension for the embedding" );
+    SCAI_ASSERT_ERROR( nodeWeights.getDistribution().isEqual(graph.getRowDistribution()), "Distribution mismatch" );
+
+    Settings coarseningSettings(settings);
+    coarseningSettings.nnCoarsening = false;
+
+    //the coarse graphs and for every level the map to the next coarser level
+    std::vector<CSRSparseMatrix<ValueType>> coarseGraphs;
+    std::vector<DenseVector<IndexType>> fineToCoarseMaps;
+    DenseVector<ValueType> weights(nodeWeights);
+
+    {
+        SCAI_REGION("Embedding.multilevelEmbedding.coarsen");
+        while (true) {
+            const CSRSparseMatrix<ValueType>& current = coarseGraphs.empty() ? graph : coarseGraphs.back();
+            const IndexType currentN = current.getNumRows();
+            if (currentN <= settings.embeddingCoarsestSize) break;
+
+            const scai::dmemo::HaloExchangePlan halo = GraphUtils<IndexType, ValueType>::buildNeighborHalo(current);
+            //the matching reads two coordinates also if they are not used
+            const std::vector<DenseVector<ValueType>> noCoordinates(2, DenseVector<ValueType>(current.getRowDistributionPtr(), 0));
+
+            CSRSparseMatrix<ValueType> coarseGraph;
+            DenseVector<IndexType> fineToCoarse;
+            MultiLevel<IndexType, ValueType>::coarsen(current, weights, halo, noCoordinates, coarseGraph, fineToCoarse, coarseningSettings);
+
+            //local matchings stall if the PEs have few local edges
+            if (coarseGraph.getNumRows() > 0.9*currentN) break;
+
+            weights = MultiLevel<IndexType, ValueType>::sumToCoarse(weights, fineToCoarse);
+            fineToCoarseMaps.push_back(std::move(fineToCoarse));
+            coarseGraphs.push_back(std::move(coarseGraph));
+        }
+    }
+
+    const CSRSparseMatrix<ValueType>& coarsest = coarseGraphs.empty() ? graph : coarseGraphs.back();
+    PRINT0("Embedding: " << coarseGraphs.size() << " coarsening levels, coarsest graph has " << coarsest.getNumRows() << " vertices");
+
+    std::vector<DenseVector<ValueType>> coordinates;
+    if (settings.embeddingMethod == "spectral") {
+        std::vector<ValueType> eigenvalues;
+        coordinates = SpectralPartition<IndexType, ValueType>::getEigenvectors(coarsest, settings.dimensions, eigenvalues);
+    } else {
+        coordinates = Diffusion<IndexType, ValueType>::diffusionCoordinates(coarsest, weights, settings);
+    }
+    smooth(coarsest, coordinates, settings.embeddingSmoothingSteps);
+
+    {
+        SCAI_REGION("Embedding.multilevelEmbedding.uncoarsen");
+        //level l maps the graph of level l-1 to coarseGraphs[l-1], level 0 is the input graph
+        for (IndexType level = fineToCoarseMaps.size(); level > 0; level--) {
+            const CSRSparseMatrix<ValueType>& fineGraph = level == 1 ? graph : coarseGraphs[level-2];
+            coordinates = projectToFine(coordinates, fineToCoarseMaps[level-1]);
+            smooth(fineGraph, coordinates, settings.embeddingSmoothingSteps);
+        }
+    }
+
+    std::chrono::duration<double> embeddingTime = std::chrono::steady_clock::now() - startTime;
+    PRINT0("Time for the embedding: " << comm->max(embeddingTime.count()));
+
+    return coordinates;
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+std::vector<DenseVector<ValueType>> Embedding<IndexType, ValueType>::projectToFine(
+    const std::vector<DenseVector<ValueType>>& coarseCoordinates,
+    const DenseVector<IndexType>& fineToCoarse) {
+
+    SCAI_REGION("Embedding.projectToFine");
+
+    const scai::dmemo::DistributionPtr fineDist = fineToCoarse.getDistributionPtr();
+    const IndexType fineLocalN = fineDist->getLocalSize();
+    const IndexType dimensions = coarseCoordinates.size();
+
+    std::vector<DenseVector<ValueType>> result(dimensions);
+    const scai::hmemo::ReadAccess<IndexType> rFineToCoarse(fineToCoarse.getLocalValues());
+
+    for (IndexType d = 0; d < dimensions; d++) {
+        const scai::dmemo::DistributionPtr coarseDist = coarseCoordinates[d].getDistributionPtr();
+        const scai::hmemo::ReadAccess<ValueType> rCoarse(coarseCoordinates[d].getLocalValues());
+
+        scai::hmemo::HArray<ValueType> fineValues(fineLocalN);
+        {
+            scai::hmemo::WriteAccess<ValueType> wFine(fineValues);
+            for (IndexType i = 0; i < fineLocalN; i++) {
+                const IndexType coarseLocal = coarseDist->global2Local(rFineToCoarse[i]);
+                SCAI_ASSERT_NE_ERROR( coarseLocal, scai::invalidIndex, "Coarse vertex " << rFineToCoarse[i] << " is not local" );
+                wFine[i] = rCoarse[coarseLocal];
+            }
+        }
+        result[d] = DenseVector<ValueType>(fineDist, std::move(fineValues));
+    }
+    return result;
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void Embedding<IndexType, ValueType>::smooth(
+    const CSRSparseMatrix<ValueType>& graph,
+    std::vector<DenseVector<ValueType>>& coordinates,
+    const IndexType steps) {
+
+    SCAI_REGION("Embedding.smooth");
+
+    const scai::dmemo::CommunicatorPtr comm = graph.getRowDistributionPtr()->getCommunicatorPtr();
+    const IndexType dimensions = coordinates.size();
+
+    const scai::dmemo::HaloExchangePlan halo = GraphUtils<IndexType, ValueType>::buildNeighborHalo(graph);
+    const CompactGraph<IndexType, ValueType> compact(graph, halo);
+    const IndexType localN = compact.numLocal();
+
+    std::vector<scai::hmemo::HArray<ValueType>> haloCoordinates(dimensions);
+    std::vector<ValueType> newValues(localN);
+
+    for (IndexType step = 0; step < steps; step++) {
+        for (IndexType d = 0; d < dimensions; d++) {
+            halo.updateHalo(haloCoordinates[d], coordinates[d].getLocalValues(), *comm);
+        }
+
+        for (IndexType d = 0; d < dimensions; d++) {
+            {
+                const scai::hmemo::ReadAccess<ValueType> rLocal(coordinates[d].getLocalValues());
+                const scai::hmemo::ReadAccess<ValueType> rHalo(haloCoordinates[d]);
+
+                #pragma omp parallel for schedule(static)
+                for (IndexType i = 0; i < localN; i++) {
+                    ValueType weightedSum = 0;
+                    ValueType weightSum = 0;
+                    for (IndexType e = compact.beginEdges(i); e < compact.endEdges(i); e++) {
+                        const typename CompactGraph<IndexType, ValueType>::LocalIndex target = compact.target(e);
+                        if (IndexType(target) == i) continue;
+                        const ValueType w = compact.weight(e);
+                        weightedSum += w*(compact.isLocal(target) ? rLocal[target] : rHalo[compact.ghostIndex(target)]);
+                        weightSum += w;
+                    }
+                    newValues[i] = weightSum > 0 ? 0.5*rLocal[i] + 0.5*weightedSum/weightSum : rLocal[i];
+                }
+            }
+            scai::hmemo::WriteAccess<ValueType> wLocal(coordinates[d].getLocalValues());
+            std::copy(newValues.begin(), newValues.end(), wLocal.get());
+        }
+    }
+}
+//---------------------------------------------------------------------------------------
+
+template class Embedding<IndexType, double>;
+template class Embedding<IndexType, float>;
+
+} // namespace ITI
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <scai/lama.hpp>
+#include <scai/lama/DenseVector.hpp>
+#include <scai/lama/matrix/CSRSparseMatrix.hpp>
+
+#include "Settings.h"
+
+namespace ITI {
+
+using scai::lama::CSRSparseMatrix;
+using scai::lama::DenseVector;
+
+/** @brief Compute coordinates for graphs that come without them, so that the geometric partitioners can be used.
+
+The graph is coarsened with the local matchings of MultiLevel::coarsen until it has at most
+settings.embeddingCoarsestSize vertices or the matchings do not shrink it any more. The coarsest graph is
+embedded with the diffusion coordinates of Diffusion::diffusionCoordinates or, with settings.embeddingMethod=spectral,
+with the eigenvectors of its Laplacian from SpectralPartition::getEigenvectors. The coordinates are then projected
+back level by level, every vertex starts at the position of its coarse vertex and a few smoothing steps move it
+towards the weighted average of its neighbors.
+
+All steps work on the distributed graph, the vertices do not move between PEs.
+*/
+
+template <typename IndexType, typename ValueType>
+class Embedding {
+public:
+
+    /** Coordinates of dimension settings.dimensions for the graph.
+
+    @param[in] graph The adjacency matrix of the graph.
+    @param[in] nodeWeights The node weights, must have the row distribution of the graph.
+    @param[in] settings Uses dimensions, embeddingCoarsestSize, embeddingSmoothingSteps, embeddingMethod and the diffusion settings, \sa Diffusion::diffusionCoordinates.
+
+    @return The coordinates, with the row distribution of the graph.
+    */
+    static std::vector<DenseVector<ValueType>> multilevelEmbedding(
+        const CSRSparseMatrix<ValueType>& graph,
+        const DenseVector<ValueType>& nodeWeights,
+        const Settings& settings);
+
+    /** Every fine vertex gets the coordinates of its coarse vertex. The coarse vertices must be local
+    on the PE of their fine vertices, as it is the case after MultiLevel::coarsen.
+    */
+    static std::vector<DenseVector<ValueType>> projectToFine(
+        const std::vector<DenseVector<ValueType>>& coarseCoordinates,
+        const DenseVector<IndexType>& fineToCoarse);
+
+    /** Smoothing steps, each moves every vertex halfway towards the weighted average of its neighbors.
+    Vertices without neighbors keep their position.
+    */
+    static void smooth(
+        const CSRSparseMatrix<ValueType>& graph,
+        std::vector<DenseVector<ValueType>>& coordinates,
+        const IndexType steps);
+};
+
+} // namespace ITI
@@ -0,0 +1,92 @@
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "Embedding.h"
+#include "FileIO.h"
+#include "GraphUtils.h"
+
+namespace ITI {
+
+template<typename T>
+class EmbeddingTest : public ::testing::Test {
+protected:
+    // the directory of all the meshes used
+    // projectRoot is defined in config.h.in
+    const std::string graphPath = projectRoot+"/meshes/";
+};
+
+using testTypes = ::testing::Types<double,float>;
+TYPED_TEST_SUITE(EmbeddingTest, testTypes);
+
+//-----------------------------------------------
+
+TYPED_TEST(EmbeddingTest, testMultilevelEmbedding) {
+    using ValueType = TypeParam;
+
+    //the coarsest graph is embedded with diffusion coordinates or with the eigenvectors of its Laplacian
+    for (const std::string method : {"diffusion", "spectral"}) {
+        std::string fileName = "Grid16x16";
+        std::string file = EmbeddingTest<ValueType>::graphPath + fileName;
+        CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph(file );
+        const IndexType n = graph.getNumRows();
+        const scai::dmemo::DistributionPtr dist = graph.getRowDistributionPtr();
+
+        Settings settings;
+        settings.dimensions = 2;
+        settings.embeddingCoarsestSize = 50;
+        settings.seed = 1;
+        settings.embeddingMethod = method;
+
+        DenseVector<ValueType> nodeWeights(dist, 1);
+        std::vector<DenseVector<ValueType>> coords = Embedding<IndexType, ValueType>::multilevelEmbedding(graph, nodeWeights, settings);
+
+        ASSERT_EQ(settings.dimensions, IndexType(coords.size()));
+        for (IndexType d = 0; d < settings.dimensions; d++) {
+            EXPECT_TRUE(coords[d].getDistribution().isEqual(*dist));
+            EXPECT_TRUE(std::isfinite(coords[d].sum()));
+        }
+
+        //neighbors must be closer to each other than two vertices on average
+        const scai::dmemo::DistributionPtr noDist(new scai::dmemo::NoDistribution(n));
+        graph.redistribute(noDist, noDist);
+        std::vector<std::vector<ValueType>> replicated(settings.dimensions, std::vector<ValueType>(n));
+        for (IndexType d = 0; d < settings.dimensions; d++) {
+            coords[d].redistribute(noDist);
+            scai::hmemo::ReadAccess<ValueType> rCoords(coords[d].getLocalValues());
+            std::copy(rCoords.get(), rCoords.get()+n, replicated[d].begin());
+        }
+
+        auto distance = [&](IndexType u, IndexType v) {
+            ValueType sum = 0;
+            for (IndexType d = 0; d < settings.dimensions; d++) {
+                sum += (replicated[d][u] - replicated[d][v])*(replicated[d][u] - replicated[d][v]);
+            }
+            return std::sqrt(sum);
+        };
+
+        const scai::lama::CSRStorage<ValueType>& storage = graph.getLocalStorage();
+        scai::hmemo::ReadAccess<IndexType> ia(storage.getIA());
+        scai::hmemo::ReadAccess<IndexType> ja(storage.getJA());
+
+        ValueType edgeLengthSum = 0;
+        for (IndexType v = 0; v < n; v++) {
+            for (IndexType j = ia[v]; j < ia[v+1]; j++) {
+                edgeLengthSum += distance(v, ja[j]);
+            }
+        }
+        const ValueType avgEdgeLength = edgeLengthSum / ja.size();
+
+        ValueType pairDistanceSum = 0;
+        for (IndexType u = 0; u < n; u++) {
+            for (IndexType v = u+1; v < n; v++) {
+                pairDistanceSum += distance(u, v);
+            }
+        }
+        const ValueType avgPairDistance = pairDistanceSum / (n*(n-1)/2);
+
+        EXPECT_LT(avgEdgeLength, 0.5*avgPairDistance) << "for method " << method;
+    }
+}
+
+} /* namespace ITI */
@@ -7,6 +7,7 @@
 
 #include "FileIO.h"
 #include "quadtree/QuadTreeCartesianEuclid.h"
+#include "NumaUtils.h"
 
 #include <scai/lama.hpp>
 #include <scai/lama/matrix/all.hpp>
@@ -32,6 +33,10 @@
 #include <tuple>
 #include <chrono>
 
+#include <fcntl.h>
+#include <glob.h>
+#include <unistd.h>
+
 
 using scai::lama::CSRStorage;
 using scai::hmemo::HArray;
@@ -767,25 +772,29 @@ scai::lama::CSRSparseMatrix<ValueType> FileIO<IndexType, ValueType>::readGraph(c
 }
 
 template<typename IndexType, typename ValueType>
-scai::lama::CSRSparseMatrix<ValueType> FileIO<IndexType, ValueType>::readGraph(const std::string filename, std::vector<DenseVector<ValueType>>& nodeWeights,  const scai::dmemo::CommunicatorPtr comm, Format format) {
+scai::lama::CSRSparseMatrix<ValueType> FileIO<IndexType, ValueType>::readGraph(const std::string filename, std::vector<DenseVector<ValueType>>& nodeWeights,  const scai::dmemo::CommunicatorPtr comm, Format format, StreamingPartition<IndexType, ValueType>* streaming) {
     SCAI_REGION("FileIO.readGraph");
 
-    if(format == Format::MATRIXMARKET) {
-        return FileIO<IndexType, ValueType>::readGraphMatrixMarket(filename, comm);
-    }
-
     std::string ending = filename.substr( filename.size()-3,  filename.size() );
     if ((format == Format::AUTO and (ending == "bgf" or ending == "bfg")) or format==Format::BINARY) {
         // if file has a .bgf ending then is a binary file
-        return readGraphBinary( filename, comm);
+        return readGraphBinary( filename, comm, streaming);
     }
 
-    if (format==Format::EDGELIST or format==Format::BINARYEDGELIST) {
-        return readEdgeList(filename, comm, format==Format::BINARYEDGELIST);
-    }
-
-    if (format==Format::EDGELISTDIST) {
-        return readEdgeListDistributed( filename, comm);
+    if (format==Format::MATRIXMARKET or format==Format::EDGELIST or format==Format::BINARYEDGELIST or format==Format::EDGELISTDIST) {
+        CSRSparseMatrix<ValueType> graph;
+        if(format == Format::MATRIXMARKET) {
+            graph = FileIO<IndexType, ValueType>::readGraphMatrixMarket(filename, comm);
+        } else if (format==Format::EDGELISTDIST) {
+            graph = readEdgeListDistributed( filename, comm);
+        } else {
+            graph = readEdgeList(filename, comm, format==Format::BINARYEDGELIST);
+        }
+        //these formats are not read in the order of the vertices, stream them afterwards
+        if (streaming != nullptr) {
+            streaming->streamGraph(graph, scai::lama::fill<DenseVector<ValueType>>(graph.getRowDistributionPtr(), 1));
+        }
+        return graph;
     }
 
     if (!(format == Format::METIS or format == Format::AUTO)) {
@@ -902,6 +911,10 @@ scai::lama::CSRSparseMatrix<ValueType> FileIO<IndexType, ValueType>::readGraph(c
     //std::cout << "Process " << comm->getRank() << " reserved memory for  " <<  edgeEstimate << " edges." << std::endl;
     startTime =  std::chrono::steady_clock::now();
 
+    if (streaming != nullptr) {
+        streaming->begin(dist);
+    }
+
     //now read in local edges
     for (IndexType i = 0; i < localN; i++) {
         bool read = !std::getline(file, line).fail();
@@ -959,6 +972,10 @@ scai::lama::CSRSparseMatrix<ValueType> FileIO<IndexType, ValueType>::readGraph(c
         if (hasEdgeWeights) {
             assert(ja.size() == values.size());
         }
+
+        if (streaming != nullptr) {
+            streaming->assignNext(neighbors.data(), neighbors.size(), numberNodeWeights > 0 ? nodeWeightStorage[0][i] : 1);
+        }
     }
 
     //elapTime = std::chrono::steady_clock::now() - startTime;
@@ -968,7 +985,7 @@ scai::lama::CSRSparseMatrix<ValueType> FileIO<IndexType, ValueType>::readGraph(c
     nodeWeights.resize(numberNodeWeights);
     //std::cout << "Process " << comm->getRank() << " allocated memory for " << numberNodeWeights << " node weights. " << std::endl;
     for (IndexType i = 0; i < numberNodeWeights; i++) {
-        nodeWeights[i] = DenseVector<ValueType>(dist, HArray<ValueType>(localN, nodeWeightStorage[i].data()));
+        nodeWeights[i] = DenseVector<ValueType>(dist, firstTouchCopy(nodeWeightStorage[i].data(), localN));
     }
 
     //std::cout << "Process " << comm->getRank() << " converted node weights. " << std::endl;
@@ -1000,9 +1017,9 @@ scai::lama::CSRSparseMatrix<ValueType> FileIO<IndexType, ValueType>::readGraph(c
     startTime =  std::chrono::steady_clock::now();
     //assign matrix
     scai::lama::CSRStorage<ValueType> myStorage(localN, globalN,
-            HArray<IndexType>(ia.size(), ia.data()),
-            HArray<IndexType>(ja.size(), ja.data()),
-            HArray<ValueType>(values.size(), values.data()));
+            firstTouchCopy(ia.data(), ia.size()),
+            firstTouchCopy(ja.data(), ja.size()),
+            firstTouchCopy(values.data(), values.size()));
 
     //elapTime = std::chrono::steady_clock::now() - startTime;
     //std::cout << "Process " << comm->getRank() << " created local storage in time " << elapTime.count() << std::endl;
@@ -1015,7 +1032,7 @@ scai::lama::CSRSparseMatrix<ValueType> FileIO<IndexType, ValueType>::readGraph(c
 //-------------------------------------------------------------------------------------------------
 
 template<typename IndexType, typename ValueType>
-scai::lama::CSRSparseMatrix<ValueType> FileIO<IndexType, ValueType>::readGraphBinary(const std::string filename, const scai::dmemo::CommunicatorPtr comm) {
+scai::lama::CSRSparseMatrix<ValueType> FileIO<IndexType, ValueType>::readGraphBinary(const std::string filename, const scai::dmemo::CommunicatorPtr comm, StreamingPartition<IndexType, ValueType>* streaming) {
     SCAI_REGION("FileIO.readGraphBinary")
 
     // root PE reads header and broadcasts information to the other PEs
@@ -1061,6 +1078,12 @@ scai::lama::CSRSparseMatrix<ValueType> FileIO<IndexType, ValueType>::readGraphBi
     const IndexType localN = endLocalRange - beginLocalRange;
     SCAI_ASSERT_LE_ERROR(localN, std::ceil(ValueType(globalN) / numPEs), "localN: " << localN << ", optSize: " << std::ceil(globalN / numPEs));
 
+    // block distribution for rows and no distribution for columns
+    const scai::dmemo::DistributionPtr dist(new scai::dmemo::BlockDistribution(globalN, comm));
+    if (streaming != nullptr) {
+        streaming->begin(dist);
+    }
+
     // set like in KaHiP/parallel/prallel_src/app/configuration.h in configuration::standard
     //const IndexType binary_io_window_size = 64;
 
@@ -1145,6 +1168,10 @@ scai::lama::CSRSparseMatrix<ValueType> FileIO<IndexType, ValueType>::readGraphBi
                 if (hasEdgeWeights) {
                     assert(ja.size() == values.size());
                 }
+
+                if (streaming != nullptr) {
+                    streaming->assignNext(ja.data() + ia[i], nodeDegree, 1);
+                }
             }
 
             // if no edge weight values vector is just 1s
@@ -1169,12 +1196,9 @@ scai::lama::CSRSparseMatrix<ValueType> FileIO<IndexType, ValueType>::readGraphBi
     //
 
     scai::lama::CSRStorage<ValueType> myStorage(localN, globalN,
-            HArray<IndexType>(ia.size(), ia.data()),
-            HArray<IndexType>(ja.size(), ja.data()),
-            HArray<ValueType>(values.size(), values.data()));
-
-    // block distribution for rows and no distribution for columns
-    const scai::dmemo::DistributionPtr dist(new scai::dmemo::BlockDistribution(globalN, comm));
+            firstTouchCopy(ia.data(), ia.size()),
+            firstTouchCopy(ja.data(), ja.size()),
+            firstTouchCopy(values.data(), values.size()));
 
     // myStorage is exactly my local part corresponding to the block distribution
     // ThomasBrandes: is localN realy dist->getLocalSize()
@@ -1621,7 +1645,7 @@ std::vector<DenseVector<ValueType>> FileIO<IndexType, ValueType>::readCoords( co
     std::vector<DenseVector<ValueType> > result(dimension);
 
     for (IndexType dim = 0; dim < dimension; dim++) {
-        result[dim] = DenseVector<ValueType>(dist, HArray<ValueType>(localN, coords[dim].data()) );
+        result[dim] = DenseVector<ValueType>(dist, firstTouchCopy(coords[dim].data(), localN) );
     }
 
     return result;
@@ -2688,6 +2712,79 @@ bool FileIO<IndexType, ValueType>::fileExists(const std::string& filename) {
 }
 //
 
+template<typename IndexType, typename ValueType>
+std::vector<BatchFiles> FileIO<IndexType, ValueType>::readFileList(const std::string& listOrPattern) {
+    std::vector<BatchFiles> files;
+
+    if (listOrPattern.find_first_of("*?[") != std::string::npos) {
+        glob_t matches;
+        if (glob(listOrPattern.c_str(), 0, nullptr, &matches) == 0) {
+            //glob sorts the matches
+            for (std::size_t i = 0; i < matches.gl_pathc; i++) {
+                const std::string graphFile(matches.gl_pathv[i]);
+                files.push_back(BatchFiles{graphFile, graphFile + ".xyz", ""});
+            }
+        }
+        globfree(&matches);
+        return files;
+    }
+
+    std::ifstream file(listOrPattern);
+    if (file.fail()) {
+        throw std::runtime_error("Could not open file list " + listOrPattern);
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        trim(line);
+        if (line.empty() or line[0] == '%' or line[0] == '#') {
+            continue;
+        }
+        std::stringstream ss(line);
+        BatchFiles step;
+        ss >> step.graphFile >> step.coordFile >> step.weightFile;
+        if (step.coordFile.empty()) {
+            step.coordFile = step.graphFile + ".xyz";
+        }
+        files.push_back(step);
+    }
+
+    return files;
+}
+//---------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void FileIO<IndexType, ValueType>::prefetchFile(const std::string& filename, const IndexType part, const IndexType numParts) {
+    SCAI_REGION("FileIO.prefetchFile");
+
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == 0) {
+        const off_t size = fileStat.st_size;
+        const off_t begin = size / numParts * part;
+        const off_t end = part + 1 == numParts ? size : size / numParts * (part + 1);
+        posix_fadvise(fd, begin, end - begin, POSIX_FADV_WILLNEED);
+
+        //the advice is only a hint, reading the range makes sure the pages are cached
+        std::vector<char> buffer(1 << 20);
+        off_t offset = begin;
+        while (offset < end) {
+            const ssize_t numRead = pread(fd, buffer.data(), std::min<off_t>(buffer.size(), end - offset), offset);
+            if (numRead <= 0) {
+                break;
+            }
+            offset += numRead;
+        }
+    }
+
+    close(fd);
+}
+//---------------------------------------------------------------------------
+
 // functions to trim a string of whitespaces
 // taken from 
 //https://stackoverflow.com/questions/216823/whats-the-best-way-to-trim-stdstring
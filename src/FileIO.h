@@ -15,6 +15,7 @@
 #include "Settings.h"
 #include "GraphUtils.h"
 #include "CommTree.h"
+#include "StreamingPartition.h"
 
 #include <vector>
 #include <set>
@@ -42,6 +43,13 @@ using scai::lama::DenseVector;
   *                            for the points: every d lines are the coordinates for a point.
  */
 
+/** The files of one step of a batch run, \sa FileIO::readFileList.
+*/
+struct BatchFiles {
+    std::string graphFile;
+    std::string coordFile;
+    std::string weightFile;     ///< the node weights of the step, in the format of a coordinate file; empty if they are read from the graph file
+};
 
 template <typename IndexType, typename ValueType>
 class FileIO {
@@ -157,9 +165,12 @@ public:
      * @param[in] filename The file to read from.
      * @param[out] nodeWeights The weights of the nodes if they exists in the provided file.
      * @param[in] fileFormat The type of file to read from.
+     * @param[in,out] streaming If given, every vertex is assigned to a block right after its line is read; for the
+     * METIS and the binary format this hides the initial partition in the reading. For the other formats the
+     * vertices are streamed after reading. Get the result with streaming->getPartition().
      * @return The adjacency matrix of the graph. The rows of the matrix are distributed with a BlockDistribution and NoDistribution for the columns.
      */
-    static CSRSparseMatrix<ValueType> readGraph(const std::string filename, std::vector<DenseVector<ValueType>>& nodeWeights, const scai::dmemo::CommunicatorPtr comm, Format = Format::AUTO);
+    static CSRSparseMatrix<ValueType> readGraph(const std::string filename, std::vector<DenseVector<ValueType>>& nodeWeights, const scai::dmemo::CommunicatorPtr comm, Format = Format::AUTO, StreamingPartition<IndexType, ValueType>* streaming = nullptr);
 
     static CSRSparseMatrix<ValueType> readGraph(const std::string filename ){
         const scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
@@ -170,9 +181,10 @@ public:
     /** Reads a graph in parallel that is stored in a binary file. Uses the same format as in ParHiP, the parallel version of KaHiP,
     see <a href="http://algo2.iti.kit.edu/schulz/software_releases/kahipv2.00.pdf">here</a> for mode details.
      * @param[in] filename The file to read from.
+     * @param[in,out] streaming If given, every vertex is assigned to a block right after its adjacency is read, \sa readGraph.
      * @return The adjacency matrix of the graph. The rows of the matrix are distributed with a BlockDistribution and NoDistribution for the columns.
      */
-    static scai::lama::CSRSparseMatrix<ValueType> readGraphBinary(const std::string filename, const scai::dmemo::CommunicatorPtr comm);
+    static scai::lama::CSRSparseMatrix<ValueType> readGraphBinary(const std::string filename, const scai::dmemo::CommunicatorPtr comm, StreamingPartition<IndexType, ValueType>* streaming = nullptr);
 
     /**Every PE reads its part of the file. The file contains all the edges of the graph: each line has two numbers indicating
      * the vertices of the edge.
@@ -362,6 +374,23 @@ public:
      */
     static bool fileExists(const std::string& filename);
 
+    /** The inputs of a batch run. If the argument contains a wildcard, the files matching the glob pattern in lexicographic order.
+     Otherwise the argument is a text file with one graph file per line, optionally followed by its coordinate file
+     and a node weight file. Empty lines and lines starting with '%' or '#' are skipped.
+     @param[in] listOrPattern A glob pattern or the name of the list file.
+     @return The files of every step, the coordinate file is the graph file with suffix .xyz if not given.
+     */
+    static std::vector<BatchFiles> readFileList(const std::string& listOrPattern);
+
+    /** Read a part of a file to bring it into the page cache, e.g. in a background thread while the previous
+     input is partitioned. The file is split into numParts byte ranges of equal size and range part is read, so
+     that together the processes of a compute node read the file once. Not collective, errors are ignored.
+     @param[in] filename The name of the file.
+     @param[in] part The index of the byte range to read.
+     @param[in] numParts The number of byte ranges.
+     */
+    static void prefetchFile(const std::string& filename, const IndexType part, const IndexType numParts);
+
 private:
     /**
      * given the central coordinates of a cell and its level, compute the bounding corners
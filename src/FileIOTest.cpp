@@ -19,6 +19,8 @@
 #include <scai/hmemo/WriteAccess.hpp>
 #include <scai/hmemo/ReadAccess.hpp>
 
+#include <cstdio>
+#include <fstream>
 #include <memory>
 
 #include "gtest/gtest.h"
@@ -776,5 +778,45 @@ TYPED_TEST (FileIOTest, testTopologyFile) {
     EXPECT_EQ( nodeMap["stark01"][0], (ValueType) 3.3); //stark01 cpu is 3.3
     EXPECT_EQ( nodeMap["stark01"][1], (ValueType) 187321); //stark01 memory is 187321
 }
+//-------------------------------------------------------------------------------------------------
+
+TYPED_TEST (FileIOTest, testReadFileList) {
+    using ValueType = TypeParam;
+
+    const std::string path = FileIOTest<ValueType>::graphPath;
+    std::vector<BatchFiles> files = FileIO<IndexType, ValueType>::readFileList( path+ "Grid?x?" );
+    ASSERT_EQ( files.size(), 2 );
+    EXPECT_EQ( files[0].graphFile, path+ "Grid4x4" );
+    EXPECT_EQ( files[0].coordFile, path+ "Grid4x4.xyz" );
+    EXPECT_TRUE( files[0].weightFile.empty() );
+    EXPECT_EQ( files[1].graphFile, path+ "Grid8x8" );
+
+    //the files can be read through the page cache
+    for( const auto& stepFiles : files ){
+        FileIO<IndexType, ValueType>::prefetchFile( stepFiles.graphFile, 0, 2 );
+        FileIO<IndexType, ValueType>::prefetchFile( stepFiles.coordFile, 1, 2 );
+    }
+    FileIO<IndexType, ValueType>::prefetchFile( path+ "doesNotExist", 0, 1 );
+
+    const scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+    const std::string listFile = "fileList_"+ std::to_string(comm->getRank())+ ".txt";
+    {
+        std::ofstream list( listFile );
+        list << "% time steps" << std::endl;
+        list << "step0.graph" << std::endl << std::endl;
+        list << "  step1.graph step1.coords " << std::endl;
+        list << "step1.graph step1.coords step2.weights" << std::endl;
+    }
+    files = FileIO<IndexType, ValueType>::readFileList( listFile );
+    ASSERT_EQ( files.size(), 3 );
+    EXPECT_EQ( files[0].graphFile, "step0.graph" );
+    EXPECT_EQ( files[0].coordFile, "step0.graph.xyz" );
+    EXPECT_EQ( files[1].graphFile, "step1.graph" );
+    EXPECT_EQ( files[1].coordFile, "step1.coords" );
+    EXPECT_TRUE( files[1].weightFile.empty() );
+    EXPECT_EQ( files[2].graphFile, "step1.graph" );
+    EXPECT_EQ( files[2].weightFile, "step2.weights" );
+    std::remove( listFile.c_str() );
+}
 
 } /* namespace ITI */
@@ -9,6 +9,10 @@
 #include <queue>
 #include <unordered_set>
 #include <chrono>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <numeric>
 
 #include <scai/dmemo/mpi/MPICommunicator.hpp>
 #include <scai/hmemo/ReadAccess.hpp>
@@ -23,6 +27,9 @@
 #include <JanusSort.hpp>
 
 #include "GraphUtils.h"
+#include "HaloExport.h"
+#include "HilbertCurve.h"
+#include "Redistribution.h"
 
 SCAI_LOG_DEF_LOGGER( logger, "GraphUtilsLogger" );
 
@@ -109,6 +116,469 @@ scai::dmemo::DistributionPtr GraphUtils<IndexType,ValueType>::reindex(scai::lama
 
     return blockDist;
 }
+//---------------------------------------------------------------------------------------
+
+namespace {
+
+/* Permute the local values of vec so that the new i-th value is the old order[i]-th value
+and give it the new distribution, which must have the same local size. */
+template<typename IndexType, typename T>
+void permuteLocalValues(DenseVector<T>& vec, const std::vector<IndexType>& order, const scai::dmemo::DistributionPtr newDist) {
+    const IndexType localN = order.size();
+    scai::hmemo::HArray<T> permuted(localN);
+    {
+        scai::hmemo::ReadAccess<T> rOld(vec.getLocalValues());
+        scai::hmemo::WriteAccess<T> wNew(permuted);
+        for (IndexType i = 0; i < localN; i++) {
+            wNew[i] = rOld[order[i]];
+        }
+    }
+    vec.swap(permuted, newDist);
+}
+
+/* Give the local vertices new global ids without moving them between PEs: the vertex at old local
+position order[i] gets position i and the global id newDist->local2Global(i). The column distribution
+of the graph must be replicated and all vectors must have its row distribution. */
+template<typename IndexType, typename ValueType>
+void applyLocalOrder(
+    CSRSparseMatrix<ValueType> &graph,
+    std::vector<DenseVector<ValueType>> &coordinates,
+    std::vector<DenseVector<ValueType>> &nodeWeights,
+    std::vector<DenseVector<IndexType>*> &indexVectors,
+    const std::vector<IndexType> &order,
+    const scai::dmemo::DistributionPtr newDist) {
+
+    const scai::dmemo::DistributionPtr inputDist = graph.getRowDistributionPtr();
+    const scai::dmemo::CommunicatorPtr comm = inputDist->getCommunicatorPtr();
+    const IndexType localN = inputDist->getLocalSize();
+    const IndexType globalN = inputDist->getGlobalSize();
+    SCAI_ASSERT_EQ_ERROR( order.size(), localN, "Wrong size of local order" );
+    SCAI_ASSERT_EQ_ERROR( newDist->getLocalSize(), localN, "The new distribution must keep the local size" );
+
+    scai::hmemo::HArray<IndexType> newIds(localN);
+    {
+        scai::hmemo::WriteAccess<IndexType> wNewIds(newIds);
+        for (IndexType i = 0; i < localN; i++) {
+            wNewIds[order[i]] = newDist->local2Global(i);
+        }
+    }
+
+    //the neighbors on other PEs are renamed as well
+    scai::dmemo::HaloExchangePlan halo = GraphUtils<IndexType,ValueType>::buildNeighborHalo(graph);
+    scai::hmemo::HArray<IndexType> haloIds;
+    halo.updateHalo( haloIds, newIds, *comm );
+
+    const CSRStorage<ValueType>& localStorage = graph.getLocalStorage();
+    const IndexType localM = localStorage.getJA().size();
+
+    scai::hmemo::HArray<IndexType> newIA(localN+1);
+    scai::hmemo::HArray<IndexType> newJA(localM);
+    scai::hmemo::HArray<ValueType> newValues(localM);
+    {
+        SCAI_REGION("GraphUtils.localReordering.permuteGraph");
+        scai::hmemo::ReadAccess<IndexType> ia(localStorage.getIA());
+        scai::hmemo::ReadAccess<IndexType> ja(localStorage.getJA());
+        scai::hmemo::ReadAccess<ValueType> values(localStorage.getValues());
+        scai::hmemo::ReadAccess<IndexType> rNewIds(newIds);
+        scai::hmemo::ReadAccess<IndexType> rHalo(haloIds);
+
+        scai::hmemo::WriteAccess<IndexType> wIA(newIA);
+        scai::hmemo::WriteAccess<IndexType> wJA(newJA);
+        scai::hmemo::WriteAccess<ValueType> wValues(newValues);
+
+        IndexType pos = 0;
+        wIA[0] = 0;
+        for (IndexType i = 0; i < localN; i++) {
+            const IndexType oldRow = order[i];
+            for (IndexType j = ia[oldRow]; j < ia[oldRow+1]; j++) {
+                const IndexType localNeighbor = inputDist->global2Local(ja[j]);
+                if (localNeighbor != scai::invalidIndex) {
+                    wJA[pos] = rNewIds[localNeighbor];
+                } else {
+                    const IndexType haloIndex = halo.global2Halo(ja[j]);
+                    SCAI_ASSERT_NE_DEBUG( haloIndex, scai::invalidIndex, "Neighbor " << ja[j] << " neither local nor in halo" );
+                    wJA[pos] = rHalo[haloIndex];
+                }
+                wValues[pos] = values[j];
+                pos++;
+            }
+            wIA[i+1] = pos;
+        }
+        SCAI_ASSERT_EQ_ERROR( pos, localM, "Wrong number of edges after reordering" );
+    }
+
+    CSRStorage<ValueType> newStorage(localN, globalN, std::move(newIA), std::move(newJA), std::move(newValues));
+    graph = CSRSparseMatrix<ValueType>(newDist, std::move(newStorage));
+
+    //permute the vectors locally and assign them the new distribution
+    for (IndexType d = 0; d < coordinates.size(); d++) {
+        permuteLocalValues(coordinates[d], order, newDist);
+    }
+    for (IndexType w = 0; w < nodeWeights.size(); w++) {
+        permuteLocalValues(nodeWeights[w], order, newDist);
+    }
+    for (DenseVector<IndexType>* vec : indexVectors) {
+        permuteLocalValues(*vec, order, newDist);
+    }
+}
+
+} // anonymous namespace
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+DenseVector<IndexType> GraphUtils<IndexType,ValueType>::localReordering(
+    CSRSparseMatrix<ValueType> &graph,
+    std::vector<DenseVector<ValueType>> &coordinates,
+    std::vector<DenseVector<ValueType>> &nodeWeights,
+    std::vector<DenseVector<IndexType>*> indexVectors,
+    const Settings settings) {
+
+    SCAI_REGION("GraphUtils.localReordering");
+
+    const scai::dmemo::DistributionPtr inputDist = graph.getRowDistributionPtr();
+    const scai::dmemo::CommunicatorPtr comm = inputDist->getCommunicatorPtr();
+    const IndexType localN = inputDist->getLocalSize();
+    const IndexType globalN = inputDist->getGlobalSize();
+
+    SCAI_ASSERT_ERROR( graph.getColDistributionPtr()->isReplicated(), "Column distribution must be replicated" );
+    for (IndexType d = 0; d < coordinates.size(); d++) {
+        SCAI_ASSERT_ERROR( coordinates[d].getDistributionPtr()->isEqual(*inputDist), "Distribution mismatch for coordinates in dimension " << d );
+    }
+    for (IndexType w = 0; w < nodeWeights.size(); w++) {
+        SCAI_ASSERT_ERROR( nodeWeights[w].getDistributionPtr()->isEqual(*inputDist), "Distribution mismatch for node weights " << w );
+    }
+    for (DenseVector<IndexType>* vec : indexVectors) {
+        SCAI_ASSERT_ERROR( vec->getDistributionPtr()->isEqual(*inputDist), "Distribution mismatch for index vector" );
+    }
+
+    //order[i] is the old local index of the vertex that gets position i
+    std::vector<IndexType> order;
+    if (settings.localReordering == "sfc") {
+        SCAI_ASSERT_EQ_ERROR( coordinates.size(), settings.dimensions, "sfc reordering needs the coordinates" );
+        const std::vector<double> hilbertIndices = HilbertCurve<IndexType,ValueType>::getHilbertIndexVector(coordinates, settings.sfcResolution, settings.dimensions);
+        order.resize(localN);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&hilbertIndices](IndexType a, IndexType b) {
+            return hilbertIndices[a] < hilbertIndices[b];
+        });
+    } else if (settings.localReordering == "rcm") {
+        order = localRCMOrder(graph);
+    } else {
+        SCAI_ASSERT_EQ_ERROR( settings.localReordering, "none", "Unknown local reordering" );
+        order.resize(localN);
+        std::iota(order.begin(), order.end(), 0);
+    }
+
+    //the new global ids are consecutive on every PE, in the computed order
+    const scai::dmemo::DistributionPtr blockDist = scai::dmemo::genBlockDistributionBySize(globalN, localN, comm);
+
+    DenseVector<IndexType> originalIds(blockDist, 0);
+    {
+        scai::hmemo::WriteAccess<IndexType> wOriginal(originalIds.getLocalValues());
+        for (IndexType i = 0; i < localN; i++) {
+            wOriginal[i] = inputDist->local2Global(order[i]);
+        }
+    }
+
+    applyLocalOrder(graph, coordinates, nodeWeights, indexVectors, order, blockDist);
+
+    return originalIds;
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void GraphUtils<IndexType,ValueType>::undoLocalReordering(DenseVector<IndexType> &vector, const DenseVector<IndexType> &originalIds) {
+    SCAI_REGION("GraphUtils.undoLocalReordering");
+
+    const scai::dmemo::DistributionPtr reorderedDist = originalIds.getDistributionPtr();
+    const scai::dmemo::CommunicatorPtr comm = reorderedDist->getCommunicatorPtr();
+    const IndexType globalN = reorderedDist->getGlobalSize();
+    const IndexType localN = reorderedDist->getLocalSize();
+    SCAI_ASSERT_EQ_ERROR( vector.size(), globalN, "Vector does not fit the reordered graph" );
+
+    //align the vector with the original ids, then rename its entries without moving them
+    vector.redistribute(reorderedDist);
+
+    const scai::hmemo::HArray<IndexType>& localOriginalIds = originalIds.getLocalValues();
+    const scai::dmemo::DistributionPtr originalDist = scai::dmemo::generalDistributionUnchecked(globalN, localOriginalIds, comm);
+    SCAI_ASSERT_EQ_ERROR( originalDist->getLocalSize(), localN, "Original ids are not a permutation" );
+
+    scai::hmemo::HArray<IndexType> renamed(localN);
+    {
+        scai::hmemo::ReadAccess<IndexType> rIds(localOriginalIds);
+        scai::hmemo::ReadAccess<IndexType> rValues(vector.getLocalValues());
+        scai::hmemo::WriteAccess<IndexType> wRenamed(renamed);
+        for (IndexType i = 0; i < localN; i++) {
+            wRenamed[originalDist->global2Local(rIds[i])] = rValues[i];
+        }
+    }
+    vector.swap(renamed, originalDist);
+
+    const scai::dmemo::DistributionPtr blockDist(new scai::dmemo::BlockDistribution(globalN, comm));
+    vector.redistribute(blockDist);
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void GraphUtils<IndexType,ValueType>::undoLocalReordering(
+    CSRSparseMatrix<ValueType> &graph,
+    std::vector<DenseVector<ValueType>> &coordinates,
+    std::vector<DenseVector<ValueType>> &nodeWeights,
+    std::vector<DenseVector<IndexType>*> indexVectors,
+    const DenseVector<IndexType> &originalIds) {
+
+    SCAI_REGION("GraphUtils.undoLocalReordering");
+
+    const scai::dmemo::DistributionPtr reorderedDist = graph.getRowDistributionPtr();
+    const scai::dmemo::CommunicatorPtr comm = reorderedDist->getCommunicatorPtr();
+    const IndexType globalN = reorderedDist->getGlobalSize();
+    const IndexType localN = reorderedDist->getLocalSize();
+    SCAI_ASSERT_ERROR( graph.getColDistributionPtr()->isReplicated(), "Column distribution must be replicated" );
+    SCAI_ASSERT_ERROR( originalIds.getDistributionPtr()->isEqual(*reorderedDist), "Original ids must have the distribution of the graph" );
+
+    const scai::hmemo::HArray<IndexType>& localOriginalIds = originalIds.getLocalValues();
+    const scai::dmemo::DistributionPtr originalDist = scai::dmemo::generalDistributionUnchecked(globalN, localOriginalIds, comm);
+    SCAI_ASSERT_EQ_ERROR( originalDist->getLocalSize(), localN, "Original ids are not a permutation" );
+
+    //the vertex at reordered position i goes back to the position of its original id
+    std::vector<IndexType> order(localN);
+    {
+        scai::hmemo::ReadAccess<IndexType> rIds(localOriginalIds);
+        for (IndexType i = 0; i < localN; i++) {
+            order[originalDist->global2Local(rIds[i])] = i;
+        }
+    }
+
+    applyLocalOrder(graph, coordinates, nodeWeights, indexVectors, order, originalDist);
+}
+//---------------------------------------------------------------------------------------
+
+namespace {
+
+//a vertex in the global sfc order of blockRenumbering: by block, then by the index on the curve
+struct BlockCurveKey {
+    IndexType block;
+    double key;
+    IndexType id;
+    bool operator<(const BlockCurveKey& rhs) const {
+        return block < rhs.block || (block == rhs.block && (key < rhs.key || (key == rhs.key && id < rhs.id)));
+    }
+    bool operator>(const BlockCurveKey& rhs) const {
+        return rhs < *this;
+    }
+    bool operator<=(const BlockCurveKey& rhs) const {
+        return !operator>(rhs);
+    }
+    bool operator>=(const BlockCurveKey& rhs) const {
+        return !operator<(rhs);
+    }
+};
+
+}//namespace
+
+template<typename IndexType, typename ValueType>
+DenseVector<IndexType> GraphUtils<IndexType,ValueType>::blockRenumbering(
+    const CSRSparseMatrix<ValueType> &graph,
+    const std::vector<DenseVector<ValueType>> &coordinates,
+    const DenseVector<IndexType> &partition,
+    const std::string ordering,
+    const Settings settings) {
+
+    SCAI_REGION("GraphUtils.blockRenumbering");
+
+    const scai::dmemo::DistributionPtr inputDist = graph.getRowDistributionPtr();
+    const scai::dmemo::CommunicatorPtr comm = inputDist->getCommunicatorPtr();
+    const IndexType k = settings.numBlocks;
+    const IndexType numPEs = comm->getSize();
+    const IndexType globalN = inputDist->getGlobalSize();
+    const IndexType localN = inputDist->getLocalSize();
+
+    SCAI_ASSERT_ERROR( ordering=="sfc" or ordering=="rcm", "Unknown order within the blocks: " << ordering );
+    SCAI_ASSERT_ERROR( graph.getColDistributionPtr()->isReplicated(), "Column distribution must be replicated" );
+
+    DenseVector<IndexType> blockPart(partition);
+    if (not blockPart.getDistribution().isEqual(*inputDist)) {
+        blockPart.redistribute(inputDist);
+    }
+
+    if (ordering == "sfc") {
+        SCAI_ASSERT_EQ_ERROR( coordinates.size(), settings.dimensions, "sfc order needs the coordinates" );
+        std::vector<DenseVector<ValueType>> localCoords(coordinates);
+        for (DenseVector<ValueType>& coords : localCoords) {
+            if (not coords.getDistribution().isEqual(*inputDist)) {
+                coords.redistribute(inputDist);
+            }
+        }
+        const std::vector<double> curveIndices = HilbertCurve<IndexType,ValueType>::getHilbertIndexVector(localCoords, settings.sfcResolution, settings.dimensions);
+
+        std::vector<BlockCurveKey> keys(localN);
+        {
+            scai::hmemo::ReadAccess<IndexType> rPart(blockPart.getLocalValues());
+            for (IndexType i = 0; i < localN; i++) {
+                SCAI_ASSERT_VALID_INDEX_DEBUG( rPart[i], k, "Wrong block id" );
+                keys[i] = BlockCurveKey{rPart[i], curveIndices[i], inputDist->local2Global(i)};
+            }
+        }
+
+        //sorting all vertices by block and curve index gives the new ids, no block has to fit on one PE
+        MPI_Comm mpi_comm = MPI_COMM_WORLD;
+        if (comm->getType() == scai::dmemo::CommunicatorType::MPI) {
+            mpi_comm = static_cast<const scai::dmemo::MPICommunicator&>(*comm).getMPIComm();
+        }
+        MPI_Datatype keyType;
+        MPI_Type_contiguous(sizeof(BlockCurveKey), MPI_BYTE, &keyType);
+        MPI_Type_commit(&keyType);
+        JanusSort::sort(mpi_comm, keys, keyType);
+        MPI_Type_free(&keyType);
+
+        //the new id is the global position in the sorted sequence
+        const IndexType sortedLocalN = keys.size();
+        std::vector<IndexType> sortedSizes(numPEs, 0);
+        sortedSizes[comm->getRank()] = sortedLocalN;
+        comm->sumImpl(sortedSizes.data(), sortedSizes.data(), numPEs, scai::common::TypeTraits<IndexType>::stype);
+        const IndexType offset = std::accumulate(sortedSizes.begin(), sortedSizes.begin() + comm->getRank(), IndexType(0));
+
+        std::vector<IndexType> byId(sortedLocalN);
+        std::iota(byId.begin(), byId.end(), 0);
+        std::sort(byId.begin(), byId.end(), [&keys](IndexType a, IndexType b) {
+            return keys[a].id < keys[b].id;
+        });
+        scai::hmemo::HArray<IndexType> sortedIds(sortedLocalN);
+        scai::hmemo::HArray<IndexType> sortedNewIds(sortedLocalN);
+        {
+            scai::hmemo::WriteAccess<IndexType> wIds(sortedIds);
+            scai::hmemo::WriteAccess<IndexType> wNewIds(sortedNewIds);
+            for (IndexType i = 0; i < sortedLocalN; i++) {
+                wIds[i] = keys[byId[i]].id;
+                wNewIds[i] = offset + byId[i];
+            }
+        }
+
+        const scai::dmemo::DistributionPtr sortedDist = scai::dmemo::generalDistributionUnchecked(globalN, std::move(sortedIds), comm);
+        DenseVector<IndexType> newIds(sortedDist, std::move(sortedNewIds));
+        newIds.redistribute(inputDist);
+        return newIds;
+    }
+
+    //the rcm order needs the edges of a block, so every block is moved to the PE of its halo plan
+    CSRSparseMatrix<ValueType> blockGraph(graph);
+    std::vector<DenseVector<ValueType>> noCoords;
+    std::vector<DenseVector<ValueType>> noWeights;
+
+    scai::hmemo::HArray<IndexType> owners(localN);
+    {
+        scai::hmemo::ReadAccess<IndexType> rPart(blockPart.getLocalValues());
+        scai::hmemo::WriteAccess<IndexType> wOwners(owners);
+        for (IndexType i = 0; i < localN; i++) {
+            SCAI_ASSERT_VALID_INDEX_DEBUG( rPart[i], k, "Wrong block id" );
+            wOwners[i] = HaloExport<IndexType, ValueType>::blockOwner(rPart[i], k, numPEs);
+        }
+    }
+    const scai::dmemo::DistributionPtr blockDist = Redistribution<IndexType, ValueType>::redistributeByNewOwners(owners, blockGraph, noCoords, noWeights, {&blockPart});
+    const IndexType blockLocalN = blockDist->getLocalSize();
+
+    //the rank of every local vertex in rcm order, the local subgraph can contain several blocks
+    std::vector<IndexType> key(blockLocalN);
+    const std::vector<IndexType> rcmOrder = localRCMOrder(blockGraph);
+    for (IndexType i = 0; i < blockLocalN; i++) {
+        key[rcmOrder[i]] = i;
+    }
+
+    //every block is complete on its PE, so the local block sizes are the global ones
+    std::vector<IndexType> blockSizes(k, 0);
+    scai::hmemo::ReadAccess<IndexType> rBlockPart(blockPart.getLocalValues());
+    for (IndexType i = 0; i < blockLocalN; i++) {
+        blockSizes[rBlockPart[i]]++;
+    }
+    comm->sumImpl(blockSizes.data(), blockSizes.data(), k, scai::common::TypeTraits<IndexType>::stype);
+    std::vector<IndexType> nextId(k, 0);
+    std::partial_sum(blockSizes.begin(), blockSizes.end()-1, nextId.begin()+1);
+
+    std::vector<IndexType> order(blockLocalN);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&rBlockPart, &key](IndexType a, IndexType b) {
+        return rBlockPart[a] < rBlockPart[b] or (rBlockPart[a] == rBlockPart[b] and key[a] < key[b]);
+    });
+
+    DenseVector<IndexType> newIds(blockDist, 0);
+    {
+        scai::hmemo::WriteAccess<IndexType> wNewIds(newIds.getLocalValues());
+        for (const IndexType i : order) {
+            wNewIds[i] = nextId[rBlockPart[i]]++;
+        }
+    }
+    rBlockPart.release();
+
+    newIds.redistribute(inputDist);
+    return newIds;
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+std::vector<IndexType> GraphUtils<IndexType,ValueType>::localRCMOrder(const CSRSparseMatrix<ValueType> &graph) {
+    SCAI_REGION("GraphUtils.localRCMOrder");
+
+    const scai::dmemo::DistributionPtr inputDist = graph.getRowDistributionPtr();
+    const IndexType localN = inputDist->getLocalSize();
+
+    const CSRStorage<ValueType>& localStorage = graph.getLocalStorage();
+    const scai::hmemo::ReadAccess<IndexType> ia(localStorage.getIA());
+    const scai::hmemo::ReadAccess<IndexType> ja(localStorage.getJA());
+
+    //local adjacency and local degrees, edges to other PEs are skipped
+    std::vector<IndexType> localDegree(localN, 0);
+    std::vector<IndexType> localNeighbors;
+    std::vector<IndexType> offsets(localN+1, 0);
+    localNeighbors.reserve(ja.size());
+    for (IndexType v = 0; v < localN; v++) {
+        for (IndexType j = ia[v]; j < ia[v+1]; j++) {
+            const IndexType localNeighbor = inputDist->global2Local(ja[j]);
+            if (localNeighbor != scai::invalidIndex && localNeighbor != v) {
+                localNeighbors.push_back(localNeighbor);
+            }
+        }
+        offsets[v+1] = localNeighbors.size();
+        localDegree[v] = offsets[v+1] - offsets[v];
+    }
+
+    //start vertices of the components are taken in increasing degree
+    std::vector<IndexType> byDegree(localN);
+    std::iota(byDegree.begin(), byDegree.end(), 0);
+    std::stable_sort(byDegree.begin(), byDegree.end(), [&localDegree](IndexType a, IndexType b) {
+        return localDegree[a] < localDegree[b];
+    });
+
+    std::vector<IndexType> order;
+    order.reserve(localN);
+    std::vector<bool> visited(localN, false);
+
+    for (IndexType start : byDegree) {
+        if (visited[start]) continue;
+
+        //BFS over this component; order doubles as the queue
+        std::size_t head = order.size();
+        order.push_back(start);
+        visited[start] = true;
+        while (head < order.size()) {
+            const IndexType v = order[head++];
+            const std::size_t firstNew = order.size();
+            for (IndexType j = offsets[v]; j < offsets[v+1]; j++) {
+                const IndexType u = localNeighbors[j];
+                if (!visited[u]) {
+                    visited[u] = true;
+                    order.push_back(u);
+                }
+            }
+            std::stable_sort(order.begin()+firstNew, order.end(), [&localDegree](IndexType a, IndexType b) {
+                return localDegree[a] < localDegree[b];
+            });
+        }
+    }
+    SCAI_ASSERT_EQ_ERROR( order.size(), localN, "Not all local vertices visited" );
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
 
 template<typename IndexType, typename ValueType>
 std::vector<IndexType> GraphUtils<IndexType,ValueType>::localBFS(const scai::lama::CSRSparseMatrix<ValueType> &graph, const IndexType u)
@@ -522,16 +992,141 @@ std::vector<ValueType>  GraphUtils<IndexType,ValueType>::getBlocksWeights(
 }
 //---------------------------------------------------------------------------------------
 
+//---------------------------------------------------------------------------------------
+// cache of halo plans built by buildNeighborHalo
+//
+
+namespace {
+
+struct HaloCacheEntry {
+    std::weak_ptr<const scai::dmemo::Distribution> distribution;
+    const void* columnIndices;      ///< the address of the local column indices, identifies the storage of the graph
+    IndexType numValues;
+    std::size_t structureHash;      ///< hash of the local row offsets and column indices
+    scai::dmemo::HaloExchangePlan plan;
+};
+
+//a few entries are enough, e.g., the fine and the coarse graphs during multilevel
+const std::size_t maxHaloCacheEntries = 8;
+
+struct HaloCache {
+    std::mutex mutex;
+    std::list<HaloCacheEntry> entries;
+    IndexType hits = 0;
+};
+
+void clearHaloCacheEntries();
+
+HaloCache& haloCache() {
+    static HaloCache cache;
+    //the plans hold LAMA arrays, they must be freed before LAMA and MPI shut down at exit. The handler is
+    //registered after the communicator was created, so it runs before the communicator is destroyed
+    static const bool registered = (std::atexit(clearHaloCacheEntries) == 0);
+    (void) registered;
+    return cache;
+}
+
+void clearHaloCacheEntries() {
+    HaloCache& cache = haloCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.entries.clear();
+    cache.hits = 0;
+}
+
+//FNV-1a over the row offsets and the column indices, a graph changed in place must not get the old plan
+template<typename ValueType>
+std::size_t structureHash(const CSRStorage<ValueType>& storage) {
+    std::size_t hash = 14695981039346656037ULL;
+    auto add = [&hash](const scai::hmemo::HArray<IndexType>& array) {
+        scai::hmemo::ReadAccess<IndexType> values(array);
+        for (IndexType i = 0; i < values.size(); i++) {
+            hash ^= std::size_t(values[i]);
+            hash *= 1099511628211ULL;
+        }
+    };
+    add(storage.getIA());
+    add(storage.getJA());
+    return hash;
+}
+
+}//namespace
+
 template<typename IndexType, typename ValueType>
 scai::dmemo::HaloExchangePlan GraphUtils<IndexType,ValueType>::buildNeighborHalo(const CSRSparseMatrix<ValueType>& input) {
 
     SCAI_REGION( "ParcoRepart.buildPartHalo" )
 
+    const scai::dmemo::DistributionPtr inputDist = input.getRowDistributionPtr();
+    const scai::dmemo::CommunicatorPtr comm = inputDist->getCommunicatorPtr();
+    const CSRStorage<ValueType>& localStorage = input.getLocalStorage();
+
+    const IndexType numValues = localStorage.getNumValues();
+    const std::size_t localStructureHash = structureHash(localStorage);
+    const void* columnIndices = scai::hmemo::ReadAccess<IndexType>(localStorage.getJA()).get();
+
+    auto matches = [&](const HaloCacheEntry& entry) {
+        return entry.distribution.lock()==inputDist and entry.columnIndices==columnIndices
+            and entry.numValues==numValues and entry.structureHash==localStructureHash;
+    };
+
+    HaloCache& cache = haloCache();
+
+    //the lock is not held during the collective operations, other threads may use the cache meanwhile
+    bool found = false;
+    scai::dmemo::HaloExchangePlan plan;
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+
+        //entries of distributions that do not exist any more are invalid, e.g. after a redistribution
+        cache.entries.remove_if( [](const HaloCacheEntry& entry) {
+            return entry.distribution.expired();
+        });
+
+        auto entryIt = std::find_if( cache.entries.begin(), cache.entries.end(), matches );
+        if (entryIt!=cache.entries.end()) {
+            found = true;
+            plan = entryIt->plan;
+            cache.entries.splice(cache.entries.begin(), cache.entries, entryIt);
+        }
+    }
+
+    //building the plan is collective, so all PEs must agree on using the cached one
+    if (comm->min( IndexType(found) )==1) {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        cache.hits++;
+        return plan;
+    }
+
     std::vector<IndexType> requiredHaloIndices = nonLocalNeighbors(input);
 
     scai::hmemo::HArrayRef<IndexType> arrRequiredIndexes( requiredHaloIndices );
 
-    return haloExchangePlan( input.getRowDistribution(), arrRequiredIndexes );
+    plan = haloExchangePlan( input.getRowDistribution(), arrRequiredIndexes );
+
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        cache.entries.remove_if( matches );
+        cache.entries.push_front( HaloCacheEntry{ inputDist, columnIndices, numValues, localStructureHash, plan } );
+        if (cache.entries.size() > maxHaloCacheEntries) {
+            cache.entries.pop_back();
+        }
+    }
+
+    return plan;
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void GraphUtils<IndexType,ValueType>::clearHaloCache() {
+    clearHaloCacheEntries();
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+IndexType GraphUtils<IndexType,ValueType>::haloCacheHits() {
+    HaloCache& cache = haloCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.hits;
 }
 //---------------------------------------------------------------------------------------
 
@@ -45,6 +45,96 @@ public:
     //TODO: deprecated version, fix and use or remove
     static scai::dmemo::DistributionPtr reindex(scai::lama::CSRSparseMatrix<ValueType> &graph);
 
+    /**
+     * @brief Permute the local rows, coordinates and node weights of every PE into a locality-improving order.
+     *
+     * The local part of a LAMA distribution is always sorted by global id, so the local order can only be
+     * changed by changing the global ids. The vertices of every PE get new, consecutive global ids in
+     * the order given by settings.localReordering: "sfc" sorts them by their index on the Hilbert curve
+     * and "rcm" uses the reverse Cuthill-McKee order of the local subgraph. No data is moved between PEs,
+     * afterwards the graph and all vectors have a general block distribution with the same local sizes as before.
+     *
+     * @param[in,out] graph The graph, its column distribution must be replicated.
+     * @param[in,out] coordinates The coordinates of the vertices, needed for "sfc".
+     * @param[in,out] nodeWeights The node weights.
+     * @param[in,out] indexVectors Additional integer vectors with the same distribution as the graph to be permuted along.
+     * @param[in] settings The ordering to use and the resolution of the space filling curve.
+     *
+     * @return A vector with the distribution of the reordered graph that stores for every vertex its old global id.
+     It can be given to undoLocalReordering to bring results back to the original numbering.
+     */
+    static scai::lama::DenseVector<IndexType> localReordering(
+        scai::lama::CSRSparseMatrix<ValueType> &graph,
+        std::vector<scai::lama::DenseVector<ValueType>> &coordinates,
+        std::vector<scai::lama::DenseVector<ValueType>> &nodeWeights,
+        std::vector<scai::lama::DenseVector<IndexType>*> indexVectors,
+        const Settings settings);
+
+    /**
+     * @brief Bring a vector computed for a reordered graph back to the original global ids.
+     *
+     * @param[in,out] vector A vector for the reordered graph, for example the partition. Can have any distribution.
+     * Afterwards, it is block distributed and entry i belongs to vertex i of the original numbering.
+     * @param[in] originalIds The vector returned by localReordering.
+     */
+    static void undoLocalReordering(scai::lama::DenseVector<IndexType> &vector, const scai::lama::DenseVector<IndexType> &originalIds);
+
+    /**
+     * @brief Give the graph and all vectors back the global ids they had before localReordering.
+     *
+     * Like localReordering, no data is moved between PEs: every PE keeps its vertices, only their local order
+     * and global ids change. The vectors can have been changed in between, for example a partition computed on the
+     * reordered graph keeps its values.
+     *
+     * @param[in,out] graph The reordered graph, its column distribution must be replicated.
+     * @param[in,out] coordinates The coordinates of the vertices.
+     * @param[in,out] nodeWeights The node weights.
+     * @param[in,out] indexVectors Additional integer vectors with the distribution of the graph.
+     * @param[in] originalIds The vector returned by localReordering, with the distribution of the graph.
+     */
+    static void undoLocalReordering(
+        scai::lama::CSRSparseMatrix<ValueType> &graph,
+        std::vector<scai::lama::DenseVector<ValueType>> &coordinates,
+        std::vector<scai::lama::DenseVector<ValueType>> &nodeWeights,
+        std::vector<scai::lama::DenseVector<IndexType>*> indexVectors,
+        const scai::lama::DenseVector<IndexType> &originalIds);
+
+    /**
+     * @brief A global numbering of the vertices that is contiguous for every block and local within the blocks.
+     *
+     * Block b gets the ids from the total size of the blocks before it on. Within a block, the vertices are numbered
+     * in the order given by ordering: "sfc" sorts them by their index on the Hilbert curve and "rcm" uses the reverse
+     * Cuthill-McKee order. For "sfc", the vertices are sorted by block and Hilbert index with a parallel sort,
+     * so a block can be larger than the memory of one PE. For "rcm", every block is moved to one PE, block b to
+     * PE b*p/k, and the result is moved back. The input is not changed.
+     *
+     * @param[in] graph The graph, its column distribution must be replicated.
+     * @param[in] coordinates The coordinates of the vertices, needed for "sfc".
+     * @param[in] partition The block of every vertex, can have a different distribution than the graph.
+     * @param[in] ordering The order within the blocks, sfc or rcm.
+     * @param[in] settings Uses numBlocks, dimensions and sfcResolution.
+     *
+     * @return The new id of every vertex, with the distribution of the graph.
+     */
+    static scai::lama::DenseVector<IndexType> blockRenumbering(
+        const scai::lama::CSRSparseMatrix<ValueType> &graph,
+        const std::vector<scai::lama::DenseVector<ValueType>> &coordinates,
+        const scai::lama::DenseVector<IndexType> &partition,
+        const std::string ordering,
+        const Settings settings);
+
+    /**
+     * @brief Reverse Cuthill-McKee order of the local subgraph.
+     *
+     * Every connected component of the local subgraph is traversed in BFS order starting from a vertex
+     * of minimum local degree, neighbors are visited in increasing degree; the whole order is then reversed.
+     * Edges to non-local vertices are ignored.
+     *
+     * @param[in] graph The graph, may be distributed.
+     * @return The local indices in RCM order, result[i] is the local index of the vertex at position i.
+     */
+    static std::vector<IndexType> localRCMOrder(const scai::lama::CSRSparseMatrix<ValueType> &graph);
+
     /**
      * @brief Perform a BFS on the local subgraph.
      *
@@ -124,12 +214,28 @@ public:
     /**
      * @brief Builds a halo containing all non-local neighbors.
      *
+     * Plans are cached, keyed by the row distribution, the address of the local column indices and a hash
+     * of the local row offsets and column indices, so metrics and refinement functions called on the same graph
+     * share one plan. Hashing is linear in the local edges, much cheaper than building the plan.
+     * A redistribution creates a new distribution and thus invalidates the entry. The cache is thread-safe
+     * and cleared at exit, before LAMA and MPI are shut down.
+     *
      * @param[in] input Adjacency Matrix
      *
      * @return HaloExchangePlan
      */
     static scai::dmemo::HaloExchangePlan buildNeighborHalo(const scai::lama::CSRSparseMatrix<ValueType> &input);
 
+    /**
+     * @brief Removes all plans cached by buildNeighborHalo.
+     */
+    static void clearHaloCache();
+
+    /**
+     * @brief The number of plans buildNeighborHalo returned from the cache since it was last cleared.
+     */
+    static IndexType haloCacheHits();
+
     /**
      * Returns true if the node identified with globalID has a neighbor that is not local on this process.
      * Since this method acquires reading locks on the CSR structure, it might be expensive to call often
@@ -3,6 +3,8 @@
 #include "ParcoRepart.h"
 #include "FileIO.h"
 #include "GraphUtils.h"
+#include "CompactGraph.h"
+#include "HilbertCurve.h"
 #include "MeshGenerator.h"
 
 #include <scai/logging.hpp>
@@ -496,6 +498,267 @@ TYPED_TEST(GraphUtilsTest, testNonLocalNeighbors) {
 }
 //------------------------------------------------------------------------------------
 
+TYPED_TEST(GraphUtilsTest, testNeighborHaloCache) {
+    using ValueType = TypeParam;
+
+    std::string file = GraphUtilsTest<ValueType>::graphPath + "trace-00008.graph";
+
+    CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph( file );
+    const IndexType N = graph.getNumRows();
+    const scai::dmemo::CommunicatorPtr comm = graph.getRowDistributionPtr()->getCommunicatorPtr();
+
+    GraphUtils<IndexType, ValueType>::clearHaloCache();
+
+    scai::dmemo::HaloExchangePlan halo1 = GraphUtils<IndexType, ValueType>::buildNeighborHalo( graph );
+    EXPECT_EQ( 0, GraphUtils<IndexType, ValueType>::haloCacheHits() );
+    scai::dmemo::HaloExchangePlan halo2 = GraphUtils<IndexType, ValueType>::buildNeighborHalo( graph );
+    EXPECT_EQ( 1, GraphUtils<IndexType, ValueType>::haloCacheHits() );
+
+    //same plan from the cache
+    EXPECT_EQ( halo1.getHaloSize(), halo2.getHaloSize() );
+    {
+        scai::hmemo::ReadAccess<IndexType> rHalo1( halo1.getHalo2GlobalIndexes() );
+        scai::hmemo::ReadAccess<IndexType> rHalo2( halo2.getHalo2GlobalIndexes() );
+        for( IndexType i=0; i<rHalo1.size(); i++ ){
+            EXPECT_EQ( rHalo1[i], rHalo2[i] );
+        }
+    }
+
+    //after a redistribution the plan must fit the new distribution
+    scai::dmemo::DistributionPtr cyclicDist( new scai::dmemo::CyclicDistribution( N, 1, comm ) );
+    graph.redistribute( cyclicDist, graph.getColDistributionPtr() );
+
+    scai::dmemo::HaloExchangePlan halo3 = GraphUtils<IndexType, ValueType>::buildNeighborHalo( graph );
+    EXPECT_EQ( 1, GraphUtils<IndexType, ValueType>::haloCacheHits() );
+    std::vector<IndexType> nonLocalN = GraphUtils<IndexType, ValueType>::nonLocalNeighbors( graph );
+    scai::hmemo::ReadAccess<IndexType> rHalo3( halo3.getHalo2GlobalIndexes() );
+    for( IndexType ind : nonLocalN ) {
+        EXPECT_TRUE( not cyclicDist->isLocal(ind) );
+        EXPECT_NE( halo3.global2Halo(ind), scai::invalidIndex );
+    }
+    for( IndexType i=0; i<rHalo3.size(); i++ ){
+        EXPECT_TRUE( not cyclicDist->isLocal(rHalo3[i]) );
+    }
+}
+//------------------------------------------------------------------------------------
+
+TYPED_TEST(GraphUtilsTest, testCompactGraph) {
+    using ValueType = TypeParam;
+
+    std::string file = GraphUtilsTest<ValueType>::graphPath + "trace-00008.graph";
+
+    CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph( file );
+    const scai::dmemo::DistributionPtr dist = graph.getRowDistributionPtr();
+    const IndexType localN = dist->getLocalSize();
+
+    scai::dmemo::HaloExchangePlan halo = GraphUtils<IndexType, ValueType>::buildNeighborHalo( graph );
+    CompactGraph<IndexType, ValueType> compactGraph( graph, halo );
+
+    EXPECT_EQ( compactGraph.numLocal(), localN );
+    EXPECT_EQ( compactGraph.numGhosts(), halo.getHaloSize() );
+    EXPECT_EQ( compactGraph.numEdges(), graph.getLocalStorage().getJA().size() );
+    //the graph has no edge weights
+    EXPECT_TRUE( compactGraph.hasUnitWeights() );
+    EXPECT_LT( compactGraph.edgeBytes(), graph.getLocalStorage().getJA().size()*(sizeof(IndexType)+sizeof(ValueType)) );
+
+    {
+        const CSRStorage<ValueType>& localStorage = graph.getLocalStorage();
+        scai::hmemo::ReadAccess<IndexType> ia( localStorage.getIA() );
+        scai::hmemo::ReadAccess<IndexType> ja( localStorage.getJA() );
+        scai::hmemo::ReadAccess<ValueType> values( localStorage.getValues() );
+
+        for (IndexType i = 0; i < localN; i++) {
+            ASSERT_EQ( compactGraph.beginEdges(i), ia[i] );
+            ASSERT_EQ( compactGraph.endEdges(i), ia[i+1] );
+            for (IndexType j = ia[i]; j < ia[i+1]; j++) {
+                const IndexType target = compactGraph.target(j);
+                EXPECT_EQ( compactGraph.toGlobal(target), ja[j] );
+                EXPECT_EQ( compactGraph.isLocal(target), dist->isLocal(ja[j]) );
+                if (!compactGraph.isLocal(target)) {
+                    EXPECT_EQ( compactGraph.ghostIndex(target), halo.global2Halo(ja[j]) );
+                }
+                EXPECT_EQ( compactGraph.weight(j), values[j] );
+            }
+        }
+    }
+}
+//------------------------------------------------------------------------------------
+
+TYPED_TEST(GraphUtilsTest, testLocalReordering) {
+    using ValueType = TypeParam;
+
+    std::string file = GraphUtilsTest<ValueType>::graphPath + "Grid16x16";
+    std::string coordsFile = file + ".xyz";
+    const IndexType dimensions = 2;
+
+    CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph( file );
+    const IndexType n = graph.getNumRows();
+    scai::dmemo::DistributionPtr dist = graph.getRowDistributionPtr();
+    const scai::dmemo::CommunicatorPtr comm = dist->getCommunicatorPtr();
+    const IndexType k = comm->getSize();
+
+    std::vector<DenseVector<ValueType>> coords = FileIO<IndexType, ValueType>::readCoords( coordsFile, n, dimensions );
+    std::vector<DenseVector<ValueType>> nodeWeights(1, DenseVector<ValueType>(dist, 1));
+
+    Settings settings;
+    settings.numBlocks = k;
+    settings.dimensions = dimensions;
+
+    //random partition and redistribution to get an arbitrary local order
+    srand(0);
+    DenseVector<IndexType> partition( dist, 0 );
+    for (IndexType i = 0; i < dist->getLocalSize(); i++) {
+        partition.getLocalValues()[i] = rand() % k;
+    }
+    aux<IndexType, ValueType>::redistributeFromPartition( partition, graph, coords, nodeWeights, settings );
+
+    const ValueType cut = GraphUtils<IndexType, ValueType>::computeCut( graph, partition, true );
+    const IndexType localN = graph.getRowDistributionPtr()->getLocalSize();
+
+    //replicated copies of the input to compare with
+    const scai::dmemo::DistributionPtr noDist( new scai::dmemo::NoDistribution(n) );
+    DenseVector<IndexType> replPartition( partition );
+    replPartition.redistribute( noDist );
+    std::vector<DenseVector<ValueType>> replCoords( coords );
+    for (IndexType d = 0; d < dimensions; d++) {
+        replCoords[d].redistribute( noDist );
+    }
+
+    for (std::string ordering : {"sfc", "rcm"}) {
+        settings.localReordering = ordering;
+
+        CSRSparseMatrix<ValueType> reorderedGraph( graph );
+        std::vector<DenseVector<ValueType>> reorderedCoords( coords );
+        std::vector<DenseVector<ValueType>> reorderedWeights( nodeWeights );
+        DenseVector<IndexType> reorderedPart( partition );
+
+        DenseVector<IndexType> originalIds = GraphUtils<IndexType, ValueType>::localReordering( reorderedGraph, reorderedCoords, reorderedWeights, {&reorderedPart}, settings );
+
+        //no vertex changed its PE
+        const scai::dmemo::DistributionPtr newDist = reorderedGraph.getRowDistributionPtr();
+        EXPECT_EQ( newDist->getLocalSize(), localN );
+        EXPECT_TRUE( originalIds.getDistributionPtr()->isEqual(*newDist) );
+        EXPECT_TRUE( reorderedCoords[0].getDistributionPtr()->isEqual(*newDist) );
+        EXPECT_TRUE( reorderedPart.getDistributionPtr()->isEqual(*newDist) );
+
+        EXPECT_TRUE( reorderedGraph.isConsistent() );
+        EXPECT_TRUE( reorderedGraph.checkSymmetry() );
+        EXPECT_EQ( reorderedGraph.getNumValues(), graph.getNumValues() );
+        EXPECT_NEAR( cut, GraphUtils<IndexType, ValueType>::computeCut( reorderedGraph, reorderedPart, true ), 1e-5 );
+
+        //every vertex kept its data
+        {
+            scai::hmemo::ReadAccess<IndexType> rIds( originalIds.getLocalValues() );
+            scai::hmemo::ReadAccess<IndexType> rPart( reorderedPart.getLocalValues() );
+            scai::hmemo::ReadAccess<IndexType> rReplPart( replPartition.getLocalValues() );
+            for (IndexType i = 0; i < localN; i++) {
+                EXPECT_EQ( rPart[i], rReplPart[rIds[i]] );
+                for (IndexType d = 0; d < dimensions; d++) {
+                    EXPECT_EQ( reorderedCoords[d].getLocalValues()[i], replCoords[d].getLocalValues()[rIds[i]] );
+                }
+            }
+        }
+
+        //undo of the whole graph restores the global ids and the local order, no vertex changes its PE
+        {
+            CSRSparseMatrix<ValueType> restoredGraph( reorderedGraph );
+            std::vector<DenseVector<ValueType>> restoredCoords( reorderedCoords );
+            std::vector<DenseVector<ValueType>> restoredWeights( reorderedWeights );
+            DenseVector<IndexType> restoredPart( reorderedPart );
+            GraphUtils<IndexType, ValueType>::undoLocalReordering( restoredGraph, restoredCoords, restoredWeights, {&restoredPart}, originalIds );
+
+            const scai::dmemo::DistributionPtr restoredDist = restoredGraph.getRowDistributionPtr();
+            ASSERT_EQ( restoredDist->getLocalSize(), localN );
+            EXPECT_TRUE( restoredPart.getDistributionPtr()->isEqual(*restoredDist) );
+            for (IndexType i = 0; i < localN; i++) {
+                EXPECT_EQ( restoredDist->local2Global(i), graph.getRowDistributionPtr()->local2Global(i) );
+                EXPECT_EQ( restoredPart.getLocalValues()[i], partition.getLocalValues()[i] );
+                for (IndexType d = 0; d < dimensions; d++) {
+                    EXPECT_EQ( restoredCoords[d].getLocalValues()[i], coords[d].getLocalValues()[i] );
+                }
+            }
+            scai::hmemo::ReadAccess<IndexType> rJA( graph.getLocalStorage().getJA() );
+            scai::hmemo::ReadAccess<IndexType> rRestoredJA( restoredGraph.getLocalStorage().getJA() );
+            ASSERT_EQ( rJA.size(), rRestoredJA.size() );
+            for (IndexType j = 0; j < rJA.size(); j++) {
+                EXPECT_EQ( rJA[j], rRestoredJA[j] );
+            }
+        }
+
+        //undo brings the partition back to the original ids
+        GraphUtils<IndexType, ValueType>::undoLocalReordering( reorderedPart, originalIds );
+        EXPECT_TRUE( reorderedPart.getDistributionPtr()->isBlockDistributed(comm) );
+        reorderedPart.redistribute( noDist );
+        {
+            scai::hmemo::ReadAccess<IndexType> rPart( reorderedPart.getLocalValues() );
+            scai::hmemo::ReadAccess<IndexType> rReplPart( replPartition.getLocalValues() );
+            for (IndexType i = 0; i < n; i++) {
+                EXPECT_EQ( rPart[i], rReplPart[i] );
+            }
+        }
+    }
+}
+//------------------------------------------------------------------------------------
+
+TYPED_TEST(GraphUtilsTest, testBlockRenumbering) {
+    using ValueType = TypeParam;
+
+    std::string file = GraphUtilsTest<ValueType>::graphPath + "Grid16x16";
+    const IndexType dimensions = 2;
+
+    CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph( file );
+    const IndexType n = graph.getNumRows();
+    scai::dmemo::DistributionPtr dist = graph.getRowDistributionPtr();
+    const scai::dmemo::CommunicatorPtr comm = dist->getCommunicatorPtr();
+    std::vector<DenseVector<ValueType>> coords = FileIO<IndexType, ValueType>::readCoords( file + ".xyz", n, dimensions );
+
+    Settings settings;
+    settings.numBlocks = 4;
+    settings.dimensions = dimensions;
+    const IndexType k = settings.numBlocks;
+
+    //the blocks are spread over all PEs and interleaved in the input numbering
+    DenseVector<IndexType> partition( dist, 0 );
+    for (IndexType i = 0; i < dist->getLocalSize(); i++) {
+        partition.getLocalValues()[i] = dist->local2Global(i) % k;
+    }
+
+    const scai::dmemo::DistributionPtr noDist( new scai::dmemo::NoDistribution(n) );
+    std::vector<DenseVector<ValueType>> replCoords( coords );
+    for (IndexType d = 0; d < dimensions; d++) {
+        replCoords[d].redistribute( noDist );
+    }
+    const std::vector<double> hilbertIndices = HilbertCurve<IndexType, ValueType>::getHilbertIndexVector( replCoords, settings.sfcResolution, dimensions );
+
+    for (std::string ordering : {"sfc", "rcm"}) {
+        DenseVector<IndexType> newIds = GraphUtils<IndexType, ValueType>::blockRenumbering( graph, coords, partition, ordering, settings );
+        EXPECT_TRUE( newIds.getDistributionPtr()->isEqual(*dist) );
+        newIds.redistribute( noDist );
+
+        //a permutation with the n/k vertices of every block in one range
+        std::vector<IndexType> vertexOfId(n, -1);
+        {
+            scai::hmemo::ReadAccess<IndexType> rNewIds( newIds.getLocalValues() );
+            for (IndexType i = 0; i < n; i++) {
+                ASSERT_LT( rNewIds[i], n );
+                EXPECT_EQ( -1, vertexOfId[rNewIds[i]] );
+                vertexOfId[rNewIds[i]] = i;
+                EXPECT_EQ( i % k, rNewIds[i] / (n/k) );
+            }
+        }
+
+        //within the blocks, the vertices follow the curve
+        if (ordering == "sfc") {
+            for (IndexType id = 1; id < n; id++) {
+                if (id % (n/k) != 0) {
+                    EXPECT_LE( hilbertIndices[vertexOfId[id-1]], hilbertIndices[vertexOfId[id]] );
+                }
+            }
+        }
+    }
+}
+//------------------------------------------------------------------------------------
+
 TYPED_TEST(GraphUtilsTest, testMEColoring_local) {
     using ValueType = TypeParam;
 
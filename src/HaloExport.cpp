@@ -0,0 +1,223 @@
+#include <scai/dmemo/CommunicationPlan.hpp>
+#include <scai/dmemo/HaloExchangePlan.hpp>
+#include <scai/tracing.hpp>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+
+#include "GraphUtils.h"
+#include "HaloExport.h"
+
+namespace ITI {
+
+template<typename IndexType, typename ValueType>
+IndexType HaloExport<IndexType, ValueType>::blockOwner(const IndexType block, const IndexType k, const IndexType numPEs) {
+    return IndexType((long long)(block)*numPEs / k);
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+std::vector<typename HaloExport<IndexType, ValueType>::BlockPlan> HaloExport<IndexType, ValueType>::computeBlockPlans(
+    const CSRSparseMatrix<ValueType>& graph,
+    const DenseVector<IndexType>& partition,
+    const IndexType k,
+    const DenseVector<IndexType>& vertexIds) {
+
+    SCAI_REGION("HaloExport.computeBlockPlans")
+
+    const scai::dmemo::DistributionPtr dist = graph.getRowDistributionPtr();
+    const scai::dmemo::CommunicatorPtr comm = dist->getCommunicatorPtr();
+    const IndexType numPEs = comm->getSize();
+    const IndexType localN = dist->getLocalSize();
+
+    DenseVector<IndexType> localPartition(partition);
+    if (not localPartition.getDistribution().isEqual(*dist)) {
+        localPartition.redistribute(dist);
+    }
+    const bool hasIds = vertexIds.size() > 0;
+    if (hasIds) {
+        SCAI_ASSERT_ERROR(vertexIds.getDistribution().isEqual(*dist), "The vertex ids must have the distribution of the graph");
+    }
+
+    //the blocks of the non-local neighbors
+    const scai::dmemo::HaloExchangePlan halo = GraphUtils<IndexType, ValueType>::buildNeighborHalo(graph);
+    auto haloData = halo.updateHaloF(localPartition.getLocalValues(), *comm);
+    auto rHaloData = scai::hmemo::hostReadAccess(haloData);
+
+    //every entry has four values: the block, the neighbor block, 0 for send or 1 for recv, and the vertex
+    std::vector<std::vector<IndexType>> sendData(numPEs);
+    {
+        const scai::lama::CSRStorage<ValueType>& localStorage = graph.getLocalStorage();
+        scai::hmemo::ReadAccess<IndexType> ia(localStorage.getIA());
+        scai::hmemo::ReadAccess<IndexType> ja(localStorage.getJA());
+        scai::hmemo::ReadAccess<IndexType> rPart(localPartition.getLocalValues());
+        scai::hmemo::ReadAccess<IndexType> rIds(vertexIds.getLocalValues());
+
+        std::vector<IndexType> neighborBlocks;
+        for (IndexType i = 0; i < localN; i++) {
+            const IndexType thisBlock = rPart[i];
+            SCAI_ASSERT_VALID_INDEX_DEBUG(thisBlock, k, "Wrong block id.");
+
+            neighborBlocks.clear();
+            for (IndexType j = ia[i]; j < ia[i+1]; j++) {
+                const IndexType neighbor = ja[j];
+                const IndexType localNeighbor = dist->global2Local(neighbor);
+                const IndexType neighborBlock = localNeighbor != scai::invalidIndex ? rPart[localNeighbor] : rHaloData[halo.global2Halo(neighbor)];
+                if (neighborBlock != thisBlock) {
+                    neighborBlocks.push_back(neighborBlock);
+                }
+            }
+            std::sort(neighborBlocks.begin(), neighborBlocks.end());
+            neighborBlocks.erase(std::unique(neighborBlocks.begin(), neighborBlocks.end()), neighborBlocks.end());
+
+            const IndexType id = hasIds ? rIds[i] : dist->local2Global(i);
+            for (const IndexType neighborBlock : neighborBlocks) {
+                std::vector<IndexType>& toOwner = sendData[blockOwner(thisBlock, k, numPEs)];
+                toOwner.insert(toOwner.end(), {thisBlock, neighborBlock, 0, id});
+                std::vector<IndexType>& toNeighborOwner = sendData[blockOwner(neighborBlock, k, numPEs)];
+                toNeighborOwner.insert(toNeighborOwner.end(), {neighborBlock, thisBlock, 1, id});
+            }
+        }
+    }
+
+    //bring the entries to the PEs of their blocks
+    std::vector<IndexType> quantities(numPEs);
+    std::vector<IndexType> sendValues;
+    for (IndexType p = 0; p < numPEs; p++) {
+        quantities[p] = sendData[p].size();
+        sendValues.insert(sendValues.end(), sendData[p].begin(), sendData[p].end());
+        std::vector<IndexType>().swap(sendData[p]);
+    }
+    const scai::dmemo::CommunicationPlan sendPlan(quantities.data(), numPEs);
+    const scai::dmemo::CommunicationPlan recvPlan = comm->transpose(sendPlan);
+    std::vector<IndexType> recvValues(recvPlan.totalQuantity());
+    comm->exchangeByPlan(recvValues.data(), recvPlan, sendValues.data(), sendPlan);
+
+    std::vector<std::array<IndexType, 4>> entries(recvValues.size() / 4);
+    for (IndexType e = 0; e < IndexType(entries.size()); e++) {
+        std::copy(recvValues.begin() + 4*e, recvValues.begin() + 4*e + 4, entries[e].begin());
+    }
+    std::sort(entries.begin(), entries.end());
+
+    //one plan for every block of this PE, also for blocks without neighbors
+    std::vector<BlockPlan> plans;
+    for (IndexType b = 0; b < k; b++) {
+        if (blockOwner(b, k, numPEs) == comm->getRank()) {
+            BlockPlan plan;
+            plan.block = b;
+            plan.sendOffsets.push_back(0);
+            plan.recvOffsets.push_back(0);
+            plans.push_back(plan);
+        }
+    }
+
+    auto e = entries.begin();
+    for (BlockPlan& plan : plans) {
+        while (e != entries.end() and (*e)[0] == plan.block) {
+            const IndexType neighborBlock = (*e)[1];
+            plan.neighbors.push_back(neighborBlock);
+            for (; e != entries.end() and (*e)[0] == plan.block and (*e)[1] == neighborBlock; e++) {
+                ((*e)[2] == 0 ? plan.send : plan.recv).push_back((*e)[3]);
+            }
+            plan.sendOffsets.push_back(plan.send.size());
+            plan.recvOffsets.push_back(plan.recv.size());
+        }
+    }
+    SCAI_ASSERT_ERROR(e == entries.end(), "Received the entries of a block of another PE");
+
+    return plans;
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void HaloExport<IndexType, ValueType>::write(const std::vector<BlockPlan>& plans, const IndexType k, const std::string& filename, const scai::dmemo::CommunicatorPtr comm) {
+    SCAI_REGION("HaloExport.write")
+
+    bool written = true;
+    for (IndexType p = 0; p < comm->getSize(); p++) { // in each round only one PE writes its blocks
+        if (comm->getRank() == p) {
+            std::ofstream out(filename, p == 0 ? std::ios::binary | std::ios::out : std::ios::binary | std::ios::app);
+            auto writeArray = [&out](const IndexType* data, const size_t n) {
+                out.write(reinterpret_cast<const char*>(data), sizeof(IndexType)*n);
+            };
+
+            if (p == 0) {
+                const IndexType header[2] = {IndexType(sizeof(IndexType)), k};
+                writeArray(header, 2);
+            }
+            for (const BlockPlan& plan : plans) {
+                const IndexType m = plan.neighbors.size();
+                std::vector<IndexType> counts(2*m);
+                for (IndexType i = 0; i < m; i++) {
+                    counts[i] = plan.sendOffsets[i+1] - plan.sendOffsets[i];
+                    counts[m + i] = plan.recvOffsets[i+1] - plan.recvOffsets[i];
+                }
+                const IndexType blockHeader[2] = {plan.block, m};
+                writeArray(blockHeader, 2);
+                writeArray(plan.neighbors.data(), m);
+                writeArray(counts.data(), 2*m);
+                writeArray(plan.send.data(), plan.send.size());
+                writeArray(plan.recv.data(), plan.recv.size());
+            }
+            written = out.good();
+        }
+        comm->synchronize();
+    }
+
+    if (comm->any(not written)) {
+        throw std::runtime_error("Could not write the halo plan to file " + filename);
+    }
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+std::vector<typename HaloExport<IndexType, ValueType>::BlockPlan> HaloExport<IndexType, ValueType>::read(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    if (not in.is_open()) {
+        throw std::runtime_error("Could not open file " + filename);
+    }
+    auto readArray = [&in](IndexType* data, const size_t n) {
+        in.read(reinterpret_cast<char*>(data), sizeof(IndexType)*n);
+    };
+
+    IndexType header[2] = {0, 0};
+    readArray(header, 2);
+    if (not in.good() or header[0] != sizeof(IndexType)) {
+        throw std::runtime_error("File " + filename + " is not a halo plan of this IndexType");
+    }
+
+    std::vector<BlockPlan> plans(header[1]);
+    for (BlockPlan& plan : plans) {
+        IndexType blockHeader[2];
+        readArray(blockHeader, 2);
+        plan.block = blockHeader[0];
+        const IndexType m = blockHeader[1];
+
+        plan.neighbors.resize(m);
+        std::vector<IndexType> counts(2*m);
+        readArray(plan.neighbors.data(), m);
+        readArray(counts.data(), 2*m);
+        plan.sendOffsets.assign(1, 0);
+        plan.recvOffsets.assign(1, 0);
+        for (IndexType i = 0; i < m; i++) {
+            plan.sendOffsets.push_back(plan.sendOffsets.back() + counts[i]);
+            plan.recvOffsets.push_back(plan.recvOffsets.back() + counts[m + i]);
+        }
+        plan.send.resize(plan.sendOffsets.back());
+        plan.recv.resize(plan.recvOffsets.back());
+        readArray(plan.send.data(), plan.send.size());
+        readArray(plan.recv.data(), plan.recv.size());
+    }
+
+    if (not in.good()) {
+        throw std::runtime_error("Halo plan in file " + filename + " is truncated");
+    }
+    return plans;
+}
+//---------------------------------------------------------------------------------------
+
+template class HaloExport<IndexType, double>;
+template class HaloExport<IndexType, float>;
+
+} // namespace ITI
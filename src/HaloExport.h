@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <scai/lama/DenseVector.hpp>
+#include <scai/lama/matrix/CSRSparseMatrix.hpp>
+
+#include "Settings.h"
+
+namespace ITI {
+
+using scai::lama::CSRSparseMatrix;
+using scai::lama::DenseVector;
+
+/** @brief The ghost exchange of the blocks of a partition, as an application needs it after partitioning.
+
+For every block b, the plan lists the neighbor blocks and, per neighbor c,
+ - send: the vertices of b with a neighbor in c, the values c needs from b,
+ - recv: the vertices of c with a neighbor in b, the ghost vertices of b owned by c.
+
+The recv list of b from c is the send list of c to b, the number of sent vertices of a block is its communication
+volume as in GraphUtils::computeCommVolume. The plan of block b is computed on PE b*p/k, so with k=p every PE gets
+the plan of its own block.
+
+The binary file written by write stores IndexType values: the size of IndexType in bytes and k, then for every block
+in ascending order the block id, the number of neighbors m, the m neighbor blocks, the m send counts, the m recv counts,
+the send lists and the recv lists, both in the order of the neighbors.
+*/
+
+template <typename IndexType, typename ValueType>
+class HaloExport {
+public:
+
+    /** The plan of one block. */
+    struct BlockPlan {
+        IndexType block = 0;
+        std::vector<IndexType> neighbors;   ///< the neighbor blocks, ascending
+        std::vector<IndexType> sendOffsets; ///< the vertices sent to neighbors[i] are send[sendOffsets[i]] to send[sendOffsets[i+1]-1]
+        std::vector<IndexType> send;        ///< the global ids of the sent vertices, ascending per neighbor
+        std::vector<IndexType> recvOffsets; ///< the same as sendOffsets for recv
+        std::vector<IndexType> recv;        ///< the global ids of the ghost vertices, ascending per neighbor
+
+        bool operator==(const BlockPlan& other) const {
+            return block == other.block and neighbors == other.neighbors and sendOffsets == other.sendOffsets
+                and send == other.send and recvOffsets == other.recvOffsets and recv == other.recv;
+        }
+    };
+
+    /** Compute the plans of the blocks of this PE. Collective operation.
+    @param[in] graph The graph, its columns must be replicated.
+    @param[in] partition The block of every vertex, can have a different distribution than the graph.
+    @param[in] k The number of blocks.
+    @param[in] vertexIds Optional, the id of every vertex in the plan, with the distribution of the graph. For example
+    the ids returned by GraphUtils::localReordering to refer to the input numbering. If empty, the global ids are used.
+    @return The plans of the blocks owned by this PE, \sa blockOwner, ordered by block.
+    */
+    static std::vector<BlockPlan> computeBlockPlans(
+        const CSRSparseMatrix<ValueType>& graph,
+        const DenseVector<IndexType>& partition,
+        const IndexType k,
+        const DenseVector<IndexType>& vertexIds = DenseVector<IndexType>());
+
+    /** The PE that computes the plan of a block.
+    */
+    static IndexType blockOwner(const IndexType block, const IndexType k, const IndexType numPEs);
+
+    /** Write the plans of all blocks into one binary file, the PEs write their blocks in turn. Collective operation.
+    @param[in] plans The plans of the blocks of this PE as returned by computeBlockPlans.
+    */
+    static void write(const std::vector<BlockPlan>& plans, const IndexType k, const std::string& filename, const scai::dmemo::CommunicatorPtr comm);
+
+    /** Read the plans of all blocks from a file written by write. Not collective, every caller reads the whole file.
+    */
+    static std::vector<BlockPlan> read(const std::string& filename);
+};
+
+} // namespace ITI
@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <cstdio>
+
+#include "gtest/gtest.h"
+
+#include "FileIO.h"
+#include "GraphUtils.h"
+#include "HaloExport.h"
+
+namespace ITI {
+
+template<typename T>
+class HaloExportTest : public ::testing::Test {
+protected:
+    // the directory of all the meshes used
+    // projectRoot is defined in config.h.in
+    const std::string graphPath = projectRoot+"/meshes/";
+};
+
+using testTypes = ::testing::Types<double,float>;
+TYPED_TEST_SUITE(HaloExportTest, testTypes);
+
+//-----------------------------------------------
+
+TYPED_TEST(HaloExportTest, testPlansMatchCommVolume) {
+    using ValueType = TypeParam;
+    using BlockPlan = typename HaloExport<IndexType, ValueType>::BlockPlan;
+
+    const std::string file = HaloExportTest<ValueType>::graphPath + "Grid16x16";
+    const scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+
+    CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph(file, comm);
+    const scai::dmemo::DistributionPtr dist = graph.getRowDistributionPtr();
+    const IndexType n = graph.getNumRows();
+    const IndexType k = 4;
+
+    //stripes of the grid, independent of the number of PEs
+    DenseVector<IndexType> partition(dist, 0);
+    {
+        scai::hmemo::WriteAccess<IndexType> wPart(partition.getLocalValues());
+        for (IndexType i = 0; i < dist->getLocalSize(); i++) {
+            wPart[i] = dist->local2Global(i)*k / n;
+        }
+    }
+
+    const std::vector<BlockPlan> plans = HaloExport<IndexType, ValueType>::computeBlockPlans(graph, partition, k);
+
+    Settings settings;
+    settings.numBlocks = k;
+    const std::vector<IndexType> commVolume = GraphUtils<IndexType, ValueType>::computeCommVolume(graph, partition, settings);
+    for (const BlockPlan& plan : plans) {
+        EXPECT_EQ(comm->getRank(), HaloExport<IndexType, ValueType>::blockOwner(plan.block, k, comm->getSize()));
+        EXPECT_EQ(commVolume[plan.block], plan.send.size());
+        //the outer stripes have one neighbor, the inner ones two
+        EXPECT_EQ((plan.block == 0 or plan.block == k-1) ? 1 : 2, plan.neighbors.size());
+    }
+    EXPECT_EQ(k, comm->sum(plans.size()));
+
+    const std::string filename = "haloExportTest" + std::to_string(sizeof(ValueType)) + ".halo";
+    HaloExport<IndexType, ValueType>::write(plans, k, filename, comm);
+    const std::vector<BlockPlan> allPlans = HaloExport<IndexType, ValueType>::read(filename);
+    ASSERT_EQ(k, allPlans.size());
+    for (const BlockPlan& plan : plans) {
+        EXPECT_TRUE(plan == allPlans[plan.block]);
+    }
+
+    //the ghosts of a block from a neighbor are the vertices the neighbor sends to it
+    for (const BlockPlan& plan : allPlans) {
+        for (IndexType i = 0; i < IndexType(plan.neighbors.size()); i++) {
+            const BlockPlan& other = allPlans[plan.neighbors[i]];
+            const auto it = std::find(other.neighbors.begin(), other.neighbors.end(), plan.block);
+            ASSERT_TRUE(it != other.neighbors.end());
+            const IndexType j = it - other.neighbors.begin();
+            const std::vector<IndexType> ghosts(plan.recv.begin() + plan.recvOffsets[i], plan.recv.begin() + plan.recvOffsets[i+1]);
+            const std::vector<IndexType> sent(other.send.begin() + other.sendOffsets[j], other.send.begin() + other.sendOffsets[j+1]);
+            EXPECT_EQ(sent, ghosts);
+            for (const IndexType ghost : ghosts) {
+                EXPECT_EQ(plan.neighbors[i], ghost*k / n);
+            }
+        }
+    }
+
+    comm->synchronize();
+    if (comm->getRank() == 0) {
+        std::remove(filename.c_str());
+    }
+}
+
+} // namespace ITI
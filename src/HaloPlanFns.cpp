@@ -137,4 +137,55 @@ HaloExchangePlan buildWithPartner(
 
 /* ---------------------------------------------------------------------- */
 
+template<typename ValueType>
+void updateHaloBlocks(
+    const HaloExchangePlan& halo,
+    const ValueType* localValues,
+    ValueType* haloValues,
+    const IndexType blockSize,
+    const Communicator& comm )
+{
+    SCAI_REGION( "HaloExchangePlan.updateHaloBlocks" )
+
+    const PartitionId numPEs = comm.getSize();
+    const CommunicationPlan& sendPlan = halo.getLocalCommunicationPlan();
+    const CommunicationPlan& recvPlan = halo.getHaloCommunicationPlan();
+
+    // same entries in the same order, every quantity multiplied by the block size
+    std::vector<IndexType> sendQuantities( numPEs, 0 );
+    std::vector<IndexType> recvQuantities( numPEs, 0 );
+
+    for ( PartitionId k = 0; k < sendPlan.size(); k++ )
+    {
+        sendQuantities[sendPlan[k].partitionId] = sendPlan[k].quantity * blockSize;
+    }
+
+    for ( PartitionId k = 0; k < recvPlan.size(); k++ )
+    {
+        recvQuantities[recvPlan[k].partitionId] = recvPlan[k].quantity * blockSize;
+    }
+
+    const CommunicationPlan blockSendPlan( sendQuantities.data(), numPEs );
+    const CommunicationPlan blockRecvPlan( recvQuantities.data(), numPEs );
+
+    ReadAccess<IndexType> sendIndexes( halo.getLocalIndexes() );
+    const IndexType numSend = sendIndexes.size();
+    SCAI_ASSERT_EQ_ERROR( numSend * blockSize, blockSendPlan.totalQuantity(), "Communication plan does not fit provided indices." );
+
+    std::vector<ValueType> sendValues( numSend * blockSize );
+
+    for ( IndexType k = 0; k < numSend; k++ )
+    {
+        const ValueType* block = localValues + sendIndexes[k] * blockSize;
+        std::copy( block, block + blockSize, sendValues.data() + k * blockSize );
+    }
+
+    comm.exchangeByPlan( haloValues, blockRecvPlan, sendValues.data(), blockSendPlan );
+}
+
+template void updateHaloBlocks<double>( const HaloExchangePlan&, const double*, double*, const IndexType, const Communicator& );
+template void updateHaloBlocks<float>( const HaloExchangePlan&, const float*, float*, const IndexType, const Communicator& );
+
+/* ---------------------------------------------------------------------- */
+
 }
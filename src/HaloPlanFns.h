@@ -16,5 +16,19 @@ scai::dmemo::HaloExchangePlan buildWithPartner(
     const scai::hmemo::HArray<scai::IndexType>& providedIndexes,
     const scai::PartitionId partner );
 
+/** Exchange the halo for several values per vertex at once. The values of local vertex i are
+localValues[i*blockSize],...,localValues[i*blockSize+blockSize-1], the values of the vertex with
+halo index h are written in the same way to haloValues, which must have space for
+halo.getHaloSize()*blockSize values. Like HaloExchangePlan::updateHalo, one message is sent to
+every neighbor PE.
+*/
+template<typename ValueType>
+void updateHaloBlocks(
+    const scai::dmemo::HaloExchangePlan& halo,
+    const ValueType* localValues,
+    ValueType* haloValues,
+    const scai::IndexType blockSize,
+    const scai::dmemo::Communicator& comm );
+
 }
 
@@ -6,6 +6,7 @@
  */
 
 #include "HilbertCurve.h"
+#include "NumaUtils.h"
 
 #include <scai/dmemo/Distribution.hpp>
 #include <scai/dmemo/HaloExchangePlan.hpp>
@@ -15,6 +16,15 @@
 #include <scai/dmemo/GeneralDistribution.hpp>
 #include <scai/dmemo/mpi/MPICommunicator.hpp>
 
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <random>
+
 
 namespace ITI {
 
@@ -375,9 +385,9 @@ std::vector<double> HilbertCurve<IndexType, ValueType>::getHilbertIndex2DVector
     ValueType dim0Extent = maxCoords[0] - minCoords[0];
     ValueType dim1Extent = maxCoords[1] - minCoords[1];
 
-    ValueType scaledPoint[2];
-    unsigned long integerIndex = 0;//TODO: also check whether this data type is long enough
     const IndexType localN = coordinates[0].getLocalValues().size();
+    //with a single process all cores of the node compute the indices
+    const bool useThreads = isSingleProcessRun();
 
     // the vector to be returned
     std::vector<double> hilbertIndices(localN,-1);
@@ -391,11 +401,13 @@ std::vector<double> HilbertCurve<IndexType, ValueType>::getHilbertIndex2DVector
         const unsigned long divisor = size_t(1) << size_t(2*int(recursionDepth));
         const double dDivisor = double(divisor);
 
+        #pragma omp parallel for schedule(static) if(useThreads)
         for (IndexType i = 0; i < localN; i++) {
+            ValueType scaledPoint[2];
             scaledPoint[0] = (coordAccess0[i]-minCoords[0])/dim0Extent;
             scaledPoint[1] = (coordAccess1[i]-minCoords[1])/dim1Extent;
 
-            integerIndex = 0;
+            unsigned long integerIndex = 0;//TODO: also check whether this data type is long enough
             for (IndexType j = 0; j < recursionDepth; j++) {
                 int subSquare;
                 if (scaledPoint[0] < 0.5) {
@@ -470,9 +482,9 @@ std::vector<double> HilbertCurve<IndexType, ValueType>::getHilbertIndex3DVector
     ValueType dim1Extent = maxCoords[1] - minCoords[1];
     ValueType dim2Extent = maxCoords[2] - minCoords[2];
 
-    ValueType x,y,z;
-    unsigned long integerIndex = 0;	//TODO: also check whether this data type is long enough
     const IndexType localN = coordinates[0].getLocalValues().size();
+    //with a single process all cores of the node compute the indices
+    const bool useThreads = isSingleProcessRun();
 
     // the DV to be returned
     std::vector<double> hilbertIndices(localN,-1);
@@ -486,12 +498,13 @@ std::vector<double> HilbertCurve<IndexType, ValueType>::getHilbertIndex3DVector
         
         const unsigned long long divisor = size_t(1) << size_t(3*int(recursionDepth));
 
+        #pragma omp parallel for schedule(static) if(useThreads)
         for (IndexType i = 0; i < localN; i++) {
-            x = (coordAccess0[i]-minCoords[0])/dim0Extent;
-            y = (coordAccess1[i]-minCoords[1])/dim1Extent;
-            z = (coordAccess2[i]-minCoords[2])/dim2Extent;
+            ValueType x = (coordAccess0[i]-minCoords[0])/dim0Extent;
+            ValueType y = (coordAccess1[i]-minCoords[1])/dim1Extent;
+            ValueType z = (coordAccess2[i]-minCoords[2])/dim2Extent;
 
-            integerIndex = 0;
+            unsigned long integerIndex = 0;	//TODO: also check whether this data type is long enough
             for (IndexType j = 0; j < recursionDepth; j++) {
                 int subSquare;
                 if (z < 0.5) {
@@ -1080,6 +1093,200 @@ MPI_Datatype getMPITypePair<float,IndexType>(){
 
 //-------------------------------------------------------------------------------------------------
 
+template<typename IndexType, typename ValueType>
+std::vector<IndexType> HilbertCurve<IndexType, ValueType>::partitionOutOfCore(const std::string& coordFile, const std::string& partitionFile, Settings settings, const scai::dmemo::CommunicatorPtr comm) {
+    SCAI_REGION( "HilbertCurve.partitionOutOfCore" )
+
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+
+    const IndexType k = settings.numBlocks;
+    const IndexType dimensions = settings.dimensions;
+    const IndexType numPEs = comm->getSize();
+    const IndexType rank = comm->getRank();
+
+    std::ifstream file(coordFile, std::ios::binary | std::ios::ate);
+    if (comm->any(file.fail())) {
+        throw std::runtime_error("File " + coordFile + " failed.");
+    }
+    const std::streamoff fileSize = file.tellg();
+    const std::streamoff beginByte = fileSize / numPEs * rank;
+    const std::streamoff endByte = rank + 1 == numPEs ? fileSize : fileSize / numPEs * (rank + 1);
+
+    //call f for every point of the lines that start in the byte range of this PE
+    std::vector<ValueType> point(dimensions);
+    auto forLocalPoints = [&](const std::function<void(const std::vector<ValueType>&)>& f) {
+        file.clear();
+        file.seekg(beginByte);
+        std::string line;
+        if (beginByte > 0) {
+            //the line that contains the first byte belongs to the previous PE, unless it starts there
+            file.seekg(beginByte - 1);
+            if (file.get() != '\n') {
+                std::getline(file, line);
+            }
+        }
+        while (file.tellg() < endByte and std::getline(file, line)) {
+            if (line.empty() or line[0] == '%') {
+                continue;
+            }
+            const char* pos = line.c_str();
+            for (IndexType d = 0; d < dimensions; d++) {
+                char* next;
+                point[d] = std::strtod(pos, &next);
+                if (next == pos) {
+                    throw std::runtime_error("Only " + std::to_string(d) + " values found, but " + std::to_string(dimensions) + " expected in line '" + line + "'");
+                }
+                pos = next;
+            }
+            f(point);
+        }
+    };
+
+    /*
+     * first pass: bounding box and a uniform sample of the local points
+     */
+    const IndexType samplesPerBlock = std::max<IndexType>(64, std::ceil(16.0/(settings.epsilon*settings.epsilon)));
+    const IndexType localSamples = std::max<IndexType>(1, std::min<std::size_t>(std::size_t(samplesPerBlock)*k, 1 << 22) / numPEs);
+
+    std::vector<ValueType> minCoords(dimensions, std::numeric_limits<ValueType>::max());
+    std::vector<ValueType> maxCoords(dimensions, std::numeric_limits<ValueType>::lowest());
+    std::vector<ValueType> sample;
+    sample.reserve(localSamples*dimensions);
+    std::mt19937 generator(std::size_t(settings.seed) + rank);
+    IndexType localN = 0;
+
+    forLocalPoints([&](const std::vector<ValueType>& p) {
+        for (IndexType d = 0; d < dimensions; d++) {
+            minCoords[d] = std::min(minCoords[d], p[d]);
+            maxCoords[d] = std::max(maxCoords[d], p[d]);
+        }
+        //reservoir sampling
+        if (localN < localSamples) {
+            sample.insert(sample.end(), p.begin(), p.end());
+        } else {
+            const IndexType replace = std::uniform_int_distribution<IndexType>(0, localN)(generator);
+            if (replace < localSamples) {
+                std::copy(p.begin(), p.end(), sample.begin() + replace*dimensions);
+            }
+        }
+        localN++;
+    });
+
+    for (IndexType d = 0; d < dimensions; d++) {
+        minCoords[d] = comm->min(minCoords[d]);
+        maxCoords[d] = comm->max(maxCoords[d]);
+    }
+    const IndexType globalN = comm->sum(localN);
+    if (globalN == 0) {
+        throw std::runtime_error("No points found in " + coordFile);
+    }
+
+    /*
+     * splitters from the weighted sample of all PEs
+     */
+    const IndexType numLocalSamples = sample.size()/dimensions;
+    std::vector<double> allKeys(localSamples*numPEs, 0);
+    std::vector<double> allWeights(localSamples*numPEs, 0);
+    for (IndexType i = 0; i < numLocalSamples; i++) {
+        allKeys[rank*localSamples + i] = getHilbertIndex(sample.data() + i*dimensions, dimensions, settings.sfcResolution, minCoords, maxCoords);
+        allWeights[rank*localSamples + i] = double(localN)/numLocalSamples;
+    }
+    std::vector<ValueType>().swap(sample);
+    comm->sumImpl(allKeys.data(), allKeys.data(), allKeys.size(), scai::common::TypeTraits<double>::stype);
+    comm->sumImpl(allWeights.data(), allWeights.data(), allWeights.size(), scai::common::TypeTraits<double>::stype);
+
+    std::vector<IndexType> order(allKeys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&allKeys](IndexType a, IndexType b) {
+        return allKeys[a] < allKeys[b];
+    });
+
+    std::vector<double> splitters;
+    splitters.reserve(k - 1);
+    double prefixWeight = 0;
+    for (const IndexType i : order) {
+        prefixWeight += allWeights[i];
+        while (splitters.size() < std::size_t(k - 1) and prefixWeight >= double(globalN)*(splitters.size() + 1)/k) {
+            splitters.push_back(allKeys[i]);
+        }
+    }
+    while (splitters.size() < std::size_t(k - 1)) {
+        splitters.push_back(1.0);
+    }
+
+    /*
+     * second pass: the block of every point, every PE writes its block ids to a part file
+     */
+    std::vector<IndexType> blockSizes(k, 0);
+    const std::string localPartFile = partitionFile + ".tmp" + std::to_string(rank);
+    {
+        std::ofstream out(localPartFile, std::ios::binary);
+        forLocalPoints([&](const std::vector<ValueType>& p) {
+            const double key = getHilbertIndex(p.data(), dimensions, settings.sfcResolution, minCoords, maxCoords);
+            const IndexType block = std::upper_bound(splitters.begin(), splitters.end(), key) - splitters.begin();
+            blockSizes[block]++;
+            out << block << '\n';
+        });
+        if (comm->any(not out.good())) {
+            throw std::runtime_error("Could not write " + localPartFile);
+        }
+    }
+    comm->sumImpl(blockSizes.data(), blockSizes.data(), k, scai::common::TypeTraits<IndexType>::stype);
+
+    /*
+     * the parts are in the order of the points, every PE copies its part to its offset in the partition file
+     */
+    //the first line has a comment with the number of points, as written by FileIO::writePartitionParallel
+    const std::string header = "% " + std::to_string(globalN) + "\n";
+    std::vector<long> partBytes(numPEs, 0);
+    {
+        std::ifstream part(localPartFile, std::ios::binary | std::ios::ate);
+        partBytes[rank] = part.tellg();
+    }
+    comm->sumImpl(partBytes.data(), partBytes.data(), numPEs, scai::common::TypeTraits<long>::stype);
+    const long offset = header.size() + std::accumulate(partBytes.begin(), partBytes.begin() + rank, 0L);
+
+    bool written = true;
+    if (rank == 0) {
+        const int fd = open(partitionFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        written = fd >= 0 and pwrite(fd, header.data(), header.size(), 0) == ssize_t(header.size());
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    if (comm->any(not written)) {
+        throw std::runtime_error("Could not write " + partitionFile);
+    }
+
+    {
+        const int fd = open(partitionFile.c_str(), O_WRONLY);
+        std::ifstream part(localPartFile, std::ios::binary);
+        std::vector<char> buffer(1 << 22);
+        long position = offset;
+        written = fd >= 0;
+        while (written and part.read(buffer.data(), buffer.size()).gcount() > 0) {
+            const std::streamsize numBytes = part.gcount();
+            written = pwrite(fd, buffer.data(), numBytes, position) == ssize_t(numBytes);
+            position += numBytes;
+        }
+        if (fd >= 0) {
+            written = (close(fd) == 0) and written;
+        }
+    }
+    std::remove(localPartFile.c_str());
+    if (comm->any(not written)) {
+        throw std::runtime_error("Could not write " + partitionFile);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const IndexType maxBlockSize = *std::max_element(blockSizes.begin(), blockSizes.end());
+    PRINT0("Out-of-core SFC partition of " << globalN << " points into " << k << " blocks in " << comm->max(elapsed.count()) \
+        << " seconds, imbalance " << (ValueType(maxBlockSize)*k/globalN - 1));
+
+    return blockSizes;
+}
+//-------------------------------------------------------------------------------------------------
+
 template class HilbertCurve<IndexType, double>;
 template class HilbertCurve<IndexType, float>;
 
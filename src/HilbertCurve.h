@@ -175,6 +175,25 @@ public:
         const DenseVector<ValueType> &nodeWeights,
         Settings settings);
 
+    /** @brief Partition the points of a coordinate file that does not need to fit into memory, with two passes over the file.
+
+     Every PE reads a byte range of the file in METIS coordinate format, one point per line, streaming line by line.
+     The first pass computes the bounding box and draws a uniform sample of the points of every PE. The Hilbert
+     indices of the samples, weighted by the number of points they represent, give k-1 splitters. The second pass
+     computes the Hilbert index of every point and its block from the splitters, and writes the block ids. Every PE
+     writes its block ids at its own offset of the partition file, after the line "% n" as written by
+     FileIO::writePartitionParallel, so the file can be read with FileIO::readPartition.
+     Only the sample is kept in memory, about max(64, 16/epsilon^2) points per block, so the imbalance is statistical.
+
+     @param[in] coordFile The coordinate file, the first settings.dimensions values of every line are used.
+     @param[in] partitionFile The file to write the block ids to, one per line in the order of the points.
+     @param[in] settings Uses numBlocks, dimensions, epsilon, sfcResolution and seed.
+     @param[in] comm The PEs that read the file.
+
+     @return The number of points in every block.
+     */
+    static std::vector<IndexType> partitionOutOfCore(const std::string& coordFile, const std::string& partitionFile, Settings settings, const scai::dmemo::CommunicatorPtr comm);
+
 
 private:
     /** @brief Accepts a 2D point and returns is hilbert index.
@@ -16,6 +16,8 @@
 #include <iostream>
 #include <chrono>
 #include <type_traits>
+#include <numeric>
+#include <cstdio>
 
 #include "GraphUtils.h"
 #include "gtest/gtest.h"
@@ -594,6 +596,50 @@ TYPED_TEST(HilbertCurveTest, testGetSortedHilbertIndices_Distributed) {
 
 }
 
+//-------------------------------------------------------------------------------------------------
+
+TYPED_TEST(HilbertCurveTest, testPartitionOutOfCore) {
+    using ValueType = TypeParam;
+
+    const std::string coordFile = HilbertCurveTest<ValueType>::graphPath + "bigtrace-00000.graph.xyz";
+    const IndexType N = 231217;
+    const scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+
+    Settings settings;
+    settings.dimensions = 2;
+    settings.numBlocks = 8;
+    settings.epsilon = 0.05;
+
+    const std::string partFile = "outOfCoreTest_" + std::to_string(comm->getSize()) + ".part";
+    const std::vector<IndexType> blockSizes = HilbertCurve<IndexType, ValueType>::partitionOutOfCore(coordFile, partFile, settings, comm);
+
+    //the splitters come from a sample, the balance is only close to epsilon
+    ASSERT_EQ(settings.numBlocks, blockSizes.size());
+    EXPECT_EQ(N, std::accumulate(blockSizes.begin(), blockSizes.end(), IndexType(0)));
+    for (const IndexType size : blockSizes) {
+        EXPECT_LE(size, (1 + 2*settings.epsilon)*N/settings.numBlocks);
+    }
+
+    //the same sizes in the file, in the order of the points
+    const DenseVector<IndexType> filePartition = FileIO<IndexType, ValueType>::readPartition(partFile, N);
+    std::vector<IndexType> fileSizes(settings.numBlocks, 0);
+    {
+        scai::hmemo::ReadAccess<IndexType> rPart(filePartition.getLocalValues());
+        for (IndexType i = 0; i < rPart.size(); i++) {
+            ASSERT_GE(rPart[i], 0);
+            ASSERT_LT(rPart[i], settings.numBlocks);
+            fileSizes[rPart[i]]++;
+        }
+    }
+    comm->sumImpl(fileSizes.data(), fileSizes.data(), settings.numBlocks, scai::common::TypeTraits<IndexType>::stype);
+    EXPECT_EQ(blockSizes, fileSizes);
+
+    comm->synchronize();
+    if (comm->getRank() == 0) {
+        std::remove(partFile.c_str());
+    }
+}
+
 //No way to combine typed and value test. See:
 // https://stackoverflow.com/questions/8507385/google-test-is-there-a-way-to-combine-a-test-which-is-both-type-parameterized-a
 //
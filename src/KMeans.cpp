@@ -9,6 +9,7 @@
 #include <cmath>
 #include <assert.h>
 #include <algorithm>
+#include <random>
 
 #include <scai/dmemo/NoDistribution.hpp>
 #include <scai/dmemo/GenBlockDistribution.hpp>
@@ -20,6 +21,8 @@
 #include "quadtree/QuadNodeCartesianEuclid.h"
 // temporary, for debugging
 #include "FileIO.h"
+#include "NumaUtils.h"
+#include "NodeShared.h"
 
 //#include "PrioQueue.h"
 
@@ -462,9 +465,11 @@ std::vector<std::vector<ValueType>> KMeans<IndexType,ValueType>::findCenters(
             }
         }
 
-        // communicate local centers and weight sums
-        std::vector<ValueType> totalWeight(k, 0);
-        comm->sumImpl(totalWeight.data(), weightSum.data(), k, scai::common::TypeTraits<ValueType>::stype);
+        // communicate local centers and weight sums, a single process has them already
+        std::vector<ValueType> totalWeight(weightSum);
+        if (comm->getSize() > 1) {
+            comm->sumImpl(totalWeight.data(), weightSum.data(), k, scai::common::TypeTraits<ValueType>::stype);
+        }
 
         // compute updated centers as weighted average
         for (IndexType d = 0; d < dim; d++) {
@@ -481,7 +486,9 @@ std::vector<std::vector<ValueType>> KMeans<IndexType,ValueType>::findCenters(
                 }
             }
 
-            comm->sumImpl(result[d].data(), result[d].data(), k, scai::common::TypeTraits<ValueType>::stype);
+            if (comm->getSize() > 1) {
+                comm->sumImpl(result[d].data(), result[d].data(), k, scai::common::TypeTraits<ValueType>::stype);
+            }
         }
 
         allWeightsCenters[w]= result ;
@@ -530,7 +537,7 @@ template<typename IndexType, typename ValueType>
 template<typename Iterator>
 DenseVector<IndexType> KMeans<IndexType,ValueType>::assignBlocks(
     const std::vector<std::vector<ValueType>>& coordinates,
-    const std::vector<point<ValueType>>& centers,
+    const ValueType* centers,
     const std::vector<IndexType>& blockSizesPrefixSum,
     const Iterator firstIndex,
     const Iterator lastIndex,
@@ -540,8 +547,8 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::assignBlocks(
     const DenseVector<IndexType> &oldBlock, // if repartition, this is the partition to be rebalanced
     const std::vector<std::vector<ValueType>> &targetBlockWeights,
     const SpatialCell<ValueType> &boundingBox,
-    std::vector<ValueType> &upperBoundOwnCenter,
-    std::vector<ValueType> &lowerBoundNextCenter,
+    FirstTouchVector<ValueType> &upperBoundOwnCenter,
+    FirstTouchVector<ValueType> &lowerBoundNextCenter,
     std::vector<std::vector<ValueType>> &influence,
     std::vector<ValueType> &imbalance,
     Settings settings,
@@ -553,6 +560,10 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::assignBlocks(
     const scai::dmemo::CommunicatorPtr comm = dist->getCommunicatorPtr();
     const IndexType localN = dist->getLocalSize();
     const IndexType currentLocalN = std::distance(firstIndex, lastIndex); //number of sampled points
+    //with a single process the block weights need no reduction
+    const bool singleProcess = comm->getSize() == 1;
+    //the points are assigned by threads only if this process has the node to itself
+    const bool useThreads = isSingleProcessRun();
 
     if (currentLocalN < 0) {
         throw std::runtime_error("currentLocalN: " + std::to_string(currentLocalN));
@@ -579,15 +590,8 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::assignBlocks(
     }
 
     // numNewBlocks is equivalent to 'k' in the classic version
-    const IndexType numNewBlocks = centers.size();
-
-    SCAI_ASSERT_EQ_ERROR(blockSizesPrefixSum.back(), numNewBlocks, "Total number of new blocks mismatch");
-
-    // centers are given as a 1D vector alongside with a prefix sum vector
-    const std::vector<point<ValueType>>& centers1DVector = centers;
+    const IndexType numNewBlocks = blockSizesPrefixSum.back();
 
-    SCAI_ASSERT_EQ_ERROR(centers1DVector.size(), numNewBlocks, "Vector size mismatch");
-    SCAI_ASSERT_EQ_ERROR(centers1DVector[0].size(), dim, "Center dimensions mismatch");
     SCAI_ASSERT_EQ_ERROR(influence.size(), numNodeWeights, "Vector size mismatch");
     for (IndexType i = 0; i < numNodeWeights; i++) {
         SCAI_ASSERT_EQ_ERROR(influence[i].size(), numNewBlocks, "Vector size mismatch");
@@ -601,7 +605,7 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::assignBlocks(
     for (IndexType newB=0; newB<numNewBlocks; newB++) {
         SCAI_REGION("KMeans.assignBlocks.filterCenters");
 
-        point<ValueType> center = centers1DVector[newB];
+        const point<ValueType> center(centers + newB*dim, centers + (newB+1)*dim);
         ValueType influenceMin = std::numeric_limits<ValueType>::max();
         for (IndexType i = 0; i < numNodeWeights; i++) {
             influenceMin = std::min(influenceMin, influence[i][newB]);
@@ -643,6 +647,16 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::assignBlocks(
         std::sort(effectMinDistAllBlocks.begin()+rangeStart, effectMinDistAllBlocks.begin()+rangeEnd);
     }
 
+    // the father blocks do not change during the balance loop, check them once outside of the threaded assignment
+    {
+        // if repartition, numOldBlocks=1 but father block<numNewBlocks
+        const IndexType numFatherBlocks = settings.repartition ? numNewBlocks : numOldBlocks;
+        scai::hmemo::ReadAccess<IndexType> rOldBlock(oldBlock.getLocalValues());
+        for (Iterator it = firstIndex; it != lastIndex; it++) {
+            SCAI_ASSERT_LT_ERROR(rOldBlock[*it], numFatherBlocks, "Wrong father block index");
+        }
+    }
+
     IndexType iter = 0;
     IndexType skippedLoops = 0;
     ValueType totalBalanceTime = 0; // for timing/profiling
@@ -675,21 +689,16 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::assignBlocks(
         {
             SCAI_REGION("KMeans.assignBlocks.balanceLoop.assign");
             scai::hmemo::WriteAccess<IndexType> wAssignment(assignment.getLocalValues());
-            // for the sampled range
-            for (Iterator it = firstIndex; it != lastIndex; it++) {
-                const IndexType i = *it;
+            // points whose bounds or centers are inconsistent, counted because the threads must not throw
+            IndexType wrongBounds = 0;
+            // for the sampled range, the points are independent and with a single process all cores share the work
+            #pragma omp parallel for schedule(static) reduction(+:totalComps,skippedLoops,wrongBounds) if(useThreads)
+            for (IndexType veryLocalI = 0; veryLocalI < currentLocalN; veryLocalI++) {
+                const IndexType i = firstIndex[veryLocalI];
                 //oldCluster: where it belonged in the previous iteration
                 const IndexType oldCluster = wAssignment[i];
                 //fatherBlock: meaningful in the hierarchical version, it is the block of this point in the previous hierarchy 
                 const IndexType fatherBlock = rOldBlock[i]; 
-                const IndexType veryLocalI = std::distance(firstIndex, it);
-
-                if (not settings.repartition) {
-                    SCAI_ASSERT_LT_ERROR(fatherBlock, numOldBlocks, "Wrong father block index");
-                } else {
-                    // numOldBlocks=1 but father block<numNewBlocks
-                    SCAI_ASSERT_LT_ERROR(fatherBlock, numNewBlocks, "Wrong father block index");
-                }
 
                 assert(influenceEffectOfOwn[veryLocalI] == 0);
                 for (IndexType j = 0; j < numNodeWeights; j++) {
@@ -702,13 +711,15 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::assignBlocks(
                     skippedLoops++;
                 } else {
                     ValueType sqDistToOwn = 0;
-                    const point<ValueType>& myCenter = centers1DVector[oldCluster];
+                    const ValueType* myCenter = centers + oldCluster*dim;
                     for (IndexType d = 0; d < dim; d++) {
                         sqDistToOwn += std::pow(myCenter[d]-coordinates[d][i], 2);
                     }
 
                     ValueType newEffectiveDistance = sqDistToOwn*influenceEffectOfOwn[veryLocalI];
-                    SCAI_ASSERT_LE_ERROR(newEffectiveDistance, upperBoundOwnCenter[i], "Distance upper bound was wrong");
+                    if (not (newEffectiveDistance <= upperBoundOwnCenter[i])) {
+                        wrongBounds++;
+                    }
                     upperBoundOwnCenter[i] = newEffectiveDistance;
                     if (lowerBoundNextCenter[i] > upperBoundOwnCenter[i]) {
                         // cluster assignment cannot have changed.
@@ -726,7 +737,6 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::assignBlocks(
                         // where the range of indices starts for the father block
                         const IndexType rangeStart = settings.repartition ? 0 : blockSizesPrefixSum[fatherBlock];
                         const IndexType rangeEnd =  settings.repartition ? blockSizesPrefixSum.back() : blockSizesPrefixSum[fatherBlock+1];
-                        SCAI_ASSERT_LE_ERROR(rangeEnd, clusterIndicesAllBlocks.size(), "Range out of bounds");
 
                         // start with the first center index
                         IndexType c = rangeStart;
@@ -740,7 +750,7 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::assignBlocks(
 
                             // squared distance from previous assigned center
                             ValueType sqDist = 0;
-                            const point<ValueType>& myCenter = centers1DVector[j];
+                            const ValueType* myCenter = centers + j*dim;
                             // TODO: restructure arrays to align memory accesses better in inner loop
                             for (IndexType d = 0; d < dim; d++) {
                                 sqDist += std::pow(myCenter[d]-coordinates[d][i], 2);
@@ -767,19 +777,16 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::assignBlocks(
                             c++;
                         } // while
 
-                        if (rangeEnd - rangeStart > 1) {
-                            SCAI_ASSERT_NE_ERROR(bestBlock, secondBest, "Best and second best should be different");
+                        // best and second best should be different
+                        if (rangeEnd - rangeStart > 1 and bestBlock == secondBest) {
+                            wrongBounds++;
                         }
 
                         assert(secondBestValue >= bestValue);
 
-                        // this point has a new center
-                        if (bestBlock != oldCluster) {
-                            // assert(bestValue >= lowerBoundNextCenter[i]);
-                            SCAI_ASSERT_GE_ERROR(bestValue, lowerBoundNextCenter[i], \
-                                                 "PE " << comm->getRank() << ": difference " << std::abs(bestValue - lowerBoundNextCenter[i]) << \
-                                                 " for i= " << i << ", oldCluster: " << oldCluster << ", newCluster: " << bestBlock << \
-                                                 ", influenceEffect: " << influenceEffectOfBestBlock);
+                        // this point has a new center, it cannot be closer than the old lower bound
+                        if (bestBlock != oldCluster and not (bestValue >= lowerBoundNextCenter[i])) {
+                            wrongBounds++;
                         }
 
                         upperBoundOwnCenter[i] = bestValue;
@@ -788,23 +795,31 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::assignBlocks(
                         wAssignment[i] = bestBlock;
                     }
                 }
-                // we found the best block for this point; increase the weight of this block
+            }// for sampled indices
+            SCAI_ASSERT_EQ_ERROR(wrongBounds, 0, "PE " << comm->getRank() << ": wrong distance bounds or centers for " << wrongBounds << " points");
+
+            // we found the best block for every point; increase the weight of these blocks
+            for (Iterator it = firstIndex; it != lastIndex; it++) {
+                const IndexType i = *it;
                 for (IndexType j = 0; j <numNodeWeights; j++) {
                     blockWeights[j][wAssignment[i]] += nodeWeights[j][i];
                 }
-
-            }// for sampled indices
+            }
 
             std::chrono::duration<ValueType,std::ratio<1>> balanceTime = std::chrono::high_resolution_clock::now() - balanceStart;
             // timePerPE[comm->getRank()] += balanceTime.count();
 
-            comm->synchronize();
+            if (not singleProcess) {
+                comm->synchronize();
+            }
         }// assignment block
 
         //get the total weight of the blocks
-        for (IndexType j = 0; j < numNodeWeights; j++){
+        if (not singleProcess) {
             SCAI_REGION("KMeans.assignBlocks.balanceLoop.blockWeightSum");
-            comm->sumImpl(blockWeights[j].data(), blockWeights[j].data(), numNewBlocks, scai::common::TypeTraits<ValueType>::stype);
+            for (IndexType j = 0; j < numNodeWeights; j++){
+                comm->sumImpl(blockWeights[j].data(), blockWeights[j].data(), numNewBlocks, scai::common::TypeTraits<ValueType>::stype);
+            }
         }
 
         // calculate imbalance for every new block and every weight
@@ -890,21 +905,25 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::assignBlocks(
         {
             SCAI_REGION("KMeans.assignBlocks.balanceLoop.updateBounds");
             scai::hmemo::ReadAccess<IndexType> rAssignement(assignment.getLocalValues());
-            for (Iterator it = firstIndex; it != lastIndex; it++) {
-                const IndexType i = *it;
+            IndexType wrongRatios = 0;
+            #pragma omp parallel for schedule(static) reduction(+:wrongRatios) if(useThreads)
+            for (IndexType veryLocalI = 0; veryLocalI < currentLocalN; veryLocalI++) {
+                const IndexType i = firstIndex[veryLocalI];
                 const IndexType cluster = rAssignement[i];
-                const IndexType veryLocalI = std::distance(firstIndex, it);// maybe optimize?
                 ValueType newInfluenceEffect = 0;
                 for (IndexType j = 0; j < numNodeWeights; j++) {
                     newInfluenceEffect += influence[j][cluster]*normalizedNodeWeights[j][i];
                 }
 
-                SCAI_ASSERT_LE_ERROR((newInfluenceEffect / influenceEffectOfOwn[veryLocalI]), maxRatio + 1e-5, "Error in calculation of influence effect");
-                SCAI_ASSERT_GE_ERROR((newInfluenceEffect / influenceEffectOfOwn[veryLocalI]), minRatio - 1e-5, "Error in calculation of influence effect");
+                const ValueType ratio = newInfluenceEffect / influenceEffectOfOwn[veryLocalI];
+                if (not (ratio <= maxRatio + 1e-5 and ratio >= minRatio - 1e-5)) {
+                    wrongRatios++;
+                }
 
-                upperBoundOwnCenter[i] *= (newInfluenceEffect / influenceEffectOfOwn[veryLocalI]) + 1e-5;
+                upperBoundOwnCenter[i] *= ratio + 1e-5;
                 lowerBoundNextCenter[i] *= minRatio - 1e-5;
             }
+            SCAI_ASSERT_EQ_ERROR(wrongRatios, 0, "Error in calculation of influence effect");
         }
 
         // update possible closest centers
@@ -994,6 +1013,13 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::assignBlocks(
             std::cout.precision(oldprecision);
         }
 
+        //with a time budget, stop balancing at the deadline; the assignment is complete, only less balanced
+        if( !allWeightsBalanced and iter < settings.balanceIterations and settings.deadlinePassed(settings.initialDeadline, comm) ){
+            PRINT0("Time budget for the initial partition is used, stop balancing after " << iter << " iterations");
+            metrics.MM["truncatedBalance"] = 1;
+            break;
+        }
+
     } while ((!allWeightsBalanced) && iter < settings.balanceIterations);
 
     if (settings.verbose) {
@@ -1163,20 +1189,6 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::computePartition(
         totalNumNewBlocks += centers[b].size();
     }
 
-    // if repartition, centers1DVector=centers[0] (remember, centers.size()=1)
-    // Basically, one vector with all the centers and the blockSizesPrefixSum is "useless"
-
-    // convert to a 1D vector
-    std::vector<point<ValueType>> centers1DVector;
-    for (int b=0; b<numOldBlocks; b++) {
-        const unsigned int k = blockSizesPrefixSum[b+1]-blockSizesPrefixSum[b];
-        assert(k==centers[b].size()); // not really needed, TODO: remove?
-        for (IndexType i=0; i<k; i++) {
-            centers1DVector.push_back(centers[b][i]);
-        }
-    }
-    SCAI_ASSERT_EQ_ERROR(centers1DVector.size(), totalNumNewBlocks, "Vector size mismatch");
-
     const IndexType dim = coordinates.size();
     assert(dim > 0);
     const IndexType localN = coordinates[0].getLocalValues().size();
@@ -1185,12 +1197,29 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::computePartition(
         SCAI_ASSERT_EQ_ERROR(nodeWeights[i].getLocalValues().size(), localN, "Mismatch between node weights and coordinate size.");
     }
     SCAI_ASSERT_EQ_ERROR(centers[0][0].size(), dim, "Center dimensions mismatch");
-    SCAI_ASSERT_EQ_ERROR(centers1DVector[0].size(), dim, "Center dimensions mismatch");
 
     scai::dmemo::CommunicatorPtr comm = coordinates[0].getDistributionPtr()->getCommunicatorPtr();
 
     const IndexType p = comm->getSize();
 
+    // the centers are the same on all processes, so every node keeps one copy of them
+    // coordinate d of center j is centers1D[j*dim+d]; if repartition, these are the centers of centers[0]
+    NodeSharedArray<ValueType> sharedCenters(comm, totalNumNewBlocks*dim);
+    if (sharedCenters.isLeader()) {
+        ValueType* wCenters = sharedCenters.data();
+        for (int b=0; b<numOldBlocks; b++) {
+            for (IndexType i=blockSizesPrefixSum[b]; i<blockSizesPrefixSum[b+1]; i++) {
+                SCAI_ASSERT_EQ_ERROR(centers[b][i-blockSizesPrefixSum[b]].size(), dim, "Center dimensions mismatch");
+                std::copy(centers[b][i-blockSizesPrefixSum[b]].begin(), centers[b][i-blockSizesPrefixSum[b]].end(), wCenters + i*dim);
+            }
+        }
+    }
+    sharedCenters.synchronize();
+    const ValueType* centers1D = sharedCenters.data();
+    if (settings.verbose) {
+        PRINT0("sharing the k-means centers saves " << ValueType(sharedCenters.nodeSize()-1)*sharedCenters.size()*sizeof(ValueType)/1024 << " KB on the node of PE 0");
+    }
+
     //
     // copy/convert node weights
     //
@@ -1276,8 +1305,8 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::computePartition(
     diagonalLength = std::sqrt(diagonalLength);
     const ValueType expectedBlockDiameter = pow(volume /totalNumNewBlocks, 1.0/dim);
 
-    std::vector<ValueType> upperBoundOwnCenter(localN, std::numeric_limits<ValueType>::max());
-    std::vector<ValueType> lowerBoundNextCenter(localN, 0);
+    FirstTouchVector<ValueType> upperBoundOwnCenter = firstTouchVector(localN, std::numeric_limits<ValueType>::max());
+    FirstTouchVector<ValueType> lowerBoundNextCenter = firstTouchVector(localN, ValueType(0));
 
     //
     // prepare sampling
@@ -1310,7 +1339,12 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::computePartition(
             //ITI::GraphUtils<IndexType, ValueType>::FisherYatesShuffle(localIndices.begin(), localIndices.end(), localN);
             // TODO: the cantor shuffle is more stable; random shuffling can yield better
             // results occasionally but has higher fluctuation/variance
-            localIndices = GraphUtils<IndexType,ValueType>::indexReorderCantor(localN);
+            if (settings.shuffleSamples) {
+                std::mt19937 generator(std::size_t(settings.seed) + comm->getRank());
+                std::shuffle(localIndices.begin(), localIndices.end(), generator);
+            } else {
+                localIndices = GraphUtils<IndexType,ValueType>::indexReorderCantor(localN);
+            }
 
             SCAI_ASSERT_EQ_ERROR(*std::max_element(localIndices.begin(), localIndices.end()), localN -1, "Error in index reordering");
             SCAI_ASSERT_EQ_ERROR(*std::min_element(localIndices.begin(), localIndices.end()), 0, "Error in index reordering");
@@ -1351,6 +1385,8 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::computePartition(
     DenseVector<IndexType> mostBalancedResult(coordinates[0].getDistributionPtr(), 0);
     ValueType minImbalance = settings.numBlocks+1; //to store the solution with the minimum imbalance
     ValueType minAchievedImbalance = settings.epsilon; //used with multiple weights; TODO: adapt for multiple balance constrains
+    //with a time budget the loop may stop at any iteration, so always keep the best solution so far
+    const bool keepMostBalanced = settings.keepMostBalanced or settings.initialDeadline>0;
 
     // TODO, recheck:
     // if repartition, should it be result = previous???
@@ -1409,7 +1445,7 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::computePartition(
 
         std::vector<ValueType> timePerPE(comm->getSize(), 0.0);
 
-        result = assignBlocks(convertedCoords, centers1DVector, blockSizesPrefixSum, firstIndex, lastIndex, convertedNodeWeights, normalizedNodeWeights, result, partition, adjustedBlockSizes, boundingBox, upperBoundOwnCenter, lowerBoundNextCenter, influence, imbalances, settings, metrics);
+        result = assignBlocks(convertedCoords, centers1D, blockSizesPrefixSum, firstIndex, lastIndex, convertedNodeWeights, normalizedNodeWeights, result, partition, adjustedBlockSizes, boundingBox, upperBoundOwnCenter, lowerBoundNextCenter, influence, imbalances, settings, metrics);
 
         // TODO: too much info? remove?
         if (settings.verbose and settings.debugMode) {
@@ -1432,30 +1468,25 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::computePartition(
         // TODO: adapt for multiple weights
         std::vector<std::vector<ValueType>> newCenters = findCenters(coordinates, result, totalNumNewBlocks, firstIndex, lastIndex, nodeWeights);
 
-        // newCenters have reversed order of the vectors
-        // maybe turn centers to a 1D vector already in computePartition?
+        // newCenters[d][j] is coordinate d of center j
+        assert(newCenters.size()==dim);
+        assert(newCenters[0].size()==totalNumNewBlocks);
 
-        std::vector<point<ValueType>> transCenters = vectorTranspose(newCenters);
-        assert(transCenters.size()==totalNumNewBlocks);
-        assert(transCenters[0].size()==dim);
-
-        // keep centroids of empty blocks at their last known position
-        for (IndexType j = 0; j <totalNumNewBlocks; j++) {
-            // center for block j is empty
-            if (std::isnan(transCenters[j][0])) {
-                transCenters[j] = centers1DVector[j];
-            }
-        }
         std::vector<ValueType> squaredDeltas(totalNumNewBlocks,0);
         std::vector<ValueType> deltas(totalNumNewBlocks,0);
         std::vector<std::vector<ValueType>> oldInfluence = influence;
         ValueType minRatio = std::numeric_limits<ValueType>::max();
 
         for (IndexType j = 0; j < totalNumNewBlocks; j++) {
+            // keep centroids of empty blocks at their last known position
+            const bool emptyBlock = std::isnan(newCenters[0][j]);
             for (int d = 0; d < dim; d++) {
-                SCAI_ASSERT_LE_ERROR(transCenters[j][d], globalMaxCoords[d]+ 1e-6, "New center coordinate out of bounds");
-                SCAI_ASSERT_GE_ERROR(transCenters[j][d], globalMinCoords[d]- 1e-6, "New center coordinate out of bounds");
-                ValueType diff = (centers1DVector[j][d] - transCenters[j][d]);
+                if (emptyBlock) {
+                    newCenters[d][j] = centers1D[j*dim+d];
+                }
+                SCAI_ASSERT_LE_ERROR(newCenters[d][j], globalMaxCoords[d]+ 1e-6, "New center coordinate out of bounds");
+                SCAI_ASSERT_GE_ERROR(newCenters[d][j], globalMinCoords[d]- 1e-6, "New center coordinate out of bounds");
+                ValueType diff = (centers1D[j*dim+d] - newCenters[d][j]);
                 squaredDeltas[j] += diff*diff;
             }
 
@@ -1470,7 +1501,17 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::computePartition(
             }
         }
 
-        centers1DVector = transCenters;
+        // all processes of the node have read the old centers before the leader overwrites them
+        sharedCenters.synchronize();
+        if (sharedCenters.isLeader()) {
+            ValueType* wCenters = sharedCenters.data();
+            for (IndexType j = 0; j < totalNumNewBlocks; j++) {
+                for (int d = 0; d < dim; d++) {
+                    wCenters[j*dim+d] = newCenters[d][j];
+                }
+            }
+        }
+        sharedCenters.synchronize();
 
         delta = *std::max_element(deltas.begin(), deltas.end());
         assert(delta >= 0);
@@ -1483,9 +1524,12 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::computePartition(
         {
             SCAI_REGION("KMeans.computePartition.updateBounds");
             scai::hmemo::ReadAccess<IndexType> rResult(result.getLocalValues());
+            const IndexType currentLocalN = std::distance(firstIndex, lastIndex);
 
-            for (auto it = firstIndex; it != lastIndex; it++) {
-                const IndexType i = *it;
+            //the bounds of the points are independent, with a single process all cores update them
+            #pragma omp parallel for schedule(static) if(isSingleProcessRun())
+            for (IndexType j = 0; j < currentLocalN; j++) {
+                const IndexType i = firstIndex[j];
                 IndexType cluster = rResult[i];
                 assert(cluster<totalNumNewBlocks);
 
@@ -1547,8 +1591,10 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::computePartition(
 
         {
             SCAI_REGION("KMeans.computePartition.currentBlockWeightSum");
-            for (IndexType i = 0; i < numNodeWeights; i++) {
-                comm->sumImpl(currentBlockWeights[i].data(), currentBlockWeights[i].data(), totalNumNewBlocks, scai::common::TypeTraits<ValueType>::stype);
+            if (comm->getSize() > 1) {
+                for (IndexType i = 0; i < numNodeWeights; i++) {
+                    comm->sumImpl(currentBlockWeights[i].data(), currentBlockWeights[i].data(), totalNumNewBlocks, scai::common::TypeTraits<ValueType>::stype);
+                }
             }
         }
 
@@ -1592,7 +1638,7 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::computePartition(
         //we must have sampled all indices, otherwise a solution will be a partial
         //assignment as the not sampled indices will belong to block 0 (from the initialization)
 
-        if(settings.keepMostBalanced  and lastIndex == localIndices.end() ){
+        if(keepMostBalanced  and lastIndex == localIndices.end() ){
             const ValueType currMinImbalance = *std::min_element( imbalances.begin(), imbalances.end() );
             const ValueType currMaxImbalance = *std::max_element( imbalances.begin(), imbalances.end() );
 
@@ -1630,6 +1676,13 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::computePartition(
         //metrics.kmeansProfiling.push_back(std::make_tuple(delta, maxTime, imbalances[0]));
         iter++;
 
+        //stop at the deadline, but not before all points were assigned once
+        if( iter >= samplingRounds and iter < maxIterations and (delta > threshold || !balanced) and settings.deadlinePassed(settings.initialDeadline, comm) ){
+            PRINT0("Time budget for the initial partition is used, stop k-means after " << iter << " iterations");
+            metrics.MM["truncatedKMeans"] = 1;
+            break;
+        }
+
     } while (iter < samplingRounds or (iter < maxIterations && (delta > threshold || !balanced)));
 
 
@@ -1640,7 +1693,7 @@ DenseVector<IndexType> KMeans<IndexType,ValueType>::computePartition(
     //special time for the core kmeans
     metrics.MM["timeKmeans"] = time;
 
-    if(settings.keepMostBalanced){
+    if(keepMostBalanced){
         return mostBalancedResult;
     }else{
         return result;
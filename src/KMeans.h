@@ -21,6 +21,7 @@
 #include "HilbertCurve.h"
 #include "AuxiliaryFunctions.h"
 #include "CommTree.h"
+#include "NumaUtils.h"
 #include "quadtree/SpatialCell.h"
 
 namespace ITI {
@@ -398,7 +399,7 @@ static ValueType computeEffectiveDistance(
  * The returned vector has always as many entries as local points, even if only some of them are non-zero.
  *
  * @param[in] coordinates input points
- * @param[in] centers block centers
+ * @param[in] centers block centers, coordinate d of center j is centers[j*dim+d]
  * @param[in] firstIndex begin of local node indices
  * @param[in] lastIndex end local node indices
  * @param[in] nodeWeights node weights
@@ -423,7 +424,7 @@ static ValueType computeEffectiveDistance(
 template< typename Iterator>
 static DenseVector<IndexType> assignBlocks(
     const std::vector<std::vector<ValueType>> &coordinates,
-    const std::vector< std::vector<ValueType> >& centers,
+    const ValueType* centers,
     const std::vector<IndexType>& blockSizesPrefixSum,
     const Iterator firstIndex,
     const Iterator lastIndex,
@@ -433,8 +434,8 @@ static DenseVector<IndexType> assignBlocks(
     const DenseVector<IndexType> &oldBlocks,
     const std::vector<std::vector<ValueType>> &targetBlockWeights,
     const SpatialCell<ValueType> &boundingBox,
-    std::vector<ValueType> &upperBoundOwnCenter,
-    std::vector<ValueType> &lowerBoundNextCenter,
+    FirstTouchVector<ValueType> &upperBoundOwnCenter,
+    FirstTouchVector<ValueType> &lowerBoundNextCenter,
     std::vector<std::vector<ValueType>> &influence,
     std::vector<ValueType> &imbalance,
     Settings settings,
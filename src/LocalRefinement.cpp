@@ -454,16 +454,19 @@ std::vector<ValueType> ITI::LocalRefinement<IndexType, ValueType>::distributedFM
 
                 auto newDistribution = scai::dmemo::generalDistributionUnchecked(globalN, indexTransport, comm);
                 SCAI_REGION_END( "LocalRefinement.distributedFMStep.loop.redistribute.generalDistribution" )
+                std::vector<IndexType> mergePlan;
 
                 {
                     SCAI_REGION( "LocalRefinement.distributedFMStep.loop.redistribute.updateDataStructures" )
 
-                    redistributeFromHalo(input, newDistribution, graphHalo, haloMatrix);
+                    //plan once, use it for the matrix and all vectors
+                    mergePlan = haloMergePlan(*inputDist, *newDistribution, graphHalo);
+                    redistributeFromHalo(input, newDistribution, mergePlan, graphHalo, haloMatrix);
                     part = scai::lama::fill<DenseVector<IndexType>>(newDistribution, localBlockID);
                     if (nodesWeighted) {
-                        redistributeFromHalo<ValueType>(nodeWeights, newDistribution, graphHalo, nodeWeightHaloData);
+                        redistributeFromHalo<ValueType>(nodeWeights, newDistribution, mergePlan, nodeWeightHaloData);
                     }
-                    redistributeFromHalo(origin, newDistribution, graphHalo, originData);
+                    redistributeFromHalo<IndexType>(origin, newDistribution, mergePlan, originData);
                 }
                 assert(input.getRowDistributionPtr()->isEqual(*part.getDistributionPtr()));
                 SCAI_REGION_END( "LocalRefinement.distributedFMStep.loop.redistribute" )
@@ -486,7 +489,7 @@ std::vector<ValueType> ITI::LocalRefinement<IndexType, ValueType>::distributedFM
                         HArray<ValueType>& localCoords = coordinates[dim].getLocalValues();
                         HArray<ValueType> haloData;
                         graphHalo.updateHalo( haloData, localCoords, *comm );
-                        redistributeFromHalo<ValueType>(coordinates[dim], newDistribution, graphHalo, haloData);
+                        redistributeFromHalo<ValueType>(coordinates[dim], newDistribution, mergePlan, haloData);
                     }
 
                     distances = LocalRefinement<IndexType, ValueType>::distancesFromBlockCenter(coordinates);
@@ -970,29 +973,68 @@ std::vector<ValueType> ITI::LocalRefinement<IndexType, ValueType>::twoWayLocalDi
 //---------------------------------------------------------------------------------------
 
 template<typename IndexType, typename ValueType>
-template<typename T>
-void ITI::LocalRefinement<IndexType, ValueType>::redistributeFromHalo(
-    DenseVector<T>& input, scai::dmemo::DistributionPtr newDist,
-    const scai::dmemo::HaloExchangePlan& halo,
-    const scai::hmemo::HArray<T>& haloData) {
+std::vector<IndexType> ITI::LocalRefinement<IndexType, ValueType>::haloMergePlan(
+    const scai::dmemo::Distribution& oldDist,
+    const scai::dmemo::Distribution& newDist,
+    const scai::dmemo::HaloExchangePlan& halo) {
 
-    SCAI_REGION( "LocalRefinement.redistributeFromHalo.Vector" )
+    SCAI_REGION( "LocalRefinement.haloMergePlan" )
 
-    scai::dmemo::DistributionPtr oldDist = input.getDistributionPtr();
-    const IndexType newLocalN = newDist->getLocalSize();
-    const IndexType oldLocalN = oldDist->getLocalSize();
+    const IndexType newLocalN = newDist.getLocalSize();
+    const IndexType oldLocalN = oldDist.getLocalSize();
 
     scai::hmemo::HArray<IndexType> oldIndices;
-    oldDist->getOwnedIndexes(oldIndices);
+    oldDist.getOwnedIndexes(oldIndices);
 
     scai::hmemo::HArray<IndexType> newIndices;
-    newDist->getOwnedIndexes(newIndices);
+    newDist.getOwnedIndexes(newIndices);
 
     scai::hmemo::ReadAccess<IndexType> oldAcc(oldIndices);
     scai::hmemo::ReadAccess<IndexType> newAcc(newIndices);
 
+    std::vector<IndexType> mergePlan(newLocalN);
     IndexType oldLocalI = 0;
 
+    for (IndexType i = 0; i < newLocalN; i++) {
+        const IndexType globalI = newAcc[i];
+        while(oldLocalI < oldLocalN && oldAcc[oldLocalI] < globalI) oldLocalI++;
+        if (oldLocalI < oldLocalN && oldAcc[oldLocalI] == globalI) {
+            mergePlan[i] = oldLocalI;
+        } else {
+            const IndexType haloI = halo.global2Halo(globalI);
+            assert(haloI != scai::invalidIndex);
+            mergePlan[i] = -(haloI+1);
+        }
+    }
+
+    return mergePlan;
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+template<typename T>
+void ITI::LocalRefinement<IndexType, ValueType>::redistributeFromHalo(
+    DenseVector<T>& input, scai::dmemo::DistributionPtr newDist,
+    const scai::dmemo::HaloExchangePlan& halo,
+    const scai::hmemo::HArray<T>& haloData) {
+
+    const std::vector<IndexType> mergePlan = haloMergePlan(input.getDistribution(), *newDist, halo);
+    redistributeFromHalo<T>(input, newDist, mergePlan, haloData);
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+template<typename T>
+void ITI::LocalRefinement<IndexType, ValueType>::redistributeFromHalo(
+    DenseVector<T>& input, scai::dmemo::DistributionPtr newDist,
+    const std::vector<IndexType>& mergePlan,
+    const scai::hmemo::HArray<T>& haloData) {
+
+    SCAI_REGION( "LocalRefinement.redistributeFromHalo.Vector" )
+
+    const IndexType newLocalN = newDist->getLocalSize();
+    SCAI_ASSERT_EQ_ERROR( mergePlan.size(), newLocalN, "Merge plan does not fit the new distribution" );
+
     HArray<T> newLocalValues(newLocalN);
 
     {
@@ -1001,15 +1043,11 @@ void ITI::LocalRefinement<IndexType, ValueType>::redistributeFromHalo(
 
         scai::hmemo::WriteOnlyAccess<T> wNewLocalValues(newLocalValues);
         for (IndexType i = 0; i < newLocalN; i++) {
-            const IndexType globalI = newAcc[i];
-            while(oldLocalI < oldLocalN && oldAcc[oldLocalI] < globalI) oldLocalI++;
-            //const IndexType oldLocalI = oldDist->global2Local(globalI);
-            if (oldLocalI < oldLocalN && oldAcc[oldLocalI] == globalI) {
-                wNewLocalValues[i] = rOldLocalValues[oldLocalI];
+            const IndexType source = mergePlan[i];
+            if (source >= 0) {
+                wNewLocalValues[i] = rOldLocalValues[source];
             } else {
-                const IndexType localI = halo.global2Halo(globalI);
-                assert(localI != scai::invalidIndex);
-                wNewLocalValues[i] = rHaloData[localI];
+                wNewLocalValues[i] = rHaloData[-source-1];
             }
         }
     }
@@ -1025,6 +1063,19 @@ void ITI::LocalRefinement<IndexType, ValueType>::redistributeFromHalo(
     const scai::dmemo::HaloExchangePlan& halo,
     const CSRStorage<ValueType>& haloStorage) {
 
+    const std::vector<IndexType> mergePlan = haloMergePlan(matrix.getRowDistribution(), *newDist, halo);
+    redistributeFromHalo(matrix, newDist, mergePlan, halo, haloStorage);
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void ITI::LocalRefinement<IndexType, ValueType>::redistributeFromHalo(
+    CSRSparseMatrix<ValueType>& matrix,
+    scai::dmemo::DistributionPtr newDist,
+    const std::vector<IndexType>& mergePlan,
+    const scai::dmemo::HaloExchangePlan& halo,
+    const CSRStorage<ValueType>& haloStorage) {
+
     SCAI_REGION( "LocalRefinement.redistributeFromHalo" )
 
     scai::dmemo::DistributionPtr oldDist = matrix.getRowDistributionPtr();
@@ -1036,6 +1087,7 @@ void ITI::LocalRefinement<IndexType, ValueType>::redistributeFromHalo(
     if (newDist->getGlobalSize() != globalN) {
         throw std::runtime_error("Old Distribution has " + std::to_string(globalN) + " values, new distribution has " + std::to_string(newDist->getGlobalSize()));
     }
+    SCAI_ASSERT_EQ_ERROR( mergePlan.size(), targetNumRows, "Merge plan does not fit the new distribution" );
 
     scai::hmemo::HArray<IndexType> targetIA(targetNumRows+1);
     scai::hmemo::HArray<IndexType> targetJA;
@@ -1076,30 +1128,16 @@ void ITI::LocalRefinement<IndexType, ValueType>::redistributeFromHalo(
         scai::hmemo::ReadAccess<IndexType> rHaloSizes(haloSizes);
         scai::hmemo::WriteAccess<IndexType> wTargetIA( targetIA );
 
-
-        scai::hmemo::HArray<IndexType> oldIndices;
-        oldDist->getOwnedIndexes(oldIndices);
-
-        scai::hmemo::HArray<IndexType> newIndices;
-        newDist->getOwnedIndexes(newIndices);
-
-        scai::hmemo::ReadAccess<IndexType> oldAcc(oldIndices);
-        scai::hmemo::ReadAccess<IndexType> newAcc(newIndices);
-
-        IndexType oldLocalIndex = 0;
-
         for (IndexType i = 0; i < targetNumRows; i++) {
-            IndexType newGlobalIndex = newAcc[i];
-            while(oldLocalIndex < sourceNumRows && oldAcc[oldLocalIndex] < newGlobalIndex) oldLocalIndex++;
+            const IndexType source = mergePlan[i];
             IndexType size;
-            if (oldLocalIndex < sourceNumRows && oldAcc[oldLocalIndex] == newGlobalIndex) {
+            if (source >= 0) {
                 localTargetIndices.push_back(i);
-                localSourceIndices.push_back(oldLocalIndex);
-                size = rSourceSizes[oldLocalIndex];
+                localSourceIndices.push_back(source);
+                size = rSourceSizes[source];
             } else {
+                const IndexType haloIndex = -source-1;
                 additionalLocalNodes.push_back(i);
-                const IndexType haloIndex = halo.global2Halo(newGlobalIndex);
-                assert(haloIndex != scai::invalidIndex);
                 localHaloIndices.push_back(haloIndex);
                 size = rHaloSizes[haloIndex];
             }
@@ -121,6 +121,30 @@ public:
     template<typename T>
     static void redistributeFromHalo(DenseVector<T>& input, scai::dmemo::DistributionPtr newDist, const scai::dmemo::HaloExchangePlan& halo, const scai::hmemo::HArray<T>& haloData);
 
+    /**
+     * Finds, for every element that is local in the new distribution, where to take it from.
+     * Entry i is the old local index if the element was local before, or -(haloIndex+1) if it is in the halo.
+     * Computed once and used for the matrix and all vectors that move to the same new distribution.
+     *
+     * @param[in] oldDist
+     * @param[in] newDist
+     * @param[in] halo
+     *
+     * @return The merge plan, of size newDist.getLocalSize().
+     */
+    static std::vector<IndexType> haloMergePlan(const scai::dmemo::Distribution& oldDist, const scai::dmemo::Distribution& newDist, const scai::dmemo::HaloExchangePlan& halo);
+
+    /** @brief Overloaded version that uses a precomputed merge plan.
+        \overload
+    */
+    static void redistributeFromHalo(CSRSparseMatrix<ValueType>& matrix, scai::dmemo::DistributionPtr newDistribution, const std::vector<IndexType>& mergePlan, const scai::dmemo::HaloExchangePlan& halo, const CSRStorage<ValueType>& haloMatrix);
+
+    /** @brief Overloaded version that uses a precomputed merge plan.
+        \overload
+    */
+    template<typename T>
+    static void redistributeFromHalo(DenseVector<T>& input, scai::dmemo::DistributionPtr newDist, const std::vector<IndexType>& mergePlan, const scai::hmemo::HArray<T>& haloData);
+
     /** First, it calculates the centroid of the local coordinates and then the distance of every local point to the centroid.
 
     @param[in] coordinates The coordinates of the points.
@@ -48,7 +48,9 @@ public:
         {"edgeImbalance", -1.0}, {"maxBorderNodesPercent",-1.0}, {"avgBorderNodesPercent",-1.0},
         {"maxBlockDiameter",-1.0}, {"harmMeanDiam",-1.0}, {"numDisconBlocks",-1.0},
         {"maxRedistVol",-1.0}, {"totRedistVol",-1.0},	 //redistribution metrics
-        {"maxCongestion",-1.0}, {"maxDilation",-1.0}, {"avgDilation",-1.0}, {"qap_J(C,D,P)", -1.0}//mapping metrics
+        {"maxCongestion",-1.0}, {"maxDilation",-1.0}, {"avgDilation",-1.0}, {"qap_J(C,D,P)", -1.0},//mapping metrics
+        {"truncatedKMeans",-1.0}, {"truncatedBalance",-1.0}, {"truncatedRefinement",-1.0}, //with a time budget: 1 if the phase was stopped early
+        {"skippedPreliminaryMetrics",-1.0}, {"skippedRefinement",-1.0}, {"skippedMapping",-1.0} //with a time budget: 1 if the phase was left out
     };
 
     //constructors
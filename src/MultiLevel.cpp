@@ -1,5 +1,7 @@
 #include <scai/dmemo/GenBlockDistribution.hpp>
 
+#include <unordered_map>
+
 #include "MultiLevel.h"
 #include "GraphUtils.h"
 #include "HaloPlanFns.h"
@@ -54,6 +56,13 @@ DenseVector<IndexType> ITI::MultiLevel<IndexType, ValueType>::multiLevelStep(
 
     auto origin = scai::lama::fill<DenseVector<IndexType>>(input.getRowDistributionPtr(), comm->getRank());//to track node movements through the hierarchies
 
+    //with a time budget, do not start another coarsening level after the deadline
+    if (settings.multiLevelRounds > 0 and settings.deadlinePassed(settings.refinementDeadline, comm)) {
+        PRINT0("Time budget is used, skip the remaining " << settings.multiLevelRounds << " coarsening levels");
+        metrics.MM["truncatedRefinement"] = 1;
+        settings.multiLevelRounds = 0;
+    }
+
     if (settings.multiLevelRounds > 0) {
         SCAI_REGION_START( "MultiLevel.multiLevelStep.prepareRecursiveCall" )
         CSRSparseMatrix<ValueType> coarseGraph;
@@ -158,6 +167,13 @@ DenseVector<IndexType> ITI::MultiLevel<IndexType, ValueType>::multiLevelStep(
         ValueType gain = 0;
         while (numRefinementRounds == 0 || gain >= settings.minGainForNextRound) {
 
+            //every refinement round keeps the partition valid, so stopping after any of them is safe
+            if (settings.deadlinePassed(settings.refinementDeadline, comm)) {
+                PRINT0("Time budget is used, stop local refinement after " << numRefinementRounds << " rounds");
+                metrics.MM["truncatedRefinement"] = 1;
+                break;
+            }
+
             std::chrono::time_point<std::chrono::steady_clock> beforeFMStep =  std::chrono::steady_clock::now();
 
             /* TODO: if getting the graph is fast, maybe doing it in every step might help
@@ -286,26 +302,17 @@ void MultiLevel<IndexType, ValueType>::coarsen(const CSRSparseMatrix<ValueType>&
 
     std::vector<IndexType> localFineToCoarse(localN);
 
-    scai::hmemo::HArray<IndexType> globalIndices;
-    distPtr->getOwnedIndexes(globalIndices);
-    scai::hmemo::ReadAccess<IndexType> rIndex(globalIndices);
-
     scai::lama::CSRSparseMatrix<ValueType> graph = adjM;
     SCAI_REGION_END("MultiLevel.coarsen.localCopy")
 
     for (IndexType i = 0; i < iterations; i++) {
         SCAI_REGION("MultiLevel.coarsen.localLoop");
-        // get local data of the adjacency matrix
-        const CSRStorage<ValueType>& localStorage = graph.getLocalStorage();
-        scai::hmemo::ReadAccess<IndexType> ia( localStorage.getIA() );
-        scai::hmemo::ReadAccess<IndexType> ja( localStorage.getJA() );
-        scai::hmemo::ReadAccess<ValueType> values( localStorage.getValues() );
-
-        // ia must have size localN+1
-        assert(ia.size()-1 == localN );
+        // compact copy of the local graph, non-local neighbors are always in the halo of the input graph
+        const CompactGraph<IndexType,ValueType> compactGraph( graph, halo );
+        assert(compactGraph.numLocal() == localN );
 
         //get a matching, the returned indices are from 0 to localN
-        std::vector<std::pair<IndexType,IndexType>> matching = MultiLevel<IndexType, ValueType>::maxLocalMatching( graph, localWeightCopy, coordinates, settings.nnCoarsening );
+        std::vector<std::pair<IndexType,IndexType>> matching = MultiLevel<IndexType, ValueType>::maxLocalMatching( compactGraph, localWeightCopy, coordinates, settings.nnCoarsening );
 
         std::vector<IndexType> localMatchingPartner(localN, -1);
 
@@ -363,17 +370,16 @@ void MultiLevel<IndexType, ValueType>::coarsen(const CSRSparseMatrix<ValueType>&
                 }
 
                 if (coarseNode >= 0) {
-                    for (IndexType j = ia[i]; j < ia[i+1]; j++) {
-                        IndexType edgeTarget = ja[j];
-                        IndexType localTarget = distPtr->global2Local(edgeTarget);//TODO: maybe optimize this
-                        if (localTarget != scai::invalidIndex && !localPreserved[localTarget]) {
+                    for (IndexType j = compactGraph.beginEdges(i); j < compactGraph.endEdges(i); j++) {
+                        IndexType localTarget = compactGraph.target(j);
+                        if (compactGraph.isLocal(localTarget) && !localPreserved[localTarget]) {
                             localTarget = localMatchingPartner[localTarget];
-                            edgeTarget = rIndex[localTarget];
                         }
+                        const IndexType edgeTarget = compactGraph.toGlobal(localTarget);
                         if (outgoingEdges[coarseNode].count(edgeTarget) == 0) {
                             outgoingEdges[coarseNode][edgeTarget] = 0;
                         }
-                        outgoingEdges[coarseNode][edgeTarget] += values[j];
+                        outgoingEdges[coarseNode][edgeTarget] += compactGraph.weight(j);
                     }
                 }
             }
@@ -406,9 +412,6 @@ void MultiLevel<IndexType, ValueType>::coarsen(const CSRSparseMatrix<ValueType>&
             }
 
             wIA.release();
-            ia.release();
-            ja.release();
-            values.release();
 
             //scai::lama::CSRStorage<ValueType> localStorage(1, comm->getSize(), numNeighbors, ia, ja, values);;
             HArray<IndexType> lJA(newJA.size(), newJA.data());
@@ -453,10 +456,7 @@ void MultiLevel<IndexType, ValueType>::coarsen(const CSRSparseMatrix<ValueType>&
 
     {
         SCAI_REGION("MultiLevel.coarsen.getCSRMatrix");
-        const CSRStorage<ValueType>& localStorage = graph.getLocalStorage();
-        scai::hmemo::ReadAccess<IndexType> ia( localStorage.getIA() );
-        scai::hmemo::ReadAccess<IndexType> ja( localStorage.getJA() );
-        scai::hmemo::ReadAccess<ValueType> values( localStorage.getValues() );
+        const CompactGraph<IndexType,ValueType> compactGraph( graph, halo );
 
         scai::hmemo::ReadAccess<IndexType> localPreserved(preserved);
         scai::hmemo::ReadAccess<IndexType> rHalo(haloData);
@@ -474,18 +474,17 @@ void MultiLevel<IndexType, ValueType>::coarsen(const CSRSparseMatrix<ValueType>&
 
             if (localPreserved[i]) {
                 assert(jaIndex == newIAWrite[iaIndex]);
-                for (IndexType j = ia[i]; j < ia[i+1]; j++) {
+                for (IndexType j = compactGraph.beginEdges(i); j < compactGraph.endEdges(i); j++) {
                     //only need to reroute nonlocal edges
-                    IndexType localNeighbor = distPtr->global2Local(ja[j]);
+                    const IndexType neighbor = compactGraph.target(j);
 
-                    if (localNeighbor != scai::invalidIndex) {
-                        assert(outgoingEdges.count(rFineToCoarse[localNeighbor]) == 0);
-                        outgoingEdges[rFineToCoarse[localNeighbor]] = values[j];
+                    if (compactGraph.isLocal(neighbor)) {
+                        assert(outgoingEdges.count(rFineToCoarse[neighbor]) == 0);
+                        outgoingEdges[rFineToCoarse[neighbor]] = compactGraph.weight(j);
                     } else {
-                        IndexType haloIndex = halo.global2Halo(ja[j]);
-                        assert(haloIndex != scai::invalidIndex);
+                        const IndexType haloIndex = compactGraph.ghostIndex(neighbor);
                         if (outgoingEdges.count(rHalo[haloIndex]) == 0)  outgoingEdges[rHalo[haloIndex]] = 0;
-                        outgoingEdges[rHalo[haloIndex]] += values[j];
+                        outgoingEdges[rHalo[haloIndex]] += compactGraph.weight(j);
                     }
                 }
 
@@ -669,25 +668,21 @@ DenseVector<ValueType> MultiLevel<IndexType, ValueType>::sumToCoarse(const Dense
 
 template<typename IndexType, typename ValueType>
 std::vector<std::pair<IndexType,IndexType>> MultiLevel<IndexType, ValueType>::maxLocalMatching(const scai::lama::CSRSparseMatrix<ValueType>& adjM, const DenseVector<ValueType>& nodeWeights, const std::vector<DenseVector<ValueType>>& coordinates, bool nnCoarsening) {
+    const CompactGraph<IndexType,ValueType> compactGraph(adjM, GraphUtils<IndexType, ValueType>::buildNeighborHalo(adjM));
+    return maxLocalMatching(compactGraph, nodeWeights, coordinates, nnCoarsening);
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+std::vector<std::pair<IndexType,IndexType>> MultiLevel<IndexType, ValueType>::maxLocalMatching(const CompactGraph<IndexType,ValueType>& graph, const DenseVector<ValueType>& nodeWeights, const std::vector<DenseVector<ValueType>>& coordinates, bool nnCoarsening) {
     SCAI_REGION("MultiLevel.maxLocalMatching");
 
-    const scai::dmemo::DistributionPtr distPtr = adjM.getRowDistributionPtr();
-    const scai::dmemo::CommunicatorPtr comm = distPtr->getCommunicatorPtr();
-
-    // get local data of the adjacency matrix
-    const CSRStorage<ValueType>& localStorage = adjM.getLocalStorage();
-    scai::hmemo::ReadAccess<IndexType> ia( localStorage.getIA() );
-    scai::hmemo::ReadAccess<IndexType> ja( localStorage.getJA() );
-    scai::hmemo::ReadAccess<ValueType> values( localStorage.getValues() );
-    
     // get local part of node weights
     scai::hmemo::ReadAccess<ValueType> rLocalNodeWeights( nodeWeights.getLocalValues() );
 
     // localN= number of local nodes
-    const IndexType localN= adjM.getLocalNumRows();
+    const IndexType localN= graph.numLocal();
 
-    // ia must have size localN+1
-    assert(ia.size()-1 == localN );
     SCAI_ASSERT_EQ_ERROR( rLocalNodeWeights.size(), localN, "Size mismatch" );
 
     // the vector<vector> to return
@@ -716,19 +711,15 @@ std::vector<std::pair<IndexType,IndexType>> MultiLevel<IndexType, ValueType>::ma
 
         IndexType bestTarget;
         if( nnCoarsening ){
-            bestTarget = nnPartner( localNode, ia, values, ja, rLocalNodeWeights, distPtr, matched, rCoord0, rCoord1, rCoord2, dim);
+            bestTarget = nnPartner( localNode, graph, rLocalNodeWeights, matched, rCoord0, rCoord1, rCoord2, dim);
         }else{
-            bestTarget = edgeRatingPartner( localNode, ia, values, ja, rLocalNodeWeights, distPtr, matched);
+            bestTarget = edgeRatingPartner( localNode, graph, rLocalNodeWeights, matched);
         }
 
         if (bestTarget > 0) {
-            IndexType globalNgbr = ja[bestTarget];
-
-            // at this point -globalNgbr- is the local node with the heaviest edge
-            // and should be matched with -localNode-.
-            // So, actually, globalNgbr is also local....
-            IndexType localNgbr = distPtr->global2Local(globalNgbr);
-            assert(localNgbr != scai::invalidIndex);
+            // the target of the best edge is local and should be matched with -localNode-.
+            const IndexType localNgbr = graph.target(bestTarget);
+            assert(graph.isLocal(localNgbr));
             //TODO: search neighbors for the heaviest edge
             matching.push_back( std::pair<IndexType,IndexType> (localNode, localNgbr) );
 
@@ -738,26 +729,25 @@ std::vector<std::pair<IndexType,IndexType>> MultiLevel<IndexType, ValueType>::ma
         }
     }
 
-    assert(ia[ia.size()-1] >= 0);
-
     return matching;
 }
 //---------------------------------------------------------------------------------------
 
 template<typename IndexType, typename ValueType>
-IndexType MultiLevel<IndexType, ValueType>::edgeRatingPartner(  const IndexType localNode, const scai::hmemo::ReadAccess<IndexType>& ia, const scai::hmemo::ReadAccess<ValueType>& values, const scai::hmemo::ReadAccess<IndexType>& ja, const scai::hmemo::ReadAccess<ValueType>& localNodeWeights, const scai::dmemo::DistributionPtr distPtr, const std::vector<bool>& matched){
+IndexType MultiLevel<IndexType, ValueType>::edgeRatingPartner(  const IndexType localNode, const CompactGraph<IndexType,ValueType>& graph, const scai::hmemo::ReadAccess<ValueType>& localNodeWeights, const std::vector<bool>& matched){
     SCAI_REGION("MultiLevel.edgeRatingPartner");
 
     IndexType bestTarget = -1;
     ValueType maxEdgeRating = -1;
 
-    const IndexType endCols = ia[localNode+1];
-    for (IndexType j = ia[localNode]; j < endCols; j++) {
-        IndexType localNeighbor = distPtr->global2Local(ja[j]);
-    
-        if (localNeighbor != scai::invalidIndex && localNeighbor != localNode && !matched[localNeighbor]) {
+    const IndexType endCols = graph.endEdges(localNode);
+    for (IndexType j = graph.beginEdges(localNode); j < endCols; j++) {
+        const IndexType localNeighbor = graph.target(j);
+
+        if (graph.isLocal(localNeighbor) && localNeighbor != localNode && !matched[localNeighbor]) {
             //neighbor is local and unmatched, possible partner
-            ValueType thisEdgeRating = values[j]*values[j]/(localNodeWeights[localNode]*localNodeWeights[localNeighbor]);
+            const ValueType edgeWeight = graph.weight(j);
+            ValueType thisEdgeRating = edgeWeight*edgeWeight/(localNodeWeights[localNode]*localNodeWeights[localNeighbor]);
 
             if (bestTarget < 0 ||  thisEdgeRating > maxEdgeRating) {
                 //either we haven't found any target yet, or the current one is better
@@ -771,7 +761,7 @@ IndexType MultiLevel<IndexType, ValueType>::edgeRatingPartner(  const IndexType
 //---------------------------------------------------------------------------------------
 
 template<typename IndexType, typename ValueType>
-IndexType MultiLevel<IndexType, ValueType>::nnPartner(  const IndexType localNode, const scai::hmemo::ReadAccess<IndexType>& ia, const scai::hmemo::ReadAccess<ValueType>& values, const scai::hmemo::ReadAccess<IndexType>& ja, const scai::hmemo::ReadAccess<ValueType>& localNodeWeights, const scai::dmemo::DistributionPtr distPtr, const std::vector<bool>& matched, const scai::hmemo::ReadAccess<ValueType> &coord0, const scai::hmemo::ReadAccess<ValueType> &coord1, const scai::hmemo::ReadAccess<ValueType> &coord2, const int dim){
+IndexType MultiLevel<IndexType, ValueType>::nnPartner(  const IndexType localNode, const CompactGraph<IndexType,ValueType>& graph, const scai::hmemo::ReadAccess<ValueType>& localNodeWeights, const std::vector<bool>& matched, const scai::hmemo::ReadAccess<ValueType> &coord0, const scai::hmemo::ReadAccess<ValueType> &coord1, const scai::hmemo::ReadAccess<ValueType> &coord2, const int dim){
     SCAI_REGION("MultiLevel.nnPartner");
 
     IndexType nn = -1;
@@ -783,11 +773,11 @@ IndexType MultiLevel<IndexType, ValueType>::nnPartner(  const IndexType localNod
     if(dim==3)
         thisPoint[2] = coord2[localNode];
 
-    const IndexType endCols = ia[localNode+1];
-    for (IndexType j = ia[localNode]; j < endCols; j++) {
-        IndexType localNeighbor = distPtr->global2Local(ja[j]);
+    const IndexType endCols = graph.endEdges(localNode);
+    for (IndexType j = graph.beginEdges(localNode); j < endCols; j++) {
+        const IndexType localNeighbor = graph.target(j);
 
-        if (localNeighbor != scai::invalidIndex && localNeighbor != localNode && !matched[localNeighbor]) {
+        if (graph.isLocal(localNeighbor) && localNeighbor != localNode && !matched[localNeighbor]) {
             //neighbor is local and unmatched, possible partner
             
             std::vector<ValueType> ngbrPoint(dim);
@@ -816,257 +806,192 @@ scai::lama::CSRSparseMatrix<ValueType> MultiLevel<IndexType, ValueType>::pixeled
     const scai::lama::CSRSparseMatrix<ValueType>& adjM,
     const std::vector<DenseVector<ValueType>> &coordinates,
     DenseVector<ValueType> &nodeWeights,
+    std::vector<IndexType> &pixelIds,
     Settings settings) {
     SCAI_REGION( "MultiLevel.pixeledCoarsen" )
 
-    const scai::dmemo::DistributionPtr coordDist = coordinates[0].getDistributionPtr();
     const scai::dmemo::DistributionPtr inputDist = adjM.getRowDistributionPtr();
-    const scai::dmemo::CommunicatorPtr comm = coordDist->getCommunicatorPtr();
+    const scai::dmemo::CommunicatorPtr comm = inputDist->getCommunicatorPtr();
 
-    //IndexType k = settings.numBlocks;
     const IndexType dimensions = coordinates.size();
     const IndexType localN = inputDist->getLocalSize();
     const IndexType globalN = inputDist->getGlobalSize();
 
-    std::vector<ValueType> maxCoords(dimensions, std::numeric_limits<ValueType>::lowest());
-    std::vector<ValueType> minCoords(dimensions, std::numeric_limits<ValueType>::max());
-    DenseVector<IndexType> result(inputDist, 0);
-
-    //TODO: if we know maximum from the input we could save that although is not too costly
-
-    /**
-     * get maximum of local coordinates
-     */
-    for (IndexType dim = 0; dim < dimensions; dim++) {
-        //get local parts of coordinates
-        const HArray<ValueType>& localPartOfCoords = coordinates[dim].getLocalValues();
-        for (IndexType i = 0; i < localN; i++) {
-            ValueType coord = localPartOfCoords[i];
-            if(coord > maxCoords[dim]) maxCoords[dim] = coord;
-            if(coord < minCoords[dim]) minCoords[dim] = coord;
-        }
-    }
-
-    /**
-     * communicate to get global  max
-     */
-    for (IndexType dim = 0; dim < dimensions; dim++) {
-        maxCoords[dim] = comm->max(maxCoords[dim]);
-        minCoords[dim] = comm->min(minCoords[dim]);
-    }
-
-    // measure density with rounding
-    // have to handle 2D and 3D cases seperately
-    //const unsigned int detailLvl = settings.pixeledDetailLevel;
-    //const unsigned long sideLen = std::pow(2,detailLvl);
-    const unsigned long sideLen = settings.pixeledSideLen;
-    const unsigned long cubeSize = std::pow(sideLen, dimensions);
-
-    if(cubeSize > globalN) {
-        std::cout<< "Warning, in pixeledCoarsen, pixeled graph size bigger than input size. Not actually a coarsening" << std::endl;
+    if( dimensions!=2 and dimensions!=3 ) {
+        throw std::runtime_error("Available only for 2D and 3D. Data given have dimension:" + std::to_string(dimensions) );
     }
 
-    //TODO: generalize this to arbitrary dimensions, do not handle 2D and 3D differently
-    // maybe a 2D or 3D arrays as a one dimensional vector?
-    // [i][j] is in position: i*sideLen + j
-    // [i][j][k] is in: i*sideLen*sideLen + j*sideLen + k
-
-    scai::hmemo::HArray<IndexType> density( cubeSize, IndexType(0) );
-
-    // initialize pixelGraph
-    scai::hmemo::HArray<IndexType> pixelIA;
-    scai::hmemo::HArray<IndexType> pixelJA;
-    scai::hmemo::HArray<ValueType> pixelValues;
+    const IndexType sideLen = settings.pixeledSideLen;
+    //edges are stored per pixel and direction
+    SCAI_ASSERT_LT_ERROR( 2*dimensions*std::pow(double(sideLen), dimensions), double(std::numeric_limits<IndexType>::max()), "Too many pixels for the index type, reduce the side length" );
 
-    // here we assume that all edges exist in the pixeled graph. That might not be true. After we add the edges that
-    // do exist, we add all missing edges with a small weight.
-    // the number of edges in a 3D grid is 3ABC-AB-AC-BC. if A=B=C we get the next formula for 3D and this is generalized for higher dimensions
-    IndexType nnzValues= 2*dimensions*(std::pow(sideLen, dimensions) - std::pow(sideLen, dimensions-1) );
-    {
-        scai::hmemo::WriteOnlyAccess<IndexType> wPixelIA( pixelIA, cubeSize+1 );
-        scai::hmemo::WriteOnlyAccess<IndexType> wPixelJA( pixelJA, nnzValues);
-        scai::hmemo::WriteOnlyAccess<ValueType> wPixelValues( pixelValues, nnzValues);
-        wPixelIA[0] = 0;
-        IndexType nnzCounter =0;
-
-        for(IndexType i=0; i<cubeSize; i++) {
-            // the indices of the neighbouring pixels
-            std::vector<IndexType> ngbrPixels = ParcoRepart<IndexType, ValueType>::neighbourPixels(i, sideLen, dimensions);
-            wPixelIA[i+1] = wPixelIA[i] + ngbrPixels.size();
-            SCAI_ASSERT(ngbrPixels.size() <= 2*dimensions, "Too many neighbouring pixels.");
-
-            for(IndexType s=0; s<ngbrPixels.size(); s++) {
-                SCAI_ASSERT( nnzCounter < nnzValues, "Non-zero values for CSRSparseMatrix: "<< nnzValues << " not calculated correctly.");
-                wPixelJA[nnzCounter]= ngbrPixels[s];
-                wPixelValues[nnzCounter] = 0.0;
-                ++nnzCounter;
-            }
-        }
+    // the pixel of every local point and of the non-local neighbors
+    const std::vector<IndexType> localPixel = ParcoRepart<IndexType, ValueType>::localPixels(coordinates, sideLen);
+    scai::dmemo::HaloExchangePlan halo = GraphUtils<IndexType, ValueType>::buildNeighborHalo(adjM);
+    HArray<IndexType> haloPixels;
+    halo.updateHalo( haloPixels, HArray<IndexType>(localPixel.size(), localPixel.data()), *comm );
 
-        SCAI_ASSERT( nnzCounter == wPixelValues.size(), "Wrong values size for CSR matrix: " << wPixelValues.size() );
-        SCAI_ASSERT( nnzCounter == wPixelJA.size(), "Wrong ja size for CSR matrix: " << wPixelJA.size());
-        SCAI_ASSERT( wPixelIA[cubeSize] == nnzCounter, "Wrong ia for CSR matrix." );
+    // [i][j] is in position: i*sideLen + j, [i][j][k] is in: i*sideLen*sideLen + j*sideLen + k
+    std::vector<IndexType> strides(dimensions, 1);
+    for(IndexType d=dimensions-1; d>0; d--) {
+        strides[d-1] = strides[d]*sideLen;
     }
+    auto pixelCoord = [&](const IndexType pixel, const IndexType d) {
+        return (pixel/strides[d])%sideLen;
+    };
 
-    // get halo for the non-local coordinates
-    scai::dmemo::HaloExchangePlan coordHalo = GraphUtils<IndexType, ValueType>::buildNeighborHalo(adjM);
-    std::vector<HArray<ValueType>> coordHaloData(dimensions);
-    for(int d=0; d<dimensions; d++) {
-        coordHalo.updateHalo( coordHaloData[d], coordinates[d].getLocalValues(), *comm );
-    }
+    // only occupied pixels and the edges between them are stored, so memory and communication
+    // grow with the number of points and not with sideLen^dimensions
+    std::unordered_map<IndexType,ValueType> localDensity;
+    // key: pixel*2*dimensions + 2*d for the neighbor below in dimension d, +1 for the neighbor above
+    std::unordered_map<IndexType,ValueType> localPixelEdges;
 
     //TODO?: if we also count diagonal edges, in 2D, every pixel will have 8 neighbors.
     IndexType notCountedPixelEdges = 0; //edges between diagonal pixels are not counted on purpose
 
-
-    if( dimensions==2 or dimensions==3 ) {
+    {
         SCAI_REGION( "MultiLevel.pixeledCoarsen.localDensity" )
-        scai::hmemo::WriteAccess<IndexType> wDensity(density);
-        scai::hmemo::ReadAccess<ValueType> coordAccess0( coordinates[0].getLocalValues() );
-        scai::hmemo::ReadAccess<ValueType> coordAccess1( coordinates[1].getLocalValues() );
-
-        //in case of dimensions==3, the third coord is correct;
-        //	 in case dimensions==2, is the second coordinate, so it the wrong one, but is never used
-        const HArray<ValueType>* thirdCoord = &coordinates[1].getLocalValues();
-        if(dimensions==3)
-            thirdCoord = &coordinates[2].getLocalValues();
-
-        scai::hmemo::ReadAccess<ValueType> coordAccess2( (*thirdCoord) );
-
         const CSRStorage<ValueType>& localStorage = adjM.getLocalStorage();
         scai::hmemo::ReadAccess<IndexType> ia(localStorage.getIA());
         scai::hmemo::ReadAccess<IndexType> ja(localStorage.getJA());
-
-        ValueType denomX = maxCoords[0]-minCoords[0]+1;
-        ValueType denomY = maxCoords[1]-minCoords[1]+1;
-        ValueType denomZ = 1;
-
-        if(dimensions==3) {
-            denomZ = maxCoords[2]-minCoords[2]+1;
-        }
-
-        IndexType scaledX, scaledY;
-        IndexType scaledZ=0; //this will not be further used in case of 2 dimensions
+        scai::hmemo::ReadAccess<IndexType> rHaloPixels(haloPixels);
 
         for(IndexType i=0; i<localN; i++) {
+            const IndexType thisPixel = localPixel[i];
+            ++localDensity[thisPixel];
 
-            //scale each point to get a pixeled coord between [0,cubeSize-1]
-            scaledX = (ValueType(coordAccess0[i]-minCoords[0])/denomX)*sideLen;
-            scaledY = (ValueType(coordAccess1[i]-minCoords[1])/denomY)*sideLen;
-            if(dimensions==3) {
-                scaledZ = (ValueType(coordAccess2[i]-minCoords[2])/denomZ)*sideLen;
-            }
-
-            IndexType thisPixel = 	scaledX*std::pow(sideLen, dimensions-1) +
-                                    scaledY*std::pow(sideLen, dimensions-2) +
-                                    scaledZ; //this is 0 if dimensions==2
-
-            //wDensity.size()=cubeSize
-            SCAI_ASSERT( thisPixel < wDensity.size(), "Index too big: "<< std::to_string(thisPixel) );
-
-            ++wDensity[thisPixel];
-
-            scai::hmemo::WriteAccess<IndexType> wPixelIA( pixelIA );
-            scai::hmemo::WriteAccess<IndexType> wPixelJA( pixelJA );
-            scai::hmemo::WriteAccess<ValueType> wPixelValues( pixelValues );
-
-            // check the neighbours to fix the pixeledEdge weights
-            const IndexType beginCols = ia[i];
-            const IndexType endCols = ia[i+1];
-            assert(ja.size() >= endCols);
+            for (IndexType j = ia[i]; j < ia[i+1]; j++) {
+                const IndexType neighbor = ja[j];
+                const IndexType localNeighbor = inputDist->global2Local(neighbor);
+                const IndexType ngbrPixel = localNeighbor != scai::invalidIndex ? localPixel[localNeighbor] : rHaloPixels[halo.global2Halo(neighbor)];
 
-            for (IndexType j = beginCols; j < endCols; j++) {
-                IndexType neighbor = ja[j];
-
-                // find the neighbor's pixel
-                ValueType ngbrX, ngbrY;
-                ValueType ngbrZ = minCoords[2]; // in case dimensions=3
-                if( coordDist->isLocal(neighbor) ) {
-                    ngbrX = coordAccess0[ coordDist->global2Local(neighbor) ];
-                    ngbrY = coordAccess1[ coordDist->global2Local(neighbor) ];
-                    if(dimensions==3)
-                        ngbrZ = coordAccess2[ coordDist->global2Local(neighbor) ];
-                } else {
-                    ngbrX = coordHaloData[0][ coordHalo.global2Halo(neighbor) ];
-                    ngbrY = coordHaloData[1][ coordHalo.global2Halo(neighbor) ];
-                    if(dimensions==3)
-                        ngbrZ = coordHaloData[2][ coordHalo.global2Halo(neighbor) ];
+                if( ngbrPixel == thisPixel ) {
+                    continue;
                 }
 
-                //the pixel the our neighbor resides
-                IndexType ngbrPixelIndex =
-                    std::pow(sideLen, dimensions-1)*(IndexType (sideLen*(ValueType(ngbrX-minCoords[0])/denomX) )) +
-                    std::pow(sideLen, dimensions-2)*(IndexType (sideLen*(ValueType(ngbrY-minCoords[1])/denomY) )) +
-                    IndexType ( sideLen*(ValueType (ngbrZ-minCoords[2])/denomZ) ); // this is 0 if dimensions=3
-
-                SCAI_ASSERT( ngbrPixelIndex < cubeSize, "Index too big: "<< ngbrPixelIndex <<". Should be less than: "<< cubeSize);
-
-                if( ngbrPixelIndex != thisPixel ) { // neighbor not in the same pixel, find the correct pixel
-                    const IndexType pixelBeginCols = wPixelIA[thisPixel];
-                    const IndexType pixelEndCols = wPixelIA[thisPixel+1];
-                    bool ngbrNotFound = true;
-
-                    for(IndexType p= pixelBeginCols; p<pixelEndCols; p++) {
-                        IndexType thisPixelOtherNeighbor = wPixelJA[p];
-                        SCAI_ASSERT(thisPixelOtherNeighbor < cubeSize, "Index too big." << ngbrPixelIndex );
-                        if( thisPixelOtherNeighbor == ngbrPixelIndex ) {  // add in edge weights
-                            ++wPixelValues[ p ];
-                            ngbrNotFound = false;
-                            break;
-                        }
+                // only pixels that share a facet are adjacent in the pixeled graph
+                IndexType differentDims = 0;
+                IndexType direction = 0;
+                bool adjacent = true;
+                for(IndexType d=0; d<dimensions; d++) {
+                    const IndexType own = pixelCoord(thisPixel, d);
+                    const IndexType other = pixelCoord(ngbrPixel, d);
+                    if( own == other ) continue;
+                    differentDims++;
+                    if( other == own+1 ) {
+                        direction = 2*d+1;
+                    } else if( other+1 == own ) {
+                        direction = 2*d;
+                    } else {
+                        adjacent = false;
                     }
+                }
+
+                if( adjacent and differentDims == 1 ) {
+                    ++localPixelEdges[thisPixel*2*dimensions + direction];
+                } else {
                     // somehow got a pixel as neighbour that is either far (maybe graph is not a mesh?) or share only
                     // a corner with thisPixel, not a cube facet
-                    if( ngbrNotFound ) {
-                        ++notCountedPixelEdges;
-                    }
+                    ++notCountedPixelEdges;
                 }
             }
         }
-    } else {
-        throw std::runtime_error("Available only for 2D and 3D. Data given have dimension:" + std::to_string(dimensions) );
     }
 
-    //PRINT(notCountedPixelEdges);
     IndexType sumMissingEdges = comm->sum(notCountedPixelEdges);
-
     PRINT0("not counted pixel edges= " << sumMissingEdges );
 
-    // sum node weights of the pixeled graph
-    SCAI_ASSERT( nodeWeights.getDistributionPtr()->isReplicated() == true, "Node weights of the pixeled graph should be replicated (at least for now).");
-    nodeWeights.allocate(density.size());
+    std::vector<ValueType> density;
+    std::vector<IndexType> edgeKeys;
+    std::vector<ValueType> edgeValues;
+    pixelIds.clear();
+    for(const auto& pixel : localDensity) {
+        pixelIds.push_back(pixel.first);
+        density.push_back(pixel.second);
+    }
+    for(const auto& edge : localPixelEdges) {
+        edgeKeys.push_back(edge.first);
+        edgeValues.push_back(edge.second);
+    }
 
     {
         SCAI_REGION( "Multilevel.pixeledCoarsen.sumDensity" )
-        comm->sumArray( density );
+        ParcoRepart<IndexType, ValueType>::sumSparse( pixelIds, density, comm );
+    }
+    {
+        SCAI_REGION( "Multilevel.pixeledCoarsen.sumValues" )
+        ParcoRepart<IndexType, ValueType>::sumSparse( edgeKeys, edgeValues, comm );
     }
 
-    scai::hmemo::WriteAccess<IndexType> wDensity(density);
-    for(int i=0; i<density.size(); i++) {
-        nodeWeights.getLocalValues()[i] = wDensity[i];
+    const IndexType numPixels = pixelIds.size();
+    if(numPixels == globalN) {
+        PRINT0("Warning, in pixeledCoarsen, every point is in its own pixel. Not actually a coarsening");
     }
-    wDensity.release();
 
+    // the node weights of the pixeled graph
+    SCAI_ASSERT( nodeWeights.getDistributionPtr()->isReplicated() == true, "Node weights of the pixeled graph should be replicated (at least for now).");
+    nodeWeights.allocate(numPixels);
     {
-        SCAI_REGION( "Multilevel.pixeledCoarsen.sumValues" )
-        // sum the values from all PEs
-        comm->sumArray( pixelValues);
+        scai::hmemo::WriteAccess<ValueType> wWeights(nodeWeights.getLocalValues());
+        std::copy(density.begin(), density.end(), wWeights.get());
     }
 
-    // add a lightweight edge to isolated pixels. Hope this does not affect the spectral partition
-    // or any other usage.
-    //PRINT(*comm << ": " << nnzValues);
-    for(int i=0; i<pixelValues.size(); i++) {
-        scai::hmemo::WriteAccess<ValueType> wPixelValues( pixelValues );
-        if(wPixelValues[i]==0) {
-            //PRINT(*comm<< ": " << i );
-            wPixelValues[i]=1e-10;
+    // row of an occupied pixel, or invalidIndex if the pixel is empty
+    auto rowOf = [&pixelIds](const IndexType pixel) {
+        const auto it = std::lower_bound(pixelIds.begin(), pixelIds.end(), pixel);
+        return (it != pixelIds.end() and *it == pixel) ? IndexType(it - pixelIds.begin()) : scai::invalidIndex;
+    };
+
+    std::vector<IndexType> pixelIA(numPixels+1, 0);
+    std::vector<IndexType> pixelJA;
+    std::vector<ValueType> pixelValues;
+
+    for(IndexType row=0; row<numPixels; row++) {
+        const IndexType pixel = pixelIds[row];
+        for(IndexType d=0; d<dimensions; d++) {
+            for(IndexType above=0; above<2; above++) {
+                const IndexType coord = pixelCoord(pixel, d);
+                if( (above==0 and coord==0) or (above==1 and coord==sideLen-1) ) {
+                    continue;
+                }
+                const IndexType column = rowOf( above ? pixel+strides[d] : pixel-strides[d] );
+                if( column == scai::invalidIndex ) {
+                    continue;
+                }
+                const IndexType key = pixel*2*dimensions + 2*d + above;
+                const auto edge = std::lower_bound(edgeKeys.begin(), edgeKeys.end(), key);
+                ValueType weight = (edge != edgeKeys.end() and *edge == key) ? edgeValues[edge - edgeKeys.begin()] : 0;
+
+                // add a lightweight edge between neighbouring occupied pixels without edges between them.
+                // Hope this does not affect the spectral partition or any other usage.
+                if( weight == 0 ) {
+                    weight = 1e-10;
+                }
+                pixelJA.push_back(column);
+                pixelValues.push_back(weight);
+            }
         }
-    }
 
-    scai::lama::CSRStorage<ValueType> pixelStorage;
+        // empty pixels are not stored, so occupied pixels separated by empty ones would be disconnected and
+        // the spectral partition fails. As the former empty pixels with lightweight edges did, connect the pixels
+        // that are consecutive in the pixel order: along the last dimension across the gap and from the end
+        // of a line to the start of the next occupied line
+        for(const IndexType column : {row-1, row+1}) {
+            if( column < 0 or column >= numPixels ) {
+                continue;
+            }
+            if( std::find(pixelJA.begin()+pixelIA[row], pixelJA.end(), column) == pixelJA.end() ) {
+                pixelJA.push_back(column);
+                pixelValues.push_back(1e-10);
+            }
+        }
+        pixelIA[row+1] = pixelJA.size();
+    }
 
-    pixelStorage.setCSRData( cubeSize, cubeSize, pixelIA, pixelJA, pixelValues);
+    scai::lama::CSRStorage<ValueType> pixelStorage( numPixels, numPixels,
+            HArray<IndexType>(pixelIA.size(), pixelIA.data()),
+            HArray<IndexType>(pixelJA.size(), pixelJA.data()),
+            HArray<ValueType>(pixelValues.size(), pixelValues.data()) );
 
     scai::lama::CSRSparseMatrix<ValueType> pixelGraph( std::move( pixelStorage ) );
 
@@ -18,6 +18,7 @@
 #include <scai/tracing.hpp>
 
 #include "AuxiliaryFunctions.h"
+#include "CompactGraph.h"
 #include "LocalRefinement.h"
 #include "Settings.h"
 #include "Metrics.h" //needed for profiling, remove is not used
@@ -95,6 +96,12 @@ public:
      */
     static std::vector<std::pair<IndexType,IndexType>> maxLocalMatching(const scai::lama::CSRSparseMatrix<ValueType>& graph, const DenseVector<ValueType> &nodeWeights, const std::vector<DenseVector<ValueType>>& coordinates, bool nnCoarsening=false );
 
+    /**
+     * @brief Perform a local maximum matching on the compact copy of the local graph.
+     * \overload
+     */
+    static std::vector<std::pair<IndexType,IndexType>> maxLocalMatching(const CompactGraph<IndexType,ValueType>& graph, const DenseVector<ValueType> &nodeWeights, const std::vector<DenseVector<ValueType>>& coordinates, bool nnCoarsening=false );
+
     /**
      * @brief Project a fine DenseVector to a coarse DenseVector. Values are interpolated linearly.
      *
@@ -132,28 +139,30 @@ public:
     static DenseVector<T> computeGlobalPrefixSum(const DenseVector<T> &input, T offset = 0);
 
     /**
-     * Creates a coarsened graph using geometric information. Rounds every point according to settings.pixeledDetailLevel
-     * creating a grid of size 2^k x 2^k (for 2D) where k=\p settings.detailLevel. Every coarse node/pixel of the
-     * grid has weight equal the number of points it contains. The edge between two coarse nodes/pixels is the
-     * number of edges of the input graph that their endpoints belong to different pixels.
+     * Creates a coarsened graph using geometric information. Rounds every point into a grid with settings.pixeledSideLen
+     * pixels per dimension over the bounding box of the points. Every occupied pixel becomes a coarse node with weight
+     * equal to the number of points it contains, empty pixels are left out, so the size of the pixeled graph grows with
+     * the number of points and not with the resolution. The edge between two coarse nodes/pixels that share a facet is the
+     * number of edges of the input graph that their endpoints belong to these pixels.
      *
-     * @warning: can happen that pixels are empty, this would create isolated vertices in the pixeled graph
-     *          which is not so good for spectral partitioning. To avoid that, we add every edge in the isolated
-     *          vertices with a small weight of 0.001. This might cause other problems though, so have it in mind.
+     * @warning: neighbouring occupied pixels without edges between them, and pixels that are consecutive in the pixel
+     *          order, are connected with a small weight of 1e-10 so the graph is connected, as spectral partitioning
+     *          needs. This might cause other problems though, so have it in mind.
      *
      * @param[in] adjM The adjacency matrix of the input graph
      * @param[in] coordinates The coordinates of the input points.
      * @param[out] nodeWeights The weights for the coarse nodes/pixels of the returned graph.
-     * @param[in] settings Describe different setting for the coarsening. Here we need settings.pixeledDetailLevel.
-     * @return The adjacency matrix of the coarsened/pixeled graph. This has side length 2^detailLevel and the whole size is dimension^sideLength.
+     * @param[out] pixelIds The sorted ids of the occupied pixels, one per row of the returned graph, numbered as in ParcoRepart::localPixels.
+     * @param[in] settings Describe different setting for the coarsening. Here we need settings.pixeledSideLen.
+     * @return The adjacency matrix of the coarsened/pixeled graph, replicated on all PEs.
      */
-    static scai::lama::CSRSparseMatrix<ValueType> pixeledCoarsen (const CSRSparseMatrix<ValueType>& adjM, const std::vector<DenseVector<ValueType>> &coordinates, DenseVector<ValueType> &nodeWeights, Settings settings);
+    static scai::lama::CSRSparseMatrix<ValueType> pixeledCoarsen (const CSRSparseMatrix<ValueType>& adjM, const std::vector<DenseVector<ValueType>> &coordinates, DenseVector<ValueType> &nodeWeights, std::vector<IndexType> &pixelIds, Settings settings);
 
 private:
 
-    static IndexType edgeRatingPartner( const IndexType localNode, const scai::hmemo::ReadAccess<IndexType>& ia, const scai::hmemo::ReadAccess<ValueType>& values, const scai::hmemo::ReadAccess<IndexType>& ja, const scai::hmemo::ReadAccess<ValueType>& localNodeWeights, const scai::dmemo::DistributionPtr distPtr, const std::vector<bool>& matched);
+    static IndexType edgeRatingPartner( const IndexType localNode, const CompactGraph<IndexType,ValueType>& graph, const scai::hmemo::ReadAccess<ValueType>& localNodeWeights, const std::vector<bool>& matched);
 
-    static IndexType nnPartner( const IndexType localNode, const scai::hmemo::ReadAccess<IndexType>& ia, const scai::hmemo::ReadAccess<ValueType>& values, const scai::hmemo::ReadAccess<IndexType>& ja, const scai::hmemo::ReadAccess<ValueType>& localNodeWeights, const scai::dmemo::DistributionPtr distPtr, const std::vector<bool>& matched,  const scai::hmemo::ReadAccess<ValueType> &coord0, const scai::hmemo::ReadAccess<ValueType> &coord1, const scai::hmemo::ReadAccess<ValueType> &coord2, const int dim);    
+    static IndexType nnPartner( const IndexType localNode, const CompactGraph<IndexType,ValueType>& graph, const scai::hmemo::ReadAccess<ValueType>& localNodeWeights, const std::vector<bool>& matched,  const scai::hmemo::ReadAccess<ValueType> &coord0, const scai::hmemo::ReadAccess<ValueType> &coord1, const scai::hmemo::ReadAccess<ValueType> &coord2, const int dim);
 
 }; // class MultiLevel
 } // namespace ITI
@@ -16,6 +16,7 @@
 #include <cstdlib>
 #include <numeric>
 #include <chrono>
+#include <queue>
 
 #include "MeshGenerator.h"
 #include "FileIO.h"
@@ -365,8 +366,9 @@ TYPED_TEST (MultiLevelTest, testPixeledCoarsen_2D) {
             }
 
             DenseVector<ValueType> pixelWeights;
+            std::vector<IndexType> pixelIds;
 
-            scai::lama::CSRSparseMatrix<ValueType> pixelGraph = MultiLevel<IndexType, ValueType>::pixeledCoarsen(graph, coords, pixelWeights, settings);
+            scai::lama::CSRSparseMatrix<ValueType> pixelGraph = MultiLevel<IndexType, ValueType>::pixeledCoarsen(graph, coords, pixelWeights, pixelIds, settings);
 
             std::chrono::duration<double> elapsedSeconds = std::chrono::steady_clock::now() - start;
             double maxElapsedTime = comm->max( elapsedSeconds.count() );
@@ -382,10 +384,40 @@ TYPED_TEST (MultiLevelTest, testPixeledCoarsen_2D) {
             SCAI_ASSERT_EQ_ERROR( pixelWeights.sum(), N, "should ne equal");
             EXPECT_LE( pixelGraph.l1Norm(), edges);
 
-            IndexType nnzValues= 2*dimensions*(std::pow(sideLen, dimensions) - std::pow(sideLen, dimensions-1) );
+            //only occupied pixels are in the graph, at most the edges of the full grid and the edges between consecutive pixels
+            IndexType nnzValues= 2*dimensions*(std::pow(sideLen, dimensions) - std::pow(sideLen, dimensions-1) ) + 2*pixelIds.size();
 
-            EXPECT_EQ( nnzValues, pixelGraph.getNumValues() );
+            EXPECT_EQ( pixelIds.size(), pixelGraph.getNumRows() );
+            EXPECT_EQ( pixelIds.size(), pixelWeights.size() );
+            EXPECT_TRUE( std::is_sorted(pixelIds.begin(), pixelIds.end()) );
+            EXPECT_LT( pixelIds.back(), pixeledGraphSize );
+            EXPECT_GT( pixelWeights.min(), 0 );
+            EXPECT_LE( pixelGraph.getNumValues(), nnzValues );
             EXPECT_GE( pixelGraph.l1Norm(), 1 );
+
+            //the pixeled graph is connected, also if empty pixels lie between the occupied ones
+            {
+                const scai::lama::CSRStorage<ValueType>& storage = pixelGraph.getLocalStorage();
+                scai::hmemo::ReadAccess<IndexType> ia(storage.getIA());
+                scai::hmemo::ReadAccess<IndexType> ja(storage.getJA());
+                std::vector<bool> visited(pixelIds.size(), false);
+                std::queue<IndexType> queue;
+                queue.push(0);
+                visited[0] = true;
+                IndexType numVisited = 1;
+                while (!queue.empty()) {
+                    const IndexType v = queue.front();
+                    queue.pop();
+                    for (IndexType j = ia[v]; j < ia[v+1]; j++) {
+                        if (!visited[ja[j]]) {
+                            visited[ja[j]] = true;
+                            numVisited++;
+                            queue.push(ja[j]);
+                        }
+                    }
+                }
+                EXPECT_EQ( pixelIds.size(), numVisited );
+            }
         }// for i=2:7
 
     }//for dim
@@ -0,0 +1,166 @@
+#include <mpi.h>
+
+#include <algorithm>
+
+#include <scai/dmemo/mpi/MPICommunicator.hpp>
+#include <scai/tracing.hpp>
+
+#include "NodeShared.h"
+
+namespace ITI {
+
+template<typename T>
+struct NodeSharedArray<T>::SharedWindow {
+    MPI_Comm nodeComm = MPI_COMM_NULL;
+    MPI_Win win = MPI_WIN_NULL;
+};
+//---------------------------------------------------------------------------------------
+
+template<typename T>
+NodeSharedArray<T>::NodeSharedArray(const scai::dmemo::CommunicatorPtr comm, const IndexType size) : n(size) {
+    SCAI_REGION("NodeSharedArray.allocate");
+
+    if (comm->getType() != scai::dmemo::CommunicatorType::MPI) {
+        localCopy.resize(n);
+        ptr = localCopy.data();
+        return;
+    }
+
+    window.reset(new SharedWindow());
+    const auto& mpiComm = static_cast<const scai::dmemo::MPICommunicator&>( *comm );
+    MPI_Comm_split_type(mpiComm.getMPIComm(), MPI_COMM_TYPE_SHARED, comm->getRank(), MPI_INFO_NULL, &window->nodeComm);
+
+    int nodeRank, nodeProcesses;
+    MPI_Comm_rank(window->nodeComm, &nodeRank);
+    MPI_Comm_size(window->nodeComm, &nodeProcesses);
+    leader = nodeRank == 0;
+    numNodeProcesses = nodeProcesses;
+
+    //only the leader allocates, the others get a pointer into its segment
+    const MPI_Aint bytes = leader ? MPI_Aint(n)*sizeof(T) : 0;
+    void* base = nullptr;
+    MPI_Win_allocate_shared(bytes, sizeof(T), MPI_INFO_NULL, window->nodeComm, &base, &window->win);
+
+    MPI_Aint leaderBytes;
+    int dispUnit;
+    MPI_Win_shared_query(window->win, 0, &leaderBytes, &dispUnit, &base);
+    ptr = static_cast<T*>(base);
+
+    //one passive epoch for the whole lifetime, synchronize() orders the accesses
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, window->win);
+}
+//---------------------------------------------------------------------------------------
+
+template<typename T>
+NodeSharedArray<T>::~NodeSharedArray() {
+    if (window) {
+        MPI_Win_unlock_all(window->win);
+        MPI_Win_free(&window->win);
+        MPI_Comm_free(&window->nodeComm);
+    }
+}
+//---------------------------------------------------------------------------------------
+
+template<typename T>
+void NodeSharedArray<T>::synchronize() {
+    if (window) {
+        MPI_Win_sync(window->win);
+        MPI_Barrier(window->nodeComm);
+        MPI_Win_sync(window->win);
+    }
+}
+//---------------------------------------------------------------------------------------
+
+template<typename T>
+void NodeSharedArray<T>::allGather(const scai::dmemo::CommunicatorPtr comm, const T* localValues, const IndexType localSize) {
+    SCAI_REGION("NodeSharedArray.allGather");
+
+    if (!window) {
+        SCAI_ASSERT_EQ_ERROR(localSize, n, "Wrong number of local values");
+        std::copy(localValues, localValues + localSize, ptr);
+        return;
+    }
+
+    const MPI_Comm globalComm = static_cast<const scai::dmemo::MPICommunicator&>( *comm ).getMPIComm();
+    const int p = comm->getSize();
+    const int rank = comm->getRank();
+
+    //the size in bytes and the leader of every process
+    int leaderRank = rank;
+    MPI_Bcast(&leaderRank, 1, MPI_INT, 0, window->nodeComm);
+    const int sendInfo[2] = {int(localSize*sizeof(T)), leaderRank};
+    std::vector<int> info(2*p);
+    MPI_Allgather(sendInfo, 2, MPI_INT, info.data(), 2, MPI_INT, globalComm);
+
+    std::vector<long long> offsets(p+1, 0);
+    for (int r = 0; r < p; r++) {
+        offsets[r+1] = offsets[r] + info[2*r];
+    }
+    SCAI_ASSERT_EQ_ERROR(offsets[p], (long long)(n)*sizeof(T), "Wrong number of local values");
+
+    //the leader collects the values of its node, the node ranks follow the global ranks
+    std::vector<int> nodeCounts, nodeDisplacements;
+    int nodeBytes = 0;
+    if (leader) {
+        for (int r = 0; r < p; r++) {
+            if (info[2*r+1] == rank) {
+                nodeCounts.push_back(info[2*r]);
+                nodeDisplacements.push_back(nodeBytes);
+                nodeBytes += info[2*r];
+            }
+        }
+    }
+    std::vector<char> nodeValues(nodeBytes);
+    MPI_Gatherv(localValues, sendInfo[0], MPI_BYTE, nodeValues.data(), nodeCounts.data(), nodeDisplacements.data(), MPI_BYTE, 0, window->nodeComm);
+
+    //the leaders exchange the values of their nodes and sort them into the rank order
+    if (leader) {
+        MPI_Comm leaderComm;
+        MPI_Comm_split(globalComm, 0, rank, &leaderComm);
+
+        std::vector<int> leaders;
+        std::vector<int> leaderCounts, leaderDisplacements;
+        int totalBytes = 0;
+        for (int r = 0; r < p; r++) {
+            if (info[2*r+1] == r) {
+                int bytes = 0;
+                for (int s = r; s < p; s++) {
+                    if (info[2*s+1] == r) {
+                        bytes += info[2*s];
+                    }
+                }
+                leaders.push_back(r);
+                leaderCounts.push_back(bytes);
+                leaderDisplacements.push_back(totalBytes);
+                totalBytes += bytes;
+            }
+        }
+
+        std::vector<char> allValues(totalBytes);
+        MPI_Allgatherv(nodeValues.data(), nodeBytes, MPI_BYTE, allValues.data(), leaderCounts.data(), leaderDisplacements.data(), MPI_BYTE, leaderComm);
+        MPI_Comm_free(&leaderComm);
+
+        char* target = reinterpret_cast<char*>(ptr);
+        for (IndexType l = 0; l < leaders.size(); l++) {
+            long long position = leaderDisplacements[l];
+            for (int r = leaders[l]; r < p; r++) {
+                if (info[2*r+1] == leaders[l]) {
+                    std::copy(allValues.begin() + position, allValues.begin() + position + info[2*r], target + offsets[r]);
+                    position += info[2*r];
+                }
+            }
+        }
+    } else {
+        MPI_Comm noComm;
+        MPI_Comm_split(globalComm, MPI_UNDEFINED, rank, &noComm);
+    }
+
+    synchronize();
+}
+//---------------------------------------------------------------------------------------
+
+template class NodeSharedArray<IndexType>;
+template class NodeSharedArray<double>;
+template class NodeSharedArray<float>;
+
+} // namespace ITI
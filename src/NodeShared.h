@@ -0,0 +1,97 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <scai/dmemo/Communicator.hpp>
+
+#include "Settings.h"
+
+/** @file NodeShared.h
+One copy per compute node of data that all processes need in full.
+
+Some structures, e.g. the edge coloring of the block graph, are computed identically by every process and kept
+replicated. With many processes per node and many blocks, these copies take a lot of memory and the computation
+is repeated by every process of the node. A NodeSharedArray is allocated once per node in an MPI-3 shared memory
+window: the node leader (the process with the smallest rank on the node) writes it, and after synchronize()
+all processes of the node read it directly.
+
+Shared are the block graph and its edge coloring in ParcoRepart::getCommunicationPairs_local and the k-means
+centers in KMeans::computePartition. The influence values stay replicated, every process updates them itself.
+*/
+
+namespace ITI {
+
+/** @brief An array of fixed size in memory shared by the processes of a node.
+
+Only the leader may write into the array, the other processes must not access it before synchronize() is
+called. If the communicator is not an MPI communicator, every process has its own array and is its own leader.
+*/
+
+template<typename T>
+class NodeSharedArray {
+public:
+
+    /** Allocate the array. Collective operation over all processes of comm.
+    @param[in] comm The communicator, split into its nodes.
+    @param[in] size The number of elements.
+    */
+    NodeSharedArray(const scai::dmemo::CommunicatorPtr comm, const IndexType size);
+
+    ~NodeSharedArray();
+
+    NodeSharedArray(const NodeSharedArray&) = delete;
+    NodeSharedArray& operator=(const NodeSharedArray&) = delete;
+
+    /** True on the process that writes the array for its node.
+    */
+    bool isLeader() const {
+        return leader;
+    }
+
+    /** The number of processes that share this array.
+    */
+    IndexType nodeSize() const {
+        return numNodeProcesses;
+    }
+
+    IndexType size() const {
+        return n;
+    }
+
+    T* data() {
+        return ptr;
+    }
+
+    const T* data() const {
+        return ptr;
+    }
+
+    /** Make the values written by the leader visible to all processes of the node. Collective operation over the node.
+    */
+    void synchronize();
+
+    /** Fill the array with the local values of all processes of comm, concatenated in the order of their ranks.
+    The values are gathered on the node leaders only, no process holds a copy of the whole array.
+    Collective operation over all processes of comm, includes synchronize().
+    @param[in] comm The communicator the array was allocated with.
+    @param[in] localValues The values of this process.
+    @param[in] localSize The number of values of this process, the sum over all processes must be size().
+    */
+    void allGather(const scai::dmemo::CommunicatorPtr comm, const T* localValues, const IndexType localSize);
+
+private:
+    IndexType n;
+    T* ptr = nullptr;
+    bool leader = true;
+    IndexType numNodeProcesses = 1;
+
+    //the MPI window and the node communicator, defined in the source file to keep mpi.h out of this header
+    struct SharedWindow;
+    std::unique_ptr<SharedWindow> window;
+
+    //used without MPI
+    std::vector<T> localCopy;
+};
+
+} // namespace ITI
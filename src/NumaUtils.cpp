@@ -0,0 +1,428 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+#include <mpi.h>
+#include <sched.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <scai/common/SCAITypes.hpp>
+#include <scai/dmemo/mpi/MPICommunicator.hpp>
+#include <scai/tracing.hpp>
+
+#include "NumaUtils.h"
+
+namespace ITI {
+
+namespace {
+
+int numThreads() {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+int threadId() {
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+/* Parse a list of the form 0-3,8,10-11 as used in sysfs for cpus and NUMA domains. */
+std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty()) continue;
+        const std::size_t dash = range.find('-');
+        const int first = std::stoi(range.substr(0, dash));
+        const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash+1));
+        for (int c = first; c <= last; c++) {
+            cpus.push_back(c);
+        }
+    }
+    return cpus;
+}
+
+/* The online cpus of every NUMA domain. If the sysfs entries are missing, all cpus form one domain. */
+std::vector<std::vector<int>> numaDomains() {
+    std::vector<std::vector<int>> domains;
+    //the ids of the online domains need not be consecutive, e.g. 0,2 or 0-1,4-5 with memory-only domains in between
+    std::ifstream onlineFile("/sys/devices/system/node/online");
+    std::string online;
+    std::getline(onlineFile, online);
+    for (const int node : parseCpuList(online)) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (file.fail()) continue;
+        std::string line;
+        std::getline(file, line);
+        std::vector<int> cpus = parseCpuList(line);
+        if (!cpus.empty()) {
+            domains.push_back(cpus);
+        }
+    }
+
+    if (domains.empty()) {
+        const int numCpus = sysconf(_SC_NPROCESSORS_ONLN);
+        domains.push_back(std::vector<int>(numCpus));
+        std::iota(domains[0].begin(), domains[0].end(), 0);
+    }
+    return domains;
+}
+
+int numaDomainOf(const int cpu, const std::vector<std::vector<int>>& domains) {
+    for (std::size_t d = 0; d < domains.size(); d++) {
+        if (std::find(domains[d].begin(), domains[d].end(), cpu) != domains[d].end()) {
+            return d;
+        }
+    }
+    return -1;
+}
+
+int currentCpu() {
+#ifdef __linux__
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+/* The socket of a cpu from sysfs, -1 if unknown. */
+int cpuSocket(const int cpu) {
+    std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/physical_package_id");
+    int socket = -1;
+    if (!(file >> socket)) {
+        return -1;
+    }
+    return socket;
+}
+
+/* The group of the cpus this process may run on, -1 if they belong to several groups or are unknown. */
+int processGroup(const std::function<int(int)>& groupOfCpu) {
+    int group = -1;
+#ifdef __linux__
+    cpu_set_t mask;
+    if (sched_getaffinity(0, sizeof(mask), &mask) != 0) {
+        return -1;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &mask)) continue;
+        const int cpuGroup = groupOfCpu(cpu);
+        if (cpuGroup == -1 or (group != -1 and cpuGroup != group)) {
+            return -1;
+        }
+        group = cpuGroup;
+    }
+#endif
+    return group;
+}
+
+/* The node of this process as the rank of the first process on it, from the shared memory split of MPI like in
+   NodeShared. Without MPI, the hostname identifies the node. */
+IndexType processNode(const scai::dmemo::CommunicatorPtr comm) {
+    if (comm->getType() != scai::dmemo::CommunicatorType::MPI) {
+        return hostHash();
+    }
+    const MPI_Comm mpiComm = static_cast<const scai::dmemo::MPICommunicator&>( *comm ).getMPIComm();
+    MPI_Comm nodeComm;
+    MPI_Comm_split_type(mpiComm, MPI_COMM_TYPE_SHARED, comm->getRank(), MPI_INFO_NULL, &nodeComm);
+    int firstRank = comm->getRank();
+    MPI_Bcast(&firstRank, 1, MPI_INT, 0, nodeComm);
+    MPI_Comm_free(&nodeComm);
+    return firstRank;
+}
+
+/* Split the sequence of ids into runs of equal ids. Returns the length of the runs if all have the same length
+   and no id appears in two runs, 0 otherwise. */
+IndexType regularRunLength(const std::vector<IndexType>& ids) {
+    std::vector<IndexType> runLengths;
+    std::vector<IndexType> runIds;
+    for (std::size_t i = 0; i < ids.size(); i++) {
+        if (i == 0 or ids[i] != ids[i-1]) {
+            if (std::find(runIds.begin(), runIds.end(), ids[i]) != runIds.end()) {
+                return 0;
+            }
+            runIds.push_back(ids[i]);
+            runLengths.push_back(0);
+        }
+        runLengths.back()++;
+    }
+    if (runLengths.empty() or std::count(runLengths.begin(), runLengths.end(), runLengths[0]) != IndexType(runLengths.size())) {
+        return 0;
+    }
+    return runLengths[0];
+}
+
+/* The number of PEs per group if the groups are regular within every parent group of parentSize consecutive PEs,
+   with the same size in all parents, and no group id is 0 (unknown). Otherwise parentSize, the level is left out. */
+IndexType regularGroupSize(const std::vector<IndexType>& ids, const IndexType parentSize) {
+    IndexType groupSize = parentSize;
+    for (IndexType first = 0; first < IndexType(ids.size()); first += parentSize) {
+        const std::vector<IndexType> parentIds(ids.begin() + first, ids.begin() + first + parentSize);
+        const IndexType runLength = std::count(parentIds.begin(), parentIds.end(), 0) > 0 ? 0 : regularRunLength(parentIds);
+        if (runLength == 0 or (first > 0 and runLength != groupSize)) {
+            return parentSize;
+        }
+        groupSize = runLength;
+    }
+    return groupSize;
+}
+
+/* Average time of a message exchange between PE 0 and partner, known on all PEs. */
+double pingPongLatency(const scai::dmemo::CommunicatorPtr comm, const IndexType partner) {
+    const IndexType repetitions = 100;
+    double time = 0;
+    if (comm->getRank() == 0 or comm->getRank() == partner) {
+        const IndexType other = comm->getRank() == 0 ? partner : 0;
+        double message = 0;
+        //one exchange to establish the connection
+        comm->swap(&message, 1, other);
+        std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+        for (IndexType r = 0; r < repetitions; r++) {
+            comm->swap(&message, 1, other);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        time = elapsed.count()/repetitions;
+    }
+    return comm->max(time);
+}
+
+} // anonymous namespace
+//---------------------------------------------------------------------------------------
+
+IndexType hostHash() {
+    char hostname[256] = {0};
+    gethostname(hostname, sizeof(hostname)-1);
+    return std::hash<std::string>()(std::string(hostname)) % 2147483647;
+}
+//---------------------------------------------------------------------------------------
+
+std::pair<int,int> nodeLocalRank(const scai::dmemo::CommunicatorPtr comm) {
+    const IndexType numPEs = comm->getSize();
+    const IndexType rank = comm->getRank();
+
+    const IndexType myHash = hostHash();
+
+    std::vector<IndexType> allHashes(numPEs, 0);
+    allHashes[rank] = myHash;
+    comm->sumImpl( allHashes.data(), allHashes.data(), numPEs, scai::common::TypeTraits<IndexType>::stype );
+
+    int localRank = 0;
+    int localSize = 0;
+    for (IndexType i = 0; i < numPEs; i++) {
+        if (allHashes[i] == myHash) {
+            if (i < rank) localRank++;
+            localSize++;
+        }
+    }
+    return {localRank, localSize};
+}
+//---------------------------------------------------------------------------------------
+
+bool pinThreads(const std::string& policy, const scai::dmemo::CommunicatorPtr comm) {
+    SCAI_REGION("NumaUtils.pinThreads");
+
+    if (policy == "none") {
+        return true;
+    }
+    if (policy != "compact" and policy != "spread") {
+        throw std::invalid_argument("Unknown thread affinity policy " + policy);
+    }
+
+    const std::pair<int,int> local = nodeLocalRank(comm);
+    const int localRank = local.first;
+    const std::vector<std::vector<int>> domains = numaDomains();
+    const int numDomains = domains.size();
+    const int threads = numThreads();
+
+    //all cores of the host, ordered by domain
+    std::vector<int> allCpus;
+    for (const std::vector<int>& domain : domains) {
+        allCpus.insert(allCpus.end(), domain.begin(), domain.end());
+    }
+
+    bool success = true;
+
+    #pragma omp parallel reduction(&&:success)
+    {
+        const int t = threadId();
+        int cpu;
+        if (policy == "compact") {
+            cpu = allCpus[(localRank*threads + t) % allCpus.size()];
+        } else {
+            const std::vector<int>& domain = domains[localRank % numDomains];
+            cpu = domain[((localRank / numDomains)*threads + t) % domain.size()];
+        }
+#ifdef __linux__
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        CPU_SET(cpu, &mask);
+        success = sched_setaffinity(0, sizeof(mask), &mask) == 0;
+#else
+        success = false;
+#endif
+    }
+
+    if (!success) {
+        std::cout << "WARNING: PE " << comm->getRank() << " could not pin its threads with policy " << policy << std::endl;
+    }
+    return success;
+}
+//---------------------------------------------------------------------------------------
+
+void printAffinity(std::ostream& out, const scai::dmemo::CommunicatorPtr comm) {
+    const IndexType numPEs = comm->getSize();
+    const IndexType rank = comm->getRank();
+    const IndexType maxThreads = comm->max( IndexType(numThreads()) );
+    const std::vector<std::vector<int>> domains = numaDomains();
+
+    //for every PE and thread: cpu+1 and domain+1, 0 if there is no such thread
+    std::vector<IndexType> placement(numPEs*maxThreads*2, 0);
+    #pragma omp parallel
+    {
+        const int t = threadId();
+        const int cpu = currentCpu();
+        placement[(rank*maxThreads + t)*2] = cpu + 1;
+        placement[(rank*maxThreads + t)*2 + 1] = numaDomainOf(cpu, domains) + 1;
+    }
+    comm->sumImpl( placement.data(), placement.data(), placement.size(), scai::common::TypeTraits<IndexType>::stype );
+
+    const std::pair<int,int> local = nodeLocalRank(comm);
+    std::vector<IndexType> localRanks(numPEs, 0);
+    localRanks[rank] = local.first;
+    comm->sumImpl( localRanks.data(), localRanks.data(), numPEs, scai::common::TypeTraits<IndexType>::stype );
+
+    if (rank == 0) {
+        out << "thread placement (PE, rank on host: thread->core/NUMA domain), " << domains.size() << " NUMA domains on host of PE 0" << std::endl;
+        for (IndexType p = 0; p < numPEs; p++) {
+            out << "\tPE " << p << ", " << localRanks[p] << ":";
+            for (IndexType t = 0; t < maxThreads; t++) {
+                const IndexType cpu = placement[(p*maxThreads + t)*2] - 1;
+                const IndexType domain = placement[(p*maxThreads + t)*2 + 1] - 1;
+                if (cpu < 0) continue;
+                out << " " << t << "->" << cpu << "/" << domain;
+            }
+            out << std::endl;
+        }
+    }
+}
+//---------------------------------------------------------------------------------------
+
+bool checkOversubscription(const scai::dmemo::CommunicatorPtr comm) {
+    const std::pair<int,int> local = nodeLocalRank(comm);
+    const int threads = numThreads();
+    const int numCpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    //threads of all processes on this host
+    const bool hostOversubscribed = local.second*threads > numCpus;
+
+    //threads of this process share fewer cores, e.g., when the launcher binds every process to one core
+    bool maskOversubscribed = false;
+#ifdef __linux__
+    cpu_set_t mask;
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+        maskOversubscribed = threads > CPU_COUNT(&mask);
+    }
+#endif
+
+    const IndexType numHost = comm->sum( IndexType(hostOversubscribed) );
+    const IndexType numMask = comm->sum( IndexType(maskOversubscribed) );
+
+    if (comm->getRank() == 0) {
+        if (numHost > 0) {
+            std::cout << "WARNING: oversubscription, " << numHost << " PEs run on hosts with more threads than cores (" << local.second << " PEs with "
+                      << threads << " threads each on the host of PE 0, " << numCpus << " cores)" << std::endl;
+        }
+        if (numMask > 0) {
+            std::cout << "WARNING: oversubscription, " << numMask << " PEs have more threads than cores in the affinity mask set by the MPI launcher. Change the binding of the launcher or use --threadAffinity" << std::endl;
+        }
+    }
+    return numHost + numMask > 0;
+}
+
+//---------------------------------------------------------------------------------------
+
+std::vector<IndexType> discoverHierarchy(const scai::dmemo::CommunicatorPtr comm, std::vector<double>& distances, const bool measureLatency) {
+    SCAI_REGION("NumaUtils.discoverHierarchy");
+
+    const IndexType numPEs = comm->getSize();
+    const IndexType rank = comm->getRank();
+    const std::vector<std::vector<int>> domains = numaDomains();
+
+    //for every PE its node, its socket+1 and its NUMA domain+1, 0 if unknown
+    std::vector<IndexType> placement(3*numPEs, 0);
+    placement[3*rank] = processNode(comm);
+    placement[3*rank+1] = processGroup(cpuSocket) + 1;
+    placement[3*rank+2] = processGroup([&domains](const int cpu) { return numaDomainOf(cpu, domains); }) + 1;
+    comm->sumImpl( placement.data(), placement.data(), placement.size(), scai::common::TypeTraits<IndexType>::stype );
+
+    std::vector<std::vector<IndexType>> ids(3, std::vector<IndexType>(numPEs));
+    for (IndexType p = 0; p < numPEs; p++) {
+        for (IndexType l = 0; l < 3; l++) {
+            ids[l][p] = placement[3*p+l];
+        }
+    }
+    const IndexType pesPerHost = regularRunLength(ids[0]);
+    distances.clear();
+    if (pesPerHost == 0) {
+        return std::vector<IndexType>();
+    }
+    const IndexType numHosts = numPEs/pesPerHost;
+
+    //the sockets must be regular within every host and the domains within every socket
+    const IndexType pesPerSocket = regularGroupSize(ids[1], pesPerHost);
+    const IndexType pesPerDomain = regularGroupSize(ids[2], pesPerSocket);
+
+    //from the root to the leaves, with the first PE of the next subtree of every level
+    const std::vector<IndexType> levels = {numHosts, pesPerHost/pesPerSocket, pesPerSocket/pesPerDomain, pesPerDomain};
+    const std::vector<IndexType> partners = {pesPerHost, pesPerSocket, pesPerDomain, 1};
+
+    //leave out levels with a single child, but keep at least one level
+    std::vector<IndexType> result;
+    std::vector<IndexType> resultPartners;
+    for (IndexType l = 0; l < 4; l++) {
+        if (levels[l] > 1 or (l == 3 and result.empty())) {
+            result.push_back(levels[l]);
+            resultPartners.push_back(partners[l]);
+        }
+    }
+
+    //the distances from the leaves to the root
+    for (int l = int(result.size())-1; l >= 0; l--) {
+        if (measureLatency and result[l] > 1) {
+            distances.push_back(pingPongLatency(comm, resultPartners[l]));
+        } else {
+            distances.push_back(std::pow(10.0, double(distances.size())));
+        }
+    }
+    const double minDistance = *std::min_element(distances.begin(), distances.end());
+    for (double& d : distances) {
+        d /= minDistance;
+    }
+
+    if (rank == 0) {
+        std::cout << "discovered hierarchy: " << numHosts << " hosts, " << levels[1] << " sockets per host, " << levels[2] << " NUMA domains per socket, "
+                  << pesPerDomain << " PEs per domain, distances";
+        for (double d : distances) {
+            std::cout << " " << d;
+        }
+        std::cout << std::endl;
+    }
+    return result;
+}
+
+} // namespace ITI
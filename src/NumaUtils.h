@@ -0,0 +1,136 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <scai/dmemo/Communicator.hpp>
+#include <scai/hmemo/HArray.hpp>
+#include <scai/hmemo/WriteOnlyAccess.hpp>
+
+#include "Settings.h"
+
+/** @file NumaUtils.h
+Helpers for hybrid MPI+OpenMP runs on multi-socket nodes.
+
+Linux places a page on the NUMA domain of the thread that first writes to it. If a large array is
+allocated and initialized by the main thread, all of it ends up on one domain and the threads on the
+other sockets access it remotely. The firstTouch functions initialize arrays with an OpenMP loop with
+static schedule, the same schedule as the loops of LAMA, so that every thread owns the pages it works on.
+This is only effective if the threads do not migrate, see pinThreads.
+*/
+
+namespace ITI {
+
+/** Copy n values into a new HArray. The pages of the array are first touched by the OpenMP threads.
+*/
+template<typename T>
+scai::hmemo::HArray<T> firstTouchCopy(const T* source, const IndexType n) {
+    scai::hmemo::HArray<T> result;
+    {
+        scai::hmemo::WriteOnlyAccess<T> wResult(result, n);
+        T* target = wResult.get();
+        #pragma omp parallel for schedule(static)
+        for (IndexType i = 0; i < n; i++) {
+            target[i] = source[i];
+        }
+    }
+    return result;
+}
+
+/** Allocator that leaves values default-initialized, so that the memory of a vector is not touched
+by the allocating thread. Use together with firstTouchVector.
+*/
+template<typename T>
+struct FirstTouchAllocator : std::allocator<T> {
+    template<typename U> struct rebind { typedef FirstTouchAllocator<U> other; };
+
+    FirstTouchAllocator() = default;
+    template<typename U> FirstTouchAllocator(const FirstTouchAllocator<U>&) {}
+
+    template<typename U>
+    void construct(U* ptr) {
+        ::new (static_cast<void*>(ptr)) U;
+    }
+    template<typename U, typename... Args>
+    void construct(U* ptr, Args&&... args) {
+        ::new (static_cast<void*>(ptr)) U(std::forward<Args>(args)...);
+    }
+};
+
+template<typename T>
+using FirstTouchVector = std::vector<T, FirstTouchAllocator<T>>;
+
+/** A vector of size n with all values set to value by the OpenMP threads.
+*/
+template<typename T>
+FirstTouchVector<T> firstTouchVector(const IndexType n, const T value) {
+    FirstTouchVector<T> result(n);
+    T* target = result.data();
+    #pragma omp parallel for schedule(static)
+    for (IndexType i = 0; i < n; i++) {
+        target[i] = value;
+    }
+    return result;
+}
+
+/** True if the whole run has a single process, then its OpenMP loops can use all cores of the node.
+A communicator of size one is not enough: the groups of a split communicator share the node with other processes.
+*/
+inline bool isSingleProcessRun() {
+    return scai::dmemo::Communicator::getCommunicatorPtr()->getSize() == 1;
+}
+
+/** @brief Hash of the hostname, positive and small enough for every IndexType.
+*/
+IndexType hostHash();
+
+/** @brief Rank of this process among the processes running on the same host, and their number.
+
+Hosts are identified by their hostname. Collective operation.
+*/
+std::pair<int,int> nodeLocalRank(const scai::dmemo::CommunicatorPtr comm);
+
+/** @brief Pin the OpenMP threads of every process to cores.
+
+    - "none": do not change the affinity set by the MPI launcher.
+    - "compact": the processes of a host get consecutive cores, ordered by NUMA domain, and every thread one of them.
+    - "spread": the processes are distributed round robin over the NUMA domains and the threads of a process are pinned to cores of its domain.
+
+If there are more threads on a host than cores, cores are reused. Collective operation.
+@return False if pinning failed on this process.
+*/
+bool pinThreads(const std::string& policy, const scai::dmemo::CommunicatorPtr comm);
+
+/** @brief Print for every process and thread the core and NUMA domain it runs on. Collective operation, root prints.
+*/
+void printAffinity(std::ostream& out, const scai::dmemo::CommunicatorPtr comm);
+
+/** @brief Check if there are more threads than cores, either on a host or in the affinity mask of a process.
+
+Collective operation. Warnings are printed by the root.
+@return True if any process is oversubscribed.
+*/
+bool checkOversubscription(const scai::dmemo::CommunicatorPtr comm);
+
+/** @brief Find the hierarchy of the PEs from the nodes they run on and the sockets and NUMA domains of their affinity masks.
+
+The nodes are the shared memory groups of MPI (MPI_Comm_split_type, as in NodeShared), the sockets and NUMA domains
+are read from sysfs. The hierarchy is only returned if it is regular: the PEs of every node, socket and NUMA domain
+have consecutive ranks, all nodes have the same number of sockets, all sockets the same number of domains and all
+domains the same number of PEs. If the sockets or domains are irregular or a PE is not bound to a single one, that
+level is left out. Levels with a single child are left out. Collective operation.
+
+The distances are either estimated, a factor of 10 for every level, or measured as the latency of a ping-pong
+between PE 0 and the first PE of the next subtree on every level, relative to the smallest latency.
+
+@param[out] distances The communication cost of every level, from the leaves to the root as in CommTree::createHierHomogeneous.
+@param[in] measureLatency If true, the distances are measured, otherwise they are estimated.
+@return The number of children per level, from the root to the leaves as in Settings::hierLevels. Empty if the PEs are not placed regularly.
+*/
+std::vector<IndexType> discoverHierarchy(const scai::dmemo::CommunicatorPtr comm, std::vector<double>& distances, const bool measureLatency);
+
+} // namespace ITI
@@ -12,6 +12,7 @@
 #include <climits>
 #include <queue>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <numeric>
 #include <iterator>
@@ -21,7 +22,14 @@
 #include <set>
 #include <iostream>
 #include <iomanip>
+#include <functional>
+#include <exception>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <scai/dmemo/CommunicationPlan.hpp>
 #include <scai/tracing.hpp>
 
 #include "PrioQueue.h"
@@ -33,6 +41,10 @@
 #include "MultiSection.h"
 #include "GraphUtils.h"
 #include "Mapping.h"
+#include "Redistribution.h"
+#include "NodeShared.h"
+#include "Checkpoint.h"
+#include "StreamingPartition.h"
 
 #if PARMETIS_FOUND
 #include "Wrappers.h"
@@ -263,7 +275,8 @@ DenseVector<IndexType> ParcoRepart<IndexType, ValueType>::partitionGraph(
     CommTree<IndexType,ValueType> commTree,
     const scai::dmemo::CommunicatorPtr comm,
     Settings settings,
-    Metrics<ValueType>& metrics)
+    Metrics<ValueType>& metrics,
+    const DenseVector<IndexType>& streamed)
 {
     IndexType k = settings.numBlocks;
     const IndexType dimensions = coordinates.size();
@@ -286,7 +299,34 @@ DenseVector<IndexType> ParcoRepart<IndexType, ValueType>::partitionGraph(
     const scai::dmemo::DistributionPtr inputDist = input.getRowDistributionPtr();
     const scai::dmemo::DistributionPtr noDist(new scai::dmemo::NoDistribution(n));
     //const scai::dmemo::CommunicatorPtr comm = coordDist->getCommunicatorPtr();
+
+    /*
+    * small inputs on many PEs are partitioned on fewer PEs
+    */
+    const IndexType numActive = numActivePEs( n, settings, comm->getSize() );
+    const bool shrink = numActive<comm->getSize() and previous.size()==0 and streamed.size()==0 and not settings.repartition \
+        and settings.checkpointDir=="-" and settings.initialPartition!=ITI::Tool::none;
+    //the refinement of geographer needs one block per PE, then only the initial partition is computed on fewer PEs
+    if( shrink and (settings.noRefinement or settings.localRefAlgo!=ITI::Tool::geographer or numActive==k) ){
+        return partitionOnFewerPEs( input, coordinates, nodeWeights, commTree, comm, settings, metrics, numActive, false );
+    }
     
+    /*
+    * with a time budget, the iterative phases stop at their deadlines
+    */
+    double reserveDeadline = 0;
+    if( settings.timeBudget>0 ){
+        const double budgetStart = Settings::clockSeconds();
+        settings.initialDeadline = budgetStart + settings.initialBudgetShare*settings.timeBudget;
+        settings.refinementDeadline = budgetStart + settings.timeBudget;
+        //optional phases are skipped if less than 10% of the budget is left
+        reserveDeadline = budgetStart + 0.9*settings.timeBudget;
+        for( const std::string key : {"truncatedKMeans", "truncatedBalance", "truncatedRefinement", "skippedPreliminaryMetrics", "skippedRefinement", "skippedMapping"} ){
+            metrics.MM[key] = 0;
+        }
+        PRINT0("Time budget of " << settings.timeBudget << " seconds, " << settings.initialBudgetShare*settings.timeBudget << " for the initial partition");
+    }
+
 	// timing info
     std::chrono::duration<double> partitionTime= std::chrono::duration<double>(0.0);
 	std::chrono::time_point<std::chrono::steady_clock> beforeInitPart =  std::chrono::steady_clock::now();
@@ -294,7 +334,27 @@ DenseVector<IndexType> ParcoRepart<IndexType, ValueType>::partitionGraph(
 	/*
 	* get an initial partition
 	*/
-	DenseVector<IndexType> result = initialPartition( input, coordinates, nodeWeights, previous, commTree, comm, settings, metrics);
+	DenseVector<IndexType> result;
+	const bool writeCheckpoints = settings.checkpointDir!="-";
+	bool isRefined = false;
+	if( Checkpoint<IndexType, ValueType>::resumeAt("refined", settings, comm) ){
+		Checkpoint<IndexType, ValueType>::read( settings.checkpointDir, "refined", input, coordinates, nodeWeights, result, comm );
+		isRefined = true;
+	}else if( Checkpoint<IndexType, ValueType>::resumeAt("initial", settings, comm) ){
+		Checkpoint<IndexType, ValueType>::read( settings.checkpointDir, "initial", input, coordinates, nodeWeights, result, comm );
+	}else{
+		if( shrink ){
+			result = partitionOnFewerPEs( input, coordinates, nodeWeights, commTree, comm, settings, metrics, numActive, true );
+		}else if( settings.multiStarts>1 ){
+			result = multiStartInitialPartition( input, coordinates, nodeWeights, previous, commTree, comm, settings, metrics);
+		}else{
+			result = initialPartition( input, coordinates, nodeWeights, previous, commTree, comm, settings, metrics, streamed );
+		}
+		if( writeCheckpoints ){
+			Checkpoint<IndexType, ValueType>::write( settings.checkpointDir, "initial", input, coordinates, nodeWeights, result, comm );
+		}
+	}
+	SCAI_ASSERT_EQ_ERROR( input.getNumRows(), n, "The checkpoint belongs to a different input" );
 
     partitionTime =  std::chrono::steady_clock::now() - beforeInitPart;
     metrics.MM["timePreliminary"] = partitionTime.count();
@@ -310,8 +370,15 @@ DenseVector<IndexType> ParcoRepart<IndexType, ValueType>::partitionGraph(
         if (comm->getSize()!=k and settings.localRefAlgo==ITI::Tool::geographer) {
             throw std::runtime_error( "Local refinement only implemented for one block per process. Called with " + std::to_string(comm->getSize()) + " processes and " + std::to_string(k) + " blocks.");
         }
+        const bool budgetUsed = settings.deadlinePassed(reserveDeadline, comm);
+        if( budgetUsed ){
+            PRINT0("Time budget is nearly used, skip local refinement");
+            metrics.MM["skippedPreliminaryMetrics"] = 1;
+            metrics.MM["skippedRefinement"] = 1;
+        }
+
         //store some metrics before local refinement
-        if( settings.metricsDetail.compare("no")!=0 ){
+        if( settings.metricsDetail.compare("no")!=0 and not budgetUsed ){
             Metrics<ValueType> tmpMetrics(settings);
             Settings tmpSettings = settings;
             tmpSettings.computeDiameter = false;
@@ -334,7 +401,12 @@ DenseVector<IndexType> ParcoRepart<IndexType, ValueType>::partitionGraph(
             }
         }
 
-        doLocalRefinement( result,  input, coordinates, nodeWeights, commTree, comm, settings, metrics );
+        if( not budgetUsed and not isRefined ){
+            doLocalRefinement( result,  input, coordinates, nodeWeights, commTree, comm, settings, metrics );
+            if( writeCheckpoints ){
+                Checkpoint<IndexType, ValueType>::write( settings.checkpointDir, "refined", input, coordinates, nodeWeights, result, comm );
+            }
+        }
 
     } else {
 
@@ -344,7 +416,10 @@ DenseVector<IndexType> ParcoRepart<IndexType, ValueType>::partitionGraph(
     metrics.MM["timeTotal"] = elapTime.count();
 
     //possible mapping at the end
-    if( settings.mappingRenumbering ) {
+    if( settings.mappingRenumbering and settings.deadlinePassed(reserveDeadline, comm) ) {
+        PRINT0("Time budget is nearly used, skip the renumbering of the blocks");
+        metrics.MM["skippedMapping"] = 1;
+    } else if( settings.mappingRenumbering ) {
         PRINT0("Applying renumbering of blocks based on the SFC index of their centers.");
         std::chrono::time_point<std::chrono::steady_clock> startRnb = std::chrono::steady_clock::now();
 
@@ -375,7 +450,8 @@ DenseVector<IndexType> ParcoRepart<IndexType, ValueType>::initialPartition(
     CommTree<IndexType,ValueType> commTree,
     scai::dmemo::CommunicatorPtr comm,
     Settings settings,
-    Metrics<ValueType>& metrics){
+    Metrics<ValueType>& metrics,
+    const DenseVector<IndexType>& streamed){
     
     SCAI_REGION( "ParcoRepart.initialPartition" )
 
@@ -410,7 +486,18 @@ DenseVector<IndexType> ParcoRepart<IndexType, ValueType>::initialPartition(
 
             if (!settings.repartition || comm->getSize() != settings.numBlocks) {
                 if (settings.initialMigration == ITI::Tool::geoSFC) {
-                    HilbertCurve<IndexType,ValueType>::redistribute(coordinateCopy, nodeWeightCopy, settings, metrics);
+                    //with multiple starts, the groups of PEs would write to the same files
+                    const bool useCheckpoint = settings.checkpointDir!="-" and settings.multiStarts<=1;
+                    if( useCheckpoint and Checkpoint<IndexType, ValueType>::resumeAt("migrated", settings, comm) ){
+                        CSRSparseMatrix<ValueType> noGraph;
+                        DenseVector<IndexType> noPartition;
+                        Checkpoint<IndexType, ValueType>::read( settings.checkpointDir, "migrated", noGraph, coordinateCopy, nodeWeightCopy, noPartition, comm );
+                    }else{
+                        HilbertCurve<IndexType,ValueType>::redistribute(coordinateCopy, nodeWeightCopy, settings, metrics);
+                        if( useCheckpoint ){
+                            Checkpoint<IndexType, ValueType>::write( settings.checkpointDir, "migrated", CSRSparseMatrix<ValueType>(), coordinateCopy, nodeWeightCopy, DenseVector<IndexType>(), comm );
+                        }
+                    }
                 }else if(settings.initialMigration == ITI::Tool::none) {
                     //do nothing
                 }else{
@@ -504,6 +591,18 @@ DenseVector<IndexType> ParcoRepart<IndexType, ValueType>::initialPartition(
             if(comm->getRank() == 0)
                 std::cout << "MS Time:" << totMsTime << std::endl;
         }
+    } else if (settings.initialPartition == ITI::Tool::geoStream) {
+        //the partition may already be streamed while the graph was read, the groups of a multi-start stream again
+        if (streamed.size() == input.getNumRows()) {
+            PRINT0("Initial partition streamed while reading the input");
+            result = streamed;
+            if (not result.getDistribution().isEqual(input.getRowDistribution())) {
+                result.redistribute(input.getRowDistributionPtr());
+            }
+        } else {
+            PRINT0("Initial partition with streaming");
+            result = StreamingPartition<IndexType, ValueType>::computePartition(input, nodeWeights[0], settings);
+        }
     } else if (settings.initialPartition == ITI::Tool::none) {
         //no need to explicitly check for repartitioning mode or not.
         assert(comm->getSize() == settings.numBlocks);
@@ -529,6 +628,268 @@ DenseVector<IndexType> ParcoRepart<IndexType, ValueType>::initialPartition(
 } //initialPartition
 //---------------------------------------------------------------------------------------
 
+template<typename IndexType, typename ValueType>
+DenseVector<IndexType> ParcoRepart<IndexType, ValueType>::multiStartInitialPartition(
+    const CSRSparseMatrix<ValueType> &input,
+    const std::vector<DenseVector<ValueType>> &coordinates,
+    const std::vector<DenseVector<ValueType>> &nodeWeights,
+    DenseVector<IndexType>& previous,
+    CommTree<IndexType,ValueType> commTree,
+    scai::dmemo::CommunicatorPtr comm,
+    Settings settings,
+    Metrics<ValueType>& metrics){
+
+    SCAI_REGION( "ParcoRepart.multiStartInitialPartition" )
+
+    const IndexType k = settings.numBlocks;
+    const IndexType numStarts = settings.multiStarts;
+    const IndexType numGroups = std::min<IndexType>( numStarts, comm->getSize() );
+    const IndexType myGroup = IndexType(comm->getRank())*numGroups/comm->getSize();
+    const scai::dmemo::CommunicatorPtr groupComm = numGroups>1 ? comm->split( myGroup ) : comm;
+
+    PRINT0("Multi-start: " << numStarts << " initial partitions on " << numGroups << " groups of PEs, objective " << settings.multiStartObjective);
+
+    //with a single group the attempts work on the input directly
+    CSRSparseMatrix<ValueType> groupGraph;
+    std::vector<DenseVector<ValueType>> groupCoords;
+    std::vector<DenseVector<ValueType>> groupWeights;
+    if( numGroups>1 ){
+        SCAI_REGION( "ParcoRepart.multiStartInitialPartition.copyToGroups" )
+        if( input.getColDistributionPtr()->isReplicated() ){
+            Redistribution<IndexType,ValueType>::copyToGroups( groupComm, numGroups, input, coordinates, nodeWeights, groupGraph, groupCoords, groupWeights );
+        }else{
+            CSRSparseMatrix<ValueType> inputCopy( input );
+            const scai::dmemo::DistributionPtr noDist( new scai::dmemo::NoDistribution(input.getNumColumns()) );
+            inputCopy.redistribute( input.getRowDistributionPtr(), noDist );
+            Redistribution<IndexType,ValueType>::copyToGroups( groupComm, numGroups, inputCopy, coordinates, nodeWeights, groupGraph, groupCoords, groupWeights );
+        }
+    }
+    const CSRSparseMatrix<ValueType>& graph = numGroups>1 ? groupGraph : input;
+    const std::vector<DenseVector<ValueType>>& coords = numGroups>1 ? groupCoords : coordinates;
+    const std::vector<DenseVector<ValueType>>& weights = numGroups>1 ? groupWeights : nodeWeights;
+
+    const std::vector<std::vector<ValueType>> blockSizes = commTree.getBalanceVectors();
+
+    //one initial partition with its own seed, the objective is the same on all PEs of attemptComm
+    auto runAttempt = [&]( const IndexType attempt, const CSRSparseMatrix<ValueType>& attemptGraph, const std::vector<DenseVector<ValueType>>& attemptCoords,
+        const std::vector<DenseVector<ValueType>>& attemptWeights, const scai::dmemo::CommunicatorPtr attemptComm, Metrics<ValueType>& attemptMetrics, ValueType& objective ){
+
+        Settings attemptSettings = settings;
+        attemptSettings.multiStarts = 1;
+        attemptSettings.seed = settings.seed + attempt;
+        attemptSettings.shuffleSamples = attempt>0;
+        DenseVector<IndexType> noPrevious;
+
+        DenseVector<IndexType> attemptPartition = initialPartition( attemptGraph, attemptCoords, attemptWeights, noPrevious, commTree, attemptComm, attemptSettings, attemptMetrics );
+
+        objective = 0;
+        if( settings.multiStartObjective=="maxCommVolume" ){
+            const std::vector<IndexType> commVolume = GraphUtils<IndexType,ValueType>::computeCommVolume( attemptGraph, attemptPartition, attemptSettings );
+            objective = *std::max_element( commVolume.begin(), commVolume.end() );
+        }else if( settings.multiStartObjective=="imbalance" ){
+            for( IndexType w=0; w<attemptWeights.size(); w++ ){
+                objective = std::max( objective, GraphUtils<IndexType,ValueType>::computeImbalance( attemptPartition, k, attemptWeights[w], blockSizes[w] ) );
+            }
+        }else{
+            objective = GraphUtils<IndexType,ValueType>::computeCut( attemptGraph, attemptPartition, true );
+        }
+        return attemptPartition;
+    };
+
+    //the attempts of this group
+    std::vector<IndexType> myAttempts;
+    for( IndexType attempt=myGroup; attempt<numStarts; attempt+=numGroups ){
+        myAttempts.push_back( attempt );
+    }
+    const IndexType numMyAttempts = myAttempts.size();
+    std::vector<DenseVector<IndexType>> partitions( numMyAttempts );
+    std::vector<Metrics<ValueType>> attemptMetrics( numMyAttempts, Metrics<ValueType>(settings) );
+    std::vector<ValueType> myObjectives( numMyAttempts, 0 );
+
+#ifdef _OPENMP
+    const IndexType numThreads = std::min<IndexType>( omp_get_max_threads(), numMyAttempts );
+#else
+    const IndexType numThreads = 1;
+#endif
+
+    if( groupComm->getSize()==1 and numThreads>1 ){
+        SCAI_REGION( "ParcoRepart.multiStartInitialPartition.threads" )
+        //a group of one PE, e.g. for a small input on fewer PEs: the attempts run in threads, every thread on its own
+        //replicated copy of the input with a communicator without processes, so that the threads do not call MPI
+        const scai::dmemo::CommunicatorPtr noComm = scai::dmemo::Communicator::getCommunicatorPtr( scai::dmemo::CommunicatorType::NO );
+        const IndexType N = graph.getNumRows();
+        const scai::dmemo::DistributionPtr noDist( new scai::dmemo::NoDistribution(N) );
+        SCAI_ASSERT_EQ_ERROR( graph.getLocalNumRows(), N, "A group of one PE must own all vertices" );
+
+        std::vector<CSRSparseMatrix<ValueType>> threadGraphs;
+        std::vector<std::vector<DenseVector<ValueType>>> threadCoords( numThreads );
+        std::vector<std::vector<DenseVector<ValueType>>> threadWeights( numThreads );
+        for( IndexType t=0; t<numThreads; t++ ){
+            threadGraphs.push_back( CSRSparseMatrix<ValueType>( noDist, graph.getLocalStorage() ) );
+            for( const DenseVector<ValueType>& coord : coords ){
+                threadCoords[t].push_back( DenseVector<ValueType>( noDist, coord.getLocalValues() ) );
+            }
+            for( const DenseVector<ValueType>& weight : weights ){
+                threadWeights[t].push_back( DenseVector<ValueType>( noDist, weight.getLocalValues() ) );
+            }
+        }
+
+        //an exception must not leave the parallel region
+        std::vector<std::exception_ptr> errors( numMyAttempts );
+        #pragma omp parallel for schedule(dynamic) num_threads(numThreads)
+        for( IndexType a=0; a<numMyAttempts; a++ ){
+#ifdef _OPENMP
+            const IndexType t = omp_get_thread_num();
+#else
+            const IndexType t = 0;
+#endif
+            try{
+                partitions[a] = runAttempt( myAttempts[a], threadGraphs[t], threadCoords[t], threadWeights[t], noComm, attemptMetrics[a], myObjectives[a] );
+            }catch( ... ){
+                errors[a] = std::current_exception();
+            }
+        }
+        for( const std::exception_ptr& error : errors ){
+            if( error ){
+                std::rethrow_exception( error );
+            }
+        }
+
+        //back to the distribution of the group, the local order is the same
+        for( DenseVector<IndexType>& partition : partitions ){
+            partition = DenseVector<IndexType>( graph.getRowDistributionPtr(), partition.getLocalValues() );
+        }
+    }else{
+        for( IndexType a=0; a<numMyAttempts; a++ ){
+            partitions[a] = runAttempt( myAttempts[a], graph, coords, weights, groupComm, attemptMetrics[a], myObjectives[a] );
+        }
+    }
+
+    //the objective of every attempt, set by the root of the group that computed it
+    std::vector<ValueType> objectives( numStarts, 0 );
+    DenseVector<IndexType> best;
+    ValueType bestObjective = std::numeric_limits<ValueType>::max();
+
+    //the attempts of a group are in increasing order, so ties are broken by the smaller attempt
+    for( IndexType a=0; a<numMyAttempts; a++ ){
+        if( groupComm->getRank()==0 ){
+            objectives[myAttempts[a]] = myObjectives[a];
+        }
+        if( a==0 or myObjectives[a]<bestObjective ){
+            best = partitions[a];
+            bestObjective = myObjectives[a];
+            for( const auto& entry : attemptMetrics[a].MM ){
+                metrics.MM[entry.first] = entry.second;
+            }
+        }
+    }
+
+    comm->sumImpl( objectives.data(), objectives.data(), numStarts, scai::common::TypeTraits<ValueType>::stype );
+    const IndexType winner = std::min_element( objectives.begin(), objectives.end() ) - objectives.begin();
+
+    if( comm->getRank()==0 ){
+        std::cout << "Multi-start objectives:";
+        for( IndexType attempt=0; attempt<numStarts; attempt++ ){
+            std::cout << " " << objectives[attempt];
+        }
+        std::cout << ", keeping attempt " << winner << std::endl;
+    }
+
+    //all PEs report the metrics of the winning attempt, sent by the first PE of the winning group
+    if( numGroups>1 ){
+        std::vector<ValueType> metricValues;
+        for( const auto& entry : metrics.MM ){
+            metricValues.push_back( entry.second );
+        }
+        const IndexType numValues = metricValues.size();
+        SCAI_ASSERT_EQ_ERROR( comm->max(numValues), comm->min(numValues), "The attempts of the groups recorded different metrics" );
+
+        IndexType winnerRoot = 0;
+        while( winnerRoot*numGroups/comm->getSize() != winner%numGroups ){
+            winnerRoot++;
+        }
+        comm->bcast( metricValues.data(), numValues, winnerRoot );
+
+        auto value = metricValues.begin();
+        for( auto& entry : metrics.MM ){
+            entry.second = *value++;
+        }
+    }
+
+    if( numGroups==1 ){
+        return best;
+    }
+
+    //only the partition of the winning group is moved to all PEs
+    return Redistribution<IndexType,ValueType>::copyFromGroup( best, myGroup==winner%numGroups, coordinates[0].getDistributionPtr() );
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+IndexType ParcoRepart<IndexType, ValueType>::numActivePEs(const IndexType n, const Settings& settings, const IndexType numPEs){
+    if( settings.minLocalVertices<=0 or n>=settings.minLocalVertices*numPEs ){
+        return numPEs;
+    }
+    return std::max<IndexType>( 1, n/settings.minLocalVertices );
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+DenseVector<IndexType> ParcoRepart<IndexType, ValueType>::partitionOnFewerPEs(
+    const CSRSparseMatrix<ValueType> &input,
+    const std::vector<DenseVector<ValueType>> &coordinates,
+    const std::vector<DenseVector<ValueType>> &nodeWeights,
+    CommTree<IndexType,ValueType> commTree,
+    scai::dmemo::CommunicatorPtr comm,
+    Settings settings,
+    Metrics<ValueType>& metrics,
+    const IndexType numActivePEs,
+    const bool initialOnly){
+
+    SCAI_REGION( "ParcoRepart.partitionOnFewerPEs" )
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+
+    const bool isActive = comm->getRank()<numActivePEs;
+    const scai::dmemo::CommunicatorPtr activeComm = comm->split( isActive ? 0 : 1 );
+
+    PRINT0("Only " << input.getNumRows()/comm->getSize() << " vertices per PE, computing the " << (initialOnly ? "initial partition" : "partition") \
+        << " on " << numActivePEs << " of " << comm->getSize() << " PEs");
+
+    CSRSparseMatrix<ValueType> activeGraph;
+    std::vector<DenseVector<ValueType>> activeCoords;
+    std::vector<DenseVector<ValueType>> activeWeights;
+    if( input.getColDistributionPtr()->isReplicated() ){
+        Redistribution<IndexType,ValueType>::copyToGroup( activeComm, isActive, input, coordinates, nodeWeights, activeGraph, activeCoords, activeWeights );
+    }else{
+        CSRSparseMatrix<ValueType> inputCopy( input );
+        const scai::dmemo::DistributionPtr noDist( new scai::dmemo::NoDistribution(input.getNumColumns()) );
+        inputCopy.redistribute( input.getRowDistributionPtr(), noDist );
+        Redistribution<IndexType,ValueType>::copyToGroup( activeComm, isActive, inputCopy, coordinates, nodeWeights, activeGraph, activeCoords, activeWeights );
+    }
+
+    DenseVector<IndexType> activePartition;
+    if( isActive ){
+        settings.minLocalVertices = 0;
+        DenseVector<IndexType> noPrevious;
+        if( not initialOnly ){
+            activePartition = partitionGraph( activeGraph, activeCoords, activeWeights, noPrevious, commTree, activeComm, settings, metrics );
+        }else if( settings.multiStarts>1 ){
+            activePartition = multiStartInitialPartition( activeGraph, activeCoords, activeWeights, noPrevious, commTree, activeComm, settings, metrics );
+        }else{
+            activePartition = initialPartition( activeGraph, activeCoords, activeWeights, noPrevious, commTree, activeComm, settings, metrics );
+        }
+    }
+
+    DenseVector<IndexType> result = Redistribution<IndexType,ValueType>::copyFromGroup( activePartition, isActive, \
+        initialOnly ? coordinates[0].getDistributionPtr() : input.getRowDistributionPtr() );
+
+    std::chrono::duration<double> elapTime = std::chrono::steady_clock::now() - start;
+    PRINT0("partition on " << numActivePEs << " PEs, including the copies, took " << comm->max(elapTime.count()) << " seconds");
+
+    return result;
+}
+//---------------------------------------------------------------------------------------
+
 template<typename IndexType, typename ValueType>
 void ParcoRepart<IndexType, ValueType>::doLocalRefinement(
 	DenseVector<IndexType> &result,
@@ -612,6 +973,13 @@ void ParcoRepart<IndexType, ValueType>::doLocalRefinement(
         //now, every PE store its own times. These will be maxed afterwards, before printing in Metrics
         metrics.MM["timeSecondDistribution"] = redistTime.count();
 
+        //the data of every PE is final now, renumber it locally for cache locality during the refinement
+        DenseVector<IndexType> originalIds;
+        if (settings.localReordering != "none") {
+            SCAI_REGION("ParcoRepart.doLocalRefinement.localReordering")
+            originalIds = GraphUtils<IndexType, ValueType>::localReordering(input, coordinates, nodeWeights, {&result}, settings);
+        }
+
         //
         // output: in std and file
         //  
@@ -640,6 +1008,17 @@ void ParcoRepart<IndexType, ValueType>::doLocalRefinement(
 
         ITI::MultiLevel<IndexType, ValueType>::multiLevelStep(input, result, nodeWeights[0], coordinates, halo, commTree, settings, metrics);
 
+        //the caller gets the global ids of the input back, the refinement may have moved vertices between PEs
+        if (settings.localReordering != "none") {
+            const scai::dmemo::DistributionPtr refinedDist = input.getRowDistributionPtr();
+            originalIds.redistribute(refinedDist);
+            result.redistribute(refinedDist);
+            for (DenseVector<ValueType>& coord : coordinates) {
+                coord.redistribute(refinedDist);
+            }
+            GraphUtils<IndexType, ValueType>::undoLocalReordering(input, coordinates, nodeWeights, {&result}, originalIds);
+        }
+
     }else if( settings.localRefAlgo==Tool::geomRebalance ){
         SCAI_REGION("ParcoRepart.doLocalRefinement.geomRebalance")
         std::vector<std::vector<ValueType>> targetBlockWeights = commTree.getBalanceVectors();
@@ -677,116 +1056,70 @@ DenseVector<IndexType> ParcoRepart<IndexType, ValueType>::pixelPartition(const s
     if (k != comm->getSize() && comm->getRank() == 0) {
         throw std::logic_error("Pixel partition only implemented for same number of blocks and processes.");
     }
-
-    std::vector<ValueType> minCoords(dimensions, std::numeric_limits<ValueType>::max());
-    std::vector<ValueType> maxCoords(dimensions, std::numeric_limits<ValueType>::lowest());
-    DenseVector<IndexType> result(coordDist, 0);
-
-    //TODO: probably minimum is not needed
-    //TODO: if we know maximum from the input we could save that although is not too costly
-
-    /*
-     * get minimum / maximum of local coordinates
-     */
-    for (IndexType dim = 0; dim < dimensions; dim++) {
-        //get local parts of coordinates
-        scai::hmemo::ReadAccess<ValueType> localPartOfCoords( coordinates[dim].getLocalValues() );
-        for (IndexType i = 0; i < localN; i++) {
-            ValueType coord = localPartOfCoords[i];
-            if (coord < minCoords[dim]) minCoords[dim] = coord;
-            if (coord > maxCoords[dim]) maxCoords[dim] = coord;
-        }
+    if (dimensions != 2 and dimensions != 3) {
+        throw std::runtime_error("Available only for 2D and 3D. Data given have dimension:" + std::to_string(dimensions) );
     }
 
-    /*
-     * communicate to get global min / max
-     */
-    for (IndexType dim = 0; dim < dimensions; dim++) {
-        minCoords[dim] = comm->min(minCoords[dim]);
-        maxCoords[dim] = comm->max(maxCoords[dim]);
-    }
+    DenseVector<IndexType> result(coordDist, 0);
 
-    // measure density with rounding
-    // have to handle 2D and 3D cases seperately
     const IndexType sideLen = settings.pixeledSideLen;
-    const IndexType cubeSize = std::pow(sideLen, dimensions);
-
-    //TODO: generalize this to arbitrary dimensions, do not handle 2D and 3D differently
-    //TODO: by a  for(int d=0; d<dimension; d++){ ... }
-    // a 2D or 3D arrays as a one dimensional vector
-    // [i][j] is in position: i*sideLen + j
-    // [i][j][k] is in: i*sideLen*sideLen + j*sideLen + k
 
-    //std::vector<IndexType> density( cubeSize ,0);
-    scai::hmemo::HArray<IndexType> density( cubeSize, IndexType(0) );
-    scai::hmemo::WriteAccess<IndexType> wDensity(density);
+    //only the occupied pixels are stored, so memory and communication grow with the number of points, not with sideLen^dimensions
+    const std::vector<IndexType> localPixel = localPixels(coordinates, sideLen);
 
     SCAI_REGION_END("ParcoRepart.pixelPartition.initialise")
 
-    if(dimensions==2) {
+    std::vector<IndexType> occupiedPixels;
+    std::vector<ValueType> pixelDensity;
+    {
         SCAI_REGION( "ParcoRepart.pixelPartition.localDensity" )
-        scai::hmemo::ReadAccess<ValueType> coordAccess0( coordinates[0].getLocalValues() );
-        scai::hmemo::ReadAccess<ValueType> coordAccess1( coordinates[1].getLocalValues() );
-
-        IndexType scaledX, scaledY;
-        //the +1 is needed
-        IndexType maxX = maxCoords[0]+1;
-        IndexType maxY = maxCoords[1]+1;
-
+        std::unordered_map<IndexType,ValueType> localDensity;
         for(IndexType i=0; i<localN; i++) {
-            scaledX = coordAccess0[i]/maxX * sideLen;
-            scaledY = coordAccess1[i]/maxY * sideLen;
-            IndexType pixelInd = scaledX*sideLen + scaledY;
-            SCAI_ASSERT( pixelInd < wDensity.size(), "Index too big: "<< std::to_string(pixelInd) );
-            ++wDensity[pixelInd];
+            ++localDensity[localPixel[i]];
         }
-    } else if(dimensions==3) {
-        SCAI_REGION( "ParcoRepart.pixelPartition.localDensity" )
-        scai::hmemo::ReadAccess<ValueType> coordAccess0( coordinates[0].getLocalValues() );
-        scai::hmemo::ReadAccess<ValueType> coordAccess1( coordinates[1].getLocalValues() );
-        scai::hmemo::ReadAccess<ValueType> coordAccess2( coordinates[2].getLocalValues() );
-
-        IndexType scaledX, scaledY, scaledZ;
-
-        IndexType maxX = maxCoords[0]+1;
-        IndexType maxY = maxCoords[1]+1;
-        IndexType maxZ = maxCoords[2]+1;
-
-        for(IndexType i=0; i<localN; i++) {
-            scaledX = coordAccess0[i]/maxX * sideLen;
-            scaledY = coordAccess1[i]/maxY * sideLen;
-            scaledZ = coordAccess2[i]/maxZ * sideLen;
-            IndexType pixelInd = scaledX*sideLen*sideLen + scaledY*sideLen + scaledZ;
-
-            SCAI_ASSERT( pixelInd < wDensity.size(), "Index too big: "<< std::to_string(pixelInd) );
-            ++wDensity[pixelInd];
+        for(const auto& pixel : localDensity) {
+            occupiedPixels.push_back(pixel.first);
+            pixelDensity.push_back(pixel.second);
         }
-    } else {
-        throw std::runtime_error("Available only for 2D and 3D. Data given have dimension:" + std::to_string(dimensions) );
     }
-    wDensity.release();
 
     // sum density from all PEs
     {
         SCAI_REGION( "ParcoRepart.pixelPartition.sumDensity" )
-        comm->sumArray( density );
+        sumSparse( occupiedPixels, pixelDensity, comm );
     }
 
-    //TODO: is that needed? we just can overwrite density array.
-    // use the summed density as a Dense vector
-    scai::lama::DenseVector<IndexType> sumDensity( density );
+    // the density of the occupied pixels, a picked pixel gets density -1
+    std::unordered_map<IndexType,IndexType> sumDensity;
+    for(IndexType p=0; p<occupiedPixels.size(); p++) {
+        sumDensity[occupiedPixels[p]] = IndexType(std::round(pixelDensity[p]));
+    }
+    // empty pixels have density 0 and are never stored, a block only crosses them to reach occupied pixels nearby
+    auto density = [&sumDensity](const IndexType pixel) {
+        const auto it = sumDensity.find(pixel);
+        return it != sumDensity.end() ? it->second : IndexType(0);
+    };
+
+    // how many empty pixels in a row a block may cross, so that a block does not flood the empty space
+    const IndexType maxEmptyHops = 2;
 
     //
     //using the summed density get an initial pixeled partition
 
-    std::vector<IndexType> pixeledPartition( density.size(), -1);
+    std::unordered_map<IndexType,IndexType> pixeledPartition;
 
     IndexType pointsLeft= globalN;
-    IndexType pixelsLeft= cubeSize;
+    IndexType pixelsLeft= occupiedPixels.size();
     IndexType maxBlockSize = globalN/k * 1.02; // allowing some imbalance
-    PRINT0("max allowed block size: " << maxBlockSize );
+    PRINT0("max allowed block size: " << maxBlockSize << ", occupied pixels: " << pixelsLeft );
     IndexType thisBlockSize;
 
+    // a pixel at the border of the growing block, with the number of empty pixels crossed to reach it
+    struct BorderPixel {
+        ValueType value;
+        IndexType emptyHops;
+    };
+
     //for all the blocks
     for(IndexType block=0; block<k; block++) {
         SCAI_REGION( "ParcoRepart.pixelPartition.localPixelGrowing")
@@ -800,18 +1133,13 @@ DenseVector<IndexType> ParcoRepart<IndexType, ValueType>::pixelPartition(const s
         ValueType pixelDistance;
 
         // start from the densest pixel
-        //IndexType maxDensityPixel = std::distance( sumDensity.begin(), std::max_element(sumDensity.begin(), sumDensity.end()) );
-
-        //TODO: sumDensity is local/not distributed. No need for that, just to avoid getValue.
-        scai::hmemo::WriteAccess<IndexType> localSumDens( sumDensity.getLocalValues() );
-
         //TODO: bad way to do that. linear time for every block. maybe sort or use a priority queue
         IndexType maxDensityPixel=-1;
         IndexType maxDensity=-1;
-        for(IndexType ii=0; ii<sumDensity.size(); ii++) {
-            if(localSumDens[ii]>maxDensity) {
-                maxDensityPixel = ii;
-                maxDensity= localSumDens[ii];
+        for(const IndexType pixel : occupiedPixels) {
+            if(density(pixel)>maxDensity) {
+                maxDensityPixel = pixel;
+                maxDensity= density(pixel);
             }
         }
 
@@ -820,74 +1148,70 @@ DenseVector<IndexType> ParcoRepart<IndexType, ValueType>::pixelPartition(const s
             break;
         }
 
-        SCAI_ASSERT(maxDensityPixel < sumDensity.size(), "Too big index: " + std::to_string(maxDensityPixel));
-        SCAI_ASSERT(maxDensityPixel >= 0, "Negative index: " + std::to_string(maxDensityPixel));
-        spreadFactor = averagePointsPerPixel/localSumDens[ maxDensityPixel ];
+        spreadFactor = averagePointsPerPixel/density(maxDensityPixel);
+
+        // the border: the current value of every border pixel and a max-heap with lazy deletion, outdated
+        // heap entries are skipped when they are popped
+        std::unordered_map<IndexType, BorderPixel> border;
+        std::priority_queue<std::pair<ValueType, IndexType>> borderQueue;
+        // the empty pixels crossed by this block, only kept while the block grows
+        std::unordered_set<IndexType> crossedEmpty;
+
+        auto isFree = [&](const IndexType pixel) {
+            return density(pixel) != -1 and crossedEmpty.count(pixel) == 0;
+        };
 
-        //TODO: change to more appropriate data type
-        // insert all the neighbouring pixels
-        std::vector<std::pair<IndexType, ValueType>> border;
         std::vector<IndexType> neighbours = ParcoRepart<IndexType, ValueType>::neighbourPixels( maxDensityPixel, sideLen, dimensions);
 
-        // insert in border if not already picked
+        // insert in border if not already picked, empty pixels included
         for(IndexType j=0; j<neighbours.size(); j++) {
-            // make sure this neighbour does not belong to another block
-            if(localSumDens[ neighbours[j]] != -1 ) {
-                std::pair<IndexType, ValueType> toInsert;
-                toInsert.first = neighbours[j];
-                SCAI_ASSERT(neighbours[j] < sumDensity.size(), "Too big index: " + std::to_string(neighbours[j]));
-                SCAI_ASSERT(neighbours[j] >= 0, "Negative index: " + std::to_string(neighbours[j]));
+            if( isFree(neighbours[j]) ) {
                 geomSpread = 1 + 1/std::log2(sideLen)*( aux<IndexType,ValueType>::absDiff(sideLen/2, neighbours[j]/sideLen)/(0.8*sideLen/2) + aux<IndexType,ValueType>::absDiff(sideLen/2, neighbours[j]%sideLen)/(0.8*sideLen/2) );
-                
+
                 // value to pick a border node
                 pixelDistance = aux<IndexType, ValueType>::pixelL2Distance2D( maxDensityPixel, neighbours[j], sideLen);
-                toInsert.second = (1/pixelDistance)* geomSpread * (spreadFactor* (std::pow(localSumDens[neighbours[j]], 0.5)) + std::pow(localSumDens[maxDensityPixel], 0.5) );
-                border.push_back(toInsert);
+                const ValueType value = (1/pixelDistance)* geomSpread * (spreadFactor* (std::pow(density(neighbours[j]), 0.5)) + std::pow(density(maxDensityPixel), 0.5) );
+                border[neighbours[j]] = BorderPixel{ value, density(neighbours[j])>0 ? 0 : 1 };
+                borderQueue.push( {value, neighbours[j]} );
             }
         }
-        thisBlockSize = localSumDens[maxDensityPixel];
+        thisBlockSize = density(maxDensityPixel);
 
         pixeledPartition[maxDensityPixel] = block;
 
         // set this pixel to -1 so it is not picked again
-        localSumDens[maxDensityPixel] = -1;
-
-
-        while(border.size() !=0 ) {     // there are still pixels to check
-
-            //TODO: different data type to avoid that
-            // sort border by the value in increasing order
-            std::sort( border.begin(), border.end(),
-            [](const std::pair<IndexType, ValueType> &left, const std::pair<IndexType, ValueType> &right) {
-                return left.second < right.second;
-            });
+        sumDensity[maxDensityPixel] = -1;
 
-            std::pair<IndexType, ValueType> bestPixel;
-            IndexType bestIndex=-1;
-            do {
-                bestPixel = border.back();
-                border.pop_back();
-                bestIndex = bestPixel.first;
+        while( not borderQueue.empty() ) {     // there are still pixels to check
 
-            } while( localSumDens[ bestIndex] +thisBlockSize > maxBlockSize and border.size()>0); // this pixel is too big
-
-            // picked last pixel in border but is too big
-            if(localSumDens[ bestIndex] +thisBlockSize > maxBlockSize ) {
-                break;
+            const std::pair<ValueType, IndexType> top = borderQueue.top();
+            borderQueue.pop();
+            const IndexType bestIndex = top.second;
+            const auto entry = border.find(bestIndex);
+            if( entry==border.end() or entry->second.value!=top.first ) {
+                continue;   // outdated entry
             }
-            SCAI_ASSERT(localSumDens[ bestIndex ] != -1, "Wrong pixel choice.");
-
-            // this pixel now belongs in this block
-            SCAI_ASSERT(bestIndex < sumDensity.size(), "Wrong pixel index: " + std::to_string(bestIndex));
-            pixeledPartition[ bestIndex ] = block;
-            thisBlockSize += localSumDens[ bestIndex ];
-            --pixelsLeft;
-            pointsLeft -= localSumDens[ bestIndex ];
+            const IndexType bestHops = entry->second.emptyHops;
+            border.erase(entry);
 
-            //averagePointsPerPixel = ValueType(pointsLeft)/pixelsLeft;
-            //spreadFactor = localSumDens[ bestIndex ]/averagePointsPerPixel;
-            //spreadFactor = (k-block)*averagePointsPerPixel/localSumDens[ bestIndex ];
-            spreadFactor = averagePointsPerPixel/localSumDens[ bestIndex ];
+            // this pixel is too big, or the block is full and does not need to cross empty pixels any more
+            const IndexType bestDensity = density( bestIndex );
+            if( bestDensity +thisBlockSize > maxBlockSize or (bestDensity==0 and thisBlockSize>=maxBlockSize) ) {
+                continue;
+            }
+            SCAI_ASSERT(bestDensity != -1, "Wrong pixel choice.");
+
+            // this pixel now belongs in this block, an empty pixel only connects the block to further pixels
+            if( bestDensity > 0 ) {
+                pixeledPartition[ bestIndex ] = block;
+                sumDensity[ bestIndex ] = -1;
+                thisBlockSize += bestDensity;
+                --pixelsLeft;
+                pointsLeft -= bestDensity;
+                spreadFactor = averagePointsPerPixel/bestDensity;
+            } else {
+                crossedEmpty.insert( bestIndex );
+            }
 
             //get the neighbours of the new pixel
             std::vector<IndexType> neighbours = ParcoRepart<IndexType, ValueType>::neighbourPixels( bestIndex, sideLen, dimensions);
@@ -895,115 +1219,168 @@ DenseVector<IndexType> ParcoRepart<IndexType, ValueType>::pixelPartition(const s
             //insert neighbour in border or update value if already there
             for(IndexType j=0; j<neighbours.size(); j++) {
 
-                SCAI_ASSERT(neighbours[j] < sumDensity.size(), "Too big index: " + std::to_string(neighbours[j]));
-                SCAI_ASSERT(neighbours[j] >= 0, "Negative index: " + std::to_string(neighbours[j]));
-
-                //geomSpread = 1 + 1.0/detailLvl*( std::abs(sideLen/2.0 - neighbours[j]/sideLen)/(0.8*sideLen/2.0) + std::abs(sideLen/2.0 - neighbours[j]%sideLen)/(0.8*sideLen/2.0) );
-                IndexType ngbrX = neighbours[j]/sideLen;
-                IndexType ngbrY = neighbours[j]%sideLen;
-
-                geomSpread= 1+ (std::pow(ngbrX-sideLen/2, 2) + std::pow(ngbrY-sideLen/2, 2))*(2/std::pow(sideLen,2));
-                //geomSpread = geomSpread * geomSpread;// std::pow(geomSpread, 0.5);
-                //
                 geomSpread = 1;
-                //
 
-                if (localSumDens[ neighbours[j]] == -1) { // this pixel is already picked by a block (maybe this)
+                if ( not isFree(neighbours[j]) ) { // this pixel is already picked by a block (maybe this)
+                    continue;
+                }
+                const IndexType neighbourDensity = density(neighbours[j]);
+                const IndexType hops = neighbourDensity>0 ? 0 : bestHops+1;
+                if( hops > maxEmptyHops ) {
                     continue;
+                }
+
+                pixelDistance = aux<IndexType, ValueType>::pixelL2Distance2D( maxDensityPixel, neighbours[j], sideLen);
+                const ValueType gain = geomSpread*  (1/(pixelDistance*pixelDistance))* ( spreadFactor *std::pow(neighbourDensity, 0.5) + std::pow(bestDensity, 0.5) );
+
+                auto inBorder = border.find(neighbours[j]);
+                if( inBorder!=border.end() ) { // its already in border, update value
+                    inBorder->second.value += gain;
+                    inBorder->second.emptyHops = std::min( inBorder->second.emptyHops, hops );
+                    borderQueue.push( {inBorder->second.value, neighbours[j]} );
                 } else {
-                    bool inBorder = false;
-
-                    for (IndexType l=0; l<border.size(); l++) {
-                        if( border[l].first == neighbours[j]) { // its already in border, update value
-                            //border[l].second = 1.3*border[l].second + geomSpread * (spreadFactor*(std::pow(localSumDens[neighbours[j]], 0.5)) + std::pow(localSumDens[bestIndex], 0.5) );
-                            pixelDistance = aux<IndexType, ValueType>::pixelL2Distance2D( maxDensityPixel, neighbours[j], sideLen);
-                            border[l].second += geomSpread*  (1/(pixelDistance*pixelDistance))* ( spreadFactor *std::pow(localSumDens[neighbours[j]], 0.5) + std::pow(localSumDens[bestIndex], 0.5) );
-                            inBorder= true;
-                        }
-                    }
-                    if (!inBorder) {
-                        std::pair<IndexType, ValueType> toInsert;
-                        toInsert.first = neighbours[j];
-                        //toInsert.second = geomSpread * (spreadFactor* (std::pow(localSumDens[neighbours[j]], 0.5)) + std::pow(localSumDens[bestIndex], 0.5));
-                        pixelDistance = aux<IndexType, ValueType>::pixelL2Distance2D( maxDensityPixel, neighbours[j], sideLen);
-                        //toInsert.second = (1/(pixelDistance*pixelDistance))* geomSpread * (spreadFactor* (std::pow(localSumDens[neighbours[j]], 0.5)) + std::pow(localSumDens[bestIndex], 0.5));
-                        toInsert.second = geomSpread*  (1/(pixelDistance*pixelDistance))* ( spreadFactor *(std::pow(localSumDens[neighbours[j]], 0.5)) + std::pow(localSumDens[bestIndex], 0.5) );
-                        //toInsert.second = geomSpread * (spreadFactor* (std::pow(localSumDens[neighbours[j]], 0.5)) + std::pow(localSumDens[bestIndex], 0.5))/(std::pow( std::abs( localSumDens[bestIndex] - localSumDens[neighbours[j]]),0.5));
-                        border.push_back(toInsert);
-                    }
+                    border[neighbours[j]] = BorderPixel{ gain, hops };
+                    borderQueue.push( {gain, neighbours[j]} );
                 }
             }
-
-            localSumDens[ bestIndex ] = -1;
         }
         //PRINT0("##### final blockSize for block "<< block << ": "<< thisBlockSize);
     } // for(IndexType block=0; block<k; block++)
 
-    // assign all orphan pixels to last block
-    for(unsigned long int pp=0; pp<pixeledPartition.size(); pp++) {
-        scai::hmemo::ReadAccess<IndexType> localSumDens( sumDensity.getLocalValues() );
-        if(pixeledPartition[pp] == -1) {
-            pixeledPartition[pp] = k-1;
-            thisBlockSize += localSumDens[pp];
-        }
-    }
-    //PRINT0("##### final blockSize for block "<< k-1 << ": "<< thisBlockSize);
-
     /*
-     * here all pixels should have a partition
+     * here all picked pixels have a partition, the remaining occupied pixels go to the last block
     */
 
     // set your local part of the partition/result
-    scai::hmemo::WriteOnlyAccess<IndexType> wLocalPart ( result.getLocalValues() );
-
-    if(dimensions==2) {
+    {
         SCAI_REGION( "ParcoRepart.pixelPartition.setLocalPartition" )
-        scai::hmemo::ReadAccess<ValueType> coordAccess0( coordinates[0].getLocalValues() );
-        scai::hmemo::ReadAccess<ValueType> coordAccess1( coordinates[1].getLocalValues() );
-
-        IndexType scaledX, scaledY;
-        //the +1 is needed
-        IndexType maxX = maxCoords[0]+1;
-        IndexType maxY = maxCoords[1]+1;
-
+        scai::hmemo::WriteOnlyAccess<IndexType> wLocalPart ( result.getLocalValues() );
         for(IndexType i=0; i<localN; i++) {
-            scaledX = coordAccess0[i]/maxX * sideLen;
-            scaledY = coordAccess1[i]/maxY * sideLen;
-            IndexType densInd = scaledX*sideLen + scaledY;
-            //PRINT(densInd << " # " << coordAccess0[i] << " _ " << coordAccess1[i] );
-            SCAI_ASSERT( densInd < density.size(), "Index too big: "<< std::to_string(densInd) );
-
-            wLocalPart[i] = pixeledPartition[densInd];
+            const auto it = pixeledPartition.find(localPixel[i]);
+            wLocalPart[i] = it != pixeledPartition.end() ? it->second : k-1;
             SCAI_ASSERT(wLocalPart[i] < k, " Wrong block number: " + std::to_string(wLocalPart[i] ) );
         }
-    } else if(dimensions==3) {
-        SCAI_REGION( "ParcoRepart.pixelPartition.setLocalPartition" )
-        scai::hmemo::ReadAccess<ValueType> coordAccess0( coordinates[0].getLocalValues() );
-        scai::hmemo::ReadAccess<ValueType> coordAccess1( coordinates[1].getLocalValues() );
-        scai::hmemo::ReadAccess<ValueType> coordAccess2( coordinates[2].getLocalValues() );
+    }
 
-        IndexType scaledX, scaledY, scaledZ;
+    return result;
+}
 
-        IndexType maxX = maxCoords[0]+1;
-        IndexType maxY = maxCoords[1]+1;
-        IndexType maxZ = maxCoords[2]+1;
+//-----------------------------------------------------------------------------------------
 
-        for(IndexType i=0; i<localN; i++) {
-            scaledX = coordAccess0[i]/maxX * sideLen;
-            scaledY = coordAccess1[i]/maxY * sideLen;
-            scaledZ = coordAccess2[i]/maxZ * sideLen;
-            IndexType densInd = scaledX*sideLen*sideLen + scaledY*sideLen + scaledZ;
+template<typename IndexType, typename ValueType>
+std::vector<IndexType> ParcoRepart<IndexType, ValueType>::localPixels(const std::vector<DenseVector<ValueType>> &coordinates, const IndexType sideLen) {
+    SCAI_REGION( "ParcoRepart.localPixels" )
 
-            SCAI_ASSERT( densInd < density.size(), "Index too big: "<< std::to_string(densInd) );
-            wLocalPart[i] = pixeledPartition[densInd];
-            SCAI_ASSERT(wLocalPart[i] < k, " Wrong block number: " + std::to_string(wLocalPart[i] ) );
+    const scai::dmemo::CommunicatorPtr comm = coordinates[0].getDistributionPtr()->getCommunicatorPtr();
+    const IndexType dimensions = coordinates.size();
+    const IndexType localN = coordinates[0].getDistributionPtr()->getLocalSize();
+
+    SCAI_ASSERT_LT_ERROR( std::pow(double(sideLen), dimensions), double(std::numeric_limits<IndexType>::max()), "Too many pixels for the index type, reduce the side length" );
+
+    std::vector<IndexType> pixels(localN, 0);
+    for (IndexType dim = 0; dim < dimensions; dim++) {
+        scai::hmemo::ReadAccess<ValueType> rCoords( coordinates[dim].getLocalValues() );
+
+        ValueType minCoord = std::numeric_limits<ValueType>::max();
+        ValueType maxCoord = std::numeric_limits<ValueType>::lowest();
+        for (IndexType i = 0; i < localN; i++) {
+            minCoord = std::min(minCoord, rCoords[i]);
+            maxCoord = std::max(maxCoord, rCoords[i]);
+        }
+        minCoord = comm->min(minCoord);
+        maxCoord = comm->max(maxCoord);
+        const ValueType width = maxCoord - minCoord;
+
+        // [i][j] is in position: i*sideLen + j, [i][j][k] in: i*sideLen*sideLen + j*sideLen + k
+        for (IndexType i = 0; i < localN; i++) {
+            IndexType scaled = width > 0 ? IndexType( (rCoords[i]-minCoord)/width*sideLen ) : 0;
+            scaled = std::min(scaled, sideLen-1);
+            pixels[i] = pixels[i]*sideLen + scaled;
         }
-    } else {
-        throw std::runtime_error("Available only for 2D and 3D. Data given have dimension:" + std::to_string(dimensions) );
     }
-    wLocalPart.release();
+    return pixels;
+}
+//-----------------------------------------------------------------------------------------
 
-    return result;
+template<typename IndexType, typename ValueType>
+void ParcoRepart<IndexType, ValueType>::sumSparse(std::vector<IndexType>& keys, std::vector<ValueType>& values, const scai::dmemo::CommunicatorPtr comm) {
+    SCAI_REGION( "ParcoRepart.sumSparse" )
+    SCAI_ASSERT_EQ_ERROR( keys.size(), values.size(), "Every key needs a value" );
+
+    //sort by key and add the values of equal keys
+    auto combine = [](std::vector<IndexType>& keys, std::vector<ValueType>& values) {
+        std::vector<IndexType> order(keys.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&keys](const IndexType a, const IndexType b) {
+            return keys[a] < keys[b];
+        });
+        std::vector<IndexType> newKeys;
+        std::vector<ValueType> newValues;
+        for (const IndexType i : order) {
+            if (!newKeys.empty() and newKeys.back() == keys[i]) {
+                newValues.back() += values[i];
+            } else {
+                newKeys.push_back(keys[i]);
+                newValues.push_back(values[i]);
+            }
+        }
+        keys.swap(newKeys);
+        values.swap(newValues);
+    };
+
+    combine(keys, values);
+
+    const IndexType numPEs = comm->getSize();
+    if (numPEs == 1) {
+        return;
+    }
+
+    //exchange pairs with the plan given by the number of entries for every PE
+    auto exchange = [&comm, numPEs](const std::vector<IndexType>& quantities, const std::vector<IndexType>& sendKeys, const std::vector<ValueType>& sendValues,
+                                    std::vector<IndexType>& recvKeys, std::vector<ValueType>& recvValues) {
+        const scai::dmemo::CommunicationPlan sendPlan(quantities.data(), numPEs);
+        const scai::dmemo::CommunicationPlan recvPlan = comm->transpose(sendPlan);
+        recvKeys.resize(recvPlan.totalQuantity());
+        recvValues.resize(recvPlan.totalQuantity());
+        comm->exchangeByPlan(recvKeys.data(), recvPlan, sendKeys.data(), sendPlan);
+        comm->exchangeByPlan(recvValues.data(), recvPlan, sendValues.data(), sendPlan);
+    };
+
+    //every key is reduced on its owner PE, the keys are spread by a hash since neighboring pixels have close ids
+    auto owner = [numPEs](const IndexType key) {
+        return IndexType(std::hash<IndexType>{}(key) % numPEs);
+    };
+    std::vector<IndexType> quantities(numPEs, 0);
+    for (const IndexType key : keys) {
+        quantities[owner(key)]++;
+    }
+    std::vector<IndexType> offsets(numPEs+1, 0);
+    std::partial_sum(quantities.begin(), quantities.end(), offsets.begin()+1);
+    std::vector<IndexType> sendKeys(keys.size());
+    std::vector<ValueType> sendValues(values.size());
+    for (IndexType i = 0; i < IndexType(keys.size()); i++) {
+        const IndexType pos = offsets[owner(keys[i])]++;
+        sendKeys[pos] = keys[i];
+        sendValues[pos] = values[i];
+    }
+
+    std::vector<IndexType> ownedKeys;
+    std::vector<ValueType> ownedValues;
+    exchange(quantities, sendKeys, sendValues, ownedKeys, ownedValues);
+    combine(ownedKeys, ownedValues);
+
+    //every PE sends its reduced keys to all PEs, the callers need the global sums everywhere
+    std::fill(quantities.begin(), quantities.end(), IndexType(ownedKeys.size()));
+    std::vector<IndexType> allOwnedKeys(numPEs*ownedKeys.size());
+    std::vector<ValueType> allOwnedValues(numPEs*ownedValues.size());
+    for (IndexType p = 0; p < numPEs; p++) {
+        std::copy(ownedKeys.begin(), ownedKeys.end(), allOwnedKeys.begin() + p*ownedKeys.size());
+        std::copy(ownedValues.begin(), ownedValues.end(), allOwnedValues.begin() + p*ownedValues.size());
+    }
+    exchange(quantities, allOwnedKeys, allOwnedValues, keys, values);
+
+    //the keys are unique now, this only sorts them
+    combine(keys, values);
 }
 
 //-----------------------------------------------------------------------------------------
@@ -1018,30 +1395,117 @@ std::vector<DenseVector<IndexType>> ParcoRepart<IndexType, ValueType>::getCommun
     const scai::dmemo::CommunicatorPtr comm = adjM.getRowDistributionPtr()->getCommunicatorPtr();
 
     assert(adjM.getNumColumns() == adjM.getNumRows() );
+    //the coloring is identical on all PEs, so it is computed once per node by the node leader and shared
     IndexType colors;
+    IndexType numColoredEdges;
     std::vector<std::vector<IndexType>> coloring;
+    //the bytes of the block graph that every PE would hold otherwise
+    ValueType sharedGraphBytes = 0;
     {
         std::chrono::time_point<std::chrono::steady_clock> beforeColoring =  std::chrono::steady_clock::now();
-        if (!adjM.getRowDistributionPtr()->isReplicated()) {
-            //PRINT0("***WARNING: In getCommunicationPairs_local: given graph is not replicated; will replicate now");
-            const scai::dmemo::DistributionPtr noDist(new scai::dmemo::NoDistribution(N));
-            adjM.redistribute(noDist, noDist);
-            //throw std::runtime_error("Input matrix must be replicated.");
+
+        NodeSharedArray<IndexType> coloringSize(comm, 2);
+        if (adjM.getRowDistributionPtr()->isReplicated()) {
+            if (coloringSize.isLeader()) {
+                coloring = GraphUtils<IndexType, ValueType>::mecGraphColoring( adjM, colors); // our implementation
+            }
+        } else {
+            //instead of replicating the graph on every PE, its rows are gathered once per node
+            const scai::dmemo::DistributionPtr dist = adjM.getRowDistributionPtr();
+            const IndexType localN = dist->getLocalSize();
+            const scai::lama::CSRStorage<ValueType>& localStorage = adjM.getLocalStorage();
+            const IndexType localNnz = localStorage.getNumValues();
+            const IndexType nnz = comm->sum(localNnz);
+            sharedGraphBytes = ValueType(N)*2*sizeof(IndexType) + ValueType(nnz)*(sizeof(IndexType) + sizeof(ValueType));
+
+            std::vector<IndexType> localRows(2*localN);
+            {
+                scai::hmemo::ReadAccess<IndexType> ia(localStorage.getIA());
+                for (IndexType i = 0; i < localN; i++) {
+                    localRows[2*i] = dist->local2Global(i);
+                    localRows[2*i+1] = ia[i+1] - ia[i];
+                }
+            }
+            //sharedRows[2*r] is the global index of the r-th gathered row, sharedRows[2*r+1] its degree
+            NodeSharedArray<IndexType> sharedRows(comm, 2*N);
+            NodeSharedArray<IndexType> sharedJA(comm, nnz);
+            NodeSharedArray<ValueType> sharedValues(comm, nnz);
+            sharedRows.allGather(comm, localRows.data(), 2*localN);
+            sharedJA.allGather(comm, scai::hmemo::ReadAccess<IndexType>(localStorage.getJA()).get(), localNnz);
+            sharedValues.allGather(comm, scai::hmemo::ReadAccess<ValueType>(localStorage.getValues()).get(), localNnz);
+
+            if (coloringSize.isLeader()) {
+                //the replicated matrix exists only on the leader and only for the coloring
+                std::vector<IndexType> firstOfRow(N);
+                scai::hmemo::HArray<IndexType> csrIA;
+                scai::hmemo::HArray<IndexType> csrJA;
+                scai::hmemo::HArray<ValueType> csrValues;
+                {
+                    const IndexType* rows = sharedRows.data();
+                    scai::hmemo::WriteOnlyAccess<IndexType> ia(csrIA, N+1);
+                    IndexType gathered = 0;
+                    for (IndexType r = 0; r < N; r++) {
+                        ia[rows[2*r]+1] = rows[2*r+1];
+                        firstOfRow[rows[2*r]] = gathered;
+                        gathered += rows[2*r+1];
+                    }
+                    ia[0] = 0;
+                    for (IndexType i = 0; i < N; i++) {
+                        ia[i+1] += ia[i];
+                    }
+
+                    scai::hmemo::WriteOnlyAccess<IndexType> ja(csrJA, nnz);
+                    scai::hmemo::WriteOnlyAccess<ValueType> values(csrValues, nnz);
+                    for (IndexType i = 0; i < N; i++) {
+                        std::copy(sharedJA.data() + firstOfRow[i], sharedJA.data() + firstOfRow[i] + ia[i+1] - ia[i], ja.get() + ia[i]);
+                        std::copy(sharedValues.data() + firstOfRow[i], sharedValues.data() + firstOfRow[i] + ia[i+1] - ia[i], values.get() + ia[i]);
+                    }
+                }
+                scai::lama::CSRStorage<ValueType> replicatedStorage;
+                replicatedStorage.allocate(N, N);
+                replicatedStorage.swap(csrIA, csrJA, csrValues);
+                CSRSparseMatrix<ValueType> replicatedGraph;
+                replicatedGraph.assign(replicatedStorage);
+                coloring = GraphUtils<IndexType, ValueType>::mecGraphColoring( replicatedGraph, colors); // our implementation
+            }
         }
-        //here graph is replicated. PE0 will write it in a file
 
-        coloring = GraphUtils<IndexType, ValueType>::mecGraphColoring( adjM, colors); // our implementation
+        if (coloringSize.isLeader()) {
+            coloringSize.data()[0] = colors;
+            coloringSize.data()[1] = coloring[0].size();
+        }
+        coloringSize.synchronize();
+        colors = coloringSize.data()[0];
+        numColoredEdges = coloringSize.data()[1];
 
         std::chrono::duration<double> coloringTime = std::chrono::steady_clock::now() - beforeColoring;
         ValueType maxTime = comm->max( coloringTime.count() );
         ValueType minTime = comm->min( coloringTime.count() );
-        if (settings.verbose) PRINT0("coloring done in time " << minTime << " -- " << maxTime << ", using " << colors << " colors" );
+        if (settings.verbose) {
+            PRINT0("coloring done in time " << minTime << " -- " << maxTime << ", using " << colors << " colors" );
+            const ValueType savedBytes = (coloringSize.nodeSize()-1)*(sharedGraphBytes + ValueType(numColoredEdges)*3*sizeof(IndexType));
+            PRINT0("sharing the block graph and its coloring saves " << savedBytes/1024 << " KB on the node of PE 0");
+        }
     }
+
+    //sharedColoring[c*numColoredEdges+i] is coloring[c][i]
+    NodeSharedArray<IndexType> sharedColoring(comm, 3*numColoredEdges);
+    if (sharedColoring.isLeader()) {
+        for (IndexType c = 0; c < 3; c++) {
+            std::copy( coloring[c].begin(), coloring[c].end(), sharedColoring.data() + c*numColoredEdges );
+        }
+        coloring.clear();
+    }
+    sharedColoring.synchronize();
+    const IndexType* firstBlocks = sharedColoring.data();
+    const IndexType* secondBlocks = sharedColoring.data() + numColoredEdges;
+    const IndexType* edgeColors = sharedColoring.data() + 2*numColoredEdges;
+
     std::vector<DenseVector<IndexType>> retG(colors);
 
     if (adjM.getNumRows()==2) {
         assert(colors<=1);
-        assert(coloring[0].size()<=1);
+        assert(numColoredEdges<=1);
     }
 
     for(IndexType i=0; i<colors; i++) {
@@ -1056,12 +1520,12 @@ std::vector<DenseVector<IndexType>> ParcoRepart<IndexType, ValueType>::getCommun
     // for all the edges:
     // coloring[0][i] = the first block , coloring[1][i] = the second block,
     // coloring[2][i]= the color/round in which the two blocks shall communicate
-    for(IndexType i=0; i<coloring[0].size(); i++) {
-        IndexType color = coloring[2][i]; // the color/round of this edge
+    for(IndexType i=0; i<numColoredEdges; i++) {
+        IndexType color = edgeColors[i]; // the color/round of this edge
         //assert(color<colors);
         SCAI_ASSERT_LT_ERROR( color, colors, "Wrong number of colors?");
-        IndexType firstBlock = coloring[0][i];
-        IndexType secondBlock = coloring[1][i];
+        IndexType firstBlock = firstBlocks[i];
+        IndexType secondBlock = secondBlocks[i];
         retG[color].setValue( firstBlock, secondBlock);
         retG[color].setValue( secondBlock, firstBlock );
     }
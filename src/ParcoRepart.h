@@ -86,6 +86,8 @@ public:
      * @param[in] commTree A tree describing the communication graph.
      * @param[in] settings Settings struct
      * @param[out] metrics Struct into which time measurements are written
+     * @param[in] streamed Optional, with settings.initialPartition=geoStream the partition streamed while the input
+     * was read, in the row distribution of the input, \sa StreamingPartition. It is used as the initial partition.
      *
      * @return partition Distributed DenseVector of length n, partition[i] contains the block ID of node i
      */
@@ -97,7 +99,8 @@ public:
         CommTree<IndexType,ValueType> commTree,
         const scai::dmemo::CommunicatorPtr comm,
         Settings settings,
-        Metrics<ValueType>& metrics);
+        Metrics<ValueType>& metrics,
+        const DenseVector<IndexType>& streamed = DenseVector<IndexType>());
 
     /**
      * Wrapper without node weights.
@@ -174,6 +177,8 @@ public:
 
     /**
      * Get an initial partition using the morton curve and measuring density per square.
+     * Only the occupied squares are stored and communicated, \sa sumSparse. A growing block crosses at most two
+     * empty squares in a row to reach further occupied ones, and only while it is not full.
      */
     static DenseVector<IndexType> pixelPartition(const std::vector<DenseVector<ValueType>> &coordinates, Settings settings);
 
@@ -200,6 +205,26 @@ public:
     */
     static std::vector<IndexType> neighbourPixels(const IndexType thisPixel,const IndexType sideLen, const IndexType dimensions);
 
+    /** The pixel of every local point in a grid with \p sideLen pixels per dimension over the bounding box of all points.
+    Pixels are numbered as in neighbourPixels. Collective operation.
+    */
+    static std::vector<IndexType> localPixels(const std::vector<DenseVector<ValueType>> &coordinates, const IndexType sideLen);
+
+    /** @brief Sum the values with the same key over all PEs, for data that is too sparse for a dense array.
+
+    The local pairs are combined and sent to the owner PE of their key, given by a hash, which sums them. The
+    owners then send their sums to all PEs. Collective operation.
+    @param[in,out] keys The local keys, in any order and with duplicates. Replaced by the sorted global keys.
+    @param[in,out] values The value of every key, replaced by the global sums.
+    */
+    static void sumSparse(std::vector<IndexType>& keys, std::vector<ValueType>& values, const scai::dmemo::CommunicatorPtr comm);
+
+    /** The number of PEs a graph with \p n vertices is partitioned on, so that every PE has at least
+    settings.minLocalVertices vertices. With fewer vertices per PE, the collectives are dominated by their latency.
+    @return numPEs if the input is large enough, otherwise a number between 1 and numPEs.
+    */
+    static IndexType numActivePEs(const IndexType n, const Settings& settings, const IndexType numPEs);
+
 
 private:
 
@@ -208,6 +233,8 @@ private:
     Attention, for metis, and methods using the multilevel approach, the term 'initial partition' usually refers to the first
     partition in the coarsest level of the multilevel cycle. Here, we obtain an initial partition without coarsening, by
     using the coordinates of the graph.
+
+    @param[in] streamed The partition streamed while reading the input, used instead of streaming again with geoStream.
     */
     static DenseVector<IndexType> initialPartition(
         const CSRSparseMatrix<ValueType> &input,
@@ -217,8 +244,46 @@ private:
         CommTree<IndexType,ValueType> commTree,
         scai::dmemo::CommunicatorPtr comm,
         Settings settings,
-        Metrics<ValueType>& metrics); 
+        Metrics<ValueType>& metrics,
+        const DenseVector<IndexType>& streamed = DenseVector<IndexType>()); 
 	
+    /** Computes settings.multiStarts initial partitions and returns the best one according to settings.multiStartObjective.
+
+    The PEs are split into min(multiStarts, p) groups of consecutive ranks, every group gets a copy of the input,
+    \sa Redistribution::copyToGroups, and computes its share of the attempts, one after the other. A group of a
+    single PE, e.g. for a small input on fewer PEs, \sa numActivePEs, runs its attempts at the same time in threads.
+    Every attempt uses a different seed and, except for the first one, k-means samples the points in a random order,
+    so settings.initialPartition must be one of the k-means tools.
+    The best partition is moved back to the distribution of the coordinates, the other partitions are discarded.
+    All PEs get the metrics of the best attempt.
+    */
+    static DenseVector<IndexType> multiStartInitialPartition(
+        const CSRSparseMatrix<ValueType> &input,
+        const std::vector<DenseVector<ValueType>> &coordinates,
+        const std::vector<DenseVector<ValueType>> &nodeWeights,
+        DenseVector<IndexType>& previous,
+        CommTree<IndexType,ValueType> commTree,
+        scai::dmemo::CommunicatorPtr comm,
+        Settings settings,
+        Metrics<ValueType>& metrics);
+
+    /** Partition on the first \p numActivePEs PEs only. The input is copied to them, \sa Redistribution::copyToGroup,
+    and the partition is moved back to the distribution of the input. The other PEs wait.
+
+    @param[in] initialOnly If true, only the initial partition is computed on the active PEs and the result is in the
+    distribution of the coordinates, otherwise the whole partitionGraph and the result is in the row distribution of the input.
+    */
+    static DenseVector<IndexType> partitionOnFewerPEs(
+        const CSRSparseMatrix<ValueType> &input,
+        const std::vector<DenseVector<ValueType>> &coordinates,
+        const std::vector<DenseVector<ValueType>> &nodeWeights,
+        CommTree<IndexType,ValueType> commTree,
+        scai::dmemo::CommunicatorPtr comm,
+        Settings settings,
+        Metrics<ValueType>& metrics,
+        const IndexType numActivePEs,
+        const bool initialOnly);
+
 	/** Wrapper function to do local refinement on a partitioned graph. 
 	 */
     static void doLocalRefinement(
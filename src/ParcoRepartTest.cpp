@@ -1083,6 +1083,186 @@ TYPED_TEST(ParcoRepartTest, testPixelNeighbours) {
 }
 //------------------------------------------------------------------------------
 
+TYPED_TEST(ParcoRepartTest, testMultiStart) {
+    using ValueType = TypeParam;
+
+    std::string fileName = "bigtrace-00000.graph";
+    std::string file = ParcoRepartTest<ValueType>::graphPath + fileName;
+    IndexType dimensions= 2;
+
+    scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+    IndexType k = comm->getSize();
+
+    CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph(file );
+    IndexType globalN = graph.getNumRows();
+
+    scai::dmemo::DistributionPtr dist ( scai::dmemo::Distribution::getDistributionPtr( "BLOCK", comm, globalN) );
+    scai::dmemo::DistributionPtr noDistPointer(new scai::dmemo::NoDistribution(globalN));
+    graph.redistribute(dist, noDistPointer);
+
+    std::vector<DenseVector<ValueType>> coords = FileIO<IndexType, ValueType>::readCoords( std::string(file + ".xyz"), globalN, dimensions);
+    std::vector<scai::lama::DenseVector<ValueType>> nodeWeights(1, DenseVector<ValueType>(graph.getRowDistributionPtr(), 1));
+
+    struct Settings settings;
+    settings.numBlocks= k;
+    settings.epsilon = 0.2;
+    settings.dimensions = dimensions;
+    settings.initialPartition = Tool::geoKmeans;
+    settings.noRefinement = true;
+    settings.multiStartObjective = "cut";
+
+    Metrics<ValueType> metrics(settings);
+    DenseVector<IndexType> singlePartition = ParcoRepart<IndexType, ValueType>::partitionGraph(graph, coords, nodeWeights, comm, settings, metrics);
+
+    settings.multiStarts = 3;
+    DenseVector<IndexType> multiPartition = ParcoRepart<IndexType, ValueType>::partitionGraph(graph, coords, nodeWeights, comm, settings, metrics);
+
+    ASSERT_EQ(globalN, multiPartition.size());
+    EXPECT_TRUE(multiPartition.getDistributionPtr()->isEqual(*dist));
+    EXPECT_EQ(0, multiPartition.min());
+    EXPECT_EQ(k-1, multiPartition.max());
+
+    //on a single PE the first attempt is the partition of the single start
+    if (comm->getSize() == 1) {
+        const ValueType singleCut = GraphUtils<IndexType, ValueType>::computeCut(graph, singlePartition, true);
+        const ValueType multiCut = GraphUtils<IndexType, ValueType>::computeCut(graph, multiPartition, true);
+        EXPECT_LE(multiCut, singleCut);
+    }
+
+    //the space-filling curve does not depend on the seed, every start would be the same
+    EXPECT_TRUE(settings.checkValidity(comm));
+    settings.initialPartition = Tool::geoSFC;
+    EXPECT_FALSE(settings.checkValidity(comm));
+}
+//---------------------------------------------------------------------------------------
+
+TYPED_TEST(ParcoRepartTest, testSumSparse) {
+    using ValueType = TypeParam;
+
+    scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+    const IndexType p = comm->getSize();
+    const IndexType rank = comm->getRank();
+
+    //every PE has key 7 twice, its own key 100+rank and the key of its successor
+    std::vector<IndexType> keys = {100+(rank+1)%p, 7, 100+rank, 7};
+    std::vector<ValueType> values = {1, 1, 1, 2};
+    ParcoRepart<IndexType, ValueType>::sumSparse(keys, values, comm);
+
+    ASSERT_EQ(p+1, keys.size());
+    ASSERT_EQ(keys.size(), values.size());
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+    EXPECT_EQ(7, keys[0]);
+    EXPECT_EQ(3*p, values[0]);
+    for (IndexType i = 1; i <= p; i++) {
+        EXPECT_EQ(100+i-1, keys[i]);
+        EXPECT_EQ(2, values[i]);
+    }
+}
+//---------------------------------------------------------------------------------------
+
+TYPED_TEST(ParcoRepartTest, testNumActivePEs) {
+    using ValueType = TypeParam;
+
+    Settings settings;
+    settings.minLocalVertices = 100;
+    EXPECT_EQ(4096, (ParcoRepart<IndexType, ValueType>::numActivePEs(409600, settings, 4096)));
+    EXPECT_EQ(1000, (ParcoRepart<IndexType, ValueType>::numActivePEs(100000, settings, 4096)));
+    EXPECT_EQ(1, (ParcoRepart<IndexType, ValueType>::numActivePEs(50, settings, 4096)));
+
+    settings.minLocalVertices = 0;
+    EXPECT_EQ(4096, (ParcoRepart<IndexType, ValueType>::numActivePEs(50, settings, 4096)));
+}
+//---------------------------------------------------------------------------------------
+
+TYPED_TEST(ParcoRepartTest, testPartitionOnFewerPEs) {
+    using ValueType = TypeParam;
+
+    std::string file = ParcoRepartTest<ValueType>::graphPath + "Grid32x32";
+    IndexType dimensions= 2;
+
+    scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+    IndexType k = comm->getSize();
+
+    CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph(file );
+    IndexType globalN = graph.getNumRows();
+
+    scai::dmemo::DistributionPtr dist ( scai::dmemo::Distribution::getDistributionPtr( "BLOCK", comm, globalN) );
+    scai::dmemo::DistributionPtr noDistPointer(new scai::dmemo::NoDistribution(globalN));
+    graph.redistribute(dist, noDistPointer);
+
+    std::vector<DenseVector<ValueType>> coords = FileIO<IndexType, ValueType>::readCoords( std::string(file + ".xyz"), globalN, dimensions);
+    std::vector<scai::lama::DenseVector<ValueType>> nodeWeights(1, DenseVector<ValueType>(graph.getRowDistributionPtr(), 1));
+
+    struct Settings settings;
+    settings.numBlocks= k;
+    settings.epsilon = 0.05;
+    settings.dimensions = dimensions;
+    settings.initialPartition = Tool::geoKmeans;
+    //half of the PEs, or all of them for a single one
+    settings.minLocalVertices = 2*globalN/comm->getSize();
+
+    //the whole partition on fewer PEs, then only the initial partition before the refinement on all PEs
+    for( const bool noRefinement : {true, false} ){
+        settings.noRefinement = noRefinement;
+        Metrics<ValueType> metrics(settings);
+        CSRSparseMatrix<ValueType> graphCopy(graph);
+        std::vector<DenseVector<ValueType>> coordsCopy(coords);
+        std::vector<DenseVector<ValueType>> weightsCopy(nodeWeights);
+        DenseVector<IndexType> partition = ParcoRepart<IndexType, ValueType>::partitionGraph(graphCopy, coordsCopy, weightsCopy, comm, settings, metrics);
+
+        ASSERT_EQ(globalN, partition.size());
+        if( noRefinement ){
+            EXPECT_TRUE(partition.getDistributionPtr()->isEqual(*dist));
+        }
+        EXPECT_EQ(0, partition.min());
+        EXPECT_EQ(k-1, partition.max());
+        partition.redistribute(graphCopy.getRowDistributionPtr());
+        EXPECT_LE(GraphUtils<IndexType, ValueType>::computeImbalance(partition, k), settings.epsilon);
+    }
+}
+//---------------------------------------------------------------------------------------
+
+TYPED_TEST(ParcoRepartTest, testTimeBudget) {
+    using ValueType = TypeParam;
+
+    std::string fileName = "bigtrace-00000.graph";
+    std::string file = ParcoRepartTest<ValueType>::graphPath + fileName;
+    IndexType dimensions= 2;
+
+    scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+    IndexType k = comm->getSize();
+
+    CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph(file );
+    IndexType globalN = graph.getNumRows();
+
+    scai::dmemo::DistributionPtr dist ( scai::dmemo::Distribution::getDistributionPtr( "BLOCK", comm, globalN) );
+    scai::dmemo::DistributionPtr noDistPointer(new scai::dmemo::NoDistribution(globalN));
+    graph.redistribute(dist, noDistPointer);
+
+    std::vector<DenseVector<ValueType>> coords = FileIO<IndexType, ValueType>::readCoords( std::string(file + ".xyz"), globalN, dimensions);
+    std::vector<scai::lama::DenseVector<ValueType>> nodeWeights(1, DenseVector<ValueType>(graph.getRowDistributionPtr(), 1));
+
+    struct Settings settings;
+    settings.numBlocks= k;
+    settings.dimensions = dimensions;
+    settings.initialPartition = Tool::geoKmeans;
+    settings.mappingRenumbering = true;
+    //far too small for any phase, everything must stop after the first iteration
+    settings.timeBudget = 1e-6;
+
+    Metrics<ValueType> metrics(settings);
+    DenseVector<IndexType> partition = ParcoRepart<IndexType, ValueType>::partitionGraph(graph, coords, nodeWeights, comm, settings, metrics);
+
+    ASSERT_EQ(globalN, partition.size());
+    EXPECT_EQ(0, partition.min());
+    EXPECT_EQ(k-1, partition.max());
+
+    EXPECT_EQ(1, metrics.MM["skippedRefinement"]);
+    EXPECT_EQ(1, metrics.MM["skippedMapping"]);
+    EXPECT_EQ(0, metrics.MM["truncatedRefinement"]);
+}
+//---------------------------------------------------------------------------------------
+
 TYPED_TEST(ParcoRepartTest, testRedistributeFromPartition) {
     using ValueType = TypeParam;
 
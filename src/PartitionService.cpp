@@ -0,0 +1,195 @@
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <scai/tracing.hpp>
+
+#include "PartitionService.h"
+
+namespace ITI {
+
+namespace {
+
+sockaddr_un socketAddress(const std::string& socketPath) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Socket path too long: " + socketPath);
+    }
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    return address;
+}
+
+//a client has this long to send its request, rank 0 must not wait forever on a client that sends nothing
+const int requestTimeoutSeconds = 10;
+
+//everything until the first newline or the end of the stream, timedOut is set if a receive timeout expired
+std::string readLine(const int fd, bool* timedOut = nullptr) {
+    std::string line;
+    char buffer[4096];
+    while (true) {
+        const ssize_t numRead = read(fd, buffer, sizeof(buffer));
+        if (numRead < 0 && errno == EINTR) {
+            continue;
+        }
+        if (numRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && timedOut != nullptr) {
+            *timedOut = true;
+            break;
+        }
+        if (numRead <= 0) {
+            break;
+        }
+        line.append(buffer, numRead);
+        const std::size_t newline = line.find('\n');
+        if (newline != std::string::npos) {
+            line.resize(newline);
+            break;
+        }
+    }
+    return line;
+}
+
+bool writeAll(const int fd, const std::string& message) {
+    std::size_t written = 0;
+    while (written < message.size()) {
+        //MSG_NOSIGNAL: a client that went away must not kill the service
+        const ssize_t numWritten = send(fd, message.data() + written, message.size() - written, MSG_NOSIGNAL);
+        if (numWritten < 0 && errno == EINTR) {
+            continue;
+        }
+        if (numWritten <= 0) {
+            return false;
+        }
+        written += numWritten;
+    }
+    return true;
+}
+
+}
+//---------------------------------------------------------------------------------------
+
+PartitionService::PartitionService(const std::string& socketPath, const scai::dmemo::CommunicatorPtr comm) : path(socketPath), comm(comm) {
+    std::string error;
+
+    if (comm->getRank() == 0) {
+        const sockaddr_un address = socketAddress(path);
+        listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0) {
+            error = std::strerror(errno);
+        } else {
+            unlink(path.c_str());
+            if (bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listenFd, 16) != 0) {
+                error = std::strerror(errno);
+                close(listenFd);
+                listenFd = -1;
+            }
+        }
+    }
+
+    if (comm->any(!error.empty())) {
+        throw std::runtime_error("Could not listen on socket " + path + ": " + (error.empty() ? "failed on rank 0" : error));
+    }
+}
+//---------------------------------------------------------------------------------------
+
+PartitionService::~PartitionService() {
+    if (connectionFd >= 0) {
+        close(connectionFd);
+    }
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(path.c_str());
+    }
+}
+//---------------------------------------------------------------------------------------
+
+bool PartitionService::nextRequest(std::vector<std::string>& args) {
+    SCAI_REGION("PartitionService.nextRequest");
+
+    std::string request;
+
+    if (comm->getRank() == 0) {
+        if (connectionFd >= 0) {
+            close(connectionFd);
+            connectionFd = -1;
+        }
+        //skip connections that fail, send nothing or do not finish their request in time
+        while (request.empty()) {
+            connectionFd = accept(listenFd, nullptr, nullptr);
+            if (connectionFd < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                request = "shutdown";
+                break;
+            }
+            const timeval timeout = {requestTimeoutSeconds, 0};
+            setsockopt(connectionFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            bool timedOut = false;
+            request = readLine(connectionFd, &timedOut);
+            if (timedOut || splitRequest(request).empty()) {
+                close(connectionFd);
+                connectionFd = -1;
+                request.clear();
+            }
+        }
+    }
+
+    comm->bcast(request, 0);
+
+    args = splitRequest(request);
+    return !(args.size() == 1 && args[0] == "shutdown");
+}
+//---------------------------------------------------------------------------------------
+
+void PartitionService::reply(const std::string& message) {
+    if (comm->getRank() == 0 && connectionFd >= 0) {
+        writeAll(connectionFd, message + "\n");
+        close(connectionFd);
+        connectionFd = -1;
+    }
+}
+//---------------------------------------------------------------------------------------
+
+std::vector<std::string> PartitionService::splitRequest(const std::string& line) {
+    std::vector<std::string> words;
+    std::istringstream stream(line);
+    std::string word;
+    while (stream >> word) {
+        words.push_back(word);
+    }
+    return words;
+}
+//---------------------------------------------------------------------------------------
+
+std::string PartitionService::sendRequest(const std::string& socketPath, const std::string& request) {
+    const sockaddr_un address = socketAddress(socketPath);
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        const std::string error = std::strerror(errno);
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw std::runtime_error("Could not connect to " + socketPath + ": " + error);
+    }
+
+    if (!writeAll(fd, request + "\n")) {
+        close(fd);
+        throw std::runtime_error("Could not send the request to " + socketPath);
+    }
+    shutdown(fd, SHUT_WR);
+
+    const std::string answer = readLine(fd);
+    close(fd);
+    return answer;
+}
+//---------------------------------------------------------------------------------------
+
+} // namespace ITI
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <scai/dmemo/Communicator.hpp>
+
+/** @file PartitionService.h
+Requests to a resident partitioner over a Unix domain socket.
+
+A run of the driver pays for the process start, MPI and LAMA initialization and reading the input every time.
+With --service, the driver instead stays resident and partitions one request after the other. A request is a
+single line with the command line options of a run, e.g. "--graphFile mesh.graph --numBlocks 64 --outFile mesh",
+the input is given by file paths (a file in /dev/shm avoids the disk). The reply is one line with the status and
+the metrics. The request "shutdown" stops the service.
+*/
+
+namespace ITI {
+
+/** @brief The socket of a resident partitioner.
+
+Only the process with rank 0 listens on the socket, the requests are broadcast to all processes of comm.
+One request is served at a time: a client connects, writes the request line, and reads the reply until the
+connection is closed. A client that does not send its request line within 10 seconds is disconnected.
+*/
+
+class PartitionService {
+public:
+
+    /** Listen on the socket, an existing file at the path is replaced. Collective operation.
+    @param[in] socketPath The path of the Unix domain socket.
+    @param[in] comm The processes that serve the requests.
+    */
+    PartitionService(const std::string& socketPath, const scai::dmemo::CommunicatorPtr comm);
+
+    /** Close and remove the socket.
+    */
+    ~PartitionService();
+
+    PartitionService(const PartitionService&) = delete;
+    PartitionService& operator=(const PartitionService&) = delete;
+
+    /** Wait for the next request. Collective operation.
+    @param[out] args The options of the request, split at white space.
+    @return False if the request was "shutdown".
+    */
+    bool nextRequest(std::vector<std::string>& args);
+
+    /** Send the reply of rank 0 to the client of the last request and close the connection.
+    */
+    void reply(const std::string& message);
+
+    /** The white space separated words of a request line.
+    */
+    static std::vector<std::string> splitRequest(const std::string& line);
+
+    /** Client side: send a request to the service and wait for the reply.
+    @return The reply, without the trailing newline.
+    */
+    static std::string sendRequest(const std::string& socketPath, const std::string& request);
+
+private:
+    std::string path;
+    scai::dmemo::CommunicatorPtr comm;
+    int listenFd = -1;
+    int connectionFd = -1;
+};
+
+} // namespace ITI
@@ -0,0 +1,54 @@
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "PartitionService.h"
+
+namespace ITI {
+
+class PartitionServiceTest : public ::testing::Test {
+};
+
+//-----------------------------------------------
+
+TEST_F(PartitionServiceTest, testSplitRequest) {
+    const std::vector<std::string> words = PartitionService::splitRequest("  --graphFile mesh.graph\t--numBlocks 16 ");
+    const std::vector<std::string> expected = {"--graphFile", "mesh.graph", "--numBlocks", "16"};
+    EXPECT_EQ(expected, words);
+    EXPECT_TRUE(PartitionService::splitRequest(" \t ").empty());
+}
+//-----------------------------------------------
+
+TEST_F(PartitionServiceTest, testRequestAndShutdown) {
+    const scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+    const std::string socketPath = "partitionServiceTest_" + std::to_string(comm->getSize()) + ".sock";
+
+    PartitionService service(socketPath, comm);
+
+    //the client runs next to the listening process
+    std::string firstReply, secondReply;
+    std::thread client;
+    if (comm->getRank() == 0) {
+        client = std::thread([&]() {
+            firstReply = PartitionService::sendRequest(socketPath, "--numBlocks 4 --epsilon 0.1");
+            secondReply = PartitionService::sendRequest(socketPath, "shutdown");
+        });
+    }
+
+    std::vector<std::string> args;
+    ASSERT_TRUE(service.nextRequest(args));
+    const std::vector<std::string> expected = {"--numBlocks", "4", "--epsilon", "0.1"};
+    EXPECT_EQ(expected, args);
+    service.reply("ok k=4");
+
+    EXPECT_FALSE(service.nextRequest(args));
+    service.reply("ok shutdown");
+
+    if (comm->getRank() == 0) {
+        client.join();
+        EXPECT_EQ("ok k=4", firstReply);
+        EXPECT_EQ("ok shutdown", secondReply);
+    }
+}
+
+} // namespace ITI
@@ -0,0 +1,509 @@
+#include <scai/dmemo/GeneralDistribution.hpp>
+#include <scai/dmemo/GenBlockDistribution.hpp>
+#include <scai/tracing.hpp>
+
+#include <numeric>
+
+#include "Redistribution.h"
+
+namespace ITI {
+
+template<typename IndexType, typename ValueType>
+const std::size_t Redistribution<IndexType, ValueType>::defaultChunkBytes;
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void Redistribution<IndexType, ValueType>::redistribute(
+    const scai::dmemo::DistributionPtr targetDistribution,
+    CSRSparseMatrix<ValueType>& graph,
+    std::vector<DenseVector<ValueType>>& coordinates,
+    std::vector<DenseVector<ValueType>>& nodeWeights,
+    std::vector<DenseVector<IndexType>*> indexVectors,
+    const std::size_t maxChunkBytes) {
+
+    SCAI_REGION("Redistribution.redistribute")
+
+    const scai::dmemo::DistributionPtr sourceDist = graph.getRowDistributionPtr();
+    const IndexType localN = sourceDist->getLocalSize();
+
+    //find the new owner of every local row
+    scai::hmemo::HArray<IndexType> myGlobalIndexes;
+    sourceDist->getOwnedIndexes(myGlobalIndexes);
+    scai::hmemo::HArray<IndexType> newOwners(localN, -1);
+    targetDistribution->computeOwners(newOwners, myGlobalIndexes);
+
+    scai::hmemo::ReadAccess<IndexType> rOwners(newOwners);
+    const std::vector<IndexType> owners(rOwners.get(), rOwners.get()+localN);
+    rOwners.release();
+
+    exchange(targetDistribution, owners, graph, coordinates, nodeWeights, indexVectors, maxChunkBytes);
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+scai::dmemo::DistributionPtr Redistribution<IndexType, ValueType>::redistributeByNewOwners(
+    const scai::hmemo::HArray<IndexType>& newOwners,
+    CSRSparseMatrix<ValueType>& graph,
+    std::vector<DenseVector<ValueType>>& coordinates,
+    std::vector<DenseVector<ValueType>>& nodeWeights,
+    std::vector<DenseVector<IndexType>*> indexVectors,
+    const std::size_t maxChunkBytes) {
+
+    SCAI_REGION("Redistribution.redistributeByNewOwners")
+
+    const scai::dmemo::DistributionPtr sourceDist = graph.getRowDistributionPtr();
+    SCAI_ASSERT_EQ_ERROR( newOwners.size(), sourceDist->getLocalSize(), "Wrong size of owners array" );
+
+    //copy the owners since newOwners can be the local values of a vector that is redistributed
+    scai::hmemo::ReadAccess<IndexType> rOwners(newOwners);
+    const std::vector<IndexType> owners(rOwners.get(), rOwners.get()+rOwners.size());
+    rOwners.release();
+
+    scai::dmemo::DistributionPtr targetDistribution = scai::dmemo::generalDistributionByNewOwners( *sourceDist, newOwners );
+
+    exchange(targetDistribution, owners, graph, coordinates, nodeWeights, indexVectors, maxChunkBytes);
+
+    return targetDistribution;
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void Redistribution<IndexType, ValueType>::exchange(
+    const scai::dmemo::DistributionPtr targetDistribution,
+    const std::vector<IndexType>& owners,
+    CSRSparseMatrix<ValueType>& graph,
+    std::vector<DenseVector<ValueType>>& coordinates,
+    std::vector<DenseVector<ValueType>>& nodeWeights,
+    std::vector<DenseVector<IndexType>*>& indexVectors,
+    const std::size_t maxChunkBytes) {
+
+    SCAI_REGION("Redistribution.exchange")
+
+    const scai::dmemo::DistributionPtr sourceDist = graph.getRowDistributionPtr();
+    const scai::dmemo::CommunicatorPtr comm = sourceDist->getCommunicatorPtr();
+    const IndexType numPEs = comm->getSize();
+    const IndexType globalN = sourceDist->getGlobalSize();
+    const IndexType localN = sourceDist->getLocalSize();
+    const IndexType newLocalN = targetDistribution->getLocalSize();
+
+    const IndexType numCoords = coordinates.size();
+    const IndexType numWeights = nodeWeights.size();
+    const IndexType numIndexVectors = indexVectors.size();
+
+    SCAI_ASSERT_EQ_ERROR( targetDistribution->getGlobalSize(), globalN, "Target distribution has wrong global size" );
+    SCAI_ASSERT_EQ_ERROR( owners.size(), localN, "Wrong size of owners vector" );
+    SCAI_ASSERT_ERROR( graph.getColDistributionPtr()->isReplicated(), "The columns of the graph must not be distributed" );
+    for (IndexType d = 0; d < numCoords; d++) {
+        SCAI_ASSERT_ERROR( coordinates[d].getDistribution().isEqual(*sourceDist), "Distribution mismatch for coordinates in dimension " << d );
+    }
+    for (IndexType w = 0; w < numWeights; w++) {
+        SCAI_ASSERT_ERROR( nodeWeights[w].getDistribution().isEqual(*sourceDist), "Distribution mismatch for node weights " << w );
+    }
+    for (IndexType v = 0; v < numIndexVectors; v++) {
+        SCAI_ASSERT_ERROR( indexVectors[v]->getDistribution().isEqual(*sourceDist), "Distribution mismatch for index vector " << v );
+    }
+
+    //----------------------------------------------------------------
+    // plan: group the local rows by their new owner and split them in chunks
+    //
+
+    SCAI_REGION_START("Redistribution.exchange.plan")
+
+    std::vector<IndexType> groupOffsets(numPEs+1, 0);
+    for (IndexType i = 0; i < localN; i++) {
+        SCAI_ASSERT_VALID_INDEX_DEBUG( owners[i], numPEs, "invalid owner" );
+        groupOffsets[owners[i]+1]++;
+    }
+    std::partial_sum(groupOffsets.begin(), groupOffsets.end(), groupOffsets.begin());
+
+    //the local rows sorted by their new owner, stable so rows keep their relative order
+    std::vector<IndexType> sendOrder(localN);
+    {
+        std::vector<IndexType> position(groupOffsets.begin(), groupOffsets.end()-1);
+        for (IndexType i = 0; i < localN; i++) {
+            sendOrder[position[owners[i]]++] = i;
+        }
+    }
+
+    const CSRStorage<ValueType>& localStorage = graph.getLocalStorage();
+    std::vector<IndexType> degrees(localN);
+    {
+        scai::hmemo::ReadAccess<IndexType> ia(localStorage.getIA());
+        for (IndexType i = 0; i < localN; i++) {
+            degrees[i] = ia[i+1]-ia[i];
+        }
+    }
+
+    //every row costs: global id, degree, ja and index vectors plus values, coordinates and weights
+    auto rowBytes = [&](IndexType i) {
+        return (2 + degrees[i] + numIndexVectors)*sizeof(IndexType) + (degrees[i] + numCoords + numWeights)*sizeof(ValueType);
+    };
+
+    //chunk boundaries in sendOrder; every chunk has at least one row
+    std::vector<IndexType> chunkOffsets(1, 0);
+    {
+        std::size_t chunkBytes = 0;
+        for (IndexType j = 0; j < localN; j++) {
+            const std::size_t bytes = rowBytes(sendOrder[j]);
+            if (chunkBytes > 0 and chunkBytes + bytes > maxChunkBytes) {
+                chunkOffsets.push_back(j);
+                chunkBytes = 0;
+            }
+            chunkBytes += bytes;
+        }
+        chunkOffsets.push_back(localN);
+    }
+    const IndexType localChunks = chunkOffsets.size()-1;
+    const IndexType numChunks = comm->max(localChunks);
+
+    SCAI_REGION_END("Redistribution.exchange.plan")
+
+    //----------------------------------------------------------------
+    // exchange in rounds
+    //
+
+    // the received rows, in the order they arrive
+    std::vector<IndexType> recvGlobalIndexes;
+    std::vector<IndexType> recvDegrees;
+    std::vector<IndexType> recvJA;
+    std::vector<ValueType> recvValues;
+    recvGlobalIndexes.reserve(newLocalN);
+    recvDegrees.reserve(newLocalN);
+
+    // vectors are written directly to their final position
+    std::vector<scai::hmemo::HArray<ValueType>> newCoordinates(numCoords, scai::hmemo::HArray<ValueType>(newLocalN, ValueType(0)));
+    std::vector<scai::hmemo::HArray<ValueType>> newWeights(numWeights, scai::hmemo::HArray<ValueType>(newLocalN, ValueType(0)));
+    std::vector<scai::hmemo::HArray<IndexType>> newIndexValues(numIndexVectors, scai::hmemo::HArray<IndexType>(newLocalN, IndexType(0)));
+
+    for (IndexType chunk = 0; chunk < numChunks; chunk++) {
+        SCAI_REGION("Redistribution.exchange.round")
+
+        //PEs with less chunks participate with empty messages
+        const IndexType chunkBegin = chunk < localChunks ? chunkOffsets[chunk] : localN;
+        const IndexType chunkEnd = chunk < localChunks ? chunkOffsets[chunk+1] : localN;
+
+        //the part of every group inside this chunk
+        std::vector<IndexType> rangeBegin(numPEs), rangeEnd(numPEs);
+        std::vector<IndexType> indexQuantities(numPEs, 0);
+        std::vector<IndexType> valueQuantities(numPEs, 0);
+        for (IndexType p = 0; p < numPEs; p++) {
+            rangeBegin[p] = std::max(chunkBegin, groupOffsets[p]);
+            rangeEnd[p] = std::max(rangeBegin[p], std::min(chunkEnd, groupOffsets[p+1]));
+            const IndexType numRows = rangeEnd[p] - rangeBegin[p];
+            if (numRows == 0) continue;
+            IndexType sumDegrees = 0;
+            for (IndexType j = rangeBegin[p]; j < rangeEnd[p]; j++) {
+                sumDegrees += degrees[sendOrder[j]];
+            }
+            // a segment is: numRows, global ids, degrees, ja, index vectors
+            indexQuantities[p] = 1 + (2 + numIndexVectors)*numRows + sumDegrees;
+            // and: values, coordinates, weights
+            valueQuantities[p] = sumDegrees + (numCoords + numWeights)*numRows;
+        }
+
+        scai::dmemo::CommunicationPlan indexSendPlan(indexQuantities.data(), numPEs);
+        scai::dmemo::CommunicationPlan valueSendPlan(valueQuantities.data(), numPEs);
+        scai::dmemo::CommunicationPlan indexRecvPlan = comm->transpose(indexSendPlan);
+        scai::dmemo::CommunicationPlan valueRecvPlan = comm->transpose(valueSendPlan);
+
+        std::vector<IndexType> indexSendBuffer(indexSendPlan.totalQuantity());
+        std::vector<ValueType> valueSendBuffer(valueSendPlan.totalQuantity());
+
+        {
+            SCAI_REGION("Redistribution.exchange.round.pack")
+
+            //offsets of the segments, they are in the order of the PE ids like in the plan
+            std::vector<IndexType> indexPos(numPEs, 0), valuePos(numPEs, 0);
+            for (IndexType p = 1; p < numPEs; p++) {
+                indexPos[p] = indexPos[p-1] + indexQuantities[p-1];
+                valuePos[p] = valuePos[p-1] + valueQuantities[p-1];
+            }
+
+            scai::hmemo::ReadAccess<IndexType> ia(localStorage.getIA());
+            scai::hmemo::ReadAccess<IndexType> ja(localStorage.getJA());
+            scai::hmemo::ReadAccess<ValueType> values(localStorage.getValues());
+            scai::hmemo::HArray<IndexType> myGlobalIndexes;
+            sourceDist->getOwnedIndexes(myGlobalIndexes);
+            scai::hmemo::ReadAccess<IndexType> rGlobal(myGlobalIndexes);
+
+            for (IndexType p = 0; p < numPEs; p++) {
+                const IndexType numRows = rangeEnd[p] - rangeBegin[p];
+                if (numRows == 0) continue;
+
+                IndexType pos = indexPos[p];
+                indexSendBuffer[pos++] = numRows;
+                for (IndexType j = rangeBegin[p]; j < rangeEnd[p]; j++) {
+                    indexSendBuffer[pos++] = rGlobal[sendOrder[j]];
+                }
+                for (IndexType j = rangeBegin[p]; j < rangeEnd[p]; j++) {
+                    indexSendBuffer[pos++] = degrees[sendOrder[j]];
+                }
+                IndexType vPos = valuePos[p];
+                for (IndexType j = rangeBegin[p]; j < rangeEnd[p]; j++) {
+                    const IndexType i = sendOrder[j];
+                    std::copy(ja.get()+ia[i], ja.get()+ia[i+1], indexSendBuffer.begin()+pos);
+                    std::copy(values.get()+ia[i], values.get()+ia[i+1], valueSendBuffer.begin()+vPos);
+                    pos += degrees[i];
+                    vPos += degrees[i];
+                }
+                indexPos[p] = pos;
+                valuePos[p] = vPos;
+            }
+
+            //array by array, so only one access is open at a time
+            for (IndexType v = 0; v < numIndexVectors; v++) {
+                scai::hmemo::ReadAccess<IndexType> rVector(indexVectors[v]->getLocalValues());
+                for (IndexType p = 0; p < numPEs; p++) {
+                    for (IndexType j = rangeBegin[p]; j < rangeEnd[p]; j++) {
+                        indexSendBuffer[indexPos[p]++] = rVector[sendOrder[j]];
+                    }
+                }
+            }
+            for (IndexType d = 0; d < numCoords; d++) {
+                scai::hmemo::ReadAccess<ValueType> rCoords(coordinates[d].getLocalValues());
+                for (IndexType p = 0; p < numPEs; p++) {
+                    for (IndexType j = rangeBegin[p]; j < rangeEnd[p]; j++) {
+                        valueSendBuffer[valuePos[p]++] = rCoords[sendOrder[j]];
+                    }
+                }
+            }
+            for (IndexType w = 0; w < numWeights; w++) {
+                scai::hmemo::ReadAccess<ValueType> rWeights(nodeWeights[w].getLocalValues());
+                for (IndexType p = 0; p < numPEs; p++) {
+                    for (IndexType j = rangeBegin[p]; j < rangeEnd[p]; j++) {
+                        valueSendBuffer[valuePos[p]++] = rWeights[sendOrder[j]];
+                    }
+                }
+            }
+        }
+
+        std::vector<IndexType> indexRecvBuffer(indexRecvPlan.totalQuantity());
+        std::vector<ValueType> valueRecvBuffer(valueRecvPlan.totalQuantity());
+        {
+            SCAI_REGION("Redistribution.exchange.round.exchangeByPlan")
+            comm->exchangeByPlan(indexRecvBuffer.data(), indexRecvPlan, indexSendBuffer.data(), indexSendPlan);
+            comm->exchangeByPlan(valueRecvBuffer.data(), valueRecvPlan, valueSendBuffer.data(), valueSendPlan);
+        }
+        //free send memory before unpacking
+        std::vector<IndexType>().swap(indexSendBuffer);
+        std::vector<ValueType>().swap(valueSendBuffer);
+
+        {
+            SCAI_REGION("Redistribution.exchange.round.unpack")
+
+            //the value segments come from the same PEs as the index segments, except when they are empty
+            std::vector<IndexType> valueOffsetFrom(numPEs, -1);
+            for (IndexType k = 0; k < valueRecvPlan.size(); k++) {
+                valueOffsetFrom[valueRecvPlan[k].partitionId] = valueRecvPlan[k].offset;
+            }
+
+            for (IndexType k = 0; k < indexRecvPlan.size(); k++) {
+                const scai::dmemo::CommunicationPlan::Entry entry = indexRecvPlan[k];
+                IndexType pos = entry.offset;
+                const IndexType numRows = indexRecvBuffer[pos++];
+                SCAI_ASSERT_GT_ERROR( numRows, 0, "Received empty segment from PE " << entry.partitionId );
+
+                const IndexType* globalIds = indexRecvBuffer.data()+pos;
+                pos += numRows;
+                const IndexType* rowDegrees = indexRecvBuffer.data()+pos;
+                pos += numRows;
+
+                IndexType sumDegrees = 0;
+                std::vector<IndexType> targetLocal(numRows);
+                for (IndexType r = 0; r < numRows; r++) {
+                    targetLocal[r] = targetDistribution->global2Local(globalIds[r]);
+                    SCAI_ASSERT_NE_ERROR( targetLocal[r], scai::invalidIndex, "Received row " << globalIds[r] << " that is not owned in target distribution" );
+                    sumDegrees += rowDegrees[r];
+                }
+                recvGlobalIndexes.insert(recvGlobalIndexes.end(), globalIds, globalIds+numRows);
+                recvDegrees.insert(recvDegrees.end(), rowDegrees, rowDegrees+numRows);
+                recvJA.insert(recvJA.end(), indexRecvBuffer.begin()+pos, indexRecvBuffer.begin()+pos+sumDegrees);
+                pos += sumDegrees;
+
+                for (IndexType v = 0; v < numIndexVectors; v++) {
+                    scai::hmemo::WriteAccess<IndexType> wVector(newIndexValues[v]);
+                    for (IndexType r = 0; r < numRows; r++) {
+                        wVector[targetLocal[r]] = indexRecvBuffer[pos++];
+                    }
+                }
+                SCAI_ASSERT_EQ_ERROR( pos, entry.offset+entry.quantity, "Wrong segment size from PE " << entry.partitionId );
+
+                const IndexType numValues = sumDegrees + (numCoords + numWeights)*numRows;
+                if (numValues == 0) continue;
+
+                IndexType vPos = valueOffsetFrom[entry.partitionId];
+                SCAI_ASSERT_GE_ERROR( vPos, 0, "No values received from PE " << entry.partitionId );
+                recvValues.insert(recvValues.end(), valueRecvBuffer.begin()+vPos, valueRecvBuffer.begin()+vPos+sumDegrees);
+                vPos += sumDegrees;
+
+                for (IndexType d = 0; d < numCoords; d++) {
+                    scai::hmemo::WriteAccess<ValueType> wCoords(newCoordinates[d]);
+                    for (IndexType r = 0; r < numRows; r++) {
+                        wCoords[targetLocal[r]] = valueRecvBuffer[vPos++];
+                    }
+                }
+                for (IndexType w = 0; w < numWeights; w++) {
+                    scai::hmemo::WriteAccess<ValueType> wWeights(newWeights[w]);
+                    for (IndexType r = 0; r < numRows; r++) {
+                        wWeights[targetLocal[r]] = valueRecvBuffer[vPos++];
+                    }
+                }
+            }
+        }
+    }
+
+    SCAI_ASSERT_EQ_ERROR( recvGlobalIndexes.size(), newLocalN, "Wrong number of received rows" );
+
+    //----------------------------------------------------------------
+    // assemble the new local storage in the order of the target distribution
+    //
+
+    SCAI_REGION_START("Redistribution.exchange.assemble")
+
+    const IndexType newNumValues = recvJA.size();
+    scai::hmemo::HArray<IndexType> newIA(newLocalN+1, IndexType(0));
+    scai::hmemo::HArray<IndexType> newJA(newNumValues);
+    scai::hmemo::HArray<ValueType> newValues(newNumValues);
+    {
+        std::vector<IndexType> targetLocal(newLocalN);
+        scai::hmemo::WriteAccess<IndexType> wIA(newIA);
+        for (IndexType r = 0; r < newLocalN; r++) {
+            targetLocal[r] = targetDistribution->global2Local(recvGlobalIndexes[r]);
+            wIA[targetLocal[r]+1] = recvDegrees[r];
+        }
+        for (IndexType i = 0; i < newLocalN; i++) {
+            wIA[i+1] += wIA[i];
+        }
+        SCAI_ASSERT_EQ_ERROR( wIA[newLocalN], newNumValues, "Wrong number of edges" );
+
+        scai::hmemo::WriteAccess<IndexType> wJA(newJA);
+        scai::hmemo::WriteAccess<ValueType> wValues(newValues);
+        IndexType recvPos = 0;
+        for (IndexType r = 0; r < newLocalN; r++) {
+            const IndexType offset = wIA[targetLocal[r]];
+            std::copy(recvJA.begin()+recvPos, recvJA.begin()+recvPos+recvDegrees[r], wJA.get()+offset);
+            std::copy(recvValues.begin()+recvPos, recvValues.begin()+recvPos+recvDegrees[r], wValues.get()+offset);
+            recvPos += recvDegrees[r];
+        }
+    }
+    std::vector<IndexType>().swap(recvJA);
+    std::vector<ValueType>().swap(recvValues);
+
+    //columns stay replicated
+    graph = CSRSparseMatrix<ValueType>(
+                targetDistribution,
+                CSRStorage<ValueType>( newLocalN, globalN, std::move(newIA), std::move(newJA), std::move(newValues) )
+            );
+
+    for (IndexType d = 0; d < numCoords; d++) {
+        coordinates[d].swap(newCoordinates[d], targetDistribution);
+    }
+    for (IndexType w = 0; w < numWeights; w++) {
+        nodeWeights[w].swap(newWeights[w], targetDistribution);
+    }
+    for (IndexType v = 0; v < numIndexVectors; v++) {
+        indexVectors[v]->swap(newIndexValues[v], targetDistribution);
+    }
+
+    SCAI_REGION_END("Redistribution.exchange.assemble")
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void Redistribution<IndexType, ValueType>::copyToGroups(
+    const scai::dmemo::CommunicatorPtr groupComm,
+    const IndexType numGroups,
+    const CSRSparseMatrix<ValueType>& graph,
+    const std::vector<DenseVector<ValueType>>& coordinates,
+    const std::vector<DenseVector<ValueType>>& nodeWeights,
+    CSRSparseMatrix<ValueType>& groupGraph,
+    std::vector<DenseVector<ValueType>>& groupCoordinates,
+    std::vector<DenseVector<ValueType>>& groupWeights ) {
+
+    SCAI_REGION("Redistribution.copyToGroups")
+
+    const scai::dmemo::CommunicatorPtr comm = graph.getRowDistributionPtr()->getCommunicatorPtr();
+    const IndexType myGroup = IndexType(comm->getRank())*numGroups/comm->getSize();
+
+    //one collective copy per group, only the PEs of the target group get the input
+    for (IndexType g = 0; g < numGroups; g++) {
+        copyToGroup(groupComm, g == myGroup, graph, coordinates, nodeWeights, groupGraph, groupCoordinates, groupWeights);
+    }
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void Redistribution<IndexType, ValueType>::copyToGroup(
+    const scai::dmemo::CommunicatorPtr groupComm,
+    const bool isTargetGroup,
+    const CSRSparseMatrix<ValueType>& graph,
+    const std::vector<DenseVector<ValueType>>& coordinates,
+    const std::vector<DenseVector<ValueType>>& nodeWeights,
+    CSRSparseMatrix<ValueType>& groupGraph,
+    std::vector<DenseVector<ValueType>>& groupCoordinates,
+    std::vector<DenseVector<ValueType>>& groupWeights ) {
+
+    SCAI_REGION("Redistribution.copyToGroup")
+
+    const scai::dmemo::CommunicatorPtr comm = graph.getRowDistributionPtr()->getCommunicatorPtr();
+    const IndexType N = graph.getNumRows();
+    const IndexType groupRank = groupComm->getRank();
+    const IndexType groupSize = groupComm->getSize();
+    const IndexType localSize = isTargetGroup ? (N*(groupRank+1))/groupSize - (N*groupRank)/groupSize : 0;
+
+    SCAI_ASSERT_ERROR( graph.getColDistributionPtr()->isReplicated(), "The columns of the input graph must not be distributed" );
+
+    const scai::dmemo::DistributionPtr targetDist = scai::dmemo::genBlockDistributionBySize(N, localSize, comm);
+    CSRSparseMatrix<ValueType> graphCopy(graph);
+    std::vector<DenseVector<ValueType>> coordinatesCopy(coordinates);
+    std::vector<DenseVector<ValueType>> weightsCopy(nodeWeights);
+    redistribute(targetDist, graphCopy, coordinatesCopy, weightsCopy, {});
+
+    if (isTargetGroup) {
+        //same local rows, now distributed over the group only
+        const scai::dmemo::DistributionPtr groupDist = scai::dmemo::genBlockDistributionBySize(N, localSize, groupComm);
+        groupGraph = CSRSparseMatrix<ValueType>(groupDist, graphCopy.getLocalStorage());
+
+        groupCoordinates.resize(coordinatesCopy.size());
+        for (IndexType d = 0; d < IndexType(coordinatesCopy.size()); d++) {
+            groupCoordinates[d] = DenseVector<ValueType>(groupDist, coordinatesCopy[d].getLocalValues());
+        }
+        groupWeights.resize(weightsCopy.size());
+        for (IndexType w = 0; w < IndexType(weightsCopy.size()); w++) {
+            groupWeights[w] = DenseVector<ValueType>(groupDist, weightsCopy[w].getLocalValues());
+        }
+    }
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+DenseVector<IndexType> Redistribution<IndexType, ValueType>::copyFromGroup(
+    const DenseVector<IndexType>& groupVector,
+    const bool isSourceGroup,
+    const scai::dmemo::DistributionPtr targetDistribution ) {
+
+    SCAI_REGION("Redistribution.copyFromGroup")
+
+    const scai::dmemo::CommunicatorPtr comm = targetDistribution->getCommunicatorPtr();
+    const IndexType N = targetDistribution->getGlobalSize();
+
+    //the PEs of the source group own their local part of the vector, all other PEs own nothing
+    scai::hmemo::HArray<IndexType> ownedIndexes;
+    scai::hmemo::HArray<IndexType> values;
+    if (isSourceGroup) {
+        SCAI_ASSERT_EQ_ERROR( groupVector.size(), N, "Size mismatch between group vector and target distribution" );
+        groupVector.getDistributionPtr()->getOwnedIndexes(ownedIndexes);
+        values = groupVector.getLocalValues();
+    }
+
+    const scai::dmemo::DistributionPtr sourceDist = scai::dmemo::generalDistributionUnchecked(N, std::move(ownedIndexes), comm);
+    DenseVector<IndexType> result(sourceDist, std::move(values));
+    result.redistribute(targetDistribution);
+    return result;
+}
+//---------------------------------------------------------------------------------------
+
+template class Redistribution<IndexType, double>;
+template class Redistribution<IndexType, float>;
+
+} // namespace ITI
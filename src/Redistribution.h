@@ -0,0 +1,135 @@
+#pragma once
+
+#include <scai/lama.hpp>
+#include <scai/lama/DenseVector.hpp>
+#include <scai/lama/matrix/CSRSparseMatrix.hpp>
+#include <scai/dmemo/Distribution.hpp>
+
+#include "Settings.h"
+
+namespace ITI {
+
+using namespace scai::lama;
+
+/** @brief Move the graph and all the vectors attached to its rows to a new distribution with a single packed exchange.
+
+Redistributing the input with LAMA is done array by array: the graph, every coordinate dimension and every
+node weight vector each compute their own plan and do their own all-to-all. Here, the new owner of every local
+row is computed once and all the data of a row (its CSR row with the edge weights, the coordinates, the node
+weights and any number of integer vectors like the partition or the origin) are packed together and
+sent in one message per target PE.
+
+The index data (global ids, degrees, column indices and integer vectors) and the floating point data
+(edge weights, coordinates and node weights) are sent as two typed buffers that share the same plan.
+If the data to be send exceed maxChunkBytes, the exchange is done in several rounds, each sending at most
+maxChunkBytes from every PE, so the size of the send and receive buffers stays bounded.
+*/
+
+template <typename IndexType, typename ValueType>
+class Redistribution {
+public:
+
+    /** Redistribute all given data to the target distribution. The source distribution is the row
+    distribution of the graph and all vectors must have the same distribution. The column distribution
+    of the graph must be replicated and it stays replicated.
+
+    @param[in] targetDistribution The new distribution of the rows.
+    @param[in,out] graph The graph to be redistributed.
+    @param[in,out] coordinates The coordinates of the graph, one vector per dimension.
+    @param[in,out] nodeWeights The node weights, one vector per weight.
+    @param[in,out] indexVectors Additional integer vectors to move along, e.g. the partition or the origin. Can be empty.
+    @param[in] maxChunkBytes Maximum number of bytes every PE sends in one round.
+    */
+    static void redistribute(
+        const scai::dmemo::DistributionPtr targetDistribution,
+        CSRSparseMatrix<ValueType>& graph,
+        std::vector<DenseVector<ValueType>>& coordinates,
+        std::vector<DenseVector<ValueType>>& nodeWeights,
+        std::vector<DenseVector<IndexType>*> indexVectors,
+        const std::size_t maxChunkBytes = defaultChunkBytes );
+
+    /** Redistribute all given data so that every local row goes to the PE given in newOwners.
+    Since the new owners are already known, no global owner computation is needed.
+
+    @param[in] newOwners The new owner for every local row. Must have the same size as the local part of the graph.
+    @return The new distribution, created with scai::dmemo::generalDistributionByNewOwners.
+
+    \sa redistribute
+    */
+    static scai::dmemo::DistributionPtr redistributeByNewOwners(
+        const scai::hmemo::HArray<IndexType>& newOwners,
+        CSRSparseMatrix<ValueType>& graph,
+        std::vector<DenseVector<ValueType>>& coordinates,
+        std::vector<DenseVector<ValueType>>& nodeWeights,
+        std::vector<DenseVector<IndexType>*> indexVectors,
+        const std::size_t maxChunkBytes = defaultChunkBytes );
+
+    /** Copy the input to groups of PEs. The PEs of the communicator of the graph are split into numGroups groups of
+    consecutive ranks and every PE gets the copy of its group, block distributed over groupComm. The copies are
+    created one group after the other with a single packed redistribution each, so at most one additional copy
+    exists at a time. The global ids of the vertices do not change.
+
+    @param[in] groupComm The communicator of the group of this PE, with the ranks in the same order as in the communicator of the graph.
+    @param[in] numGroups The number of groups, group g contains the PEs with rank*numGroups/p == g.
+    @param[out] groupGraph, groupCoordinates, groupWeights The copy of the input for the group of this PE.
+    */
+    static void copyToGroups(
+        const scai::dmemo::CommunicatorPtr groupComm,
+        const IndexType numGroups,
+        const CSRSparseMatrix<ValueType>& graph,
+        const std::vector<DenseVector<ValueType>>& coordinates,
+        const std::vector<DenseVector<ValueType>>& nodeWeights,
+        CSRSparseMatrix<ValueType>& groupGraph,
+        std::vector<DenseVector<ValueType>>& groupCoordinates,
+        std::vector<DenseVector<ValueType>>& groupWeights );
+
+    /** Move the input to one group of PEs, e.g., the first ranks, block distributed over groupComm. The other PEs
+    end up with nothing. Collective operation over the communicator of the graph. The global ids do not change.
+
+    @param[in] groupComm The communicator of the group of this PE, with the ranks in the same order as in the communicator of the graph.
+    @param[in] isTargetGroup True on the PEs of the group that gets the input.
+    @param[out] groupGraph, groupCoordinates, groupWeights The input on the PEs of the target group, not set on the other PEs.
+    */
+    static void copyToGroup(
+        const scai::dmemo::CommunicatorPtr groupComm,
+        const bool isTargetGroup,
+        const CSRSparseMatrix<ValueType>& graph,
+        const std::vector<DenseVector<ValueType>>& coordinates,
+        const std::vector<DenseVector<ValueType>>& nodeWeights,
+        CSRSparseMatrix<ValueType>& groupGraph,
+        std::vector<DenseVector<ValueType>>& groupCoordinates,
+        std::vector<DenseVector<ValueType>>& groupWeights );
+
+    /** The reverse of copyToGroups for an integer vector, e.g., a partition: the vector of one group is moved to the
+    target distribution over all PEs. Collective operation over the communicator of the target distribution.
+
+    @param[in] groupVector The vector, distributed over the group communicator. Only read on the PEs of the source group.
+    @param[in] isSourceGroup True on the PEs of the group that holds the vector that is copied.
+    @param[in] targetDistribution The distribution of the result.
+    */
+    static DenseVector<IndexType> copyFromGroup(
+        const DenseVector<IndexType>& groupVector,
+        const bool isSourceGroup,
+        const scai::dmemo::DistributionPtr targetDistribution );
+
+    /** The default upper bound for the bytes send from one PE in one round, 256MB.
+    */
+    static const std::size_t defaultChunkBytes = std::size_t(1) << 28;
+
+private:
+
+    /** Does the actual packing and exchange. owners[i] is the PE that owns local row i in
+    the target distribution.
+    */
+    static void exchange(
+        const scai::dmemo::DistributionPtr targetDistribution,
+        const std::vector<IndexType>& owners,
+        CSRSparseMatrix<ValueType>& graph,
+        std::vector<DenseVector<ValueType>>& coordinates,
+        std::vector<DenseVector<ValueType>>& nodeWeights,
+        std::vector<DenseVector<IndexType>*>& indexVectors,
+        const std::size_t maxChunkBytes );
+
+}; //class Redistribution
+
+} // namespace ITI
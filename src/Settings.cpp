@@ -1,4 +1,5 @@
 #include <unistd.h>
+#include <chrono>
 
 #include <scai/lama/matrix/all.hpp>
 
@@ -31,6 +32,9 @@ std::ostream& ITI::operator<<( std::ostream& out, const ITI::Tool tool) {
     case Tool::geoMS:
         token = "geoMS";
         break;
+    case Tool::geoStream:
+        token = "geoStream";
+        break;
     case Tool::geomRebalance:
         token = "geomRebalance";
         break;
@@ -127,6 +131,8 @@ std::istream& ITI::operator>>(std::istream& in, ITI::Tool& tool) {
         tool = ITI::Tool::geoKmeansBalance;
     else if( token=="geoMS" or tokenLower=="geoms")
         tool = ITI::Tool::geoMS;
+    else if( token=="geoStream" or tokenLower=="geostream")
+        tool = ITI::Tool::geoStream;
     else if( token=="geomRebalance" or tokenLower=="geomrebalance")
         tool = ITI::Tool::geomRebalance;
     else if( token=="parMetisGraph" or tokenLower=="parmetisgraph")
@@ -211,10 +217,31 @@ bool ITI::Settings::checkValidity(const scai::dmemo::CommunicatorPtr comm ) {
         }
         return false;
     }
+    //only the k-means tools depend on the seed, any other tool would compute the same partition in every start
+    if( multiStarts>1 and not (initialPartition==Tool::geoKmeans or initialPartition==Tool::geoKmeansBalance
+            or initialPartition==Tool::geoHierKM or initialPartition==Tool::geoHierRepart) ){
+        this->isValid = false;
+        if( comm->getRank()==0){
+            std::cout<< "ERROR: multiStarts needs a k-means tool for the initial partition, not " << ITI::to_string(initialPartition) << std::endl;
+        }
+        return false;
+    }
 
     return true;
 }
 
+bool ITI::Settings::deadlinePassed(const double deadline, const scai::dmemo::CommunicatorPtr comm) const {
+    if( deadline<=0 ){
+        return false;
+    }
+    //the clocks of the PEs are not synchronized, but every PE measures against its own start time
+    return comm->any( clockSeconds()>deadline );
+}
+
+double ITI::Settings::clockSeconds() {
+    return std::chrono::duration<double>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
 template <typename ValueType>
 ITI::Settings ITI::Settings::setDefault( const scai::lama::CSRSparseMatrix<ValueType>& graph){
     Settings retSet = *this;
@@ -121,6 +121,8 @@ inline std::ostream& operator<<(std::ostream& out, Format method) {
 - geoHierRepart First step is same as using geoHierKM but we also do a post-processing repartition step to improve the cut more.
 - geoSFC Partition a point set (no graph is needed) using the hilbert space filling curve.
 - geoMS Partition a point set (no graph is needed) using the MultiSection algorithm.
+- geoStream Partition a graph in one pass over its vertices with the LDG or Fennel score, \sa StreamingPartition. If the graph is
+	read from a file, the vertices are assigned while they are read.
 ### The tools below require the external libraries parmetis and zoltan2.
 - parMetisGraph Partition a graph using parmetis
 - parMetisGeom Partition a mesh using a version of parmetis that also uses coordinates for an initial partition.
@@ -130,7 +132,7 @@ inline std::ostream& operator<<(std::ostream& out, Format method) {
 - zoltanMJ Partition a point set (no graph is needed) using the Multijagged algorithm of zoltan2.
 - zoltanMJ Partition a point set (no graph is needed) using the space filling curves algorithm of zoltan2.
 */
-enum class Tool { geographer, geoKmeans, geoHierKM, geoHierRepart, geoKmeansBalance, geoSFC, geoMS, geomRebalance, parMetisGraph, parMetisGeom, parMetisSFC, parMetisRefine, zoltanRIB, zoltanRCB, zoltanMJ, zoltanXPulp, zoltanSFC, parhipFastMesh, parhipUltraFastMesh, parhipEcoMesh, parhipFastSocial, parhipUltraFastSocial, parhipEcoSocial, myAlgo, none, unknown};
+enum class Tool { geographer, geoKmeans, geoHierKM, geoHierRepart, geoKmeansBalance, geoSFC, geoMS, geoStream, geomRebalance, parMetisGraph, parMetisGeom, parMetisSFC, parMetisRefine, zoltanRIB, zoltanRCB, zoltanMJ, zoltanXPulp, zoltanSFC, parhipFastMesh, parhipUltraFastMesh, parhipEcoMesh, parhipFastSocial, parhipUltraFastSocial, parhipEcoSocial, myAlgo, none, unknown};
 
 
 std::istream& operator>>(std::istream& in, ITI::Tool& tool);
@@ -162,6 +164,24 @@ struct Settings {
     ITI::Tool initialPartition = ITI::Tool::geoKmeans;			///< the tool to use to get the initial partition, \sa Tool
     //static const ITI::Tool initialMigration = ITI::Tool::geoSFC;///< pre-processing step to redistribute/migrate coordinates
     ITI::Tool initialMigration = ITI::Tool::geoSFC;
+    std::string streamingScore = "fennel";		///< the score of the blocks for geoStream: ldg or fennel
+    IndexType multiStarts = 1;					///< number of initial partitions computed on disjoint groups of PEs, the best one is kept
+    std::string multiStartObjective = "cut";	///< how the initial partitions of the multi-start are compared: cut, maxCommVolume or imbalance
+    IndexType minLocalVertices = 0;			///< if there are fewer vertices per PE, the input is partitioned on n/minLocalVertices PEs; 0 (default) to always use all PEs
+    double timeBudget = 0;						///< wall clock seconds for partitionGraph, iterative phases stop early to meet it; 0 for no limit
+    double initialBudgetShare = 0.6;			///< fraction of the time budget given to the initial partition, the rest is for local refinement
+
+    /// absolute deadlines of the phases in seconds of the steady clock, set by partitionGraph from timeBudget. 0 for no deadline
+    double initialDeadline = 0;
+    double refinementDeadline = 0;
+
+    /** True if the deadline has passed on any PE, so that all PEs stop in the same iteration.
+    Always false for a deadline of 0. Collective operation if the deadline is set.
+    */
+    bool deadlinePassed(const double deadline, const scai::dmemo::CommunicatorPtr comm) const;
+
+    /** Seconds of the steady clock, the unit of the deadlines. */
+    static double clockSeconds();
     //@}
 
     /** @name Input data and other info
@@ -171,17 +191,28 @@ struct Settings {
     std::string fileName = "-";	///< the name of the input file to read the graph from
     std::string outFile = "-";	///< name of the file to store metrics (if desired)
     std::string outDir = "-"; 	//this is used by the competitors main
+    std::string batchFiles = "-";	///< if set, partition these inputs one after the other; a glob pattern or a file with one input per line, \sa FileIO::readFileList
+    std::string serviceSocket = "-";	///< if set, stay resident and partition the requests sent to this Unix domain socket, \sa PartitionService
+    bool outOfCoreSFC = false;		///< partition the points of the coordinate file with two passes over the file, without reading them into memory, \sa HilbertCurve::partitionOutOfCore
     std::string PEGraphFile = "-"; //TODO: this should not be in settings
     ITI::Format fileFormat = ITI::Format::AUTO;   	///< the format of the input file, \sa Format
     ITI::Format coordFormat = ITI::Format::AUTO; 	///< the format of the coordinated input file, \sa Format
     bool useDiffusionCoordinates = false;		///< if not coordinates are provided, we can use artificial coordinates
     IndexType diffusionRounds = 20;				///< number of rounds to create the diffusion coordinates
+    bool useGraphEmbedding = false;		///< if no coordinates are provided, compute them with a multilevel embedding of the graph, \sa Embedding
+    IndexType embeddingCoarsestSize = 2000;	///< coarsen the graph for the embedding until it has at most that many vertices
+    IndexType embeddingSmoothingSteps = 5;	///< smoothing steps on every level of the embedding
+    std::string embeddingMethod = "diffusion";	///< the embedding of the coarsest graph: diffusion or spectral (eigenvectors of the Laplacian)
     IndexType numNodeWeights = 0;		///< number of vertex weights
     std::string machine;                ///< name of the machine that the executable is running
     double seed;                        ///< random seed used for some routines
     std::string callingCommand;         ///< the complete calling command used
     bool autoSetCpuMem = false;         ///< if set, geographer will gather cpu and memory info and use them for partitioning
     IndexType processPerNode = 24;      ///< the number of processes per compute node. Is used with autoSetCpuMem to determine the cpu ID
+    bool autoTopology = false;          ///< build a hierarchical communication tree from the hosts and NUMA domains of the PEs
+    bool probeLatency = false;          ///< with autoTopology, measure the distances of the hierarchy levels with a ping-pong instead of estimating them
+    bool measureSpeed = false;          ///< with autoSetCpuMem, use the measured SpMV throughput of every PE instead of its cpu frequency
+    std::string speedCacheFile = "-";   ///< with measureSpeed, file to average the measurements of several runs
     bool w2UpperBound = false;          ///< when given a file with the block sizes or the topology, treat the second weight as an upper bound(usually, this is used so the second weight corresponds to the memory capacity of the PEs)
     bool useMemFromFile = false;        ///< when a topology or block sizes file is given, if true, use the actual values in the file for memory. otherwise set the max memory to 1.2*number of graph rows.
     //@}
@@ -230,6 +261,7 @@ struct Settings {
     bool freezeBalancedInfluence = false;
     bool erodeInfluence = false;
     bool keepMostBalanced = false;
+    bool shuffleSamples = false;			///< sample the local points in a random order given by the seed instead of the fixed cantor order
     std::string KMBalanceMethod = "reb_lex";
     //IndexType batchSize = 100;              ///< after how many moves we calculate the global sum in KMeans::rebalance()
     double batchPercent = 0.01;          ///< calculate the batch size as a percentage of the number of local points
@@ -237,6 +269,21 @@ struct Settings {
     std::vector<IndexType> hierLevels; 		///< for hierarchial kMeans, the number of blocks per level
     //@}
 
+    /** @name Autotuning of the performance parameters, \sa AutoTuner
+    */
+    //@{
+    bool autoTune = false;					///< choose sfcResolution, minSamplingNodes, influenceChangeCap and batchPercent by probing on a sample
+    std::string tuningDBFile = "-";			///< file with the tuned parameters per input features, read before and updated after probing
+    double tuningSampleFraction = 0.1;		///< fraction of the points used by the probes
+    //@}
+
+    /** @name Checkpoints of the pipeline stages, \sa Checkpoint
+    */
+    //@{
+    std::string checkpointDir = "-";		///< directory for a checkpoint after every stage, "-" for no checkpoints
+    std::string resumeFrom = "-";			///< continue from the latest checkpoint up to this stage, a stage name or "last"; "-" to start from the beginning
+    //@}
+
     /** @name Parameters for multisection
     */
     //@{
@@ -263,6 +310,7 @@ struct Settings {
     bool debugMode = false; 				///< even more checks and prints
     bool writeDebugCoordinates = false;		///< store coordinates and block id
     bool writePEgraph = false;				///< store the processor graph
+    bool storeHaloPlan = false;				///< store the send and receive lists of the blocks, \sa HaloExport
     //TODO: storeInfo is mostly ignore. remove?
     bool storeInfo = false;					///< store metrics info
     bool storePartition = false;            ///< store partition info
@@ -285,10 +333,21 @@ struct Settings {
     bool setAutoSettings;
     ///this is used by the competitors main to set the tools we are gonna use
     std::vector<std::string> tools;
+    ///this is used by the competitors main: split the PEs into that many groups that run different tools at the same time
+    IndexType concurrentGroups = 1;
 
     /// for mapping by renumbering the block centers according to their SFC index
     bool mappingRenumbering = false;
 
+    /// reorder the local vertices of every PE for the local refinement to improve cache locality: none, sfc or rcm
+    std::string localReordering = "none";
+
+    /// write a global numbering that is contiguous per block, ordered within the blocks by: none, sfc or rcm
+    std::string blockRenumbering = "none";
+
+    /// pin the OpenMP threads of every process: none, compact or spread (over the NUMA domains)
+    std::string threadAffinity = "none";
+
     /// variable to check if the settings given are valid or not
     bool isValid = true;
     //@}
@@ -331,7 +390,16 @@ struct Settings {
         }
 
         out<< "initial migration: " << initialMigration << std::endl;
+        if( localReordering!="none" ) {
+            out<< "local reordering: " << localReordering << std::endl;
+        }
         out<< "initial partition: " << initialPartition << std::endl;
+        if( multiStarts>1 ) {
+            out<< "\tmultiStarts: " << multiStarts << ", objective: " << multiStartObjective << std::endl;
+        }
+        if( timeBudget>0 ) {
+            out<< "time budget: " << timeBudget << " seconds, initial partition share " << initialBudgetShare << std::endl;
+        }
 
         if(ITI::to_string(initialPartition).rfind("geoSFC",0)==0 ){
         //if (initialPartition==ITI::Tool::geoSFC) {
@@ -354,6 +422,9 @@ struct Settings {
         else if(ITI::to_string(initialPartition).rfind("geoMS",0)==0 ){
             out<< "\tbisect: " << bisect << std::endl;
             out<< "\tuseIter "<< useIter << std::endl;
+        }
+        else if (initialPartition==ITI::Tool::geoStream) {
+            out<< "\tstreamingScore: " << streamingScore << std::endl;
         } else {
             out<< "initial partition undefined" << std::endl;
         }
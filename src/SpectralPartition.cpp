@@ -8,9 +8,177 @@
 
 #include "SpectralPartition.h"
 #include "GraphUtils.h"
+#include "CompactGraph.h"
+#include "ParcoRepart.h"
+#include "HaloPlanFns.h"
+
+#include <scai/hmemo/ReadAccess.hpp>
+#include <scai/hmemo/WriteAccess.hpp>
+
+#include <cstdint>
 
 namespace ITI {
 
+namespace {
+
+/* Dense blocks of vectors are stored row-wise: value c of local vertex i is at i*width+c.
+   The small dense matrices of the Rayleigh-Ritz step are replicated and always use double. */
+
+/* A pseudo random value in [-1,1] that only depends on the global id and the column, so the
+   start vectors do not depend on the distribution. */
+double pseudoRandom(std::uint64_t x) {
+    //splitmix64
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x = x ^ (x >> 31);
+    return 2.0*(double(x >> 11) / double(1ULL << 53)) - 1.0;
+}
+
+/* G = A^T B for blocks A of width a and B of width b, summed over all PEs. */
+template<typename ValueType>
+std::vector<double> blockGram(const std::vector<ValueType>& A, const IndexType a, const std::vector<ValueType>& B, const IndexType b, const IndexType localN, const scai::dmemo::Communicator& comm) {
+    std::vector<double> G(a*b, 0);
+    for (IndexType i = 0; i < localN; i++) {
+        for (IndexType r = 0; r < a; r++) {
+            const double value = A[i*a+r];
+            for (IndexType c = 0; c < b; c++) {
+                G[r*b+c] += value*B[i*b+c];
+            }
+        }
+    }
+    comm.sumImpl( G.data(), G.data(), a*b, scai::common::TypeTraits<double>::stype );
+    return G;
+}
+
+/* Returns the block (width a) times the small matrix C (a x b), only the columns [firstColumn, a) of the block and the rows [firstColumn, a) of C are used. */
+template<typename ValueType>
+std::vector<ValueType> blockTimesSmall(const std::vector<ValueType>& block, const IndexType a, const std::vector<double>& C, const IndexType b, const IndexType localN, const IndexType firstColumn = 0) {
+    std::vector<ValueType> result(localN*b, 0);
+    #pragma omp parallel for schedule(static)
+    for (IndexType i = 0; i < localN; i++) {
+        for (IndexType r = firstColumn; r < a; r++) {
+            const double value = block[i*a+r];
+            for (IndexType c = 0; c < b; c++) {
+                result[i*b+c] += value*C[r*b+c];
+            }
+        }
+    }
+    return result;
+}
+
+/* Make the columns of the block orthonormal with a Cholesky QR. Columns that are numerically dependent on the previous ones are removed.
+   Returns the number of kept columns, the block is resized accordingly. The span of the first j kept columns is not changed. */
+template<typename ValueType>
+IndexType orthonormalize(std::vector<ValueType>& block, const IndexType width, const IndexType localN, const scai::dmemo::Communicator& comm, std::vector<bool>& kept) {
+    const std::vector<double> G = blockGram(block, width, block, width, localN, comm);
+
+    //upper triangular factor, row j belongs to column j
+    std::vector<double> R(width*width, 0);
+    std::vector<IndexType> keptColumns;
+    kept.assign(width, false);
+    for (IndexType j = 0; j < width; j++) {
+        double d = G[j*width+j];
+        for (IndexType k : keptColumns) {
+            d -= R[k*width+j]*R[k*width+j];
+        }
+        if (!(d > 1e-10*G[j*width+j]) or G[j*width+j] <= 0) {
+            continue;
+        }
+        R[j*width+j] = std::sqrt(d);
+        for (IndexType i = j+1; i < width; i++) {
+            double value = G[j*width+i];
+            for (IndexType k : keptColumns) {
+                value -= R[k*width+j]*R[k*width+i];
+            }
+            R[j*width+i] = value / R[j*width+j];
+        }
+        keptColumns.push_back(j);
+        kept[j] = true;
+    }
+
+    //solve y R = x for every row x of the block, only for the kept columns
+    const IndexType newWidth = keptColumns.size();
+    std::vector<ValueType> result(localN*newWidth);
+    #pragma omp parallel for schedule(static)
+    for (IndexType i = 0; i < localN; i++) {
+        for (IndexType jj = 0; jj < newWidth; jj++) {
+            const IndexType j = keptColumns[jj];
+            double value = block[i*width+j];
+            for (IndexType kk = 0; kk < jj; kk++) {
+                value -= result[i*newWidth+kk]*R[keptColumns[kk]*width+j];
+            }
+            result[i*newWidth+jj] = value / R[j*width+j];
+        }
+    }
+    block.swap(result);
+    return newWidth;
+}
+
+/* Eigenvalues and eigenvectors of a small symmetric matrix with the cyclic Jacobi method.
+   The eigenvalues are sorted ascending, column j of the returned matrix is the eigenvector of eigenvalue j. */
+std::vector<double> symmetricEigen(std::vector<double> A, const IndexType s, std::vector<double>& eigenvalues) {
+    std::vector<double> V(s*s, 0);
+    for (IndexType i = 0; i < s; i++) {
+        V[i*s+i] = 1;
+    }
+
+    for (IndexType sweep = 0; sweep < 100; sweep++) {
+        double offDiagonal = 0;
+        double total = 0;
+        for (IndexType i = 0; i < s; i++) {
+            for (IndexType j = 0; j < s; j++) {
+                total += A[i*s+j]*A[i*s+j];
+                if (i != j) offDiagonal += A[i*s+j]*A[i*s+j];
+            }
+        }
+        if (offDiagonal <= 1e-30*total) break;
+
+        for (IndexType p = 0; p < s; p++) {
+            for (IndexType q = p+1; q < s; q++) {
+                if (A[p*s+q] == 0) continue;
+                const double theta = (A[q*s+q] - A[p*s+p]) / (2*A[p*s+q]);
+                const double t = (theta >= 0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta*theta + 1));
+                const double c = 1 / std::sqrt(t*t + 1);
+                const double sn = t*c;
+                for (IndexType k = 0; k < s; k++) {
+                    const double akp = A[k*s+p], akq = A[k*s+q];
+                    A[k*s+p] = c*akp - sn*akq;
+                    A[k*s+q] = sn*akp + c*akq;
+                }
+                for (IndexType k = 0; k < s; k++) {
+                    const double apk = A[p*s+k], aqk = A[q*s+k];
+                    A[p*s+k] = c*apk - sn*aqk;
+                    A[q*s+k] = sn*apk + c*aqk;
+                }
+                for (IndexType k = 0; k < s; k++) {
+                    const double vkp = V[k*s+p], vkq = V[k*s+q];
+                    V[k*s+p] = c*vkp - sn*vkq;
+                    V[k*s+q] = sn*vkp + c*vkq;
+                }
+            }
+        }
+    }
+
+    std::vector<IndexType> order(s);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](IndexType i, IndexType j) {
+        return A[i*s+i] < A[j*s+j];
+    });
+
+    eigenvalues.resize(s);
+    std::vector<double> sortedV(s*s);
+    for (IndexType j = 0; j < s; j++) {
+        eigenvalues[j] = A[order[j]*s+order[j]];
+        for (IndexType k = 0; k < s; k++) {
+            sortedV[k*s+j] = V[k*s+order[j]];
+        }
+    }
+    return sortedV;
+}
+
+} // anonymous namespace
+
 
 template<typename IndexType, typename ValueType>
 scai::lama::DenseVector<IndexType> SpectralPartition<IndexType, ValueType>::getPartition(const CSRSparseMatrix<ValueType> &adjM, const std::vector<DenseVector<ValueType>> &coordinates, Settings settings) {
@@ -24,7 +192,6 @@ scai::lama::DenseVector<IndexType> SpectralPartition<IndexType, ValueType>::getP
     const scai::dmemo::CommunicatorPtr comm = inputDist->getCommunicatorPtr();
 
     IndexType k = settings.numBlocks;
-    const IndexType dimensions = coordinates.size();
     const IndexType localN = inputDist->getLocalSize();
     const IndexType globalN = inputDist->getGlobalSize();
 
@@ -34,7 +201,8 @@ scai::lama::DenseVector<IndexType> SpectralPartition<IndexType, ValueType>::getP
 
     // get a pixeled-coarsen graph , this is replicated in every PE
     scai::lama::DenseVector<ValueType> pixelWeights;
-    scai::lama::CSRSparseMatrix<ValueType> pixelGraph = MultiLevel<IndexType, ValueType>::pixeledCoarsen(adjM, coordinates, pixelWeights, settings);
+    std::vector<IndexType> pixelIds;
+    scai::lama::CSRSparseMatrix<ValueType> pixelGraph = MultiLevel<IndexType, ValueType>::pixeledCoarsen(adjM, coordinates, pixelWeights, pixelIds, settings);
     SCAI_ASSERT( pixelGraph.getRowDistributionPtr()->isReplicated() == 1, "Pixel graph should (?) be replicated.");
 
     IndexType numPixels = pixelGraph.getNumRows();
@@ -62,7 +230,9 @@ scai::lama::DenseVector<IndexType> SpectralPartition<IndexType, ValueType>::getP
 
     {
         SCAI_REGION( "SpectralPartition.getPartition.getFiedlerVectorAndSort" )
-        fiedler= SpectralPartition<IndexType, ValueType>::getFiedlerVector( pixelGraph, fiedlerEigenvalue );
+        std::vector<ValueType> eigenvalues;
+        fiedler = SpectralPartition<IndexType, ValueType>::getEigenvectors( pixelGraph, 1, eigenvalues )[0];
+        fiedlerEigenvalue = eigenvalues[0];
         SCAI_ASSERT( fiedler.size() == numPixels, "Sizes do not agree.");
         fiedler.sort(permutation, true);
     }
@@ -118,24 +288,8 @@ scai::lama::DenseVector<IndexType> SpectralPartition<IndexType, ValueType>::getP
     // here, every pixel must belong to a part
     //
 
-    const unsigned long sideLen = settings.pixeledSideLen;
-
-    //TODO: finding the max is also done in pixeledCoarsen, maybe we can pass max as input parameter there
-    std::vector<ValueType> maxCoords(dimensions, std::numeric_limits<ValueType>::lowest());
-
-    // get local max
-    for (IndexType dim = 0; dim < dimensions; dim++) {
-        //get local parts of coordinates
-        const scai::hmemo::HArray<ValueType>& localPartOfCoords = coordinates[dim].getLocalValues();
-        for (IndexType i = 0; i < localN; i++) {
-            ValueType coord = localPartOfCoords[i];
-            if (coord > maxCoords[dim]) maxCoords[dim] = coord;
-        }
-    }
-    // communicate to get global  max
-    for (IndexType dim = 0; dim < dimensions; dim++) {
-        maxCoords[dim] = comm->max(maxCoords[dim]);
-    }
+    // the same pixels as in pixeledCoarsen
+    const std::vector<IndexType> localPixel = ParcoRepart<IndexType, ValueType>::localPixels(coordinates, settings.pixeledSideLen);
 
     // set your local part of the partition/result
     DenseVector<IndexType>  result(inputDist, 0);
@@ -144,22 +298,10 @@ scai::lama::DenseVector<IndexType> SpectralPartition<IndexType, ValueType>::getP
         scai::hmemo::WriteOnlyAccess<IndexType> wLocalPart ( result.getLocalValues() );
         scai::hmemo::ReadAccess<IndexType> rPixelPart( localPixelPartition.getLocalValues() );
 
-        scai::hmemo::ReadAccess<ValueType> coordAccess0( coordinates[0].getLocalValues() );
-        scai::hmemo::ReadAccess<ValueType> coordAccess1( coordinates[1].getLocalValues() );
-        // this is faulty, if dimensions=2 coordAccess2 is equal to coordAccess1
-        scai::hmemo::ReadAccess<ValueType> coordAccess2( coordinates[dimensions-1].getLocalValues() );
-
         for(IndexType i=0; i<localN; i++) {
-            IndexType scaledX = sideLen*coordAccess0[i]/(maxCoords[0]+1);
-            IndexType scaledY = sideLen*coordAccess1[i]/(maxCoords[1]+1);
-            IndexType thisPixel;    // the pixel this node belongs to
-            if(dimensions==3) {
-                IndexType scaledZ = sideLen*coordAccess2[i]/(maxCoords[2]+1);
-                thisPixel = scaledX*sideLen*sideLen + scaledY*sideLen + scaledZ;
-            } else {
-                thisPixel = scaledX*sideLen + scaledY;
-            }
-            SCAI_ASSERT( thisPixel < numPixels, "Index too big: "<< thisPixel );
+            // the row of the pixel this node belongs to, every pixel with a point is in the pixeled graph
+            const IndexType thisPixel = std::lower_bound(pixelIds.begin(), pixelIds.end(), localPixel[i]) - pixelIds.begin();
+            SCAI_ASSERT( thisPixel < numPixels and pixelIds[thisPixel] == localPixel[i], "Pixel "<< localPixel[i] << " not in the pixeled graph" );
 
             // set the block for this node
             wLocalPart[i] = rPixelPart[ thisPixel ];
@@ -277,6 +419,216 @@ scai::lama::DenseVector<ValueType> SpectralPartition<IndexType, ValueType>::getF
     return t;
 }
 
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+std::vector<scai::lama::DenseVector<ValueType>> SpectralPartition<IndexType, ValueType>::getEigenvectors(const scai::lama::CSRSparseMatrix<ValueType>& adjM, const IndexType numVectors, std::vector<ValueType>& eigenvalues, const ValueType tolerance, const IndexType maxIterations ) {
+    SCAI_REGION("SpectralPartition.getEigenvectors");
+
+    const IndexType globalN = adjM.getNumRows();
+    SCAI_ASSERT_EQ_ERROR( globalN, adjM.getNumColumns(), "Matrix not square, numRows != numColumns");
+    SCAI_ASSERT_GT_ERROR( numVectors, 0, "Need at least one eigenvector");
+    SCAI_ASSERT_LT_ERROR( 3*numVectors, globalN, "Too many eigenvectors for the size of the graph");
+
+    const scai::dmemo::DistributionPtr dist = adjM.getRowDistributionPtr();
+    const scai::dmemo::CommunicatorPtr comm = dist->getCommunicatorPtr();
+    const IndexType localN = dist->getLocalSize();
+    const IndexType m = numVectors;
+
+    //the halo and the compact graph need global column indices
+    const scai::lama::CSRSparseMatrix<ValueType>* graph = &adjM;
+    scai::lama::CSRSparseMatrix<ValueType> replicatedColumns;
+    if (!adjM.getColDistributionPtr()->isReplicated()) {
+        replicatedColumns = adjM;
+        replicatedColumns.redistribute(dist, scai::dmemo::DistributionPtr(new scai::dmemo::NoDistribution(globalN)));
+        graph = &replicatedColumns;
+    }
+
+    const scai::dmemo::HaloExchangePlan halo = GraphUtils<IndexType, ValueType>::buildNeighborHalo(*graph);
+    const CompactGraph<IndexType, ValueType> compact(*graph, halo);
+
+    //weighted degrees without self loops, the diagonal of the Laplacian
+    std::vector<ValueType> degree(localN, 0);
+    for (IndexType i = 0; i < localN; i++) {
+        for (IndexType e = compact.beginEdges(i); e < compact.endEdges(i); e++) {
+            if (IndexType(compact.target(e)) != i) degree[i] += compact.weight(e);
+        }
+    }
+    //Gershgorin bound for the largest eigenvalue, used to scale the tolerance
+    const ValueType maxDegree = comm->max( localN > 0 ? *std::max_element(degree.begin(), degree.end()) : ValueType(0) );
+    const ValueType normBound = std::max( 2*maxDegree, ValueType(1) );
+
+    std::vector<ValueType> ghostValues;
+
+    //result = L*block for a block of the given width, one halo exchange for all columns
+    auto applyLaplacian = [&](const std::vector<ValueType>& block, const IndexType width) {
+        SCAI_REGION("SpectralPartition.getEigenvectors.SpMM");
+        ghostValues.resize(compact.numGhosts()*width);
+        updateHaloBlocks(halo, block.data(), ghostValues.data(), width, *comm);
+
+        std::vector<ValueType> result(localN*width);
+        #pragma omp parallel for schedule(static)
+        for (IndexType i = 0; i < localN; i++) {
+            ValueType* row = result.data() + i*width;
+            for (IndexType c = 0; c < width; c++) {
+                row[c] = degree[i]*block[i*width+c];
+            }
+            for (IndexType e = compact.beginEdges(i); e < compact.endEdges(i); e++) {
+                const typename CompactGraph<IndexType, ValueType>::LocalIndex target = compact.target(e);
+                if (IndexType(target) == i) continue;
+                const ValueType w = compact.weight(e);
+                const ValueType* neighbor = compact.isLocal(target) ? block.data() + target*width : ghostValues.data() + compact.ghostIndex(target)*width;
+                for (IndexType c = 0; c < width; c++) {
+                    row[c] -= w*neighbor[c];
+                }
+            }
+        }
+        return result;
+    };
+
+    //remove the component of the constant vector, the eigenvector of eigenvalue zero
+    auto deflate = [&](std::vector<ValueType>& block, const IndexType width) {
+        std::vector<double> sums(width, 0);
+        for (IndexType i = 0; i < localN; i++) {
+            for (IndexType c = 0; c < width; c++) {
+                sums[c] += block[i*width+c];
+            }
+        }
+        comm->sumImpl( sums.data(), sums.data(), width, scai::common::TypeTraits<double>::stype );
+        for (IndexType i = 0; i < localN; i++) {
+            for (IndexType c = 0; c < width; c++) {
+                block[i*width+c] -= sums[c]/globalN;
+            }
+        }
+    };
+
+    //Rayleigh-Ritz: the m smallest Ritz pairs in the span of the orthonormal basis
+    std::vector<double> theta;
+    auto rayleighRitz = [&](const std::vector<ValueType>& basis, const std::vector<ValueType>& laplacianBasis, const IndexType width) {
+        std::vector<double> H = blockGram(basis, width, laplacianBasis, width, localN, *comm);
+        for (IndexType r = 0; r < width; r++) {
+            for (IndexType c = r+1; c < width; c++) {
+                H[r*width+c] = H[c*width+r] = 0.5*(H[r*width+c] + H[c*width+r]);
+            }
+        }
+        const std::vector<double> V = symmetricEigen(H, width, theta);
+        //keep the first m columns
+        std::vector<double> C(width*m);
+        for (IndexType r = 0; r < width; r++) {
+            std::copy(V.begin() + r*width, V.begin() + r*width + m, C.begin() + r*m);
+        }
+        theta.resize(m);
+        return C;
+    };
+
+    //
+    // start vectors
+    //
+
+    std::vector<ValueType> X(localN*m);
+    for (IndexType i = 0; i < localN; i++) {
+        const std::uint64_t globalI = dist->local2Global(i);
+        for (IndexType c = 0; c < m; c++) {
+            X[i*m+c] = pseudoRandom(globalI*m + c);
+        }
+    }
+    deflate(X, m);
+    //Cholesky QR is done twice, the second pass restores the orthogonality lost in the first
+    std::vector<bool> kept;
+    IndexType startWidth = orthonormalize(X, m, localN, *comm, kept);
+    startWidth = orthonormalize(X, startWidth, localN, *comm, kept);
+    SCAI_ASSERT_EQ_ERROR( startWidth, m, "Start vectors are dependent" );
+
+    std::vector<ValueType> AX = applyLaplacian(X, m);
+    {
+        const std::vector<double> C = rayleighRitz(X, AX, m);
+        X = blockTimesSmall(X, m, C, m, localN);
+        AX = blockTimesSmall(AX, m, C, m, localN);
+    }
+
+    std::vector<ValueType> P;
+    IndexType widthP = 0;
+    std::vector<double> residualNorms(m, 0);
+
+    IndexType iter = 0;
+    for (; iter < maxIterations; iter++) {
+        //residuals
+        std::vector<ValueType> W(localN*m);
+        for (IndexType i = 0; i < localN; i++) {
+            for (IndexType c = 0; c < m; c++) {
+                W[i*m+c] = AX[i*m+c] - theta[c]*X[i*m+c];
+            }
+        }
+        std::fill(residualNorms.begin(), residualNorms.end(), 0);
+        for (IndexType i = 0; i < localN; i++) {
+            for (IndexType c = 0; c < m; c++) {
+                residualNorms[c] += W[i*m+c]*W[i*m+c];
+            }
+        }
+        comm->sumImpl( residualNorms.data(), residualNorms.data(), m, scai::common::TypeTraits<double>::stype );
+        double maxResidual = 0;
+        for (IndexType c = 0; c < m; c++) {
+            residualNorms[c] = std::sqrt(residualNorms[c]);
+            maxResidual = std::max(maxResidual, residualNorms[c]);
+        }
+        if (maxResidual <= tolerance*normBound) {
+            break;
+        }
+
+        //Jacobi preconditioner
+        for (IndexType i = 0; i < localN; i++) {
+            if (degree[i] > 0) {
+                for (IndexType c = 0; c < m; c++) {
+                    W[i*m+c] /= degree[i];
+                }
+            }
+        }
+        deflate(W, m);
+
+        //basis [X W P]
+        const IndexType width = 2*m + widthP;
+        std::vector<ValueType> S(localN*width);
+        for (IndexType i = 0; i < localN; i++) {
+            std::copy(X.begin() + i*m, X.begin() + (i+1)*m, S.begin() + i*width);
+            std::copy(W.begin() + i*m, W.begin() + (i+1)*m, S.begin() + i*width + m);
+            std::copy(P.begin() + i*widthP, P.begin() + (i+1)*widthP, S.begin() + i*width + 2*m);
+        }
+
+        IndexType basisWidth = orthonormalize(S, width, localN, *comm, kept);
+        const IndexType keptX = std::count(kept.begin(), kept.begin() + m, true);
+        basisWidth = orthonormalize(S, basisWidth, localN, *comm, kept);
+        if (basisWidth <= m) {
+            break;
+        }
+
+        const std::vector<ValueType> AS = applyLaplacian(S, basisWidth);
+        const std::vector<double> C = rayleighRitz(S, AS, basisWidth);
+
+        //the new search direction is the part of the new X outside of the span of the old X
+        P = blockTimesSmall(S, basisWidth, C, m, localN, keptX);
+        widthP = m;
+        X = blockTimesSmall(S, basisWidth, C, m, localN);
+        AX = blockTimesSmall(AS, basisWidth, C, m, localN);
+    }
+
+    const double maxResidual = *std::max_element(residualNorms.begin(), residualNorms.end());
+    PRINT0("LOBPCG: " << iter << " iterations for " << m << " eigenvectors, max residual " << maxResidual << ", smallest eigenvalue " << theta[0]);
+
+    eigenvalues.assign(theta.begin(), theta.end());
+    std::vector<scai::lama::DenseVector<ValueType>> result(m);
+    for (IndexType c = 0; c < m; c++) {
+        scai::hmemo::HArray<ValueType> localValues(localN);
+        {
+            scai::hmemo::WriteAccess<ValueType> wValues(localValues);
+            for (IndexType i = 0; i < localN; i++) {
+                wValues[i] = X[i*m+c];
+            }
+        }
+        result[c] = scai::lama::DenseVector<ValueType>(dist, std::move(localValues));
+    }
+    return result;
+}
+
 /*
 template<typename IndexType, typename ValueType>
 scai::lama::DenseVector<ValueType> SpectralPartition<IndexType, ValueType>::getFiedlerVector2(const scai::lama::CSRSparseMatrix<ValueType>& adjM, ValueType& eigenvalue ){
@@ -311,6 +663,7 @@ scai::lama::DenseVector<ValueType> SpectralPartition<IndexType, ValueType>::getF
 */
 //---------------------------------------------------------------------------------------
 
-template class SpectralPartition<IndexType, ValueType>;
+template class SpectralPartition<IndexType, double>;
+template class SpectralPartition<IndexType, float>;
 
 };
@@ -57,6 +57,26 @@ public:
      */
     static scai::lama::DenseVector<ValueType> getFiedlerVector(const scai::lama::CSRSparseMatrix<ValueType>& adjM,
             ValueType& eigenvalue );
+
+    /** The eigenvectors of the Laplacian of a graph for the smallest non-zero eigenvalues.
+     *
+     *  Method: LOBPCG (locally optimal block preconditioned conjugate gradient) with a Jacobi preconditioner.
+     *  All vectors are computed together: every iteration does one sparse matrix product with the block of
+     *  up to 3*numVectors vectors and a few reductions of small dense matrices. The constant vector, the
+     *  eigenvector of eigenvalue zero, is projected out of all iterates.
+     *
+     *  Paper: Toward the optimal preconditioned eigensolver: locally optimal block preconditioned conjugate gradient method
+     *         Andrew V. Knyazev
+     *
+     * @param[in] adjM The adjacency matrix of the graph, can be distributed.
+     * @param[in] numVectors The number of eigenvectors, e.g. 1 for the Fiedler vector or the dimension of a spectral embedding.
+     * @param[out] eigenvalues The eigenvalues of the returned vectors, in ascending order.
+     * @param[in] tolerance Stop when the residual norm of every vector is below tolerance times an upper bound of the largest eigenvalue.
+     * @param[in] maxIterations Maximum number of iterations.
+     * @return The eigenvectors, normalized and with the row distribution of adjM.
+     */
+    static std::vector<scai::lama::DenseVector<ValueType>> getEigenvectors(const scai::lama::CSRSparseMatrix<ValueType>& adjM,
+            const IndexType numVectors, std::vector<ValueType>& eigenvalues, const ValueType tolerance = 1e-5, const IndexType maxIterations = 500 );
 };
 
 }
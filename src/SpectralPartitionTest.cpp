@@ -28,14 +28,15 @@
 
 namespace ITI {
 
-class DISABLED_SpectralPartitionTest : public ::testing::Test {
+class SpectralPartitionTest : public ::testing::Test {
 protected:
     // the directory of all the meshes used
     // projectRoot is defined in config.h.in
     const std::string graphPath = projectRoot+"/meshes/";
 };
 
-TEST_F(DISABLED_SpectralPartitionTest, testFiedlerVector) {
+TEST_F(SpectralPartitionTest, testFiedlerVector) {
+    using ValueType = double;
     using scai::hmemo::HArray;
 
     scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
@@ -130,7 +131,40 @@ TEST_F(DISABLED_SpectralPartitionTest, testFiedlerVector) {
 
 //------------------------------------------------------------------------------
 
-TEST_F(DISABLED_SpectralPartitionTest, DISABLED_testGetPartition) {
+TEST_F(SpectralPartitionTest, testEigenvectors) {
+    using ValueType = double;
+
+    std::string file = graphPath + "Grid16x16";
+    scai::lama::CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph( file );
+    const IndexType n = graph.getNumRows();
+
+    //the two smallest non-zero eigenvalues of the Laplacian of a 16x16 grid are both 2-2cos(pi/16)
+    const ValueType expected = 2 - 2*std::cos(M_PI/16);
+    const IndexType numVectors = 2;
+
+    std::vector<ValueType> eigenvalues;
+    std::vector<DenseVector<ValueType>> eigenvectors = SpectralPartition<IndexType, ValueType>::getEigenvectors( graph, numVectors, eigenvalues, 1e-6 );
+
+    ASSERT_EQ( numVectors, eigenvectors.size() );
+    ASSERT_EQ( numVectors, eigenvalues.size() );
+
+    scai::lama::CSRSparseMatrix<ValueType> laplacian = GraphUtils<IndexType, ValueType>::constructLaplacian( graph );
+
+    for (IndexType c = 0; c < numVectors; c++) {
+        EXPECT_NEAR( expected, eigenvalues[c], 1e-3 );
+        EXPECT_EQ( n, eigenvectors[c].size() );
+        EXPECT_NEAR( 1, eigenvectors[c].l2Norm(), 1e-6 );
+        //orthogonal to the constant vector
+        EXPECT_NEAR( 0, eigenvectors[c].sum(), 1e-6 );
+
+        DenseVector<ValueType> residual = scai::lama::eval<DenseVector<ValueType>>( laplacian*eigenvectors[c] - eigenvalues[c]*eigenvectors[c] );
+        EXPECT_LT( residual.l2Norm(), 1e-4 );
+    }
+    EXPECT_NEAR( 0, eigenvectors[0].dotProduct(eigenvectors[1]), 1e-6 );
+}
+
+TEST_F(SpectralPartitionTest, DISABLED_testGetPartition) {
+    using ValueType = double;
     //std::string file = "Grid32x32";
     std::string file = graphPath + "trace-00008.graph";
     std::ifstream f(file);
@@ -171,7 +205,8 @@ TEST_F(DISABLED_SpectralPartitionTest, DISABLED_testGetPartition) {
 }
 //------------------------------------------------------------------------------
 
-TEST_F(DISABLED_SpectralPartitionTest, testGetPartitionFromPixeledGraph) {
+TEST_F(SpectralPartitionTest, testGetPartitionFromPixeledGraph) {
+    using ValueType = double;
     //std::string file = "Grid32x32";
     std::string file = graphPath + "trace-00008.graph";
     std::ifstream f(file);
@@ -202,7 +237,8 @@ TEST_F(DISABLED_SpectralPartitionTest, testGetPartitionFromPixeledGraph) {
 
     // get a pixeled-coarsen graph , this is replicated in every PE
     scai::lama::DenseVector<ValueType> pixelWeights;
-    scai::lama::CSRSparseMatrix<ValueType> pixelGraph = MultiLevel<IndexType, ValueType>::pixeledCoarsen(graph, coordinates, pixelWeights, settings);
+    std::vector<IndexType> pixelIds;
+    scai::lama::CSRSparseMatrix<ValueType> pixelGraph = MultiLevel<IndexType, ValueType>::pixeledCoarsen(graph, coordinates, pixelWeights, pixelIds, settings);
     SCAI_ASSERT( pixelGraph.getRowDistributionPtr()->isReplicated() == 1, "Pixel graph should (?) be replicated.");
 
     int emptyPixels=0;
@@ -0,0 +1,204 @@
+#include <scai/dmemo/NoDistribution.hpp>
+#include <scai/tracing.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+#include "StreamingPartition.h"
+
+namespace ITI {
+
+template<typename IndexType, typename ValueType>
+StreamingPartition<IndexType, ValueType>::StreamingPartition(const Settings& settings) :
+    k(settings.numBlocks), epsilon(settings.epsilon), useFennel(settings.streamingScore == "fennel") {
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void StreamingPartition<IndexType, ValueType>::begin(const scai::dmemo::DistributionPtr distribution, const ValueType localWeight) {
+    dist = distribution;
+    const scai::dmemo::Communicator& comm = dist->getCommunicator();
+    const IndexType localN = dist->getLocalSize();
+    const IndexType globalN = dist->getGlobalSize();
+
+    //the share of this PE in the global weight scales its added weight to an estimate of the global one
+    if (comm.all(localWeight >= 0)) {
+        totalWeight = comm.sum(localWeight);
+        weightShare = totalWeight > 0 ? localWeight/totalWeight : ValueType(localN)/globalN;
+    } else {
+        totalWeight = -1;
+        weightShare = ValueType(localN)/globalN;
+    }
+
+    //all PEs exchange the same number of times, each after the same fraction of its vertices
+    numExchanges = std::min<IndexType>(maxExchanges, comm.max(localN));
+    exchangesDone = 0;
+
+    blocks.clear();
+    blocks.reserve(localN);
+    exchangedWeights.assign(k, 0);
+    addedWeights.assign(k, 0);
+    neighborsInBlock.assign(k, 0);
+    touchedBlocks.clear();
+    lightestBlocks.clear();
+    for (IndexType b = 0; b < k; b++) {
+        lightestBlocks.insert(std::make_pair(ValueType(0), b));
+    }
+    assignedWeight = 0;
+    assignedDegrees = 0;
+
+    //a PE without vertices does all its exchanges now
+    exchangeWeights();
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void StreamingPartition<IndexType, ValueType>::exchangeWeights() {
+    const long long localN = dist->getLocalSize();
+    const long long numAssigned = blocks.size();
+
+    while (exchangesDone < numExchanges and numAssigned >= localN*(exchangesDone + 1)/numExchanges) {
+        SCAI_REGION("StreamingPartition.exchangeWeights")
+        dist->getCommunicator().sumImpl(addedWeights.data(), addedWeights.data(), k, scai::common::TypeTraits<ValueType>::stype);
+        lightestBlocks.clear();
+        for (IndexType b = 0; b < k; b++) {
+            exchangedWeights[b] += addedWeights[b];
+            addedWeights[b] = 0;
+            lightestBlocks.insert(std::make_pair(exchangedWeights[b], b));
+        }
+        exchangesDone++;
+    }
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+ValueType StreamingPartition<IndexType, ValueType>::estimatedWeight(const IndexType block) const {
+    return exchangedWeights[block] + (weightShare > 0 ? addedWeights[block]/weightShare : 0);
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+IndexType StreamingPartition<IndexType, ValueType>::assignNext(const IndexType* neighbors, const IndexType degree, const ValueType weight) {
+    const IndexType localN = dist->getLocalSize();
+    const IndexType globalN = dist->getGlobalSize();
+    const IndexType numAssigned = blocks.size();
+    SCAI_ASSERT_LT_ERROR(numAssigned, localN, "More vertices streamed than local in the distribution");
+
+    //the blocks of the local neighbors that already arrived
+    for (IndexType j = 0; j < degree; j++) {
+        const IndexType localNeighbor = dist->global2Local(neighbors[j]);
+        if (localNeighbor != scai::invalidIndex and localNeighbor < numAssigned) {
+            const IndexType block = blocks[localNeighbor];
+            if (neighborsInBlock[block]++ == 0) {
+                touchedBlocks.push_back(block);
+            }
+        }
+    }
+
+    //the weights are measured in average vertices, so the scores do not depend on the scale of the node weights
+    const ValueType averageWeight = weight > 0 ? (assignedWeight + weight)/(numAssigned + 1) : std::max<ValueType>(assignedWeight/std::max<IndexType>(numAssigned, 1), 1);
+    const ValueType capacity = (1 + epsilon)*(totalWeight > 0 ? totalWeight : averageWeight*globalN)/k;
+    const ValueType averageDegree = ValueType(assignedDegrees + degree)/(numAssigned + 1);
+    const ValueType alpha = std::sqrt(ValueType(k))*(averageDegree*globalN/2)/std::pow(ValueType(globalN), ValueType(1.5));
+    //the weight of this vertex in the estimate of the global block weights
+    const ValueType scaledWeight = weightShare > 0 ? weight/weightShare : weight;
+
+    auto score = [&](const IndexType block) {
+        if (useFennel) {
+            return neighborsInBlock[block] - alpha*ValueType(1.5)*std::sqrt(estimatedWeight(block)/averageWeight);
+        }
+        return neighborsInBlock[block]*(1 - estimatedWeight(block)/capacity);
+    };
+
+    //a block without neighbors scores best if it is the lightest
+    IndexType bestBlock = lightestBlocks.begin()->second;
+    ValueType bestScore = score(bestBlock);
+    for (const IndexType block : touchedBlocks) {
+        if (estimatedWeight(block) + scaledWeight > capacity) {
+            continue;
+        }
+        const ValueType blockScore = score(block);
+        if (blockScore > bestScore or (blockScore == bestScore and estimatedWeight(block) < estimatedWeight(bestBlock))) {
+            bestScore = blockScore;
+            bestBlock = block;
+        }
+    }
+
+    for (const IndexType block : touchedBlocks) {
+        neighborsInBlock[block] = 0;
+    }
+    touchedBlocks.clear();
+
+    lightestBlocks.erase(std::make_pair(estimatedWeight(bestBlock), bestBlock));
+    addedWeights[bestBlock] += weight;
+    lightestBlocks.insert(std::make_pair(estimatedWeight(bestBlock), bestBlock));
+
+    blocks.push_back(bestBlock);
+    assignedWeight += weight;
+    assignedDegrees += degree;
+
+    exchangeWeights();
+    return bestBlock;
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+DenseVector<IndexType> StreamingPartition<IndexType, ValueType>::getPartition() const {
+    SCAI_ASSERT_EQ_ERROR(IndexType(blocks.size()), dist->getLocalSize(), "Not all local vertices were streamed");
+    return DenseVector<IndexType>(dist, scai::hmemo::HArray<IndexType>(blocks.size(), blocks.data()));
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+void StreamingPartition<IndexType, ValueType>::streamGraph(const CSRSparseMatrix<ValueType>& graph, const DenseVector<ValueType>& nodeWeights) {
+    SCAI_REGION("StreamingPartition.streamGraph")
+
+    const scai::dmemo::DistributionPtr rowDist = graph.getRowDistributionPtr();
+    const IndexType localN = rowDist->getLocalSize();
+
+    //the neighbors are needed as global ids
+    CSRSparseMatrix<ValueType> replicatedColumns;
+    if (not graph.getColDistributionPtr()->isReplicated()) {
+        replicatedColumns = graph;
+        replicatedColumns.redistribute(rowDist, scai::dmemo::DistributionPtr(new scai::dmemo::NoDistribution(graph.getNumColumns())));
+    }
+    const scai::lama::CSRStorage<ValueType>& storage = replicatedColumns.getNumRows() > 0 ? replicatedColumns.getLocalStorage() : graph.getLocalStorage();
+
+    DenseVector<ValueType> weights(nodeWeights);
+    if (not weights.getDistribution().isEqual(*rowDist)) {
+        weights.redistribute(rowDist);
+    }
+
+    scai::hmemo::ReadAccess<IndexType> ia(storage.getIA());
+    scai::hmemo::ReadAccess<IndexType> ja(storage.getJA());
+    scai::hmemo::ReadAccess<ValueType> rWeights(weights.getLocalValues());
+    begin(rowDist, std::accumulate(rWeights.get(), rWeights.get() + localN, ValueType(0)));
+    for (IndexType i = 0; i < localN; i++) {
+        assignNext(ja.get() + ia[i], ia[i + 1] - ia[i], rWeights[i]);
+    }
+}
+//---------------------------------------------------------------------------------------
+
+template<typename IndexType, typename ValueType>
+DenseVector<IndexType> StreamingPartition<IndexType, ValueType>::computePartition(const CSRSparseMatrix<ValueType>& graph, const DenseVector<ValueType>& nodeWeights, const Settings settings) {
+    SCAI_REGION("StreamingPartition.computePartition")
+    std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
+
+    const scai::dmemo::CommunicatorPtr comm = graph.getRowDistributionPtr()->getCommunicatorPtr();
+
+    StreamingPartition<IndexType, ValueType> stream(settings);
+    stream.streamGraph(graph, nodeWeights);
+
+    std::chrono::duration<double> streamTime = std::chrono::steady_clock::now() - startTime;
+    PRINT0("Streaming partition (" << settings.streamingScore << ") in " << comm->max(streamTime.count()) << " seconds");
+
+    return stream.getPartition();
+}
+//---------------------------------------------------------------------------------------
+
+template class StreamingPartition<IndexType, double>;
+template class StreamingPartition<IndexType, float>;
+
+} // namespace ITI
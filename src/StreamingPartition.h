@@ -0,0 +1,100 @@
+#pragma once
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <scai/lama/DenseVector.hpp>
+#include <scai/lama/matrix/CSRSparseMatrix.hpp>
+
+#include "Settings.h"
+
+namespace ITI {
+
+using scai::lama::CSRSparseMatrix;
+using scai::lama::DenseVector;
+
+/** @brief One-pass partition of a graph while its adjacency is streamed, e.g. by FileIO::readGraph.
+
+Every vertex is assigned when it arrives, to the block that maximizes a size-constrained score of the blocks of its
+already assigned neighbors, see settings.streamingScore:
+ - ldg: |N(v) in B| * (1 - |B|/C), linear deterministic greedy,
+ - fennel: |N(v) in B| - alpha*gamma*|B|^(gamma-1) with gamma=1.5 and alpha=sqrt(k)*m/n^gamma.
+
+Every PE streams its local vertices into all k blocks. The PEs exchange the weights of the blocks a fixed number of
+times during the stream, every PE after the same fraction of its local vertices. In between, the global weight of a
+block is estimated from the last exchange and the weight this PE added since, scaled by the inverse of the share of
+the PE in the global weight, as if the other PEs filled the block at the same rate. The capacity C of a block is
+(1+epsilon) times the global weight over k. Only neighbors that are local to the PE and already assigned count for
+the score; the partition is meant as a fast start for the local refinement.
+*/
+
+template <typename IndexType, typename ValueType>
+class StreamingPartition {
+public:
+
+    StreamingPartition(const Settings& settings);
+
+    /** Start the stream of the local vertices of dist, they must arrive in the order of their local indices.
+    Collective operation, as is the assignment of every vertex after which the block weights are exchanged; there
+    must be no other collective operations on the communicator of dist during the stream.
+    @param[in] dist The distribution of the vertices.
+    @param[in] localWeight The total weight of the local vertices, if not known the capacity of the blocks is
+    estimated from the average weight of the vertices seen so far.
+    */
+    void begin(const scai::dmemo::DistributionPtr dist, const ValueType localWeight = -1);
+
+    /** Assign the next vertex of the stream.
+    @param[in] neighbors The global ids of the neighbors.
+    @param[in] degree The number of neighbors.
+    @param[in] weight The weight of the vertex.
+    @return The block of the vertex.
+    */
+    IndexType assignNext(const IndexType* neighbors, const IndexType degree, const ValueType weight);
+
+    /** The partition of the streamed vertices, in the distribution given to begin. */
+    DenseVector<IndexType> getPartition() const;
+
+    /** Stream the local rows of a graph that is already in memory, starts a new stream.
+    @param[in] graph The graph.
+    @param[in] nodeWeights The weights of the vertices, in the row distribution of the graph.
+    */
+    void streamGraph(const CSRSparseMatrix<ValueType>& graph, const DenseVector<ValueType>& nodeWeights);
+
+    /** The partition of the local rows of a graph that is already in memory, \sa streamGraph.
+    @param[in] graph The graph.
+    @param[in] nodeWeights The weights of the vertices, in the row distribution of the graph.
+    @param[in] settings Uses numBlocks, epsilon and streamingScore.
+    */
+    static DenseVector<IndexType> computePartition(const CSRSparseMatrix<ValueType>& graph, const DenseVector<ValueType>& nodeWeights, const Settings settings);
+
+private:
+    /** Exchange the block weights until as many exchanges are done as the assigned vertices of this PE require. */
+    void exchangeWeights();
+
+    /** The estimated global weight of a block. */
+    ValueType estimatedWeight(const IndexType block) const;
+
+    const IndexType k;
+    const ValueType epsilon;
+    const bool useFennel;
+
+    static const IndexType maxExchanges = 64;  ///< how often the block weights are exchanged during a stream, at most
+
+    scai::dmemo::DistributionPtr dist;
+    ValueType totalWeight = -1;         ///< the global weight, -1 if not known
+    ValueType weightShare = 1;          ///< the share of this PE in the global weight
+    IndexType numExchanges = 0;
+    IndexType exchangesDone = 0;
+
+    std::vector<IndexType> blocks;      ///< the block of every assigned local vertex
+    std::vector<ValueType> exchangedWeights;    ///< the global block weights at the last exchange
+    std::vector<ValueType> addedWeights;        ///< the weight this PE added to every block since the last exchange
+    std::set<std::pair<ValueType, IndexType>> lightestBlocks;	///< the blocks ordered by their estimated weight
+    std::vector<IndexType> neighborsInBlock;	///< for every block, the neighbors of the current vertex in it
+    std::vector<IndexType> touchedBlocks;		///< the blocks with neighbors of the current vertex
+    ValueType assignedWeight = 0;
+    IndexType assignedDegrees = 0;
+};
+
+} // namespace ITI
@@ -0,0 +1,102 @@
+#include "gtest/gtest.h"
+
+#include "FileIO.h"
+#include "GraphUtils.h"
+#include "StreamingPartition.h"
+
+namespace ITI {
+
+template<typename T>
+class StreamingPartitionTest : public ::testing::Test {
+protected:
+    // the directory of all the meshes used
+    // projectRoot is defined in config.h.in
+    const std::string graphPath = projectRoot+"/meshes/";
+};
+
+using testTypes = ::testing::Types<double,float>;
+TYPED_TEST_SUITE(StreamingPartitionTest, testTypes);
+
+//-----------------------------------------------
+
+TYPED_TEST(StreamingPartitionTest, testBalanceAndCut) {
+    using ValueType = TypeParam;
+
+    const std::string file = StreamingPartitionTest<ValueType>::graphPath + "bubbles-00010.graph";
+    const scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+
+    CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph(file, comm);
+    const IndexType n = graph.getNumRows();
+    const DenseVector<ValueType> nodeWeights(graph.getRowDistributionPtr(), 1);
+
+    Settings settings;
+    settings.numBlocks = 8;
+    settings.epsilon = 0.05;
+
+    //blocks of consecutive vertices in the file order, without looking at the edges
+    const scai::dmemo::DistributionPtr dist = graph.getRowDistributionPtr();
+    DenseVector<IndexType> blockPartition(dist, 0);
+    {
+        scai::hmemo::WriteAccess<IndexType> wBlockPartition(blockPartition.getLocalValues());
+        for (IndexType i = 0; i < wBlockPartition.size(); i++) {
+            wBlockPartition[i] = IndexType((long long)(dist->local2Global(i))*settings.numBlocks / n);
+        }
+    }
+    const ValueType blockCut = GraphUtils<IndexType, ValueType>::computeCut(graph, blockPartition);
+
+    for (const std::string score : {"ldg", "fennel"}) {
+        settings.streamingScore = score;
+        const DenseVector<IndexType> partition = StreamingPartition<IndexType, ValueType>::computePartition(graph, nodeWeights, settings);
+
+        ASSERT_EQ(n, partition.size());
+        EXPECT_GE(partition.min(), 0);
+        EXPECT_LT(partition.max(), settings.numBlocks);
+
+        //every PE adds to a block only its share of the remaining capacity, up to one vertex
+        const ValueType imbalance = GraphUtils<IndexType, ValueType>::computeImbalance(partition, settings.numBlocks);
+        EXPECT_LE(imbalance, settings.epsilon + ValueType(comm->getSize())*settings.numBlocks/n);
+
+        EXPECT_LE(GraphUtils<IndexType, ValueType>::computeCut(graph, partition), blockCut) << "for score " << score;
+    }
+
+    //with one block per PE, the stream has to beat the blocks in file order as well
+    settings.numBlocks = comm->getSize();
+    {
+        scai::hmemo::WriteAccess<IndexType> wBlockPartition(blockPartition.getLocalValues());
+        for (IndexType i = 0; i < wBlockPartition.size(); i++) {
+            wBlockPartition[i] = IndexType((long long)(dist->local2Global(i))*settings.numBlocks / n);
+        }
+    }
+    const ValueType onePerPECut = GraphUtils<IndexType, ValueType>::computeCut(graph, blockPartition);
+
+    for (const std::string score : {"ldg", "fennel"}) {
+        settings.streamingScore = score;
+        const DenseVector<IndexType> partition = StreamingPartition<IndexType, ValueType>::computePartition(graph, nodeWeights, settings);
+        EXPECT_LT(partition.max(), settings.numBlocks);
+        EXPECT_LE(GraphUtils<IndexType, ValueType>::computeCut(graph, partition), onePerPECut) << "for score " << score;
+    }
+}
+//-----------------------------------------------
+
+TYPED_TEST(StreamingPartitionTest, testStreamWhileReading) {
+    using ValueType = TypeParam;
+
+    const std::string file = StreamingPartitionTest<ValueType>::graphPath + "Grid32x32";
+    const scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+
+    Settings settings;
+    settings.numBlocks = 4;
+
+    //streaming while reading sees the same vertices in the same order as streaming afterwards
+    StreamingPartition<IndexType, ValueType> streaming(settings);
+    std::vector<DenseVector<ValueType>> nodeWeights;
+    CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph(file, nodeWeights, comm, Format::METIS, &streaming);
+    const DenseVector<IndexType> streamed = streaming.getPartition();
+
+    const DenseVector<IndexType> afterReading = StreamingPartition<IndexType, ValueType>::computePartition(graph, DenseVector<ValueType>(graph.getRowDistributionPtr(), 1), settings);
+
+    ASSERT_TRUE(streamed.getDistribution().isEqual(graph.getRowDistribution()));
+    EXPECT_EQ(0, (streamed - afterReading).maxNorm());
+}
+
+} // namespace ITI
@@ -7,6 +7,9 @@
  *
  *
  * where #p is the number of PEs that the graph is distributed to and #k the number of blocks to partition to
+ *
+ * with --concurrentGroups=#g the PEs are split into #g groups and the tools run concurrently, each on #p/#g PEs:
+ * mpirun -n #p allCompetitors --graphFile=... --numBlocks=#k --tools=parMetisGraph,zoltanRCB,zoltanMJ --concurrentGroups=3
 */
 
 #include <cstdlib>
@@ -28,6 +31,7 @@
 #include "Wrappers.h"
 #include "parseArgs.h"
 #include "mainHeader.h"
+#include "Redistribution.h"
 
 #if PARMETIS_FOUND
 #include "parmetisWrapper.h"
@@ -43,7 +47,193 @@
 #endif
 
 
+//---------------------------------------------------------------------------------------------
+
+namespace ITI {
+
+/* Partition the input with one tool settings.repeatTimes times, report and store the aggregated metrics.
+   Collective operation on comm, the communicator of the input.
+   Returns false if the tool was skipped because its output file exists already.
+*/
+template<typename ValueType>
+bool runTool(
+    const ITI::Tool thisTool,
+    CSRSparseMatrix<ValueType>& graph,
+    std::vector<DenseVector<ValueType>>& coords,
+    std::vector<DenseVector<ValueType>>& nodeWeights,
+    const ITI::CommTree<IndexType,ValueType>& commTree,
+    Settings settings,
+    const scai::dmemo::CommunicatorPtr comm,
+    Metrics<ValueType>& aggrMetrics ) {
+
+    const IndexType N = graph.getNumRows();
+    const IndexType thisPE = comm->getRank();
+    scai::dmemo::DistributionPtr dist = graph.getRowDistributionPtr();
+
+    comm->synchronize();
+    std::cout.precision(5);
+    MSG0("will start partition with tool " << ITI::to_string(thisTool) );
+
+    // if using unit weights, set flag for wrappers
+    bool nodeWeightsUse = true;
+
+    // if graph is too big, repeat less times to avoid memory and time problems
+    if( N>std::pow(2,29) ) {
+        settings.repeatTimes = 3;
+        if( thisPE==0 ) {
+            std::cout << "WARNING: because the graph is too big, we repeat only " << settings.repeatTimes << " times" << std::endl;
+        }
+    } 
+ 
+    //set outFile depending if we get outDir or outFile parameter
+    std::string outFile = getOutFileName(settings, ITI::to_string(thisTool), comm);
+
+    std::ifstream f(outFile);
+    if( f.good() and settings.storeInfo ) {
+        comm->synchronize();	// maybe not needed
+        PRINT0("\n\tWARNING: File " << outFile << " already exists. Skipping partition with " << ITI::to_string(thisTool));
+        return false;
+    }
+
+    //get the partition
+    ITI::Wrappers<IndexType,ValueType>* partitioner;
+    if( ITI::to_string(thisTool).rfind("zoltan",0)==0 ){
+#if ZOLTAN_FOUND            
+        partitioner = new zoltanWrapper<IndexType,ValueType>;
+#else
+        throw std::runtime_error("Requested a zoltan tool but zoltan is not found. Pick another tool.\nAborting...");
+#endif            
+    }else if( ITI::to_string(thisTool).rfind("parMetis",0)==0 ){
+#if PARMETIS_FOUND            
+        partitioner = new parmetisWrapper<IndexType,ValueType>;
+#else
+        throw std::runtime_error("Requested a parmetis tool but parmetis is not found. Pick another tool.\nAborting...");
+#endif
+    }
+    else if(ITI::to_string(thisTool).rfind("parhip",0)==0 ){
+#if PARHIP_FOUND
+        partitioner = new parhipWrapper<IndexType,ValueType>;
+#else         
+        throw std::runtime_error("Requested a parhip tool but parhip is not found. Pick another tool.\nAborting...");
+#endif   
+    }else{
+        throw std::runtime_error("Provided tool: "+ ITI::to_string(thisTool) + " not supported.\nAborting..." );
+    }
+
+    // get the partition and metrics
+    //
+    scai::lama::DenseVector<IndexType> partition;
+    scai::lama::DenseVector<IndexType> oldPartition(dist, 1);
+    std::vector<Metrics<ValueType>> metricsVec;
+
+    for( int r=0; r<settings.repeatTimes; r++){
+        metricsVec.push_back( Metrics<ValueType>( settings ) );
+
+        partition = partitioner->partition( graph, coords, nodeWeights, nodeWeightsUse, thisTool, commTree, settings, metricsVec[r]);
+        
+        // partition has the the same distribution as the graph rows
+        SCAI_ASSERT_ERROR( partition.getDistribution().isEqual( graph.getRowDistribution() ), "Distribution mismatch.")
+
+        //ValueType partDiff = oldPartition.maxDiffNorm(partition); // another way to check if partitions are close but is more expensive
+        bool isIdentical = partition.all(scai::common::CompareOp::EQ, oldPartition);
+        if( isIdentical ){
+            if(comm->getRank()==0){
+                std::cout<< "Partition is identical, not calculating metrics" << std::endl;  
+            }
+            //keep only the run time of this run
+            ValueType runTime = metricsVec[r].MM["timeTotal"];
+            metricsVec[r] = metricsVec[r-1];
+            metricsVec[r].MM["timeTotal"] = runTime;
+        }else{
+            //std::vector<std::vector<ValueType>> blockSizes = commTree.getBalanceVectors();
+            metricsVec[r].getMetrics( graph, partition, nodeWeights, settings, commTree );
+        }
+
+        PRINT0("time to get the partition with " << ITI::to_string(thisTool) << ": " << metricsVec[r].MM["timeTotal"] );
+
+        //if one run exceeds the time limit, do not execute the rest of the runs
+        if( metricsVec[r].MM["timeTotal"]>ITI::HARD_TIME_LIMIT) {
+            if(comm->getRank()==0){
+                std::cout<< "Stopping runs because of excessive running total running time: " << metricsVec[r].MM["timeTotal"] << std::endl;
+            }
+            break;
+        }
+        oldPartition = partition;
+    }
+
+    //aggregate metrics in one struct
+    aggrMetrics = aggregateVectorMetrics( metricsVec, comm );
+
+    //---------------------------------------------------------------
+    //
+    // Reporting output to std::cout
+    //
+
+    if( thisPE==0 ) {
+        printInfo( std::cout, comm, settings);
+        std::cout << "\nFinished tool: " << ITI::to_string(thisTool) << std::endl;
+        
+        aggrMetrics.print( std::cout );
+
+        // write in a file
+        if( outFile!= "-" and settings.storeInfo) {
+            std::ofstream outF( outFile, std::ios::out);
+            if(outF.is_open()) {
+                outF << "Running " << __FILE__ << " for tool " << ITI::to_string(thisTool) << std::endl;
+                printInfo( outF, comm, settings);
+
+                aggrMetrics.print( outF );
+                //printMetricsShort( aggrMetrics, outF);
+                std::cout<< "Output information written to file " << outFile << std::endl;
+            } else {
+                std::cout<< "\n\tWARNING: Could not open file " << outFile << " informations not stored.\n"<< std::endl;
+            }
+        }
+        std::cout<< "###" << std::endl;
+    }
+
+    if( outFile!="-" and settings.storePartition ) {
+        std::chrono::time_point<std::chrono::steady_clock> beforePartWrite = std::chrono::steady_clock::now();
+        std::string partOutFile = outFile+".part";
+        ITI::FileIO<IndexType, ValueType>::writePartitionParallel( partition, partOutFile );
+
+        std::chrono::duration<double> writePartTime =  std::chrono::steady_clock::now() - beforePartWrite;
+        if( comm->getRank()==0 ) {
+            std::cout << " and last partition of the series in file " << partOutFile << std::endl;
+            std::cout<< " Time needed to write .partition file: " << writePartTime.count() <<  std::endl;
+        }
+    }
+
+    // the code below writes the output coordinates in one file per processor for visualization purposes.
+    //=================
+
+    if (settings.writeDebugCoordinates) {
 
+        std::vector<DenseVector<ValueType> > coordinateCopy = coords;
+
+        //scai::dmemo::DistributionPtr distFromPartition = scai::dmemo::DistributionPtr(new scai::dmemo::GeneralDistribution( partition.getDistribution(), partition.getLocalValues() ) );
+        scai::dmemo::DistributionPtr distFromPartition = scai::dmemo::generalDistributionByNewOwners( partition.getDistribution(), partition.getLocalValues());
+        for (IndexType dim = 0; dim < settings.dimensions; dim++) {
+            assert( coordinateCopy[dim].size() == N);
+            //coordinates[dim].redistribute(partition.getDistributionPtr());
+            coordinateCopy[dim].redistribute( distFromPartition );
+        }
+
+        std::string destPath = "partResults/" +  ITI::to_string(thisTool) +"/blocks_" + std::to_string(settings.numBlocks) ;
+        struct stat sb;
+        if (stat(destPath.data(), &sb) == 0 && S_ISDIR(sb.st_mode)) {
+            ITI::FileIO<IndexType, ValueType>::writeCoordsDistributed( coordinateCopy, settings.dimensions, destPath + "/debugResult");
+            comm->synchronize();
+        } else {
+            std::cout<< "WARNING: directrory " << destPath << " does not exist. De buf coordinates were not stored. Create directory and re-run" << std::endl;
+        }
+    }
+    if( thisPE==0) std::cout<< std::endl;
+    comm->synchronize();    // needed when storing files
+    return true;
+}
+
+} // namespace ITI
 //---------------------------------------------------------------------------------------------
 
 int main(int argc, char** argv) {
@@ -119,170 +309,87 @@ int main(int argc, char** argv) {
 
     const IndexType thisPE = comm->getRank();   
 
-    for( int t=0; t<wantedTools.size(); t++) {
-
-        comm->synchronize();
-        ITI::Tool thisTool = wantedTools[t];
-        std::cout.precision(5);
-        MSG0("will start partition with tool " << ITI::to_string(thisTool) );
-
-        // if using unit weights, set flag for wrappers
-        bool nodeWeightsUse = true;
-
-        // if graph is too big, repeat less times to avoid memory and time problems
-        if( N>std::pow(2,29) ) {
-            settings.repeatTimes = 3;
-            if( thisPE==0 ) {
-                std::cout << "WARNING: because the graph is too big, we repeat only " << settings.repeatTimes << " times" << std::endl;
-            }
-        } 
-     
-        //set outFile depending if we get outDir or outFile parameter
-        std::string outFile = getOutFileName(settings, ITI::to_string(thisTool), comm);
-
-        std::ifstream f(outFile);
-        if( f.good() and settings.storeInfo ) {
-            comm->synchronize();	// maybe not needed
-            PRINT0("\n\tWARNING: File " << outFile << " already exists. Skipping partition with " << ITI::to_string(thisTool));
-            continue;
+    if( settings.concurrentGroups<=1 or comm->getSize()==1 ){
+        for( int t=0; t<wantedTools.size(); t++) {
+            Metrics<ValueType> aggrMetrics( settings );
+            runTool( wantedTools[t], graph, coords, nodeWeights, commTree, settings, comm, aggrMetrics );
         }
+    } else {
+        //
+        // run the tools concurrently on groups of PEs, each with its own copy of the input
+        //
 
-        //get the partition
-        ITI::Wrappers<IndexType,ValueType>* partitioner;
-        if( ITI::to_string(thisTool).rfind("zoltan",0)==0 ){
-#if ZOLTAN_FOUND            
-            partitioner = new zoltanWrapper<IndexType,ValueType>;
-#else
-            throw std::runtime_error("Requested a zoltan tool but zoltan is not found. Pick another tool.\nAborting...");
-#endif            
-        }else if( ITI::to_string(thisTool).rfind("parMetis",0)==0 ){
-#if PARMETIS_FOUND            
-            partitioner = new parmetisWrapper<IndexType,ValueType>;
-#else
-            throw std::runtime_error("Requested a parmetis tool but parmetis is not found. Pick another tool.\nAborting...");
-#endif
-        }
-        else if(ITI::to_string(thisTool).rfind("parhip",0)==0 ){
-#if PARHIP_FOUND
-            partitioner = new parhipWrapper<IndexType,ValueType>;
-#else         
-            throw std::runtime_error("Requested a parhip tool but parhip is not found. Pick another tool.\nAborting...");
-#endif   
-        }else{
-            throw std::runtime_error("Provided tool: "+ ITI::to_string(thisTool) + " not supported.\nAborting..." );
+        const IndexType numTools = wantedTools.size();
+        const IndexType numGroups = std::min<IndexType>( {settings.concurrentGroups, numTools, comm->getSize()} );
+        const IndexType myGroup = IndexType(thisPE)*numGroups/comm->getSize();
+        scai::dmemo::CommunicatorPtr groupComm = comm->split( myGroup );
+
+        PRINT0("running " << numTools << " tools on " << numGroups << " groups of PEs");
+
+        CSRSparseMatrix<ValueType> groupGraph;
+        std::vector<DenseVector<ValueType>> groupCoords;
+        std::vector<DenseVector<ValueType>> groupWeights;
+        {
+            std::chrono::time_point<std::chrono::steady_clock> beforeCopy = std::chrono::steady_clock::now();
+            Redistribution<IndexType,ValueType>::copyToGroups( groupComm, numGroups, graph, coords, nodeWeights, groupGraph, groupCoords, groupWeights );
+            std::chrono::duration<double> copyTime = std::chrono::steady_clock::now() - beforeCopy;
+            PRINT0("input copied to the groups in " << comm->max(copyTime.count()) << " seconds");
         }
 
-        // get the partition and metrics
-        //
-        scai::lama::DenseVector<IndexType> partition;
-        scai::lama::DenseVector<IndexType> oldPartition(dist, 1);
-        std::vector<Metrics<ValueType>> metricsVec;
-
-        for( int r=0; r<settings.repeatTimes; r++){
-            metricsVec.push_back( Metrics<ValueType>( settings ) );
-
-            partition = partitioner->partition( graph, coords, nodeWeights, nodeWeightsUse, thisTool, commTree, settings, metricsVec[r]);
-            
-            // partition has the the same distribution as the graph rows
-            SCAI_ASSERT_ERROR( partition.getDistribution().isEqual( graph.getRowDistribution() ), "Distribution mismatch.")
-
-            //ValueType partDiff = oldPartition.maxDiffNorm(partition); // another way to check if partitions are close but is more expensive
-            bool isIdentical = partition.all(scai::common::CompareOp::EQ, oldPartition);
-            if( isIdentical ){
-                if(comm->getRank()==0){
-                    std::cout<< "Partition is identical, not calculating metrics" << std::endl;  
-                }
-                //keep only the run time of this run
-                ValueType runTime = metricsVec[r].MM["timeTotal"];
-                metricsVec[r] = metricsVec[r-1];
-                metricsVec[r].MM["timeTotal"] = runTime;
-            }else{
-                //std::vector<std::vector<ValueType>> blockSizes = commTree.getBalanceVectors();
-                metricsVec[r].getMetrics( graph, partition, nodeWeights, settings, commTree );
-            }
+        //the original input is not needed any more
+        graph = CSRSparseMatrix<ValueType>();
+        coords.clear();
+        nodeWeights.clear();
 
-            PRINT0("time to get the partition with " << ITI::to_string(thisTool) << ": " << metricsVec[r].MM["timeTotal"] );
+        ITI::CommTree<IndexType,ValueType> groupCommTree = createCommTree( vm, settings, groupComm, groupWeights );
+        groupCommTree.adaptWeights( groupWeights );
 
-            //if one run exceeds the time limit, do not execute the rest of the runs
-            if( metricsVec[r].MM["timeTotal"]>ITI::HARD_TIME_LIMIT) {
-                if(comm->getRank()==0){
-                    std::cout<< "Stopping runs because of excessive running total running time: " << metricsVec[r].MM["timeTotal"] << std::endl;
-                }
-                break;
-            }
-            oldPartition = partition;
+        //tool t runs on group t%numGroups
+        std::vector<Metrics<ValueType>> toolMetrics( numTools, Metrics<ValueType>(settings) );
+        std::vector<bool> toolRan( numTools, false );
+        for( IndexType t=myGroup; t<numTools; t+=numGroups ){
+            toolRan[t] = runTool( wantedTools[t], groupGraph, groupCoords, groupWeights, groupCommTree, settings, groupComm, toolMetrics[t] );
         }
 
-        //aggregate metrics in one struct
-        const Metrics<ValueType> aggrMetrics = aggregateVectorMetrics( metricsVec, comm );
-
-        //---------------------------------------------------------------
         //
-        // Reporting output to std::cout
+        // gather the metrics, every value is only known in the group that ran the tool
         //
 
-        if( thisPE==0 ) {
-            printInfo( std::cout, comm, settings);
-            std::cout << "\nFinished tool: " << ITI::to_string(thisTool) << std::endl;
-            
-            aggrMetrics.print( std::cout );
-
-            // write in a file
-            if( outFile!= "-" and settings.storeInfo) {
-                std::ofstream outF( outFile, std::ios::out);
-                if(outF.is_open()) {
-                    outF << "Running " << __FILE__ << " for tool " << ITI::to_string(thisTool) << std::endl;
-                    printInfo( outF, comm, settings);
-
-                    aggrMetrics.print( outF );
-                    //printMetricsShort( aggrMetrics, outF);
-                    std::cout<< "Output information written to file " << outFile << std::endl;
-                } else {
-                    std::cout<< "\n\tWARNING: Could not open file " << outFile << " informations not stored.\n"<< std::endl;
-                }
+        const Metrics<ValueType> defaultMetrics( settings );
+        const IndexType numValues = defaultMetrics.MM.size();
+        std::vector<ValueType> allValues( numTools*(numValues+1), 0 );
+        for( IndexType t=myGroup; t<numTools; t+=numGroups ){
+            if( groupComm->getRank()!=0 ) continue;
+            ValueType* values = allValues.data() + t*(numValues+1);
+            values[0] = toolRan[t];
+            IndexType i = 1;
+            for( const auto& entry : defaultMetrics.MM ){
+                values[i++] = toolMetrics[t].MM[entry.first];
             }
-            std::cout<< "###" << std::endl;
         }
+        comm->sumImpl( allValues.data(), allValues.data(), allValues.size(), scai::common::TypeTraits<ValueType>::stype );
 
-        if( outFile!="-" and settings.storePartition ) {
-            std::chrono::time_point<std::chrono::steady_clock> beforePartWrite = std::chrono::steady_clock::now();
-            std::string partOutFile = outFile+".part";
-            ITI::FileIO<IndexType, ValueType>::writePartitionParallel( partition, partOutFile );
-
-            std::chrono::duration<double> writePartTime =  std::chrono::steady_clock::now() - beforePartWrite;
-            if( comm->getRank()==0 ) {
-                std::cout << " and last partition of the series in file " << partOutFile << std::endl;
-                std::cout<< " Time needed to write .partition file: " << writePartTime.count() <<  std::endl;
+        if( thisPE==0 ) {
+            std::cout << "\nMetrics of all concurrent runs:" << std::endl;
+            for( IndexType t=0; t<numTools; t++ ){
+                const ValueType* values = allValues.data() + t*(numValues+1);
+                std::cout << "\nTool: " << ITI::to_string(wantedTools[t]) << " on group " << t%numGroups;
+                if( values[0]==0 ){
+                    std::cout << ", skipped" << std::endl;
+                    continue;
+                }
+                std::cout << std::endl;
+                Metrics<ValueType> gathered( settings );
+                IndexType i = 1;
+                for( auto& entry : gathered.MM ){
+                    entry.second = values[i++];
+                }
+                gathered.print( std::cout );
             }
+            std::cout<< "###" << std::endl;
         }
+    }
 
-        // the code below writes the output coordinates in one file per processor for visualization purposes.
-        //=================
-
-        if (settings.writeDebugCoordinates) {
-
-            std::vector<DenseVector<ValueType> > coordinateCopy = coords;
-
-            //scai::dmemo::DistributionPtr distFromPartition = scai::dmemo::DistributionPtr(new scai::dmemo::GeneralDistribution( partition.getDistribution(), partition.getLocalValues() ) );
-            scai::dmemo::DistributionPtr distFromPartition = scai::dmemo::generalDistributionByNewOwners( partition.getDistribution(), partition.getLocalValues());
-            for (IndexType dim = 0; dim < settings.dimensions; dim++) {
-                assert( coordinateCopy[dim].size() == N);
-                //coordinates[dim].redistribute(partition.getDistributionPtr());
-                coordinateCopy[dim].redistribute( distFromPartition );
-            }
-
-            std::string destPath = "partResults/" +  ITI::to_string(thisTool) +"/blocks_" + std::to_string(settings.numBlocks) ;
-            struct stat sb;
-            if (stat(destPath.data(), &sb) == 0 && S_ISDIR(sb.st_mode)) {
-                ITI::FileIO<IndexType, ValueType>::writeCoordsDistributed( coordinateCopy, settings.dimensions, destPath + "/debugResult");
-                comm->synchronize();
-            } else {
-                std::cout<< "WARNING: directrory " << destPath << " does not exist. De buf coordinates were not stored. Create directory and re-run" << std::endl;
-            }
-        }
-        if( thisPE==0) std::cout<< std::endl;
-        comm->synchronize();    // needed when storing files 
-    } // for wantedTools.size()
 
     std::chrono::duration<ValueType> totalTimeLocal = std::chrono::steady_clock::now() - startTime;
     ValueType totalTime = comm->max( totalTimeLocal.count() );
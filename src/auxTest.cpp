@@ -25,6 +25,7 @@
 #include "SpectralPartition.h"
 #include "GraphUtils.h"
 #include "AuxiliaryFunctions.h"
+#include "Redistribution.h"
 #include "KMeans.h"
 #include "Metrics.h"
 
@@ -580,6 +581,93 @@ TYPED_TEST(auxTest, benchmarkRedistributeFromPartition) {
 
 }
 
+//-----------------------------------------------------------------
+
+TYPED_TEST(auxTest, testPackedRedistribution) {
+
+    using ValueType = TypeParam;
+
+    std::string fileName = "Grid16x16";
+    std::string file = auxTest<ValueType>::graphPath + fileName;
+
+    const IndexType dimensions= 2;
+    const scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+    const IndexType k = comm->getSize();
+
+    CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph(file, comm);
+    const IndexType N = graph.getNumRows();
+    std::vector<DenseVector<ValueType>> coordinates = FileIO<IndexType, ValueType>::readCoords( std::string(file + ".xyz"), N, dimensions, comm);
+
+    const scai::dmemo::DistributionPtr inputDist  = graph.getRowDistributionPtr();
+    const IndexType localN = inputDist->getLocalSize();
+
+    //two weights, the second is the global id so we can check where it ended
+    std::vector<DenseVector<ValueType>> nodeWeights(2, DenseVector<ValueType>(inputDist, 1));
+    DenseVector<IndexType> origin(inputDist, 0);
+    DenseVector<IndexType> partition(inputDist, 0);
+    srand( comm->getRank() );
+    for (IndexType i = 0; i < localN; i++) {
+        const IndexType globalI = inputDist->local2Global(i);
+        nodeWeights[1].getLocalValues()[i] = globalI;
+        origin.getLocalValues()[i] = globalI;
+        partition.getLocalValues()[i] = rand() % k;
+    }
+
+    const scai::dmemo::DistributionPtr targetDist = scai::dmemo::generalDistributionByNewOwners( partition.getDistribution(), partition.getLocalValues() );
+
+    //the reference, array by array
+    CSRSparseMatrix<ValueType> refGraph = graph;
+    refGraph.redistribute( targetDist, refGraph.getColDistributionPtr() );
+    std::vector<DenseVector<ValueType>> refCoordinates = coordinates;
+    for (IndexType d = 0; d < dimensions; d++) {
+        refCoordinates[d].redistribute( targetDist );
+    }
+
+    //a large chunk size and a tiny one that forces many rounds
+    for( std::size_t chunkBytes: std::vector<std::size_t>({Redistribution<IndexType,ValueType>::defaultChunkBytes, 64}) ){
+        CSRSparseMatrix<ValueType> copyGraph = graph;
+        std::vector<DenseVector<ValueType>> copyCoordinates = coordinates;
+        std::vector<DenseVector<ValueType>> copyWeights = nodeWeights;
+        DenseVector<IndexType> copyOrigin = origin;
+        DenseVector<IndexType> copyPartition = partition;
+
+        Redistribution<IndexType,ValueType>::redistribute( targetDist, copyGraph, copyCoordinates, copyWeights, {&copyOrigin, &copyPartition}, chunkBytes );
+
+        EXPECT_TRUE( copyGraph.getRowDistribution().isEqual(*targetDist) );
+        EXPECT_TRUE( copyGraph.getColDistributionPtr()->isReplicated() );
+        EXPECT_TRUE( copyGraph.checkSymmetry() );
+        EXPECT_EQ( copyGraph.getNumValues(), graph.getNumValues() );
+
+        const IndexType newLocalN = targetDist->getLocalSize();
+        {
+            const CSRStorage<ValueType>& storage = copyGraph.getLocalStorage();
+            const CSRStorage<ValueType>& refStorage = refGraph.getLocalStorage();
+            scai::hmemo::ReadAccess<IndexType> ia(storage.getIA()), refIa(refStorage.getIA());
+            scai::hmemo::ReadAccess<IndexType> ja(storage.getJA()), refJa(refStorage.getJA());
+            for (IndexType i = 0; i <= newLocalN; i++) {
+                ASSERT_EQ( ia[i], refIa[i] );
+            }
+            for (IndexType j = 0; j < ia[newLocalN]; j++) {
+                EXPECT_EQ( ja[j], refJa[j] );
+            }
+        }
+
+        scai::hmemo::ReadAccess<ValueType> rWeights(copyWeights[1].getLocalValues());
+        scai::hmemo::ReadAccess<IndexType> rOrigin(copyOrigin.getLocalValues());
+        scai::hmemo::ReadAccess<IndexType> rPart(copyPartition.getLocalValues());
+        for (IndexType i = 0; i < newLocalN; i++) {
+            const IndexType globalI = targetDist->local2Global(i);
+            EXPECT_EQ( rWeights[i], globalI );
+            EXPECT_EQ( rOrigin[i], globalI );
+            EXPECT_EQ( rPart[i], comm->getRank() );
+            for (IndexType d = 0; d < dimensions; d++) {
+                EXPECT_EQ( copyCoordinates[d].getLocalValues()[i], refCoordinates[d].getLocalValues()[i] );
+            }
+        }
+    }
+}
+//-----------------------------------------------------------------
+
 TYPED_TEST (auxTest, testMetisInterface) {
     using ValueType = TypeParam;
     
@@ -8,6 +8,23 @@
 #include "KMeans.h"
 #include "CommTree.h"
 #include "ParcoRepart.h"
+#include "HilbertCurve.h"
+#include "MultiLevel.h"
+#include "AuxiliaryFunctions.h"
+#include "Embedding.h"
+#ifdef PARMETIS_FOUND
+#include "parmetisWrapper.h"
+#endif
+
+#include <chrono>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 
 namespace ITI {
@@ -18,8 +35,63 @@ protected:
     std::string graphPath = "./meshes/";
 };
 
+namespace {
+
+/* Counts the hardware cache misses of the calling thread between start() and stop().
+If the counter is not available (no linux, no permission), stop() returns -1. */
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+#ifdef __linux__
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    ~CacheMissCounter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    void start() {
+#ifdef __linux__
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    long long stop() {
+        long long count = -1;
+#ifdef __linux__
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &count, sizeof(count)) != sizeof(count)) {
+                count = -1;
+            }
+        }
+#endif
+        return count;
+    }
+
+private:
+    int fd = -1;
+};
+
+} // anonymous namespace
+
 
 TEST_F( benchmarkTest, benchMapping ) {
+    using ValueType = double;
 
     //std::string fileName = "Grid32x32";
     //std::string fileName = "slowrot-00000.graph";
@@ -27,15 +99,17 @@ TEST_F( benchmarkTest, benchMapping ) {
     std::string file = graphPath + fileName;
     const IndexType dimensions = 2;
 
+    scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+
     Settings settings;
     settings.dimensions = dimensions;
     settings.numBlocks = 8;
     settings.noRefinement = true;
     settings.writePEgraph = true;
-    settings.writeInFile = true;
     settings.storeInfo = true;
 
     const IndexType k = settings.numBlocks;
+    const bool writeInFile = true;
 
     //
     // 1 - read graph, coordinates and create unit nodeweights
@@ -65,67 +139,197 @@ TEST_F( benchmarkTest, benchMapping ) {
     }
 
     //
-    // 3 - read and partition graph without using the PEgraph
+    // 3 - partition the graph with the balance constraints of the tree but without its hierarchy
     //
 
-    settings.initialPartition = InitialPartitioningMethods::KMeans;
-    struct Metrics metrics(settings);
+    settings.initialPartition = Tool::geoKmeans;
+    Metrics<ValueType> metrics(settings);
 
     std::vector<std::vector<ValueType>> balances = cTree.getBalanceVectors( -1 );
     SCAI_ASSERT_EQ_ERROR( balances.size(), 2, "Wrong number of balance constrains");
     SCAI_ASSERT_EQ_ERROR( balances[0].size(), k, "Wrong size of balance vector");
 
-
-    // get partition ParcoRepart::partitionGraph to accept constrains
-    scai::lama::DenseVector<IndexType> partition = ParcoRepart<IndexType, ValueType>::partitionGraph(graph, coords, unitWeights, balances, settings, metrics);
+    DenseVector<IndexType> previous;
+    scai::lama::DenseVector<IndexType> partition = ParcoRepart<IndexType, ValueType>::partitionGraph(graph, coords, unitWeights, previous, cTree, comm, settings, metrics);
     ASSERT_EQ(globalN, partition.size());
 
     //
     // 4 - partition graph with the PEgraph
     //
 
-    //read graph again or redistribute because the previous partition might have change it
+    //read graph and coordinates again because the previous partition has redistributed them
     scai::lama::CSRSparseMatrix<ValueType> graph2 = FileIO<IndexType, ValueType>::readGraph(file );
+    std::vector<DenseVector<ValueType>> coords2 = FileIO<IndexType, ValueType>::readCoords( std::string(file + ".xyz"), globalN, dimensions);
+    std::vector<scai::lama::DenseVector<ValueType>> unitWeights2(2, scai::lama::DenseVector<ValueType>(graph2.getRowDistributionPtr(), 1));
 
-    struct Metrics metrics2( settings );
+    Metrics<ValueType> metrics2( settings );
 
-    scai::lama::DenseVector<IndexType> partitionWithPE = ITI::KMeans::computeHierarchicalPartition(  \
-            graph2, coords, unitWeights, cTree, settings, metrics );
+    scai::lama::DenseVector<IndexType> partitionWithPE = KMeans<IndexType,ValueType>::computeHierarchicalPartition( coords2, unitWeights2, cTree, settings, metrics2 );
 
-    if(settings.writeInFile) {
+    if(writeInFile) {
         FileIO<IndexType,ValueType>::writePartitionParallel( partition, "./partResults/partKM"+std::to_string(settings.numBlocks)+".out");
         FileIO<IndexType,ValueType>::writePartitionParallel( partitionWithPE, "./partResults/partHKM"+std::to_string(settings.numBlocks)+".out");
-
-        //FileIO<IndexType,ValueType>::writeGraph( GraphUtils<IndexType,ValueType>::getBlockGraph(graph, partition, settings.numBlocks), "blockKM"+std::to_string(settings.numBlocks)+".graph", 1);
-        //FileIO<IndexType,ValueType>::writeGraph( GraphUtils<IndexType,ValueType>::getBlockGraph(graph, partitionWithPE, settings.numBlocks), "blockHKM"+std::to_string(settings.numBlocks)+".graph", 1);
     }
 
     //
     // 5 - compare quality
     //
 
-    scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
     PRINT0("--------- Metrics for regular partition");
 
     //graph and partition are distributed inside partitionGraph; distributions must allign
-    unitWeights[0].redistribute( partition.getDistributionPtr() );
+    for( DenseVector<ValueType>& weights : unitWeights ){
+        weights.redistribute( partition.getDistributionPtr() );
+    }
 
     metrics.getMappingMetrics( graph, partition, PEGraph);
-    metrics.getEasyMetrics( graph, partition, unitWeights[0], settings );
+    metrics.getEasyMetrics( graph, partition, unitWeights, settings );
     if(comm->getRank()==0)
         metrics.print( std::cout );
 
     PRINT0("--------- Metrics for hierarchical partition");
 
-    //graph and partition are distributed inside partitionGraph; distributions must allign
-    unitWeights[0].redistribute( partitionWithPE.getDistributionPtr() );
+    graph2.redistribute( partitionWithPE.getDistributionPtr(), graph2.getColDistributionPtr() );
+    for( DenseVector<ValueType>& weights : unitWeights2 ){
+        weights.redistribute( partitionWithPE.getDistributionPtr() );
+    }
 
     metrics2.getMappingMetrics( graph2, partitionWithPE, PEGraph);
-    metrics2.getEasyMetrics( graph2, partitionWithPE, unitWeights[0], settings );
+    metrics2.getEasyMetrics( graph2, partitionWithPE, unitWeights2, settings );
     if(comm->getRank()==0)
         metrics2.print( std::cout );
 
+}//TEST_F( benchmarkTest, benchMapping )
+
+//---------------------------------------------------------------------------------------
+
+TEST_F( benchmarkTest, benchLocalReordering ) {
+    using ValueType = double;
+
+    std::string fileName = "bubbles-00010.graph";
+    std::string file = graphPath + fileName;
+    const IndexType dimensions = 2;
+
+    scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
+    const IndexType k = comm->getSize();
+
+    Settings settings;
+    settings.dimensions = dimensions;
+    settings.numBlocks = k;
+    settings.multiLevelRounds = 5;
+    settings.minBorderNodes = 100;
+
+    for (std::string ordering : {"none", "sfc", "rcm"}) {
+        settings.localReordering = ordering;
+
+        //
+        // 1 - read the input and simulate the migration after the initial SFC partition
+        //
+
+        scai::lama::CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph( file );
+        const IndexType globalN = graph.getNumRows();
+        std::vector<DenseVector<ValueType>> coords = FileIO<IndexType, ValueType>::readCoords( std::string(file + ".xyz"), globalN, dimensions );
+        std::vector<DenseVector<ValueType>> nodeWeights(1, DenseVector<ValueType>(graph.getRowDistributionPtr(), 1));
+
+        DenseVector<IndexType> partition = HilbertCurve<IndexType, ValueType>::computePartition( coords, settings );
+        aux<IndexType, ValueType>::redistributeFromPartition( partition, graph, coords, nodeWeights, settings );
+
+        //
+        // 2 - reorder locally
+        //
+
+        std::chrono::time_point<std::chrono::steady_clock> beforeReordering = std::chrono::steady_clock::now();
+        if (ordering != "none") {
+            GraphUtils<IndexType, ValueType>::localReordering( graph, coords, nodeWeights, {&partition}, settings );
+        }
+        const double reorderingTime = comm->max( std::chrono::duration<double>(std::chrono::steady_clock::now() - beforeReordering).count() );
+
+        //
+        // 3 - multilevel refinement, count cache misses
+        //
+
+        Metrics<ValueType> metrics(settings);
+        CommTree<IndexType, ValueType> commTree;
+        commTree.createFlatHomogeneous( k );
+        scai::dmemo::HaloExchangePlan halo = GraphUtils<IndexType, ValueType>::buildNeighborHalo( graph );
+
+        CacheMissCounter counter;
+        comm->synchronize();
+        std::chrono::time_point<std::chrono::steady_clock> beforeML = std::chrono::steady_clock::now();
+        counter.start();
+        MultiLevel<IndexType, ValueType>::multiLevelStep( graph, partition, nodeWeights[0], coords, halo, commTree, settings, metrics );
+        const long long localMisses = counter.stop();
+        const double mlTime = comm->max( std::chrono::duration<double>(std::chrono::steady_clock::now() - beforeML).count() );
+
+        //all PEs take part in both reductions, a PE without counter reports -1
+        const double totalMisses = comm->sum( double(localMisses) );
+        const bool countersAvailable = comm->min( double(localMisses) ) >= 0;
+        const ValueType cut = GraphUtils<IndexType, ValueType>::computeCut( graph, partition, true );
+
+        PRINT0( "local reordering " << ordering << ": reordering time " << reorderingTime << ", multilevel time " << mlTime
+            << ", cache misses " << (countersAvailable ? std::to_string((long long) totalMisses) : std::string("n/a")) << ", cut " << cut );
+    }
+}//TEST_F( benchmarkTest, benchLocalReordering )
+
+//---------------------------------------------------------------------------------------
+
+TEST_F( benchmarkTest, benchEmbedding ) {
+    using ValueType = double;
+
+    std::string fileName = "bubbles-00010.graph";
+    std::string file = graphPath + fileName;
+    const IndexType dimensions = 2;
+
+    scai::dmemo::CommunicatorPtr comm = scai::dmemo::Communicator::getCommunicatorPtr();
 
-}//TEST_F( benchmarkTest, testMapping )
+    Settings settings;
+    settings.dimensions = dimensions;
+    settings.numBlocks = comm->getSize();
+    settings.seed = 1;
+
+    scai::lama::CSRSparseMatrix<ValueType> graph = FileIO<IndexType, ValueType>::readGraph( file );
+    std::vector<DenseVector<ValueType>> nodeWeights(1, DenseVector<ValueType>(graph.getRowDistributionPtr(), 1));
+
+    //
+    // 1 - embedding and geometric partition, the coordinates of the file are not used
+    //
+
+    comm->synchronize();
+    std::chrono::time_point<std::chrono::steady_clock> beforeEmbedding = std::chrono::steady_clock::now();
+    std::vector<DenseVector<ValueType>> coords = Embedding<IndexType, ValueType>::multilevelEmbedding( graph, nodeWeights[0], settings );
+    const double embeddingTime = comm->max( std::chrono::duration<double>(std::chrono::steady_clock::now() - beforeEmbedding).count() );
+
+    {
+        scai::lama::CSRSparseMatrix<ValueType> graphCopy( graph );
+        std::vector<DenseVector<ValueType>> weightsCopy( nodeWeights );
+        std::chrono::time_point<std::chrono::steady_clock> beforePartition = std::chrono::steady_clock::now();
+        DenseVector<IndexType> partition = ParcoRepart<IndexType, ValueType>::partitionGraph( graphCopy, coords, weightsCopy, settings );
+        const double partitionTime = comm->max( std::chrono::duration<double>(std::chrono::steady_clock::now() - beforePartition).count() );
+        const ValueType cut = GraphUtils<IndexType, ValueType>::computeCut( graphCopy, partition, true );
+        const ValueType imbalance = GraphUtils<IndexType, ValueType>::computeImbalance( partition, settings.numBlocks );
+        PRINT0( "embedding + geographer: embedding time " << embeddingTime << ", partition time " << partitionTime << ", cut " << cut << ", imbalance " << imbalance );
+    }
+
+    //
+    // 2 - graph partitioner for comparison
+    //
+
+#ifdef PARMETIS_FOUND
+    {
+        Metrics<ValueType> metrics(settings);
+        CommTree<IndexType, ValueType> commTree;
+        commTree.createFlatHomogeneous( settings.numBlocks );
+        parmetisWrapper<IndexType, ValueType> parMetis;
+        std::chrono::time_point<std::chrono::steady_clock> beforePartition = std::chrono::steady_clock::now();
+        DenseVector<IndexType> partition = parMetis.partition( graph, coords, nodeWeights, false, Tool::parMetisGraph, commTree, settings, metrics );
+        const double partitionTime = comm->max( std::chrono::duration<double>(std::chrono::steady_clock::now() - beforePartition).count() );
+        const ValueType cut = GraphUtils<IndexType, ValueType>::computeCut( graph, partition, true );
+        const ValueType imbalance = GraphUtils<IndexType, ValueType>::computeImbalance( partition, settings.numBlocks );
+        PRINT0( "parMetisGraph: partition time " << partitionTime << ", cut " << cut << ", imbalance " << imbalance );
+    }
+#else
+    PRINT0( "parMetis not found, no comparison" );
+#endif
+}//TEST_F( benchmarkTest, benchEmbedding )
 
-}// namespace
\ No newline at end of file
+} // namespace ITI
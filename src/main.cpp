@@ -27,6 +27,11 @@
 #include "GraphUtils.h"
 #include "parseArgs.h"
 #include "mainHeader.h"
+#include "NumaUtils.h"
+#include "AutoTuner.h"
+#include "Checkpoint.h"
+#include "HilbertCurve.h"
+#include "HaloExport.h"
 
 /**
  *  Examples of use:
@@ -39,6 +44,18 @@
  *
  * ./a.out --graphFile fileName --epsilon 0.05 --initialPartition=4 --dimensions=2 --bisect=0 --numPoints=4000000 --distribution=uniform --cutsPerDim=10 13
  *
+ * for a resident service that partitions the requests sent to a socket, see PartitionService.h
+ * ./a.out --service /tmp/geographer.sock
+ *
+ * for partitioning all time steps of a simulation in one run
+ * ./a.out --batchFiles "output/mesh_*.graph" --numBlocks 64 --outFile mesh
+ *
+ * for partitioning a point cloud that does not fit into memory, the block ids are written to points.part
+ * ./a.out --coordFile points.xyz --dimensions=3 --numBlocks 1024 --outOfCoreSFC=1 --outFile points.part
+ *
+ * for repeating only the local refinement of an earlier run that wrote checkpoints
+ * ./a.out --graphFile fileName --checkpointDir ckpt --resume initial --minGainForNextGlobalRound=10
+ *
  */
 
 //----------------------------------------------------------------------------
@@ -76,6 +93,34 @@ int main(int argc, char** argv) {
 
     printInfo( std::cout, comm, settings);
 
+    //check before pinning, afterwards every thread has a single core in its mask
+    ITI::checkOversubscription(comm);
+    if( settings.threadAffinity!="none" ) {
+        ITI::pinThreads(settings.threadAffinity, comm);
+        ITI::printAffinity(std::cout, comm);
+    } else if( settings.verbose ) {
+        ITI::printAffinity(std::cout, comm);
+    }
+
+    //stay resident and partition the inputs of the requests
+    if( settings.serviceSocket!="-" ){
+        ITI::runPartitionService<ValueType>( settings, comm );
+        return 0;
+    }
+
+    //partition the inputs one after the other
+    if( settings.batchFiles!="-" ){
+        ITI::runBatch<ValueType>( vm, settings, comm );
+        return 0;
+    }
+
+    //partition the coordinate file without reading it into memory
+    if( settings.outOfCoreSFC ){
+        const std::string coordFile = vm.count("coordFile") ? vm["coordFile"].as<std::string>() : settings.fileName + ".xyz";
+        ITI::HilbertCurve<IndexType, ValueType>::partitionOutOfCore( coordFile, settings.outFile, settings, comm );
+        return 0;
+    }
+
     //---------------------------------------------------------
     //
     // generate or read graph and coordinates
@@ -88,8 +133,25 @@ int main(int argc, char** argv) {
     std::vector<scai::lama::DenseVector<ValueType>> nodeWeights;		//the weights for each node
 
     // total number of points
-    const IndexType N = readInput<ValueType>( vm, settings, comm, graph, coordinates, nodeWeights );
+    IndexType N;
+    // with geoStream, the initial partition computed while reading
+    DenseVector<IndexType> streamedPartition;
+    if( ITI::Checkpoint<IndexType, ValueType>::resumeAt( "input", settings, comm ) ){
+        DenseVector<IndexType> noPartition;
+        ITI::Checkpoint<IndexType, ValueType>::read( settings.checkpointDir, "input", graph, coordinates, nodeWeights, noPartition, comm );
+        //the checkpoint of a point set has no graph
+        N = graph.getNumRows() > 0 ? graph.getNumRows() : coordinates[0].size();
+        settings.numNodeWeights = nodeWeights.size();
+    }else{
+        N = readInput<ValueType>( vm, settings, comm, graph, coordinates, nodeWeights, &streamedPartition );
+        if( settings.checkpointDir!="-" ){
+            ITI::Checkpoint<IndexType, ValueType>::write( settings.checkpointDir, "input", graph, coordinates, nodeWeights, DenseVector<IndexType>(), comm );
+        }
+    }
 
+    if( settings.autoTune ){
+        settings = ITI::AutoTuner<IndexType, ValueType>::tune( graph, coordinates, nodeWeights, settings );
+    }
     if( settings.setAutoSettings ){
         settings = settings.setDefault( graph );
     }
@@ -193,20 +255,15 @@ int main(int argc, char** argv) {
         if(r>0) {
             PRINT0("Input redistribution: block distribution for graph rows, coordinates and nodeWeigts, no distribution for graph columns");
 
-            graph.redistribute( rowDistPtr, noDistPtr );
-            for(int d=0; d<settings.dimensions; d++) {
-                coordinates[d].redistribute( rowDistPtr );
-            }
-            for (IndexType i = 0; i < nodeWeights.size(); i++) {
-                nodeWeights[i].redistribute( rowDistPtr );
-            }
+            //graph, coordinates, node weights and the old partition are moved together
+            aux<IndexType,ValueType>::redistributeInput( rowDistPtr, partition, graph, coordinates, nodeWeights );
         }
 
         metricsVec.push_back( Metrics<ValueType>( settings ) );
 
         std::chrono::time_point<std::chrono::steady_clock> beforePartTime =  std::chrono::steady_clock::now();
 
-        partition = ITI::ParcoRepart<IndexType, ValueType>::partitionGraph( graph, coordinates, nodeWeights, previous, commTree, comm, settings, metricsVec[r] );
+        partition = ITI::ParcoRepart<IndexType, ValueType>::partitionGraph( graph, coordinates, nodeWeights, previous, commTree, comm, settings, metricsVec[r], streamedPartition );
         assert( partition.size() == N);
         assert( coordinates[0].size() == N);
 
@@ -331,6 +388,23 @@ int main(int argc, char** argv) {
         std::cout<< "Total time " << totalT << std::endl;
     }
 
+    // write the ghost exchange of the blocks for the application
+    if( settings.storeHaloPlan and graph.getNumRows()>0 ){
+        const std::string haloFile = (settings.outFile!="-" ? settings.outFile : settings.fileName) + ".halo";
+        const auto plans = ITI::HaloExport<IndexType, ValueType>::computeBlockPlans( graph, partition, settings.numBlocks );
+        ITI::HaloExport<IndexType, ValueType>::write( plans, settings.numBlocks, haloFile, comm );
+        PRINT0("Halo plan stored in " << haloFile );
+    }
+
+    // write the new id of every vertex, entry i belongs to vertex i of the input file
+    if( settings.blockRenumbering!="none" and graph.getNumRows()>0 ){
+        const std::string permFile = (settings.outFile!="-" ? settings.outFile : settings.fileName) + ".perm";
+        DenseVector<IndexType> newIds = ITI::GraphUtils<IndexType, ValueType>::blockRenumbering( graph, coordinates, partition, settings.blockRenumbering, settings );
+        newIds.redistribute( scai::dmemo::DistributionPtr(new scai::dmemo::BlockDistribution(N, comm)) );
+        ITI::FileIO<IndexType, ValueType>::writePartitionParallel( newIds, permFile );
+        PRINT0("Block renumbering stored in " << permFile );
+    }
+
     if( settings.outFile=="-" and settings.storePartition ){
         settings.outFile = ITI::to_string(settings.initialPartition)+"_"+std::to_string(settings.numBlocks);
         if( comm->getRank()==0 ) {
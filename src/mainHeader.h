@@ -5,7 +5,14 @@
 #include "sys/times.h"
 #include "sys/vtimes.h"
 
+#include <algorithm>
 #include <chrono>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <cxxopts.hpp>
 
 #include "AuxiliaryFunctions.h"
@@ -15,114 +22,168 @@
 #include "MeshGenerator.h"
 #include "parseArgs.h"
 #include "CommTree.h"
+#include "Diffusion.h"
+#include "Embedding.h"
+#include "NumaUtils.h"
+#include "ParcoRepart.h"
+#include "PartitionService.h"
+#include "AutoTuner.h"
 
 namespace ITI{
 
-/** Read the needed parameters from the virtual machine and return the input data.
-    @param[in] vm The virtual machine with the input parameters
+/** Read the graph, the coordinates and the node weights from files.
+    @param[in] graphFile The name of the graph file
+    @param[in] coordFile The name of the coordinates file
+    @param[in] vm The virtual machine with the input parameters, only the file formats are used
     @param[in/out] settings Some input settings. Some of them might change
     @param[in] comm The communicator
     @param[out] graph The returned input matrix
     @param[out] coords The returned input coordinates
     @param[out] nodeWeights The returned input node weights
+    @param[out] streamedPartition If given and the initial partition is geoStream, the partition computed while reading the graph
+    @return The number of vertices
 */
 
 template <typename ValueType>
-IndexType readInput( 
+IndexType readFileInput(
+    const std::string& graphFile,
+    const std::string& coordFile,
     const cxxopts::ParseResult& vm,
     Settings& settings,
     const scai::dmemo::CommunicatorPtr& comm,
     scai::lama::CSRSparseMatrix<ValueType>& graph,
     std::vector<scai::lama::DenseVector<ValueType>>& coords,
-    std::vector<scai::lama::DenseVector<ValueType>>& nodeWeights ){
-
-    std::chrono::time_point<std::chrono::steady_clock> startTime =  std::chrono::steady_clock::now();
-    IndexType N;
+    std::vector<scai::lama::DenseVector<ValueType>>& nodeWeights,
+    scai::lama::DenseVector<IndexType>* streamedPartition = nullptr ){
 
-    if (vm.count("graphFile")) {
-        std::string graphFile =  vm["graphFile"].as<std::string>();
-        std::string coordFile;
+    // read the graph, with geoStream the vertices are assigned to blocks while they are read
+    std::unique_ptr<ITI::StreamingPartition<IndexType, ValueType>> streaming;
+    if( streamedPartition!=nullptr and settings.initialPartition==ITI::Tool::geoStream ){
+        streaming.reset( new ITI::StreamingPartition<IndexType, ValueType>(settings) );
+    }
+    if (vm.count("fileFormat")) {
+        graph = ITI::FileIO<IndexType, ValueType>::readGraph( graphFile, nodeWeights, comm, settings.fileFormat, streaming.get() );
+    } else {
+        graph = ITI::FileIO<IndexType, ValueType>::readGraph( graphFile, nodeWeights, comm, ITI::Format::AUTO, streaming.get() );
+    }
+    if( streaming ){
+        *streamedPartition = streaming->getPartition();
+    }
 
-        if (vm.count("coordFile")) {
-            coordFile = vm["coordFile"].as<std::string>();
-        } else {
-            coordFile = graphFile + ".xyz";
-        }
+    const IndexType N = graph.getNumRows();
 
-        // read the graph
-        if (vm.count("fileFormat")) {
-            graph = ITI::FileIO<IndexType, ValueType>::readGraph( graphFile, nodeWeights, comm, settings.fileFormat );
-        } else {
-            graph = ITI::FileIO<IndexType, ValueType>::readGraph( graphFile, nodeWeights, comm );
-        }
+    SCAI_ASSERT_EQUAL( graph.getNumColumns(),  graph.getNumRows(), "matrix not square");
+    SCAI_ASSERT( graph.isConsistent(), "Graph not consistent");
 
-        N = graph.getNumRows();
+    scai::dmemo::DistributionPtr rowDistPtr = graph.getRowDistributionPtr();
 
-        SCAI_ASSERT_EQUAL( graph.getNumColumns(),  graph.getNumRows(), "matrix not square");
-        SCAI_ASSERT( graph.isConsistent(), "Graph not consistent");
+    // set the node weights
+    IndexType numReadNodeWeights = nodeWeights.size();
 
-        scai::dmemo::DistributionPtr rowDistPtr = graph.getRowDistributionPtr();
+    //Case where we ask to automatically find cpu and memory. This creates an tree with 2 nodeweights.
+    // If input has less node weights add unit weights
+    if( settings.autoSetCpuMem and numReadNodeWeights!=2){
+        if (comm->getRank() == 0) {
+            std::cout << "WARNING:\n\toption autoSetCpuMem is activated and it will create a tree with two node weights"<< std::endl;
+            std::cout<< "\tbut input has " << numReadNodeWeights << " number of weights. Will adapt (pad or remove) input weights and"<< std::endl;
+            std::cout <<"\twill consider only two weights." << std::endl;
+        }
+        settings.numNodeWeights = 2;
+    }
 
-        // set the node weights
-        IndexType numReadNodeWeights = nodeWeights.size();
+    // user did not specify number of weights to use
+    if( settings.numNodeWeights==0 ){
+        if ( numReadNodeWeights==0 ) {
+            nodeWeights.resize(1);
+            nodeWeights[0] = fill<DenseVector<ValueType>>(rowDistPtr, 1.0);
+            settings.numNodeWeights=1;
+        }else if ( numReadNodeWeights>0 ) {
+            settings.numNodeWeights = numReadNodeWeights;
+        }
+    }
 
-        //Case where we ask to automatically find cpu and memory. This creates an tree with 2 nodeweights.
-        // If input has less node weights add unit weights
-        if( settings.autoSetCpuMem and numReadNodeWeights!=2){
+    if (settings.numNodeWeights > 0) {
+        if (settings.numNodeWeights < nodeWeights.size()) {
+            nodeWeights.resize(settings.numNodeWeights);
             if (comm->getRank() == 0) {
-                std::cout << "WARNING:\n\toption autoSetCpuMem is activated and it will create a tree with two node weights"<< std::endl;
-                std::cout<< "\tbut input has " << numReadNodeWeights << " number of weights. Will adapt (pad or remove) input weights and"<< std::endl;
-                std::cout <<"\twill consider only two weights." << std::endl;
+                std::cout << "Read " << numReadNodeWeights << " weights per node but " << settings.numNodeWeights << " weights were specified, thus discarding "
+                          << numReadNodeWeights - settings.numNodeWeights << std::endl;
             }
-            settings.numNodeWeights = 2;
-        }
-
-        // user did not specify number of weights to use
-        if( settings.numNodeWeights==0 ){
-            if ( numReadNodeWeights==0 ) {
-                nodeWeights.resize(1);
-                nodeWeights[0] = fill<DenseVector<ValueType>>(rowDistPtr, 1.0);
-                settings.numNodeWeights=1;
-            }else if ( numReadNodeWeights>0 ) {
-                settings.numNodeWeights = numReadNodeWeights;
+        } else if (settings.numNodeWeights > nodeWeights.size()) {
+            nodeWeights.resize(settings.numNodeWeights);
+            for (IndexType i = numReadNodeWeights; i < settings.numNodeWeights; i++) {
+                nodeWeights[i] = fill<DenseVector<ValueType>>(rowDistPtr, 1.0);
+            }
+            if (comm->getRank() == 0) {
+                std::cout << "Read " << numReadNodeWeights << " weights per node but " << settings.numNodeWeights << " weights were specified, padding with "
+                          << settings.numNodeWeights - numReadNodeWeights << " unit weights. " << std::endl;
             }
         }
+    }
 
-        if (settings.numNodeWeights > 0) {
-            if (settings.numNodeWeights < nodeWeights.size()) {
-                nodeWeights.resize(settings.numNodeWeights);
-                if (comm->getRank() == 0) {
-                    std::cout << "Read " << numReadNodeWeights << " weights per node but " << settings.numNodeWeights << " weights were specified, thus discarding "
-                              << numReadNodeWeights - settings.numNodeWeights << std::endl;
-                }
-            } else if (settings.numNodeWeights > nodeWeights.size()) {
-                nodeWeights.resize(settings.numNodeWeights);
-                for (IndexType i = numReadNodeWeights; i < settings.numNodeWeights; i++) {
-                    nodeWeights[i] = fill<DenseVector<ValueType>>(rowDistPtr, 1.0);
-                }
-                if (comm->getRank() == 0) {
-                    std::cout << "Read " << numReadNodeWeights << " weights per node but " << settings.numNodeWeights << " weights were specified, padding with "
-                              << settings.numNodeWeights - numReadNodeWeights << " unit weights. " << std::endl;
-                }
-            }
+    //read the coordinates file
+    if( settings.useGraphEmbedding ){
+        coords = ITI::Embedding<IndexType, ValueType>::multilevelEmbedding(graph, nodeWeights[0], settings);
+    }else if( settings.useDiffusionCoordinates ){
+        SCAI_ASSERT_GT_ERROR( settings.dimensions, 0, "Diffusion coordinates need at least one dimension" );
+        if (comm->getRank() == 0) {
+            std::cout << "Computing diffusion coordinates from " << settings.dimensions << " landmarks" << std::endl;
         }
+        coords = ITI::Diffusion<IndexType, ValueType>::diffusionCoordinates(graph, nodeWeights[0], settings);
+    }else if( settings.dimensions==0 ){
+        //if dimensions are explicitly set to 0, set only one coord with the same value
+        const scai::dmemo::DistributionPtr dist(new scai::dmemo::BlockDistribution(N, comm));
+        coords.push_back( DenseVector<ValueType>( dist, 0.0 ) );
+    }else if (vm.count("coordFormat")) {
+        coords = ITI::FileIO<IndexType, ValueType>::readCoords(coordFile, N, settings.dimensions, comm, settings.coordFormat);
+    } else if (vm.count("fileFormat")) {
+        coords = ITI::FileIO<IndexType, ValueType>::readCoords(coordFile, N, settings.dimensions, comm, settings.fileFormat);
+    } else {
+        coords = ITI::FileIO<IndexType, ValueType>::readCoords(coordFile, N, settings.dimensions, comm);
+    }
+    if( settings.dimensions>2 ){
+        SCAI_ASSERT_EQUAL(coords[0].getLocalValues().size(), coords[1].getLocalValues().size(), "coordinates not of same size" );
+    }
+
+    return N;
+}
+
+
+/** Read the needed parameters from the virtual machine and return the input data.
+    @param[in] vm The virtual machine with the input parameters
+    @param[in/out] settings Some input settings. Some of them might change
+    @param[in] comm The communicator
+    @param[out] graph The returned input matrix
+    @param[out] coords The returned input coordinates
+    @param[out] nodeWeights The returned input node weights
+    @param[out] streamedPartition If given and the initial partition is geoStream, the partition computed while reading the graph
+*/
 
-        //read the coordinates file
-        if( settings.dimensions==0 ){
-            //if dimensions are explicitly set to 0, set only one coord with the same value
-            const scai::dmemo::DistributionPtr dist(new scai::dmemo::BlockDistribution(N, comm));
-            coords.push_back( DenseVector<ValueType>( dist, 0.0 ) );
-        }else if (vm.count("coordFormat")) {
-            coords = ITI::FileIO<IndexType, ValueType>::readCoords(coordFile, N, settings.dimensions, comm, settings.coordFormat);
-        } else if (vm.count("fileFormat")) {
-            coords = ITI::FileIO<IndexType, ValueType>::readCoords(coordFile, N, settings.dimensions, comm, settings.fileFormat);
+template <typename ValueType>
+IndexType readInput( 
+    const cxxopts::ParseResult& vm,
+    Settings& settings,
+    const scai::dmemo::CommunicatorPtr& comm,
+    scai::lama::CSRSparseMatrix<ValueType>& graph,
+    std::vector<scai::lama::DenseVector<ValueType>>& coords,
+    std::vector<scai::lama::DenseVector<ValueType>>& nodeWeights,
+    scai::lama::DenseVector<IndexType>* streamedPartition = nullptr ){
+
+    std::chrono::time_point<std::chrono::steady_clock> startTime =  std::chrono::steady_clock::now();
+    IndexType N;
+
+    if (vm.count("graphFile")) {
+        std::string graphFile =  vm["graphFile"].as<std::string>();
+        std::string coordFile;
+
+        if (vm.count("coordFile")) {
+            coordFile = vm["coordFile"].as<std::string>();
         } else {
-            coords = ITI::FileIO<IndexType, ValueType>::readCoords(coordFile, N, settings.dimensions, comm);
-        }
-        if( settings.dimensions>2 ){
-            SCAI_ASSERT_EQUAL(coords[0].getLocalValues().size(), coords[1].getLocalValues().size(), "coordinates not of same size" );
+            coordFile = graphFile + ".xyz";
         }
 
+        N = readFileInput<ValueType>( graphFile, coordFile, vm, settings, comm, graph, coords, nodeWeights, streamedPartition );
+
     }else if(vm.count("generate")) {
 
         N = settings.numX * settings.numY * settings.numZ;
@@ -403,8 +464,130 @@ IndexType getCpuFreqLinux(const scai::dmemo::CommunicatorPtr& comm, const int no
 }
 
 
+/** Measure the speed of every PE with a short SpMV on the 7-point stencil of a cube with 64^3 rows. The kernel is
+    synthetic and independent of the input, so the values in the cache file are valid for all inputs; like the loops
+    of the partitioner over the graph, it is bound by memory bandwidth. All PEs run
+    the kernel at the same time, so PEs that share cores or memory bandwidth with other processes are measured as slower.
+    Every process runs the kernel with the number of cores of its host divided by the number of processes on the host.
+
+    If a cache file is given, the measurement of a process is averaged with the value stored for the same host and
+    the same rank on that host, and the file is updated. This smooths the noise of single measurements over several runs.
+
+    @return The throughput of every PE in rows per microsecond, replicated on all PEs.
+*/
 template <typename vType>
-std::vector<std::vector<vType>> calculateLoadRequests(const scai::dmemo::CommunicatorPtr& comm, const int nodeSize=24){
+std::vector<vType> calibrateSpeed(const scai::dmemo::CommunicatorPtr& comm, const std::string& cacheFile="-"){
+    SCAI_REGION("mainHeader.calibrateSpeed");
+
+    const IndexType numPEs = comm->getSize();
+    const IndexType rank = comm->getRank();
+
+    //the stencil matrix, every row averages its neighbors
+    const IndexType sideLen = 64;
+    const IndexType n = sideLen*sideLen*sideLen;
+    std::vector<IndexType> ia(n+1, 0);
+    std::vector<IndexType> ja;
+    ja.reserve(7*n);
+    for( IndexType z=0; z<sideLen; z++ ){
+        for( IndexType y=0; y<sideLen; y++ ){
+            for( IndexType x=0; x<sideLen; x++ ){
+                const IndexType i = (z*sideLen + y)*sideLen + x;
+                ja.push_back(i);
+                if( x>0 ) ja.push_back(i-1);
+                if( x+1<sideLen ) ja.push_back(i+1);
+                if( y>0 ) ja.push_back(i-sideLen);
+                if( y+1<sideLen ) ja.push_back(i+sideLen);
+                if( z>0 ) ja.push_back(i-sideLen*sideLen);
+                if( z+1<sideLen ) ja.push_back(i+sideLen*sideLen);
+                ia[i+1] = ja.size();
+            }
+        }
+    }
+
+    //every process uses its share of the cores of its host, so the processes of a host do not oversubscribe it
+    const std::pair<int,int> nodeRank = nodeLocalRank(comm);
+    const int numThreads = std::max<int>( 1, std::thread::hardware_concurrency()/nodeRank.second );
+
+    std::vector<vType> xVec(n, 1.0);
+    std::vector<vType> yVec(n, 0.0);
+    auto spmv = [&](){
+        #pragma omp parallel for schedule(static) num_threads(numThreads)
+        for( IndexType i=0; i<n; i++ ){
+            vType sum = 0;
+            for( IndexType e=ia[i]; e<ia[i+1]; e++ ){
+                sum += xVec[ja[e]];
+            }
+            yVec[i] = sum/(ia[i+1]-ia[i]);
+        }
+        std::swap(xVec, yVec);
+    };
+
+    //one warm up round, then measure for at least 0.2 seconds
+    spmv();
+    comm->synchronize();
+    std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    IndexType rounds = 0;
+    do{
+        spmv();
+        rounds++;
+        elapsed = std::chrono::steady_clock::now() - startTime;
+    }while( elapsed.count()<0.2 );
+
+    double throughput = rounds*double(n)/elapsed.count()/1e6;
+
+    //processes are identified in the cache by the hash of their hostname and their rank on the host
+    const IndexType myHost = hostHash();
+    const IndexType localRank = nodeRank.first;
+
+    std::map<std::pair<IndexType,IndexType>, double> cached;
+    if( cacheFile!="-" ){
+        std::ifstream in(cacheFile);
+        IndexType host, hostRank;
+        double value;
+        while( in >> host >> hostRank >> value ){
+            cached[{host, hostRank}] = value;
+        }
+        const auto entry = cached.find({myHost, localRank});
+        if( entry!=cached.end() ){
+            throughput = 0.5*throughput + 0.5*entry->second;
+        }
+    }
+
+    std::vector<IndexType> allKeys(2*numPEs, 0);
+    allKeys[2*rank] = myHost;
+    allKeys[2*rank+1] = localRank;
+    comm->sumImpl( allKeys.data(), allKeys.data(), 2*numPEs, scai::common::TypeTraits<IndexType>::stype );
+
+    std::vector<double> allThroughputs(numPEs, 0.0);
+    allThroughputs[rank] = throughput;
+    comm->sumImpl( allThroughputs.data(), allThroughputs.data(), numPEs, scai::common::TypeTraits<double>::stype );
+
+    if( cacheFile!="-" and rank==0 ){
+        for( IndexType i=0; i<numPEs; i++ ){
+            cached[{allKeys[2*i], allKeys[2*i+1]}] = allThroughputs[i];
+        }
+        std::ofstream out(cacheFile);
+        if( out.is_open() ){
+            for( const auto& entry : cached ){
+                out << entry.first.first << " " << entry.first.second << " " << entry.second << std::endl;
+            }
+        }else{
+            std::cout << "WARNING: could not write the speed cache file " << cacheFile << std::endl;
+        }
+    }
+
+    if( rank==0 ){
+        const auto minMax = std::minmax_element( allThroughputs.begin(), allThroughputs.end() );
+        std::cout << "measured SpMV throughput in rows/us, min: " << *minMax.first << ", max: " << *minMax.second << std::endl;
+    }
+
+    return std::vector<vType>( allThroughputs.begin(), allThroughputs.end() );
+}
+
+
+template <typename vType>
+std::vector<std::vector<vType>> calculateLoadRequests(const scai::dmemo::CommunicatorPtr& comm, const int nodeSize=24, const bool measureSpeed=false, const std::string& speedCacheFile="-"){
 
     const IndexType numPEs = comm->getSize();
     const IndexType rank = comm->getRank();
@@ -412,21 +595,29 @@ std::vector<std::vector<vType>> calculateLoadRequests(const scai::dmemo::Communi
     //in the version, we have two node weights: cpu frequency and memory size
     std::vector<std::vector<vType>> retWeights (2, std::vector<vType> (numPEs, 0.0) );
 
-    //start with the cpu frequency
+    //start with the cpu speed: measured or the cpu frequency
 
-    const double myCpuFreq = getCpuFreqLinux(comm, nodeSize);
-    std::vector<IndexType> allCpuFreq(numPEs, 0);
-    allCpuFreq[rank] = myCpuFreq;
+    if( measureSpeed ){
+        const std::vector<vType> speeds = calibrateSpeed<vType>(comm, speedCacheFile);
+        const vType sumSpeed = std::accumulate( speeds.begin(), speeds.end(), vType(0.0) );
+        for( int i=0; i<numPEs; i++){
+            retWeights[0][i] = speeds[i]/sumSpeed;
+        }
+    }else{
+        const double myCpuFreq = getCpuFreqLinux(comm, nodeSize);
+        std::vector<IndexType> allCpuFreq(numPEs, 0);
+        allCpuFreq[rank] = myCpuFreq;
 
-    //replicate all frequencies in all PEs
-    comm->sumImpl( allCpuFreq.data(), allCpuFreq.data(), numPEs, scai::common::TypeTraits<IndexType>::stype );
+        //replicate all frequencies in all PEs
+        comm->sumImpl( allCpuFreq.data(), allCpuFreq.data(), numPEs, scai::common::TypeTraits<IndexType>::stype );
 
-    const IndexType sumCpuFreq = std::accumulate( allCpuFreq.begin(), allCpuFreq.end(), 0 );
+        const IndexType sumCpuFreq = std::accumulate( allCpuFreq.begin(), allCpuFreq.end(), 0 );
 
-    //set first weight relevant to the CPU frequency
+        //set first weight relevant to the CPU frequency
 
-    for( int i=0; i<numPEs; i++){
-        retWeights[0][i] = ((vType) allCpuFreq[i]) /sumCpuFreq;
+        for( int i=0; i<numPEs; i++){
+            retWeights[0][i] = ((vType) allCpuFreq[i]) /sumCpuFreq;
+        }
     }
 
     //memory
@@ -569,11 +760,31 @@ ITI::CommTree<IndexType,ValueType> createCommTree(
             }
         }
 
+    }else if( settings.autoTopology ){
+        std::vector<double> distances;
+        const std::vector<IndexType> levels = discoverHierarchy( comm, distances, settings.probeLatency );
+
+        if( levels.empty() or settings.numBlocks!=comm->getSize() ){
+            if( comm->getRank()==0 ){
+                std::cout << "WARNING: could not build a hierarchy with one block per PE from the topology, using a flat tree" << std::endl;
+            }
+            commTree.createFlatHomogeneous( settings.numBlocks, nodeWeights.size() );
+        }else{
+            settings.hierLevels = levels;
+            settings.processPerNode = nodeLocalRank(comm).second;
+            if( settings.autoSetCpuMem ){
+                std::vector<std::vector<ValueType>> blockWeights = calculateLoadRequests<ValueType>(comm, settings.processPerNode, settings.measureSpeed, settings.speedCacheFile);
+                commTree.createHierHeterogeneous( blockWeights, std::vector<bool>{true, false}, levels );
+                commTree.setDistances( std::vector<ValueType>(distances.begin(), distances.end()) );
+            }else{
+                commTree.createHierHomogeneous( levels, std::vector<ValueType>(distances.begin(), distances.end()), nodeWeights.size() );
+            }
+        }
     }else if( settings.hierLevels.size()!=0 ){
         if( settings.autoSetCpuMem ){
             //the number of process or cores in each compute node
             const int coresPerNode = settings.hierLevels.back(); 
-            std::vector<std::vector<ValueType>> blockWeights = calculateLoadRequests<ValueType>(comm, coresPerNode);
+            std::vector<std::vector<ValueType>> blockWeights = calculateLoadRequests<ValueType>(comm, coresPerNode, settings.measureSpeed, settings.speedCacheFile);
             commTree.createFlatHeterogeneous( blockWeights, std::vector<bool>{true, false}  );
         }else if( vm.count("distance_parameter_string") ){
             SCAI_ASSERT( !vm.count("blockSizesFile"), "conflicting arguments");
@@ -598,7 +809,7 @@ ITI::CommTree<IndexType,ValueType> createCommTree(
             commTree.createFromLevels(settings.hierLevels, numWeights );
         }
     }else if( settings.autoSetCpuMem){
-        std::vector<std::vector<ValueType>> blockWeights = calculateLoadRequests<ValueType>(comm, settings.processPerNode);
+        std::vector<std::vector<ValueType>> blockWeights = calculateLoadRequests<ValueType>(comm, settings.processPerNode, settings.measureSpeed, settings.speedCacheFile);
         commTree.createFlatHeterogeneous( blockWeights, std::vector<bool>{true, false} );
     } else {
         commTree.createFlatHomogeneous( settings.numBlocks, nodeWeights.size() );
@@ -610,4 +821,318 @@ ITI::CommTree<IndexType,ValueType> createCommTree(
 }
 
 
+/** Serve partition requests on settings.serviceSocket until a shutdown request, \sa PartitionService.
+    Every request is handled like a run of the driver with the options of the request. The input of the last
+    request is kept and reused if the next request has the same input options and the graph file was not modified.
+    The reply is "ok" followed by the metrics as name=value pairs, or "error" followed by the message.
+    @param[in] serviceSettings The settings of the service call, only serviceSocket is used.
+    @param[in] comm The communicator
+*/
+template <typename ValueType>
+void runPartitionService( const Settings& serviceSettings, const scai::dmemo::CommunicatorPtr& comm ){
+
+    PartitionService service( serviceSettings.serviceSocket, comm );
+    MSG0( "Partition service listening on " << serviceSettings.serviceSocket );
+
+    //the options that determine the input data
+    const std::vector<std::string> inputOptions = { "graphFile", "coordFile", "fileFormat", "coordFormat", "numNodeWeights", "dimensions",
+        "generate", "numX", "numY", "numZ", "quadTreeFile", "useDiffusionCoordinates", "useGraphEmbedding", "autoSetCpuMem" };
+
+    //input of the last request, partitionGraph redistributes its arguments so every request works on a copy
+    std::string cachedKey;
+    scai::lama::CSRSparseMatrix<ValueType> cachedGraph;
+    std::vector<scai::lama::DenseVector<ValueType>> cachedCoordinates;
+    std::vector<scai::lama::DenseVector<ValueType>> cachedNodeWeights;
+    IndexType cachedNumNodeWeights = 0;
+
+    std::vector<std::string> args;
+    while( service.nextRequest(args) ){
+        std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
+        std::ostringstream answer;
+
+        try{
+            std::vector<std::string> words = args;
+            words.insert( words.begin(), "GeographerService" );
+            std::vector<char*> argvVec;
+            for( std::string& word : words ){
+                argvVec.push_back( &word[0] );
+            }
+            int argc = argvVec.size();
+            char** argv = argvVec.data();
+            const int prevArgc = argc;
+
+            cxxopts::Options options = ITI::populateOptions();
+            cxxopts::ParseResult vm = options.parse( argc, argv );
+            Settings settings = initialize( prevArgc, argv, vm, comm );
+
+            std::string key;
+            for( const cxxopts::KeyValue& option : vm.arguments() ){
+                if( std::find( inputOptions.begin(), inputOptions.end(), option.key() )!=inputOptions.end() ){
+                    key += option.key()+ "="+ option.value()+ " ";
+                }
+            }
+            if( vm.count("graphFile") ){
+                //an input file written again in place must be read again; the node weights are part of the graph file
+                const std::string graphFile = vm["graphFile"].as<std::string>();
+                const std::string coordFile = vm.count("coordFile") ? vm["coordFile"].as<std::string>() : graphFile + ".xyz";
+                std::string fileKey;
+                if( comm->getRank()==0 ){
+                    for( const std::string& file : {graphFile, coordFile} ){
+                        struct stat fileStat;
+                        if( stat( file.c_str(), &fileStat )==0 ){
+                            fileKey += "modified="+ std::to_string( fileStat.st_mtim.tv_sec )+ "."+ std::to_string( fileStat.st_mtim.tv_nsec )+ " size="+ std::to_string( fileStat.st_size )+ " ";
+                        }else{
+                            fileKey += "missing ";
+                        }
+                    }
+                }
+                comm->bcast( fileKey, 0 );
+                key += fileKey;
+            }
+
+            scai::lama::CSRSparseMatrix<ValueType> graph;
+            std::vector<scai::lama::DenseVector<ValueType>> coordinates( settings.dimensions );
+            std::vector<scai::lama::DenseVector<ValueType>> nodeWeights;
+
+            if( not cachedKey.empty() and key==cachedKey ){
+                graph = cachedGraph;
+                coordinates = cachedCoordinates;
+                nodeWeights = cachedNodeWeights;
+                settings.numNodeWeights = cachedNumNodeWeights;
+                MSG0( "Reusing the input of the last request" );
+            }else{
+                cachedKey.clear();
+                readInput<ValueType>( vm, settings, comm, graph, coordinates, nodeWeights );
+                cachedGraph = graph;
+                cachedCoordinates = coordinates;
+                cachedNodeWeights = nodeWeights;
+                cachedNumNodeWeights = settings.numNodeWeights;
+                cachedKey = key;
+            }
+            const IndexType N = graph.getNumRows();
+
+            if( settings.autoTune ){
+                settings = ITI::AutoTuner<IndexType, ValueType>::tune( graph, coordinates, nodeWeights, settings );
+            }
+            if( settings.setAutoSettings ){
+                settings = settings.setDefault( graph );
+            }
+            settings.isValid = settings.checkValidity(comm);
+            if( !settings.isValid ){
+                throw std::runtime_error("Settings struct is not valid, check the input parameter values.");
+            }
+
+            ITI::CommTree<IndexType,ValueType> commTree = createCommTree( vm, settings, comm, nodeWeights );
+            commTree.adaptWeights( nodeWeights );
+
+            scai::lama::DenseVector<IndexType> previous;
+            if( vm.count("previousPartition") ){
+                previous = ITI::FileIO<IndexType, ValueType>::readPartition( vm["previousPartition"].as<std::string>(), N );
+                settings.repartition = true;
+            }
+
+            Metrics<ValueType> metrics( settings );
+            scai::lama::DenseVector<IndexType> partition = ITI::ParcoRepart<IndexType, ValueType>::partitionGraph( graph, coordinates, nodeWeights, previous, commTree, comm, settings, metrics );
+            if( !comm->all( partition.getDistribution().isEqual( graph.getRowDistribution() ) ) ){
+                partition.redistribute( graph.getRowDistributionPtr() );
+            }
+            metrics.getMetrics( graph, partition, nodeWeights, settings, commTree );
+
+            answer << "ok n=" << N << " k=" << settings.numBlocks;
+            if( settings.outFile!="-" ){
+                //the global ids are kept by the redistributions, the file is written from a block distribution
+                const scai::dmemo::DistributionPtr blockDist( new scai::dmemo::BlockDistribution( N, comm ) );
+                partition.redistribute( blockDist );
+                const std::string partOutFile = settings.outFile+ ".part";
+                ITI::FileIO<IndexType, ValueType>::writePartitionParallel( partition, partOutFile );
+                answer << " partFile=" << partOutFile;
+            }
+            for( const auto& metric : metrics.MM ){
+                if( metric.second!=-1 ){
+                    answer << " " << metric.first << "=" << metric.second;
+                }
+            }
+            std::chrono::duration<double> requestTime = std::chrono::steady_clock::now() - startTime;
+            answer << " requestTime=" << comm->max( requestTime.count() );
+        }catch( const std::exception& e ){
+            std::string message = e.what();
+            std::replace( message.begin(), message.end(), '\n', ' ' );
+            answer.str( "" );
+            answer << "error " << message;
+        }
+
+        std::string request;
+        for( const std::string& word : args ){
+            request += word+ " ";
+        }
+        MSG0( "Request: " << request << "\n\treply: " << answer.str() );
+        service.reply( answer.str() );
+    }
+
+    service.reply( "ok shutdown" );
+    MSG0( "Partition service stopped" );
+}
+
+
+/** Partition a sequence of inputs, e.g. the time steps of a simulation, in one run, \sa FileIO::readFileList.
+    The communication tree and the autotuned settings of the first step are used for all steps. The partition of a
+    step is the previous partition of the next step if the number of vertices did not change. For every step the
+    metrics are printed and, as for a single run, stored in outFile_<step> and the partition in outFile_<step>.part.
+
+    A step with the same graph file as the step before only changes the coordinates and node weights: the graph is
+    not read again but kept in the distribution the previous step left it in, so the halo plans of this distribution,
+    \sa GraphUtils::buildNeighborHalo, stay valid as well. The node weights come from the weight file of the step or,
+    without one, are kept from the previous step.
+
+    The next step is not parsed while the current one is partitioned: the readers are collective LAMA operations
+    on comm, and a reader thread would need its own communicator and MPI_THREAD_MULTIPLE. Instead, a background
+    thread only reads the files of the next step into the page cache, \sa FileIO::prefetchFile.
+    @param[in] vm The virtual machine with the input parameters
+    @param[in] settings The settings of the run, settings.batchFiles gives the inputs
+    @param[in] comm The communicator
+*/
+template <typename ValueType>
+void runBatch( const cxxopts::ParseResult& vm, Settings settings, const scai::dmemo::CommunicatorPtr& comm ){
+
+    const std::vector<ITI::BatchFiles> files = ITI::FileIO<IndexType, ValueType>::readFileList( settings.batchFiles );
+    if( files.empty() ){
+        throw std::runtime_error("No input files found for " + settings.batchFiles);
+    }
+    MSG0( "Partitioning a batch of " << files.size() << " inputs" );
+
+    //the checkpoints of the stages have no step, a later step would resume from the state of an earlier one
+    if( settings.checkpointDir!="-" ){
+        MSG0( "WARNING: checkpoints are not supported for a batch of inputs, checkpointDir is ignored" );
+        settings.checkpointDir = "-";
+        settings.resumeFrom = "-";
+    }
+
+    auto sameGraph = [&files]( const std::size_t step ){
+        return step>0 and files[step].graphFile==files[step-1].graphFile;
+    };
+
+    //every process of a compute node reads a part of the next files, together they read them once per node
+    const std::pair<int,int> nodeRank = nodeLocalRank( comm );
+    auto prefetch = [nodeRank]( const ITI::BatchFiles stepFiles, const bool withGraph ){
+        if( withGraph ){
+            ITI::FileIO<IndexType, ValueType>::prefetchFile( stepFiles.graphFile, nodeRank.first, nodeRank.second );
+        }
+        ITI::FileIO<IndexType, ValueType>::prefetchFile( stepFiles.coordFile, nodeRank.first, nodeRank.second );
+        if( not stepFiles.weightFile.empty() ){
+            ITI::FileIO<IndexType, ValueType>::prefetchFile( stepFiles.weightFile, nodeRank.first, nodeRank.second );
+        }
+    };
+    std::thread prefetcher;
+
+    ITI::CommTree<IndexType,ValueType> commTree;
+    scai::lama::DenseVector<IndexType> previous;
+
+    //kept for the next step if its graph file is the same
+    scai::lama::CSRSparseMatrix<ValueType> graph;
+    std::vector<scai::lama::DenseVector<ValueType>> nodeWeights;
+    IndexType N = 0;
+
+    try{
+        for( std::size_t step=0; step<files.size(); step++ ){
+            std::chrono::time_point<std::chrono::steady_clock> beforeRead = std::chrono::steady_clock::now();
+            if( prefetcher.joinable() ){
+                prefetcher.join();
+            }
+
+            std::vector<scai::lama::DenseVector<ValueType>> coordinates( settings.dimensions );
+            if( sameGraph(step) ){
+                //only the vertex data changed, bring it to the distribution of the kept graph
+                const scai::dmemo::DistributionPtr graphDist = graph.getRowDistributionPtr();
+                coordinates = ITI::FileIO<IndexType, ValueType>::readCoords( files[step].coordFile, N, settings.dimensions, comm );
+                for( scai::lama::DenseVector<ValueType>& coord : coordinates ){
+                    coord.redistribute( graphDist );
+                }
+                if( not files[step].weightFile.empty() ){
+                    nodeWeights = ITI::FileIO<IndexType, ValueType>::readCoords( files[step].weightFile, N, nodeWeights.size(), comm );
+                }
+                for( scai::lama::DenseVector<ValueType>& weights : nodeWeights ){
+                    weights.redistribute( graphDist );
+                }
+                MSG0( "step " << step << ": same graph as the previous step, read only coordinates and weights" );
+            }else{
+                N = readFileInput<ValueType>( files[step].graphFile, files[step].coordFile, vm, settings, comm, graph, coordinates, nodeWeights );
+                if( not files[step].weightFile.empty() ){
+                    nodeWeights = ITI::FileIO<IndexType, ValueType>::readCoords( files[step].weightFile, N, nodeWeights.size(), comm );
+                    for( scai::lama::DenseVector<ValueType>& weights : nodeWeights ){
+                        weights.redistribute( graph.getRowDistributionPtr() );
+                    }
+                }
+            }
+            if( not aux<IndexType,ValueType>::checkConsistency( graph, coordinates, nodeWeights, settings) ){
+                throw std::runtime_error("Input " + files[step].graphFile + " not consistent.");
+            }
+            std::chrono::duration<double> readTime = std::chrono::steady_clock::now() - beforeRead;
+
+            if( step+1<files.size() ){
+                prefetcher = std::thread( prefetch, files[step+1], not sameGraph(step+1) );
+            }
+
+            if( step==0 ){
+                if( settings.autoTune ){
+                    settings = ITI::AutoTuner<IndexType, ValueType>::tune( graph, coordinates, nodeWeights, settings );
+                }
+                commTree = createCommTree( vm, settings, comm, nodeWeights );
+            }
+            commTree.adaptWeights( nodeWeights );
+
+            Settings stepSettings = settings.setAutoSettings ? settings.setDefault( graph ) : settings;
+            stepSettings.isValid = stepSettings.checkValidity(comm);
+            if( !stepSettings.isValid ){
+                throw std::runtime_error("Settings struct is not valid, check the input parameter values.");
+            }
+
+            //the previous partition refers to the same vertices only if their number did not change
+            if( comm->all( previous.size()==N ) ){
+                stepSettings.repartition = true;
+                previous.redistribute( graph.getRowDistributionPtr() );
+            }else{
+                previous = scai::lama::DenseVector<IndexType>();
+            }
+
+            Metrics<ValueType> metrics( stepSettings );
+            scai::lama::DenseVector<IndexType> partition = ITI::ParcoRepart<IndexType, ValueType>::partitionGraph( graph, coordinates, nodeWeights, previous, commTree, comm, stepSettings, metrics );
+            if( !comm->all( partition.getDistribution().isEqual( graph.getRowDistribution() ) ) ){
+                partition.redistribute( graph.getRowDistributionPtr() );
+            }
+            metrics.getMetrics( graph, partition, nodeWeights, stepSettings, commTree );
+            metrics.MM["inputTime"] = ValueType( comm->max( readTime.count() ) );
+
+            if( comm->getRank()==0 ){
+                std::cout << "step " << step << " input:" << files[step].graphFile << " k:" << stepSettings.numBlocks << std::endl;
+                metrics.printHorizontal2( std::cout );
+            }
+
+            if( settings.outFile!="-" ){
+                const std::string stepFile = settings.outFile+ "_"+ std::to_string(step);
+                if( settings.storeInfo and comm->getRank()==0 ){
+                    std::ofstream outF( stepFile, std::ios::out );
+                    if( outF.is_open() ){
+                        outF << "input: " << files[step].graphFile << std::endl;
+                        stepSettings.print( outF, comm );
+                        metrics.print( outF );
+                    }
+                }
+                if( settings.storePartition ){
+                    //the global ids are kept by the redistributions, the file is written in the block distribution
+                    scai::lama::DenseVector<IndexType> blockPartition( partition );
+                    blockPartition.redistribute( scai::dmemo::DistributionPtr( new scai::dmemo::BlockDistribution( N, comm ) ) );
+                    ITI::FileIO<IndexType, ValueType>::writePartitionParallel( blockPartition, stepFile+ ".part" );
+                }
+            }
+
+            previous = partition;
+        }
+    }catch( ... ){
+        if( prefetcher.joinable() ){
+            prefetcher.join();
+        }
+        throw;
+    }
+}
+
 }//namespace ITI
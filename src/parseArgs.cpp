@@ -3,6 +3,7 @@
 
 #include "parseArgs.h"
 #include "Settings.h"
+#include "Checkpoint.h"
 
 using namespace cxxopts;
 
@@ -35,15 +36,27 @@ Options populateOptions() {
     ("autoSetCpuMem", "if set, geographer will gather cpu and memory info and use them to build a heterogeneous communication tree used for partitioning")
     ("w2UpperBound", "if true, when given a file with the block sizes or the topology, treat the second weight as an upper bound (usually, this is used so the second weight corresponds to the memory capacity of the PEs)")
     ("processPerNode", "the number of processes per compute node. Is used with autoSetCpuMem to determine the internal cpu/core ID within a compute node and query the cpu frequency.",  value<IndexType>())
+    ("autoTopology", "build a hierarchical communication tree from the hosts and the NUMA domains the PEs run on. Replaces hierLevels and sets processPerNode. Works if the PEs of every host and NUMA domain have consecutive ranks, otherwise a flat tree is used.")
+    ("probeLatency", "with autoTopology, measure the distances between the levels of the hierarchy with a ping-pong instead of using a factor of 10 per level")
+    ("measureSpeed", "with autoSetCpuMem, every PE runs a short SpMV kernel and its measured throughput is used instead of the cpu frequency. All PEs measure at the same time, so sharing cores or memory bandwidth is taken into account.")
+    ("speedCacheFile", "with measureSpeed, file that stores the measured speed of every process, identified by host and rank on the host. A new measurement is averaged with the stored one.", value<std::string>())
     ("useMemFromFile", "when a topology or block sizes file is given, if true, use the actual values in the file for memory. otherwise set the max memory to 1.2*number of graph rows.")
     ("mappingRenumbering", "map blocks to PEs using the SFC index of the block's center. This works better when PUs are numbered consecutively." )
+    ("threadAffinity", "pin the OpenMP threads of every process. none: keep the binding of the MPI launcher, compact: consecutive cores for the processes of a host, spread: processes round robin over the NUMA domains and their threads inside the domain. The placement is printed at startup.", value<std::string>())
     ("hierarchy_parameter_string", "a sequence of h number separated by : that indicate the structure of a tree-like architecture from leaves to root. For example, the system 12:4:2 has 2 nodes that each has 4 sockets (for example) and each socket has 12 cores, summing to 12*4*2=96 PEs", value<std::string>() )
     ("distance_parameter_string", "The communication costs between PEs that belong to different subtrees of a tree-like system from leaves to root. For example, 1:10:500 means that two leaves/PEs with the same socket have communication cost 1, to leaves/PEs in different sockets but in the same node have communication cost 10 and two leaves/PEs in different nodes have cost 500", value<std::string>())
     //repartitioning
     ("previousPartition", "file of previous partition, used for repartitioning", value<std::string>())
     //multi-level and local refinement
-    ("initialPartition", "Choose initial partitioning method between space-filling curves (geoSFC), balanced k-means (geoKmeans) or the hierarchical version (geoHierKM) and MultiJagged (geoMS). If parmetis or zoltan are installed, you can also choose to partition with them using for example, parMetisGraph or zoltanMJ. For more information, see src/Settings.h file.", value<std::string>())
+    ("initialPartition", "Choose initial partitioning method between space-filling curves (geoSFC), balanced k-means (geoKmeans) or the hierarchical version (geoHierKM) and MultiJagged (geoMS), or a one-pass streaming partition of the graph (geoStream). If parmetis or zoltan are installed, you can also choose to partition with them using for example, parMetisGraph or zoltanMJ. For more information, see src/Settings.h file.", value<std::string>())
     ("initialMigration", "The preprocessing step to distribute data before calling the partitioning algorithm", value<std::string>())
+    ("streamingScore", "With --initialPartition geoStream, the score of the blocks when a vertex is assigned: ldg or fennel", value<std::string>())
+    ("minLocalVertices", "If the input has fewer vertices per PE, it is gathered and partitioned on fewer PEs, so that every PE has at least that many. Default is 0, always use all PEs", value<IndexType>())
+    ("multiStarts", "Compute that many initial partitions at the same time on disjoint groups of PEs, or in threads on a single PE, every one with a different seed, and keep the best. Needs a k-means initial partition. Local refinement is done afterwards for the best partition only.", value<IndexType>())
+    ("multiStartObjective", "How the initial partitions of --multiStarts are compared: cut, maxCommVolume or imbalance", value<std::string>())
+    ("timeBudget", "Wall clock seconds for the partitioning. k-means, balancing and local refinement stop early and keep the most balanced solution found so far; optional phases are skipped when the budget is nearly used. 0 for no limit", value<double>())
+    ("initialBudgetShare", "Fraction of the time budget for the initial partition, the rest is for local refinement", value<double>())
+    ("localReordering", "Reorder the local vertices of every PE during the local refinement to improve cache locality: none, sfc (Hilbert curve order) or rcm (reverse Cuthill-McKee). The partition is written in the original numbering.", value<std::string>())
     ("noRefinement", "skip local refinement steps")
     ("multiLevelRounds", "Tuning Parameter: How many multi-level rounds with coarsening to perform", value<IndexType>()->default_value(std::to_string(settings.multiLevelRounds)))
     ("minBorderNodes", "Tuning parameter: Minimum number of border nodes used in each refinement step", value<IndexType>())
@@ -73,14 +86,25 @@ Options populateOptions() {
     ("erodeInfluence", "Tuning parameter for K-Means, in case of large deltas and imbalances.")
     ("KMBalanceMethod", "used in KMeans to partition targeting for a better imbalance. Possible values are 'repart', 'reb_lex' and 'reb_sqImba'. First repartition, the two other apply a rebalance method and repartition.", value<std::string>())
     ("focusOnBalance", "Used in hierarchical versions of K-Means to rebalance at every step.")
+    //autotuning
+    ("autoTune", "Choose sfcResolution, minSamplingNodes, influenceChangeCap and batchPercent by running k-means on a sample of the input for a few candidates. The fastest configuration within epsilon is used.")
+    ("tuningDBFile", "With autoTune, file with the chosen parameters per input features (size, maximum degree, dimensions, k and p). A stored entry is used instead of probing, new results are added.", value<std::string>())
+    ("tuningSampleFraction", "With autoTune, fraction of the points used to probe the parameters", value<double>())
+    ("checkpointDir", "Directory to write a checkpoint of the distributed state after reading the input, the migration before k-means, the initial partition and the local refinement", value<std::string>())
+    ("resume", "With checkpointDir, continue from the latest checkpoint up to the given stage: input, migrated, initial, refined or last. E.g. resume=initial repeats only the local refinement", value<std::string>())
     // using '/' to separate the lines breaks the output message
     ("hierLevels", "The number of blocks per level starting from the leaves. Total number of PEs (=number of leaves) is the product for all hierLevels[i] and there are hierLevels.size() hierarchy levels. Example: --hierLevels 10,4,3 there are 3 levels. In the first/top one, each node has 3 children, in the next one each node has 4 and in the last, each node has 10. In total 3*4*10= 120 leaves/PEs", value<std::string>())
     //output
     ("outFile", "write result partition into file", value<std::string>())
+    ("batchFiles", "Partition a sequence of inputs, e.g. time steps, in one run. A glob pattern of graph files or a file with one graph file, optionally followed by its coordinate file and a node weight file, per line. A step with the graph file of the previous step only reads its coordinates and weights and keeps the distributed graph. The partition of a step is the previous partition of the next", value<std::string>())
+    ("service", "Stay resident and partition the requests sent to this Unix domain socket. A request is one line with the options of a run, the input given by file paths. The request shutdown stops the service", value<std::string>())
+    ("outOfCoreSFC", "Partition the points of a coordinate file that does not fit into memory with a space filling curve, streaming the file twice. Reads coordFile, or graphFile with .xyz appended, and writes the block ids to outFile", value<bool>())
     ("redistAndStore", "redistribute and store the graph after partitioning", value<bool>())
     //debug
     ("writeDebugCoordinates", "Write Coordinates of nodes in each block", value<bool>())
     ("writePEgraph", "Write the processor graph to a file", value<bool>())
+    ("storeHaloPlan", "Write the neighbor blocks, send and receive lists of every block to the binary file outFile.halo")
+    ("blockRenumbering", "Write the new id of every vertex in a numbering that is contiguous per block to outFile.perm, ordered within the blocks by sfc (Hilbert curve) or rcm (reverse Cuthill-McKee)", value<std::string>())
     ("verbose", "Increase output.")
     ("debugMode", "Increase output and more expensive checks")
     ("storeInfo", "Store timing and other metrics in file.")
@@ -98,6 +122,7 @@ Options populateOptions() {
     //used for the competitors main
     ("outDir", "write result partition into folder", value<std::string>())
     ("tools", "choose which supported tools to use. For multiple tool use comma to separate without spaces. See in Settings::Tools for the supported tools and how to call them.", value<std::string>() )
+    ("concurrentGroups", "split the PEs into that many groups of consecutive ranks. Every group gets its own copy of the input and the tools are run round robin on the groups at the same time. The metrics of all runs are gathered at the end.", value<IndexType>() )
     //mesh generation
     ("generate", "generate uniform mesh as input graph")
     ("numX", "Number of points in x dimension of generated graph", value<IndexType>())
@@ -106,6 +131,10 @@ Options populateOptions() {
     // exotic test cases
     ("quadTreeFile", "read QuadTree from file", value<std::string>())
     ("useDiffusionCoordinates", "Use coordinates based from diffusive systems instead of loading from file", value<bool>())
+    ("useGraphEmbedding", "Compute coordinates with a multilevel embedding of the graph instead of loading from file")
+    ("embeddingCoarsestSize", "Coarsen the graph for the embedding until it has at most that many vertices", value<IndexType>()->default_value(std::to_string(settings.embeddingCoarsestSize)))
+    ("embeddingSmoothingSteps", "Smoothing steps on every level of the embedding", value<IndexType>()->default_value(std::to_string(settings.embeddingSmoothingSteps)))
+    ("embeddingMethod", "Embedding of the coarsest graph: diffusion or spectral, with the eigenvectors of the Laplacian for the smallest non-zero eigenvalues", value<std::string>())
 	//("myAlgoParam", "help message", value<int>())
     ;
 
@@ -132,7 +161,9 @@ Settings interpretSettings(cxxopts::ParseResult vm) {
         return settings;
     }
 
-    if (vm.count("generate") + vm.count("graphFile") + vm.count("quadTreeFile") != 1) {
+    //the service gets the input with every request, a batch from its file list, the out-of-core partition only needs coordinates
+    const bool onlyCoordFile = vm.count("outOfCoreSFC") && vm.count("coordFile");
+    if (!vm.count("service") && !vm.count("batchFiles") && !onlyCoordFile && vm.count("generate") + vm.count("graphFile") + vm.count("quadTreeFile") != 1) {
         std::cout << "Call with --graphFile <input>. Use --help for more parameters." << std::endl;
         settings.isValid = false;
         //return 126;
@@ -169,6 +200,24 @@ Settings interpretSettings(cxxopts::ParseResult vm) {
         settings.storeInfo = true;
     }
 
+    if (vm.count("batchFiles")) {
+        settings.batchFiles = vm["batchFiles"].as<std::string>();
+    }
+
+    if (vm.count("outOfCoreSFC")) {
+        settings.outOfCoreSFC = vm["outOfCoreSFC"].as<bool>();
+        if (settings.outOfCoreSFC && !vm.count("outFile")) {
+            if (comm->getRank() == 0) {
+                std::cout << "Call outOfCoreSFC with --outFile to store the partition." << std::endl;
+            }
+            settings.isValid = false;
+        }
+    }
+
+    if (vm.count("service")) {
+        settings.serviceSocket = vm["service"].as<std::string>();
+    }
+
     if (vm.count("outDir")) {
         settings.outDir = vm["outDir"].as<std::string>();
         settings.storeInfo = true;
@@ -190,6 +239,46 @@ Settings interpretSettings(cxxopts::ParseResult vm) {
         }
     }
 
+    if (vm.count("localReordering")) {
+        settings.localReordering = vm["localReordering"].as<std::string>();
+        if( not (settings.localReordering=="none" or settings.localReordering=="sfc" or settings.localReordering=="rcm") ) {
+            if(comm->getRank() ==0 ) {
+                std::cout<<"WARNING: wrong value for parameter localReordering= " << settings.localReordering << ". Setting to none" <<std::endl;
+            }
+            settings.localReordering="none";
+        }
+    }
+
+    if (vm.count("blockRenumbering")) {
+        settings.blockRenumbering = vm["blockRenumbering"].as<std::string>();
+        if( not (settings.blockRenumbering=="none" or settings.blockRenumbering=="sfc" or settings.blockRenumbering=="rcm") ) {
+            if(comm->getRank() ==0 ) {
+                std::cout<<"WARNING: wrong value for parameter blockRenumbering= " << settings.blockRenumbering << ". Setting to none" <<std::endl;
+            }
+            settings.blockRenumbering="none";
+        }
+    }
+
+    if (vm.count("embeddingMethod")) {
+        settings.embeddingMethod = vm["embeddingMethod"].as<std::string>();
+        if( not (settings.embeddingMethod=="diffusion" or settings.embeddingMethod=="spectral") ) {
+            if(comm->getRank() ==0 ) {
+                std::cout<<"WARNING: wrong value for parameter embeddingMethod= " << settings.embeddingMethod << ". Setting to diffusion" <<std::endl;
+            }
+            settings.embeddingMethod="diffusion";
+        }
+    }
+
+    if (vm.count("threadAffinity")) {
+        settings.threadAffinity = vm["threadAffinity"].as<std::string>();
+        if( not (settings.threadAffinity=="none" or settings.threadAffinity=="compact" or settings.threadAffinity=="spread") ) {
+            if(comm->getRank() ==0 ) {
+                std::cout<<"WARNING: wrong value for parameter threadAffinity= " << settings.threadAffinity << ". Setting to none" <<std::endl;
+            }
+            settings.threadAffinity="none";
+        }
+    }
+
     if( vm.count("noComputeDiameter") ) {
         settings.computeDiameter = false;
     } else {
@@ -207,6 +296,9 @@ Settings interpretSettings(cxxopts::ParseResult vm) {
     settings.keepMostBalanced = vm.count("keepMostBalanced");
     settings.noRefinement = vm.count("noRefinement");
     settings.useDiffusionCoordinates = vm.count("useDiffusionCoordinates");
+    settings.useGraphEmbedding = vm.count("useGraphEmbedding");
+    settings.embeddingCoarsestSize = vm["embeddingCoarsestSize"].as<IndexType>();
+    settings.embeddingSmoothingSteps = vm["embeddingSmoothingSteps"].as<IndexType>();
     settings.gainOverBalance = vm.count("gainOverBalance");
     settings.useDiffusionTieBreaking = vm.count("useDiffusionTieBreaking");
     settings.useGeometricTieBreaking = vm.count("useGeometricTieBreaking");
@@ -215,9 +307,24 @@ Settings interpretSettings(cxxopts::ParseResult vm) {
     settings.bisect = vm.count("bisect");
     settings.writeDebugCoordinates = vm.count("writeDebugCoordinates");
     settings.writePEgraph = vm.count("writePEgraph");
+    settings.storeHaloPlan = vm.count("storeHaloPlan");
     settings.setAutoSettings = vm.count("autoSettings");
     settings.mappingRenumbering = vm.count("mappingRenumbering");
     settings.autoSetCpuMem = vm.count("autoSetCpuMem");
+    settings.autoTopology = vm.count("autoTopology");
+    settings.probeLatency = vm.count("probeLatency");
+    if( settings.autoTopology and (vm.count("hierLevels") or vm.count("hierarchy_parameter_string") or vm.count("topologyFile") or vm.count("blockSizesFile") or vm.count("PEgraphFile")) ){
+        throw std::invalid_argument("Conflicting arguments, autoTopology cannot be combined with a given hierarchy, topology, block sizes or PE graph");
+    }
+    settings.measureSpeed = vm.count("measureSpeed");
+    if (vm.count("speedCacheFile")) {
+        settings.speedCacheFile = vm["speedCacheFile"].as<std::string>();
+    }
+    if( settings.measureSpeed and not settings.autoSetCpuMem ){
+        if(comm->getRank() ==0 ) {
+            std::cout<<"WARNING: option measureSpeed only has an effect together with autoSetCpuMem" <<std::endl;
+        }
+    }
     settings.w2UpperBound = vm.count("w2UpperBound");
     settings.useMemFromFile = vm.count("useMemFromFile");
 
@@ -338,6 +445,39 @@ Settings interpretSettings(cxxopts::ParseResult vm) {
     if (vm.count("influenceChangeCap")) {
         settings.influenceChangeCap = vm["influenceChangeCap"].as<double>();
     }
+    if (vm.count("autoTune")) {
+        settings.autoTune = true;
+    }
+    if (vm.count("tuningDBFile")) {
+        settings.tuningDBFile = vm["tuningDBFile"].as<std::string>();
+        if( not settings.autoTune and comm->getRank()==0 ){
+            std::cout<<"WARNING: tuningDBFile is only used with autoTune" <<std::endl;
+        }
+    }
+    if (vm.count("tuningSampleFraction")) {
+        settings.tuningSampleFraction = vm["tuningSampleFraction"].as<double>();
+        if( settings.tuningSampleFraction<=0 or settings.tuningSampleFraction>1 ){
+            if(comm->getRank() ==0 ) {
+                std::cout<<"WARNING: wrong value for parameter tuningSampleFraction= " << settings.tuningSampleFraction << ". Setting to 0.1" <<std::endl;
+            }
+            settings.tuningSampleFraction = 0.1;
+        }
+    }
+    if (vm.count("checkpointDir")) {
+        settings.checkpointDir = vm["checkpointDir"].as<std::string>();
+    }
+    if (vm.count("resume")) {
+        settings.resumeFrom = vm["resume"].as<std::string>();
+        if( settings.resumeFrom!="last" and Checkpoint<IndexType,double>::stageIndex(settings.resumeFrom)<0 ){
+            if(comm->getRank() ==0 ) {
+                std::cout<<"WARNING: wrong value for parameter resume= " << settings.resumeFrom << ". Setting to last" <<std::endl;
+            }
+            settings.resumeFrom = "last";
+        }
+        if( settings.checkpointDir=="-" and comm->getRank()==0 ){
+            std::cout<<"WARNING: resume is only used with checkpointDir" <<std::endl;
+        }
+    }
     if (vm.count("balanceIterations")) {
         settings.balanceIterations = vm["balanceIterations"].as<IndexType>();
     }
@@ -422,6 +562,72 @@ Settings interpretSettings(cxxopts::ParseResult vm) {
         }
     }
 
+    if (vm.count("streamingScore")) {
+        settings.streamingScore = vm["streamingScore"].as<std::string>();
+        if( not (settings.streamingScore=="ldg" or settings.streamingScore=="fennel") ) {
+            if(comm->getRank() ==0 ) {
+                std::cout<<"WARNING: wrong value for parameter streamingScore= " << settings.streamingScore << ". Setting to fennel" <<std::endl;
+            }
+            settings.streamingScore="fennel";
+        }
+    }
+
+    if (vm.count("minLocalVertices")) {
+        settings.minLocalVertices = vm["minLocalVertices"].as<IndexType>();
+        if( settings.minLocalVertices<0 ){
+            if(comm->getRank() ==0 ) {
+                std::cout<<"WARNING: wrong value for parameter minLocalVertices= " << settings.minLocalVertices << ". Setting to 0 (use all PEs)" <<std::endl;
+            }
+            settings.minLocalVertices = 0;
+        }
+    }
+
+    if (vm.count("multiStarts")) {
+        settings.multiStarts = vm["multiStarts"].as<IndexType>();
+        if( settings.multiStarts<1 ){
+            if(comm->getRank() ==0 ) {
+                std::cout<<"WARNING: wrong value for parameter multiStarts= " << settings.multiStarts << ". Setting to 1" <<std::endl;
+            }
+            settings.multiStarts = 1;
+        }
+        if( settings.multiStarts>1 and settings.repartition ){
+            if(comm->getRank() ==0 ) {
+                std::cout<<"WARNING: multiStarts is not supported for repartitioning. Setting to 1" <<std::endl;
+            }
+            settings.multiStarts = 1;
+        }
+    }
+
+    if (vm.count("multiStartObjective")) {
+        settings.multiStartObjective = vm["multiStartObjective"].as<std::string>();
+        if( not (settings.multiStartObjective=="cut" or settings.multiStartObjective=="maxCommVolume" or settings.multiStartObjective=="imbalance") ) {
+            if(comm->getRank() ==0 ) {
+                std::cout<<"WARNING: wrong value for parameter multiStartObjective= " << settings.multiStartObjective << ". Setting to cut" <<std::endl;
+            }
+            settings.multiStartObjective="cut";
+        }
+    }
+
+    if (vm.count("timeBudget")) {
+        settings.timeBudget = vm["timeBudget"].as<double>();
+        if( settings.timeBudget<0 ){
+            if(comm->getRank() ==0 ) {
+                std::cout<<"WARNING: wrong value for parameter timeBudget= " << settings.timeBudget << ". Setting to 0 (no limit)" <<std::endl;
+            }
+            settings.timeBudget = 0;
+        }
+    }
+
+    if (vm.count("initialBudgetShare")) {
+        settings.initialBudgetShare = vm["initialBudgetShare"].as<double>();
+        if( settings.initialBudgetShare<=0 or settings.initialBudgetShare>1 ){
+            if(comm->getRank() ==0 ) {
+                std::cout<<"WARNING: wrong value for parameter initialBudgetShare= " << settings.initialBudgetShare << ". Setting to 0.6" <<std::endl;
+            }
+            settings.initialBudgetShare = 0.6;
+        }
+    }
+
     if ( settings.hierLevels.size() > 0 ) {
         if (!(settings.initialPartition == Tool::geoHierKM
                 || settings.initialPartition == Tool::geoHierRepart)) {
@@ -453,6 +659,16 @@ Settings interpretSettings(cxxopts::ParseResult vm) {
         settings.tools = tools;
     }
 
+    if (vm.count("concurrentGroups")) {
+        settings.concurrentGroups = vm["concurrentGroups"].as<IndexType>();
+        if( settings.concurrentGroups<1 ){
+            if(comm->getRank() ==0 ) {
+                std::cout<<"WARNING: wrong value for parameter concurrentGroups= " << settings.concurrentGroups << ". Setting to 1" <<std::endl;
+            }
+            settings.concurrentGroups = 1;
+        }
+    }
+
     if( vm.count("PEgraphFile") or vm.count("topologyFile")){
         if( vm.count("distance_parameter_string") or vm.count("hierarchy_parameter_string") ){
             if(comm->getRank() ==0 ) {